@@ -0,0 +1,101 @@
+#ifndef PO_CONCURRENCY_COMPLETION_H
+#define PO_CONCURRENCY_COMPLETION_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file completion.h
+ * @brief Per-ticket completion notification usable across processes.
+ *
+ * A fixed-size table that lives in memory shared by producers (whoever
+ * finishes a ticket) and waiters (whoever holds it). Ticket @c t maps to slot
+ * @c t & (PO_COMPLETION_SLOTS - 1); the slot word records the last ticket
+ * completed there and doubles as a futex, so publishing a completion wakes
+ * only the threads waiting on that slot instead of every waiter of a queue.
+ * A per-slot waiter count lets publishers skip the syscall when nobody sleeps.
+ *
+ * Completions are also appended to a bounded log so a thread multiplexing
+ * many tickets (e.g. an event loop) can consume them in batches instead of
+ * blocking on each one.
+ *
+ * Ticket 0 is reserved ("nothing completed yet"). Two tickets alias when they
+ * are PO_COMPLETION_SLOTS apart; a newer completion on a slot also reports the
+ * older ticket as done, so the table is exact as long as fewer than
+ * PO_COMPLETION_SLOTS tickets are in flight at once.
+ *
+ * The structure holds no pointers and needs no destructor: it can be placed
+ * in a MAP_SHARED mapping and initialised with po_completion_init().
+ */
+
+#define PO_COMPLETION_SLOTS 65536u   // Must be a power of two
+#define PO_COMPLETION_LOG_SIZE 8192u // Must be a power of two
+
+typedef struct po_completion_slot_s {
+    atomic_uint done;    // Futex word: last ticket completed in this slot
+    atomic_uint waiters; // Threads currently blocked on done
+} po_completion_slot_t;
+
+typedef struct po_completion_table_s {
+    atomic_uint log_head;        // Completions published so far
+    atomic_uint_least64_t wakes; // futex wake calls issued
+    // Ring of recently completed tickets: ((log position + 1) << 32) | ticket,
+    // so a reader can tell a published entry from a stale or unwritten one.
+    atomic_uint_least64_t log[PO_COMPLETION_LOG_SIZE];
+    po_completion_slot_t slots[PO_COMPLETION_SLOTS];
+} po_completion_table_t;
+
+/**
+ * @brief Reset every slot and the completion log.
+ * @note Thread-safe: No (call before the table is shared).
+ */
+void po_completion_init(po_completion_table_t *table);
+
+/**
+ * @brief Mark @p ticket as completed and wake the threads waiting on it.
+ * @note Thread-safe: Yes. Async-signal-safe: No.
+ */
+void po_completion_publish(po_completion_table_t *table, uint32_t ticket);
+
+/**
+ * @brief Non-blocking check.
+ * @return true if @p ticket (non-zero) has completed.
+ */
+bool po_completion_is_done(po_completion_table_t *table, uint32_t ticket);
+
+/**
+ * @brief Block until @p ticket completes or @p timeout_ms elapses.
+ *
+ * @param timeout_ms Relative timeout; negative waits forever.
+ * @return 0 if the ticket completed, -1 on timeout (errno = ETIMEDOUT) or
+ *         if interrupted by a signal / po_completion_wake_all() (errno = EINTR).
+ */
+int po_completion_wait(po_completion_table_t *table, uint32_t ticket, int timeout_ms);
+
+/**
+ * @brief Wake every blocked waiter (e.g. office closing, shutdown).
+ *
+ * Woken waiters return -1/EINTR unless their ticket completed meanwhile.
+ */
+void po_completion_wake_all(po_completion_table_t *table);
+
+/**
+ * @brief Drain completed tickets from the log.
+ *
+ * @param cursor In/out read position; start from po_completion_log_head().
+ * @param out Destination for up to @p max tickets.
+ * @return Number of tickets copied, or -1 if the reader fell more than
+ *         PO_COMPLETION_LOG_SIZE entries behind (cursor is moved to the head;
+ *         the caller must re-check its tickets with po_completion_is_done()).
+ */
+int po_completion_log_read(po_completion_table_t *table, uint32_t *cursor, uint32_t *out,
+                           size_t max);
+
+/**
+ * @brief Current log write position.
+ */
+uint32_t po_completion_log_head(po_completion_table_t *table);
+
+#endif // PO_CONCURRENCY_COMPLETION_H
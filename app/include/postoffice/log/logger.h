@@ -5,17 +5,32 @@
  * @addtogroup logger
  * @brief Asynchronous, lock-free logging API and configuration.
  *
- * This module provides a non-blocking logging API using a lock-free MPMC
- * ring buffer and a background consumer thread to drain records to the
- * configured sinks (console, file, syslog).
+ * This module provides a non-blocking logging API using a lock-free byte
+ * ring and a background consumer thread to drain records to the configured
+ * sinks (console, file, syslog).
  *
  * Key features:
- * - Lock-free ring buffer for pending records (work queue)
- * - Preallocated record pool with a lock-free freelist to avoid malloc/free in hot paths
- * - Non-blocking hot path for producers via a lock-free MPMC ring buffer
- * - Dedicated consumer thread(s) for writing to sinks
+ * - Variable-length records in one contiguous byte ring (reserve/commit):
+ *   a record takes a small header plus its message, not a fixed 1 KiB slot
+ * - File and function names kept as pointers to the caller's static strings
+ * - Non-blocking hot path for producers (one CAS to reserve, one store to commit)
+ * - Dedicated consumer thread(s) for writing to sinks; console and file
+ *   output is staged per drained batch and written with one writev() per
+ *   sink, optionally by a separate writer thread (async_writer)
+ * - Size- or age-based file rotation (path.1 .. path.N), safe when several
+ *   processes append to the same file
  * - No dynamic allocations in the hot path
  * - Configurable log levels and overflow policies
+ * - Optional per-thread rings: each logging thread gets its own
+ *   single-producer ring on first use (freed after the thread exits), and the
+ *   consumer merges them by timestamp, so producers share no written cache line
+ * - Optional deferred formatting: producers copy the raw arguments and the
+ *   static format pointer instead of running vsnprintf; text is rendered on
+ *   the consumer thread, or never when only binary (.polog) sinks are
+ *   attached (decode those offline with tools/polog_decode)
+ * - Optional shared-memory transport: one process serves a ring in POSIX
+ *   shared memory and drains it together with its own records, in timestamp
+ *   order; other processes publish into it and run no consumer or sinks
  *
  * @{
  */
@@ -61,6 +76,7 @@ typedef enum po_logger_overflow_policy {
 #define LOGGER_SINK_SYSLOG (1u << 2)  /**< Log to syslog */
 #define LOGGER_SINK_STDOUT (1u << 3)  /**< Log to stdout */
 #define LOGGER_SINK_STDERR (1u << 4)  /**< Log to stderr */
+#define LOGGER_SINK_BINARY (1u << 5)  /**< Log unformatted records to a .polog file */
 
 /** Compile-time default level (can be overridden with -DLOGGER_COMPILE_LEVEL=N) */
 #ifndef LOGGER_COMPILE_LEVEL
@@ -79,10 +95,21 @@ typedef enum po_logger_overflow_policy {
  */
 typedef struct po_logger_config {
     po_log_level_t level; /**< Minimum runtime level (messages below are discarded) */
-    size_t ring_capacity; /**< Capacity of the internal ring buffer (power-of-two recommended) */
+    size_t ring_capacity; /**< Pending short records (power of two); the ring gets 128 B each */
     unsigned consumers;   /**< Number of consumer threads (0 = auto-detect) */
     po_logger_overflow_policy_t policy; /**< Behavior when queue is full */
     size_t cacheline_bytes;             /**< Cache line size (0 = use default) */
+    bool deferred_format;               /**< Capture raw args; format on the consumer */
+    bool per_thread_rings;              /**< One single-producer ring per logging thread */
+    size_t thread_ring_capacity;        /**< Short records per thread ring (0 = 64) */
+    bool async_writer;                  /**< Hand staged batches to a writer thread */
+    size_t rotate_bytes;                /**< Rotate a file sink at this size (0 = never) */
+    unsigned rotate_seconds;            /**< Rotate a file sink at this age (0 = never) */
+    unsigned rotate_keep;               /**< Rotated files kept as path.1..N (0 = 5) */
+    uint32_t default_category;          /**< Category of threads that never set one */
+    const char *shm_name;               /**< Shared log ring to join (NULL = private; see init) */
+    bool shm_serve;                     /**< Create shm_name and drain it (else publish into it) */
+    size_t shm_capacity;                /**< Short records in a served ring (0 = 16384) */
 } po_logger_config_t;
 
 /**
@@ -96,6 +123,20 @@ typedef struct po_logger_config {
  *                the necessary values, so the caller retains ownership of the struct.
  * @return 0 on success, -1 on error (errno set).
  *
+ * With @c shm_name and @c shm_serve, the logger also creates that shared
+ * ring and writes other processes' records to its own sinks, routed by
+ * category. With @c shm_name alone it attaches to the ring instead: records
+ * go there (formatted on the producer, DROP_NEW when full), no consumer
+ * thread starts, and the po_logger_add_sink_* calls succeed without opening
+ * anything. If no process serves the ring, the logger falls back to a
+ * private ring and local sinks.
+ *
+ * An attached client ignores @c ring_capacity, @c consumers, @c policy,
+ * @c deferred_format, @c per_thread_rings, @c thread_ring_capacity,
+ * @c async_writer and the @c rotate_* fields: they describe the private ring
+ * and sinks, which only the fallback uses. Its records follow the serving
+ * process's settings (rotation, writer) instead.
+ *
  * @note Thread-safe: No (Must be called from the main thread before spawning others).
  * @warning Calling this function multiple times without shutdown is undefined behavior.
  */
@@ -160,6 +201,18 @@ int po_logger_level_from_str(const char *str);
  */
 int po_logger_add_sink_console(bool use_stderr);
 
+/**
+ * @brief Add console output for some categories only.
+ *
+ * @param[in] use_stderr If true, use stderr; otherwise use stdout.
+ * @param[in] category_mask Bitmask of categories to show (0 = all). One mask
+ *                          applies to every console sink.
+ * @return 0 on success, -1 on error.
+ *
+ * @note Thread-safe: No (Ideally call during initialization).
+ */
+int po_logger_add_sink_console_categorized(bool use_stderr, uint32_t category_mask);
+
 /**
  * @brief Add file output as a log sink.
  *
@@ -187,6 +240,22 @@ int po_logger_add_sink_file(const char *path, bool append);
  */
 int po_logger_add_sink_file_categorized(const char *path, bool append, uint32_t category_mask);
 
+/**
+ * @brief Add a binary `.polog` file as a log sink.
+ *
+ * Records are stored unformatted: format, file and function strings once per
+ * file session, then per record a fixed header plus the captured arguments.
+ * Records formatted on the producer (deferred mode off, or a format it cannot
+ * capture) are stored as text. Decode with `tools/polog_decode`.
+ *
+ * @param[in] path Path to the .polog file (must not be NULL).
+ * @param[in] append If true, append a new session; otherwise overwrite.
+ * @return 0 on success, -1 on error.
+ *
+ * @note Thread-safe: No (Ideally call during initialization).
+ */
+int po_logger_add_sink_binary(const char *path, bool append);
+
 /**
  * @brief Add syslog as a log sink.
  *
@@ -19,9 +19,9 @@
  *  - Header-only macros: avoid function call / branch overhead on hot paths.
  *  - Safe to invoke before explicit creation (create-on-first-use for timers /
  *    counters / histograms via underlying perf calls where semantics allow).
- *  - **Timers use Coarse Clock**: To minimize overhead (~5ns vs ~50ns), timers
- *    use `CLOCK_MONOTONIC_COARSE`. Precision is reduced to **~1-4ms** (tick
- *    rate dependent). Use for coarse-grained loops, not micro-benchmarks.
+ *  - **Timers use a cheap clock**: a calibrated invariant TSC where available
+ *    (see po_perf_now_ns()), CLOCK_MONOTONIC otherwise. Each stop records the
+ *    total, the count and a log-linear latency histogram of the same name.
  *
  *  Performance Optimization Strategy
  *  ---------------------------------
@@ -43,8 +43,9 @@
  *  Thread Safety & Ordering
  *  ------------------------
  *  All macros delegate to perf asynchronous recording functions that are
- *  thread-safe. Timer start/stop pairings are logical (identified by name) and
- *  should be balanced from the same thread to preserve intuitive semantics.
+ *  thread-safe. Timer start/stop pairs keep their start stamp per thread, so
+ *  they must be balanced on the same thread; use PO_METRIC_TIMER_BEGIN/END
+ *  (stamp on the caller's stack) for scopes that nest or recurse.
  *  Histogram recording is fire-and-forget; bins are defined once.
  *
  *  Initialization / Shutdown
@@ -177,6 +178,10 @@ static inline uint64_t po_metric_now_ns(void) {
     do {                                                                                           \
         (void)(name);                                                                              \
     } while (0)
+#define PO_METRIC_COUNTER_CREATE_SHARDED(name)                                                     \
+    do {                                                                                           \
+        (void)(name);                                                                              \
+    } while (0)
 #define PO_METRIC_COUNTER_INC(name)                                                                \
     do {                                                                                           \
         (void)(name);                                                                              \
@@ -198,12 +203,19 @@ static inline uint64_t po_metric_now_ns(void) {
     do {                                                                                           \
         (void)(name);                                                                              \
     } while (0)
+#define PO_METRIC_TIMER_BEGIN(var, name)                                                           \
+    po_perf_timer_scope_t var = {.idx = ((void)(name), -1), .start_ns = 0}
+#define PO_METRIC_TIMER_END(var) ((void)(var))
 #define PO_METRIC_HISTO_CREATE(name, bins, nbins)                                                  \
     do {                                                                                           \
         (void)(name);                                                                              \
         (void)(bins);                                                                              \
         (void)(nbins);                                                                             \
     } while (0)
+#define PO_METRIC_HISTO_CREATE_HDR(name)                                                           \
+    do {                                                                                           \
+        (void)(name);                                                                              \
+    } while (0)
 #define PO_METRIC_HISTO_RECORD(name, val)                                                          \
     do {                                                                                           \
         (void)(name);                                                                              \
@@ -212,6 +224,8 @@ static inline uint64_t po_metric_now_ns(void) {
 #else
 // Active implementation with TLS-based index caching for zero-overhead hot paths
 #define PO_METRIC_COUNTER_CREATE(name) po_perf_counter_create((name))
+// Per-CPU counter for hot paths hit by many threads/processes (see perf.h)
+#define PO_METRIC_COUNTER_CREATE_SHARDED(name) po_perf_counter_create_sharded((name))
 
 // Compiler portability wrapper for constant checking optimization
 #if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
@@ -270,7 +284,28 @@ static inline uint64_t po_metric_now_ns(void) {
     } \
 } while (0)
 
+/**
+ * @def PO_METRIC_TIMER_BEGIN(var, name)
+ * @brief Declare @p var as a stack-held timing scope on timer @p name.
+ *
+ * Unlike START/STOP the start stamp lives in @p var, so scopes of one timer
+ * may nest or recurse. Close with PO_METRIC_TIMER_END(var).
+ */
+#define PO_METRIC_TIMER_BEGIN(var, name)                                                           \
+    po_perf_timer_scope_t var = po_perf_timer_begin_by_idx(__extension__({                         \
+        static __thread int _cached_idx = -1;                                                      \
+        int _idx = _cached_idx;                                                                    \
+        if (!PO_IS_CONSTANT(name))                                                                 \
+            _idx = po_perf_timer_lookup(name);                                                     \
+        else if (_idx < 0)                                                                         \
+            _idx = _cached_idx = po_perf_timer_lookup(name);                                       \
+        _idx;                                                                                      \
+    }))
+
+#define PO_METRIC_TIMER_END(var) po_perf_timer_end(&(var))
+
 #define PO_METRIC_HISTO_CREATE(name, bins, nbins) po_perf_histogram_create((name), (bins), (nbins))
+#define PO_METRIC_HISTO_CREATE_HDR(name) po_perf_histogram_create_hdr((name))
 
 #define PO_METRIC_HISTO_RECORD(name, val) do { \
     if (PO_IS_CONSTANT(name)) { \
@@ -15,6 +15,7 @@
 
 #include <arpa/inet.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/cdefs.h>
 #include <sys/epoll.h>
@@ -72,6 +73,24 @@ typedef uint8_t zcp_buffer_t;
 int net_send_message(int fd, uint8_t msg_type, uint8_t flags, const uint8_t *payload,
                      uint32_t payload_len) __nonnull((4));
 
+/**
+ * @brief Encode a complete frame (length prefix, header, payload) into @p buf.
+ *
+ * For callers that queue outgoing messages themselves, e.g. an event loop
+ * that must not block on a full socket buffer.
+ *
+ * @param[out] buf Destination.
+ * @param[in] cap Bytes available at @p buf.
+ * @param[in] msg_type The message type identifier.
+ * @param[in] flags The message flags bitmask.
+ * @param[in] payload Payload bytes (Nullable when @p payload_len is 0).
+ * @param[in] payload_len Length of payload in bytes.
+ * @return Frame size in bytes, or 0 if it does not fit in @p cap.
+ * @note Thread-safe: Yes.
+ */
+size_t net_encode_message(void *buf, size_t cap, uint8_t msg_type, uint8_t flags,
+                          const uint8_t *payload, uint32_t payload_len);
+
 /**
  * @brief Initialize process-wide zero-copy pools for TX/RX.
  *
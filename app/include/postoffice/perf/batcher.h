@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #ifdef __cplusplus
@@ -17,6 +18,14 @@ typedef enum {
     PERF_BATCHER_METRICS = 1 << 0
 } perf_batcher_flags_t;
 
+/**
+ * @brief Wakeup syscall counts of a batcher (see perf_batcher_get_stats).
+ */
+typedef struct {
+    uint64_t signals; // eventfd writes by producers
+    uint64_t parks;   // eventfd reads by consumers
+} perf_batcher_stats_t;
+
 /**
  * @brief Create a new batcher.
  *
@@ -39,7 +48,10 @@ po_perf_batcher_t *perf_batcher_create(po_perf_ringbuf_t *rb, size_t batch_size,
 void perf_batcher_destroy(po_perf_batcher_t **b);
 
 /**
- * @brief Enqueue an item via the batcher (signals consumer).
+ * @brief Enqueue an item via the batcher.
+ *
+ * Writes the eventfd only if a consumer is parked; while consumers are
+ * draining no syscall is made.
  *
  * @param[in] b The batcher (must not be NULL).
  * @param[in] item The item to enqueue (opaque pointer).
@@ -50,16 +62,43 @@ void perf_batcher_destroy(po_perf_batcher_t **b);
 int perf_batcher_enqueue(po_perf_batcher_t *b, void *item);
 
 /**
- * @brief Dequeue a batch of items.
+ * @brief Dequeue a batch of items, blocking while the ring is empty.
+ *
+ * Drains what is available; if nothing is, polls briefly (adaptive budget)
+ * and then parks on the eventfd until a producer wakes it.
  *
  * @param[in] b The batcher (must not be NULL).
- * @param[out] out Array of pointers to store items.
- * @return Number of items dequeued (can be 0), or -1 on error.
+ * @param[out] out Array of at least batch_size pointers to store items.
+ * @return Number of items dequeued (can be 0 after a wakeup that found
+ *         nothing, e.g. at shutdown), or -1 on error.
  *
- * @note Thread-safe: No (Single Consumer only).
+ * @note Thread-safe: Yes (several consumers may share a batcher).
  */
 ssize_t perf_batcher_next(po_perf_batcher_t *b, void **out);
 
+/**
+ * @brief Dequeue up to batch_size available items without blocking.
+ *
+ * One claim on the ring for the whole batch (see perf_ringbuf_dequeue_batch).
+ *
+ * @param[in] b The batcher (must not be NULL).
+ * @param[out] out Array of at least batch_size pointers to store items.
+ * @return Number of items dequeued (0 if empty).
+ *
+ * @note Thread-safe: Yes.
+ */
+size_t perf_batcher_drain(po_perf_batcher_t *b, void **out);
+
+/**
+ * @brief Read the wakeup syscall counters.
+ *
+ * @param[in] b The batcher (must not be NULL).
+ * @param[out] out Counters.
+ *
+ * @note Thread-safe: Yes.
+ */
+void perf_batcher_get_stats(const po_perf_batcher_t *b, perf_batcher_stats_t *out);
+
 /**
  * @brief Flush pending items to a file descriptor (e.g. socket).
  *
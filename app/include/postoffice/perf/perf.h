@@ -44,6 +44,48 @@ typedef struct po_perf_counter po_perf_counter_t;     // opaque
 typedef struct po_perf_timer po_perf_timer_t;         // opaque
 typedef struct po_perf_histogram po_perf_histogram_t; // opaque
 
+// Maximum metric name length, including the terminating NUL
+#define PO_PERF_METRIC_NAME_MAX 64
+
+/**
+ * @brief Point-in-time value of one counter (see po_perf_counter_snapshot).
+ */
+typedef struct po_perf_counter_sample {
+    char name[PO_PERF_METRIC_NAME_MAX];
+    uint64_t value;
+    int sharded; // 1 if the value was summed from per-CPU slots
+} po_perf_counter_sample_t;
+
+/**
+ * @brief Caller-owned timing scope (see po_perf_timer_begin_by_idx).
+ *
+ * Holds the start stamp on the caller's stack, so scopes nest, recurse and
+ * run concurrently on any number of threads without sharing state.
+ */
+typedef struct po_perf_timer_scope {
+    int idx;           // Timer index, -1 if the timer could not be resolved
+    uint64_t start_ns; // po_perf_now_ns() at begin
+} po_perf_timer_scope_t;
+
+/**
+ * @brief Point-in-time summary of one histogram (see po_perf_histogram_snapshot).
+ *
+ * count/sum/min/max are exact for log-linear histograms and zero-filled
+ * (except count) for threshold-bin ones.
+ */
+typedef struct po_perf_histogram_summary {
+    char name[PO_PERF_METRIC_NAME_MAX];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    int hdr; // 1 for log-linear histograms
+} po_perf_histogram_summary_t;
+
 // -----------------------------------------------------------------------------
 // Initialization / Shutdown
 // -----------------------------------------------------------------------------
@@ -104,6 +146,45 @@ void po_perf_counter_inc(const char *name) __nonnull((1));
  */
 void po_perf_counter_add(const char *name, uint64_t delta) __nonnull((1));
 
+/**
+ * @brief Create (or convert) a counter whose increments go to per-CPU slots.
+ *
+ * A plain counter is one cache line that every process and thread hammers;
+ * a sharded one gives each CPU its own line (indexed with sched_getcpu()) and
+ * is summed only when read. Meant for hot counters; the number of sharded
+ * counters is capped, so the call fails with ENOMEM once the cap is reached
+ * and the counter then keeps working unsharded. Increments recorded before
+ * the conversion are preserved. Idempotent.
+ *
+ * @param[in] name Counter name (string key, must not be NULL).
+ * @return 0 on success, -1 on failure (errno set).
+ *
+ * @note Thread-safe: Yes.
+ */
+int po_perf_counter_create_sharded(const char *name) __nonnull((1));
+
+/**
+ * @brief Read the current total of a counter.
+ *
+ * @param[in]  name Counter name (must not be NULL).
+ * @param[out] out  Counter total (per-CPU slots summed).
+ * @return 0 on success, -1 if the counter does not exist (errno = ENOENT).
+ *
+ * @note Thread-safe: Yes (concurrent increments may or may not be included).
+ */
+int po_perf_counter_value(const char *name, uint64_t *out) __nonnull((1, 2));
+
+/**
+ * @brief Copy the totals of up to @p max counters, in creation order.
+ *
+ * @param[out] out Destination array.
+ * @param[in]  max Capacity of @p out.
+ * @return Number of samples written.
+ *
+ * @note Thread-safe: Yes.
+ */
+size_t po_perf_counter_snapshot(po_perf_counter_sample_t *out, size_t max);
+
 // -----------------------------------------------------------------------------
 // Timers API
 // -----------------------------------------------------------------------------
@@ -119,7 +200,11 @@ void po_perf_counter_add(const char *name, uint64_t delta) __nonnull((1));
 int po_perf_timer_create(const char *name) __nonnull((1));
 
 /**
- * @brief Start a timer asynchronously.
+ * @brief Start a timer for the calling thread.
+ *
+ * The start stamp is kept per thread, so threads timing the same name do
+ * not interfere. A second start on the same thread before the stop restarts
+ * the measurement; use po_perf_timer_begin_by_idx() for nested scopes.
  *
  * @param[in] name Timer name (string key, must not be NULL).
  * @return 0 on success, -1 on failure.
@@ -129,7 +214,10 @@ int po_perf_timer_create(const char *name) __nonnull((1));
 int po_perf_timer_start(const char *name) __nonnull((1));
 
 /**
- * @brief Stop a timer asynchronously and accumulate elapsed time.
+ * @brief Stop the calling thread's timer and record the elapsed time.
+ *
+ * Adds to the timer's total and count and to its log-linear latency
+ * histogram (same name). A stop without a matching start is ignored.
  *
  * @param[in] name Timer name (string key, must not be NULL).
  * @return 0 on success, -1 on failure.
@@ -138,6 +226,29 @@ int po_perf_timer_start(const char *name) __nonnull((1));
  */
 int po_perf_timer_stop(const char *name) __nonnull((1));
 
+/**
+ * @brief Read the accumulated total and number of recorded intervals of a timer.
+ *
+ * @param[in]  name     Timer name (must not be NULL).
+ * @param[out] total_ns Sum of recorded intervals.
+ * @param[out] count    Number of recorded intervals.
+ * @return 0 on success, -1 if the timer does not exist (errno = ENOENT).
+ *
+ * @note Thread-safe: Yes.
+ */
+int po_perf_timer_value(const char *name, uint64_t *total_ns, uint64_t *count)
+    __nonnull((1, 2, 3));
+
+/**
+ * @brief Timestamp from the clock used by timers, in nanoseconds.
+ *
+ * Calibrated invariant TSC where available (a few ns per read), otherwise
+ * CLOCK_MONOTONIC. Only differences are meaningful.
+ *
+ * @note Thread-safe: Yes.
+ */
+uint64_t po_perf_now_ns(void);
+
 // -----------------------------------------------------------------------------
 // Histograms API
 // -----------------------------------------------------------------------------
@@ -166,6 +277,63 @@ int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbin
  */
 int po_perf_histogram_record(const char *name, uint64_t value) __nonnull((1));
 
+/**
+ * @brief Create a log-linear (HDR-style) histogram by name (synchronous).
+ *
+ * Covers the whole uint64_t range with no configuration: values below 32 are
+ * counted exactly, larger ones in 32 linear sub-buckets per power of two, so
+ * reported percentiles are within 1/32 (~3%) of the true value. Bucketing is
+ * a clz and a shift. The layout is fixed and lives in the perf SHM segment,
+ * so every process recording under the same name adds into one merged
+ * distribution. Recorded with po_perf_histogram_record() like any histogram.
+ *
+ * @param[in] name Histogram name (must not be NULL).
+ * @return 0 on success, -1 on failure (errno = EEXIST if the name is taken,
+ *         ENOMEM if the log-linear slots are exhausted).
+ *
+ * @note Thread-safe: Yes.
+ */
+int po_perf_histogram_create_hdr(const char *name) __nonnull((1));
+
+/**
+ * @brief Estimate the value at percentile @p p (0..100) of a histogram.
+ *
+ * Log-linear histograms return the upper edge of the bucket holding the
+ * ranked sample, clamped to the recorded min/max. Threshold-bin histograms
+ * return the bin threshold.
+ *
+ * @param[in]  name Histogram name (must not be NULL).
+ * @param[in]  p    Percentile, clamped to [0, 100].
+ * @param[out] out  Estimated value (0 if nothing was recorded).
+ * @return 0 on success, -1 if the histogram does not exist (errno = ENOENT).
+ *
+ * @note Thread-safe: Yes.
+ */
+int po_perf_histogram_percentile(const char *name, double p, uint64_t *out) __nonnull((1, 3));
+
+/**
+ * @brief Summarize one histogram (count, min/max, p50/p90/p99/p99.9).
+ *
+ * @param[in]  name Histogram name (must not be NULL).
+ * @param[out] out  Summary.
+ * @return 0 on success, -1 if the histogram does not exist (errno = ENOENT).
+ *
+ * @note Thread-safe: Yes.
+ */
+int po_perf_histogram_summary(const char *name, po_perf_histogram_summary_t *out)
+    __nonnull((1, 2));
+
+/**
+ * @brief Summarize up to @p max histograms, in creation order.
+ *
+ * @param[out] out Destination array.
+ * @param[in]  max Capacity of @p out.
+ * @return Number of summaries written.
+ *
+ * @note Thread-safe: Yes.
+ */
+size_t po_perf_histogram_snapshot(po_perf_histogram_summary_t *out, size_t max);
+
 // -----------------------------------------------------------------------------
 // Lookup Functions (for macro caching)
 // -----------------------------------------------------------------------------
@@ -243,6 +411,35 @@ void po_perf_timer_start_by_idx(int idx);
  */
 void po_perf_timer_stop_by_idx(int idx);
 
+/**
+ * @brief Open a stack-held timing scope.
+ *
+ * @param[in] idx Timer index from po_perf_timer_lookup (negative: no-op scope).
+ * @return Scope to pass to po_perf_timer_end().
+ *
+ * @note Thread-safe: Yes (no shared state until the scope ends).
+ */
+po_perf_timer_scope_t po_perf_timer_begin_by_idx(int idx);
+
+/**
+ * @brief Close a scope and record its duration into the timer.
+ *
+ * @param[in] scope Scope from po_perf_timer_begin_by_idx().
+ *
+ * @note Thread-safe: Yes (Wait-free).
+ */
+void po_perf_timer_end(const po_perf_timer_scope_t *scope);
+
+/**
+ * @brief Record an externally measured interval into a timer.
+ *
+ * @param[in] idx        Timer index.
+ * @param[in] elapsed_ns Interval length.
+ *
+ * @note Thread-safe: Yes (Wait-free).
+ */
+void po_perf_timer_record_by_idx(int idx, uint64_t elapsed_ns);
+
 /**
  * @brief Record histogram value by index.
  *
@@ -58,6 +58,22 @@ int perf_ringbuf_enqueue(po_perf_ringbuf_t *restrict rb, void *item);
  */
 int perf_ringbuf_dequeue(po_perf_ringbuf_t *restrict rb, void **restrict out);
 
+/**
+ * @brief Dequeue up to @p max items with a single claim on the read index.
+ *
+ * Takes the run of consecutive published items at the head (stopping at the
+ * first slot a producer has not finished writing), so a consumer pays one
+ * CAS per batch instead of one per item.
+ *
+ * @param[in] rb The ring buffer (must not be NULL).
+ * @param[out] out Array receiving the items, in FIFO order.
+ * @param[in] max Capacity of @p out.
+ * @return Number of items dequeued (0 if empty).
+ *
+ * @note Thread-safe: Yes (MPMC, like perf_ringbuf_dequeue()).
+ */
+size_t perf_ringbuf_dequeue_batch(po_perf_ringbuf_t *restrict rb, void **restrict out, size_t max);
+
 /**
  * @brief Get the number of items currently in the ring buffer.
  *
@@ -0,0 +1,78 @@
+/**
+ * @file class_queue.h
+ * @ingroup priority_queue
+ * @brief Lock-free two-class (high/normal) priority queue.
+ *
+ * A concurrent alternative to po_priority_queue_t for workloads whose ordering
+ * is "class first, then arrival": one bounded MPMC FIFO per class (sequence-
+ * numbered ring cells, no locks, no allocation after creation). Pop drains the
+ * high class before the normal one; within a class elements leave in the
+ * order their push completed.
+ *
+ * The ordering is relaxed only across concurrent operations: an element whose
+ * push has not returned yet may be missed by a concurrent pop. Arbitrary
+ * removal is not supported.
+ */
+
+#ifndef PO_CLASS_QUEUE_H
+#define PO_CLASS_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct po_class_queue po_class_queue_t;
+
+typedef enum {
+    PO_CLASS_QUEUE_HIGH = 0,   // Served first (e.g. VIP)
+    PO_CLASS_QUEUE_NORMAL = 1, // Served when the high class is empty
+    PO_CLASS_QUEUE_CLASSES
+} po_class_queue_class_t;
+
+/**
+ * @brief Create a queue.
+ * @param capacity Slots per class; rounded up to a power of two (min 2).
+ * @return New queue handle or NULL on failure.
+ */
+po_class_queue_t *po_class_queue_create(size_t capacity);
+
+/**
+ * @brief Destroy the queue. Elements still queued are not freed.
+ * @note Thread-safe: No (no concurrent operations may be in flight).
+ */
+void po_class_queue_destroy(po_class_queue_t *q);
+
+/**
+ * @brief Append an element to the tail of a class.
+ * @param element Non-NULL element pointer.
+ * @return 0 on success, -1 with errno = EAGAIN if that class is full
+ *         (EINVAL on bad arguments).
+ * @note Thread-safe: Yes (multi-producer).
+ */
+int po_class_queue_push(po_class_queue_t *q, void *element, po_class_queue_class_t cls);
+
+/**
+ * @brief Remove the oldest element of the highest non-empty class.
+ * @param[out] cls Optional: class the element came from.
+ * @return Element, or NULL if both classes are empty.
+ * @note Thread-safe: Yes (multi-consumer).
+ */
+void *po_class_queue_pop(po_class_queue_t *q, po_class_queue_class_t *cls);
+
+/**
+ * @brief Approximate number of queued elements (exact when quiescent).
+ */
+size_t po_class_queue_size(const po_class_queue_t *q);
+
+/**
+ * @brief Check if empty (same caveat as po_class_queue_size()).
+ * @return 1 if empty, 0 otherwise.
+ */
+int po_class_queue_is_empty(const po_class_queue_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // PO_CLASS_QUEUE_H
@@ -0,0 +1,111 @@
+/**
+ * @file indexed_heap.h
+ * @ingroup priority_queue
+ * @brief Intrusive indexed min-heap (4-ary, array-backed).
+ *
+ * An allocation-free alternative to po_priority_queue_t: callers embed a
+ * po_heap_node_t in their elements and the heap keeps each node's array
+ * position in it, so arbitrary removal and key updates need no lookup table.
+ * Push and pop only touch the contiguous node array (which grows by doubling
+ * and can be pre-sized with po_indexed_heap_reserve()).
+ *
+ * An element can be in at most one heap at a time through a given node.
+ */
+
+#ifndef PO_INDEXED_HEAP_H
+#define PO_INDEXED_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index of a node that is not in any heap
+#define PO_HEAP_NOT_QUEUED SIZE_MAX
+
+/**
+ * @brief Handle embedded in heap elements.
+ */
+typedef struct po_heap_node {
+    size_t index; // Position in the heap array, PO_HEAP_NOT_QUEUED if detached
+} po_heap_node_t;
+
+#define PO_HEAP_NODE_INIT {.index = PO_HEAP_NOT_QUEUED}
+
+// Recover the enclosing element from its embedded node
+#define PO_HEAP_ENTRY(node, type, member) ((type *)((char *)(node) - offsetof(type, member)))
+
+typedef struct po_indexed_heap po_indexed_heap_t;
+
+/**
+ * @brief Node ordering. Returns <0 if @p a must come out before @p b.
+ */
+typedef int (*po_indexed_heap_cmp_t)(const po_heap_node_t *a, const po_heap_node_t *b);
+
+/**
+ * @brief Create a new heap.
+ * @param compare Node comparator (Min-Heap property).
+ * @param capacity Initial slots (0 = small default).
+ * @return New heap handle or NULL on failure.
+ */
+po_indexed_heap_t *po_indexed_heap_create(po_indexed_heap_cmp_t compare, size_t capacity);
+
+/**
+ * @brief Destroy the heap. Queued nodes are left untouched.
+ */
+void po_indexed_heap_destroy(po_indexed_heap_t *heap);
+
+/**
+ * @brief Grow the node array so @p capacity elements fit without reallocating.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int po_indexed_heap_reserve(po_indexed_heap_t *heap, size_t capacity);
+
+/**
+ * @brief Insert a detached node.
+ * @return 0 on success, -1 on failure (errno = EEXIST if the node is already
+ *         queued, ENOMEM if the array could not grow).
+ */
+int po_indexed_heap_push(po_indexed_heap_t *heap, po_heap_node_t *node);
+
+/**
+ * @brief Remove and return the top node (min); it is left detached.
+ * @return Top node or NULL if empty.
+ */
+po_heap_node_t *po_indexed_heap_pop(po_indexed_heap_t *heap);
+
+/**
+ * @brief Peek at the top node without removing it.
+ * @return Top node or NULL if empty.
+ */
+po_heap_node_t *po_indexed_heap_peek(const po_indexed_heap_t *heap);
+
+/**
+ * @brief Remove a queued node in O(log N).
+ * @return 0 on success, -1 if the node is not in this heap.
+ */
+int po_indexed_heap_remove(po_indexed_heap_t *heap, po_heap_node_t *node);
+
+/**
+ * @brief Restore heap order after the key of a queued node changed.
+ * @return 0 on success, -1 if the node is not in this heap.
+ */
+int po_indexed_heap_update(po_indexed_heap_t *heap, po_heap_node_t *node);
+
+/**
+ * @brief Get the number of elements.
+ */
+size_t po_indexed_heap_size(const po_indexed_heap_t *heap);
+
+/**
+ * @brief Check if empty.
+ * @return 1 if empty, 0 otherwise.
+ */
+int po_indexed_heap_is_empty(const po_indexed_heap_t *heap);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // PO_INDEXED_HEAP_H
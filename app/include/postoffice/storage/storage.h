@@ -84,6 +84,8 @@ typedef struct po_storage_config {
     size_t batch_size;                       //!< Max records per flush batch (>=1); impacts latency vs throughput.
     po_logstore_fsync_policy_t fsync_policy; //!< Durability policy controlling fsync frequency.
     bool attach_logger_sink;                 //!< If true, install a logger sink writing formatted lines to the store.
+    size_t segment_bytes;                    //!< Log segment roll threshold (0 => single aof.log).
+    bool background_compact;                 //!< If true, compact sealed segments in the background.
 } po_storage_config_t;
 
 /**
@@ -74,8 +74,8 @@ po_perf_ringbuf_t *perf_ringbuf_create(size_t capacity, perf_ringbuf_flags_t fla
     if (flags & PERF_RINGBUF_METRICS) {
         PO_METRIC_COUNTER_CREATE("ringbuf.create");
         PO_METRIC_COUNTER_INC("ringbuf.create");
-        PO_METRIC_COUNTER_CREATE("ringbuf.enqueue");
-        PO_METRIC_COUNTER_CREATE("ringbuf.dequeue");
+        PO_METRIC_COUNTER_CREATE_SHARDED("ringbuf.enqueue");
+        PO_METRIC_COUNTER_CREATE_SHARDED("ringbuf.dequeue");
         PO_METRIC_COUNTER_CREATE("ringbuf.full");
     }
 
@@ -163,6 +163,48 @@ int perf_ringbuf_dequeue(po_perf_ringbuf_t *restrict rb, void **restrict out) {
     return 0;
 }
 
+size_t perf_ringbuf_dequeue_batch(po_perf_ringbuf_t *restrict rb, void **restrict out, size_t max) {
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    size_t n;
+
+    for (;;) {
+        // Length of the published run starting at head
+        n = 0;
+        while (n < max) {
+            size_t seq = atomic_load_explicit(&rb->slots[(head + n) & rb->mask].seq,
+                                              memory_order_acquire);
+            if (seq != head + n + 1)
+                break;
+            n++;
+        }
+
+        if (n == 0) {
+            size_t seq = atomic_load_explicit(&rb->slots[head & rb->mask].seq,
+                                              memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)(head + 1) < 0)
+                return 0; // Empty
+            head = atomic_load_explicit(&rb->head, memory_order_relaxed); // Stale head
+            continue;
+        }
+
+        if (likely(atomic_compare_exchange_weak_explicit(&rb->head, &head, head + n,
+                                                         memory_order_relaxed,
+                                                         memory_order_relaxed)))
+            break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        slot_t *slot = &rb->slots[(head + i) & rb->mask];
+        out[i] = slot->item;
+        atomic_store_explicit(&slot->seq, head + i + rb->mask + 1, memory_order_release);
+    }
+
+    if (rb->flags & PERF_RINGBUF_METRICS)
+        PO_METRIC_COUNTER_ADD("ringbuf.dequeue", n);
+
+    return n;
+}
+
 size_t perf_ringbuf_count(const po_perf_ringbuf_t *restrict rb) {
     size_t h = atomic_load_explicit(&rb->head, memory_order_relaxed);
     size_t t = atomic_load_explicit(&rb->tail, memory_order_relaxed);
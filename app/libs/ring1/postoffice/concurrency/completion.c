@@ -0,0 +1,169 @@
+#include "postoffice/concurrency/completion.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SLOT_MASK (PO_COMPLETION_SLOTS - 1u)
+#define LOG_MASK (PO_COMPLETION_LOG_SIZE - 1u)
+
+_Static_assert((PO_COMPLETION_SLOTS & SLOT_MASK) == 0, "PO_COMPLETION_SLOTS must be a power of 2");
+_Static_assert((PO_COMPLETION_LOG_SIZE & LOG_MASK) == 0,
+               "PO_COMPLETION_LOG_SIZE must be a power of 2");
+_Static_assert(sizeof(atomic_uint) == sizeof(uint32_t), "futex word must be 32 bits");
+
+// Shared (non-private) futex ops: the table may live in a MAP_SHARED region.
+static long futex_wait(atomic_uint *addr, uint32_t expected, const struct timespec *timeout) {
+    return syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static long futex_wake(atomic_uint *addr, int count) {
+    return syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+static bool ticket_reached(uint32_t done, uint32_t ticket) {
+    // Only tickets of the same residue class land in a slot, so anything at or
+    // after ours (modulo wrap-around) means ours has been published.
+    return done != 0 && (int32_t)(done - ticket) >= 0;
+}
+
+void po_completion_init(po_completion_table_t *table) {
+    memset(table, 0, sizeof(*table));
+}
+
+void po_completion_publish(po_completion_table_t *table, uint32_t ticket) {
+    if (ticket == 0)
+        return;
+
+    po_completion_slot_t *slot = &table->slots[ticket & SLOT_MASK];
+    atomic_store(&slot->done, ticket);
+    // seq_cst store/load pairs with the waiter's increment-then-check so one
+    // of the two sides always observes the other.
+    if (atomic_load(&slot->waiters) > 0) {
+        futex_wake(&slot->done, INT_MAX);
+        atomic_fetch_add_explicit(&table->wakes, 1, memory_order_relaxed);
+    }
+
+    uint32_t pos = atomic_fetch_add(&table->log_head, 1);
+    atomic_store_explicit(&table->log[pos & LOG_MASK], ((uint64_t)(pos + 1) << 32) | ticket,
+                          memory_order_release);
+}
+
+bool po_completion_is_done(po_completion_table_t *table, uint32_t ticket) {
+    if (ticket == 0)
+        return false;
+    return ticket_reached(atomic_load(&table->slots[ticket & SLOT_MASK].done), ticket);
+}
+
+int po_completion_wait(po_completion_table_t *table, uint32_t ticket, int timeout_ms) {
+    if (ticket == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    po_completion_slot_t *slot = &table->slots[ticket & SLOT_MASK];
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    atomic_fetch_add(&slot->waiters, 1);
+    int rc = -1;
+    int err = ETIMEDOUT;
+    for (;;) {
+        uint32_t done = atomic_load(&slot->done);
+        if (ticket_reached(done, ticket)) {
+            rc = 0;
+            break;
+        }
+
+        struct timespec rel, *prel = NULL;
+        if (timeout_ms >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            rel.tv_sec = deadline.tv_sec - now.tv_sec;
+            rel.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (rel.tv_nsec < 0) {
+                rel.tv_sec--;
+                rel.tv_nsec += 1000000000L;
+            }
+            if (rel.tv_sec < 0)
+                break; // ETIMEDOUT
+            prel = &rel;
+        }
+
+        if (futex_wait(&slot->done, done, prel) == 0) {
+            // Woken: either our ticket, an aliased one, or wake_all()
+            if (ticket_reached(atomic_load(&slot->done), ticket)) {
+                rc = 0;
+                break;
+            }
+            if (atomic_load(&slot->done) == done) {
+                err = EINTR;
+                break;
+            }
+        } else if (errno == ETIMEDOUT) {
+            break;
+        } else if (errno == EINTR) {
+            err = EINTR;
+            break;
+        }
+        // EAGAIN: the word changed before we slept; re-check
+    }
+    atomic_fetch_sub(&slot->waiters, 1);
+
+    if (rc != 0)
+        errno = err;
+    return rc;
+}
+
+void po_completion_wake_all(po_completion_table_t *table) {
+    for (uint32_t i = 0; i < PO_COMPLETION_SLOTS; i++) {
+        if (atomic_load_explicit(&table->slots[i].waiters, memory_order_relaxed) > 0) {
+            futex_wake(&table->slots[i].done, INT_MAX);
+            atomic_fetch_add_explicit(&table->wakes, 1, memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t po_completion_log_head(po_completion_table_t *table) {
+    return atomic_load(&table->log_head);
+}
+
+int po_completion_log_read(po_completion_table_t *table, uint32_t *cursor, uint32_t *out,
+                           size_t max) {
+    uint32_t head = atomic_load(&table->log_head);
+    uint32_t pos = *cursor;
+    if (head - pos > PO_COMPLETION_LOG_SIZE) {
+        *cursor = head;
+        return -1;
+    }
+
+    size_t n = 0;
+    while (pos != head && n < max) {
+        uint64_t entry = atomic_load_explicit(&table->log[pos & LOG_MASK], memory_order_acquire);
+        uint32_t entry_pos = (uint32_t)(entry >> 32) - 1;
+        if (entry_pos != pos) {
+            if (entry != 0 && (int32_t)(entry_pos - pos) > 0) { // Lapped while reading
+                *cursor = head;
+                return -1;
+            }
+            break; // Slot reserved but not written yet: pick it up next time
+        }
+        out[n++] = (uint32_t)entry;
+        pos++;
+    }
+
+    *cursor = pos;
+    return (int)n;
+}
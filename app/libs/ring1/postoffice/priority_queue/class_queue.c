@@ -0,0 +1,90 @@
+/**
+ * @file class_queue.c
+ * @brief Implementation of the lock-free two-class priority queue.
+ *
+ * One MPMC sequenced ring (perf_ringbuf) per class; pop scans the classes in
+ * priority order.
+ */
+
+#include <errno.h>
+#include <postoffice/perf/ringbuf.h>
+#include <postoffice/priority_queue/class_queue.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct po_class_queue {
+    po_perf_ringbuf_t *rings[PO_CLASS_QUEUE_CLASSES];
+};
+
+static size_t round_up_pow2(size_t n) {
+    size_t p = 2;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+po_class_queue_t *po_class_queue_create(size_t capacity) {
+    if (capacity == 0 || capacity > (SIZE_MAX >> 1) + 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    po_class_queue_t *q = calloc(1, sizeof(*q));
+    if (!q)
+        return NULL;
+
+    size_t cap = round_up_pow2(capacity);
+    for (int i = 0; i < PO_CLASS_QUEUE_CLASSES; i++) {
+        q->rings[i] = perf_ringbuf_create(cap, PERF_RINGBUF_NOFLAGS);
+        if (!q->rings[i]) {
+            po_class_queue_destroy(q);
+            return NULL;
+        }
+    }
+    return q;
+}
+
+void po_class_queue_destroy(po_class_queue_t *q) {
+    if (!q)
+        return;
+    for (int i = 0; i < PO_CLASS_QUEUE_CLASSES; i++)
+        perf_ringbuf_destroy(&q->rings[i]);
+    free(q);
+}
+
+int po_class_queue_push(po_class_queue_t *q, void *element, po_class_queue_class_t cls) {
+    if (!q || !element || (unsigned)cls >= PO_CLASS_QUEUE_CLASSES) {
+        errno = EINVAL;
+        return -1;
+    }
+    return perf_ringbuf_enqueue(q->rings[cls], element); // EAGAIN when full
+}
+
+void *po_class_queue_pop(po_class_queue_t *q, po_class_queue_class_t *cls) {
+    if (!q)
+        return NULL;
+
+    for (int i = 0; i < PO_CLASS_QUEUE_CLASSES; i++) {
+        void *element;
+        if (perf_ringbuf_dequeue(q->rings[i], &element) == 0) {
+            if (cls)
+                *cls = (po_class_queue_class_t)i;
+            return element;
+        }
+    }
+    return NULL;
+}
+
+size_t po_class_queue_size(const po_class_queue_t *q) {
+    if (!q)
+        return 0;
+
+    size_t total = 0;
+    for (int i = 0; i < PO_CLASS_QUEUE_CLASSES; i++)
+        total += perf_ringbuf_count(q->rings[i]);
+    return total;
+}
+
+int po_class_queue_is_empty(const po_class_queue_t *q) {
+    return po_class_queue_size(q) == 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file indexed_heap.c
+ * @brief Implementation of the intrusive indexed heap.
+ *
+ * 4-ary layout: children of i are 4i+1..4i+4, so a sift-down touches one or
+ * two cache lines of node pointers per level and the tree is half as deep as
+ * a binary heap. Sifting moves a "hole" instead of swapping, writing each
+ * displaced node (and its index) once.
+ */
+
+#include <errno.h>
+#include <postoffice/priority_queue/indexed_heap.h>
+#include <stdlib.h>
+
+#define HEAP_ARITY 4
+#define HEAP_DEFAULT_CAPACITY 16
+
+struct po_indexed_heap {
+    po_heap_node_t **nodes;
+    size_t size;
+    size_t capacity;
+    po_indexed_heap_cmp_t compare;
+};
+
+po_indexed_heap_t *po_indexed_heap_create(po_indexed_heap_cmp_t compare, size_t capacity) {
+    if (!compare) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    po_indexed_heap_t *heap = calloc(1, sizeof(*heap));
+    if (!heap)
+        return NULL;
+
+    heap->compare = compare;
+    if (po_indexed_heap_reserve(heap, capacity ? capacity : HEAP_DEFAULT_CAPACITY) != 0) {
+        free(heap);
+        return NULL;
+    }
+    return heap;
+}
+
+void po_indexed_heap_destroy(po_indexed_heap_t *heap) {
+    if (!heap)
+        return;
+    free(heap->nodes);
+    free(heap);
+}
+
+int po_indexed_heap_reserve(po_indexed_heap_t *heap, size_t capacity) {
+    if (!heap)
+        return -1;
+    if (capacity <= heap->capacity)
+        return 0;
+    if (capacity > SIZE_MAX / sizeof(*heap->nodes)) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    po_heap_node_t **nodes = realloc(heap->nodes, capacity * sizeof(*nodes));
+    if (!nodes)
+        return -1;
+    heap->nodes = nodes;
+    heap->capacity = capacity;
+    return 0;
+}
+
+static inline void place(po_indexed_heap_t *heap, size_t index, po_heap_node_t *node) {
+    heap->nodes[index] = node;
+    node->index = index;
+}
+
+// Move @p node up from hole @p index; returns its final position.
+static size_t sift_up(po_indexed_heap_t *heap, size_t index, po_heap_node_t *node) {
+    while (index > 0) {
+        size_t parent = (index - 1) / HEAP_ARITY;
+        po_heap_node_t *p = heap->nodes[parent];
+        if (heap->compare(node, p) >= 0)
+            break;
+        place(heap, index, p);
+        index = parent;
+    }
+    place(heap, index, node);
+    return index;
+}
+
+static void sift_down(po_indexed_heap_t *heap, size_t index, po_heap_node_t *node) {
+    size_t size = heap->size;
+    for (;;) {
+        size_t first = HEAP_ARITY * index + 1;
+        if (first >= size)
+            break;
+
+        size_t last = first + HEAP_ARITY < size ? first + HEAP_ARITY : size;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (heap->compare(heap->nodes[c], heap->nodes[best]) < 0)
+                best = c;
+        }
+
+        if (heap->compare(heap->nodes[best], node) >= 0)
+            break;
+        place(heap, index, heap->nodes[best]);
+        index = best;
+    }
+    place(heap, index, node);
+}
+
+// Re-sift @p node sitting in hole @p index in whichever direction it belongs.
+static void restore(po_indexed_heap_t *heap, size_t index, po_heap_node_t *node) {
+    if (sift_up(heap, index, node) == index)
+        sift_down(heap, index, node);
+}
+
+int po_indexed_heap_push(po_indexed_heap_t *heap, po_heap_node_t *node) {
+    if (!heap || !node) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (node->index != PO_HEAP_NOT_QUEUED) {
+        errno = EEXIST;
+        return -1;
+    }
+
+    if (heap->size == heap->capacity && po_indexed_heap_reserve(heap, heap->capacity * 2) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    sift_up(heap, heap->size++, node);
+    return 0;
+}
+
+po_heap_node_t *po_indexed_heap_pop(po_indexed_heap_t *heap) {
+    if (!heap || heap->size == 0)
+        return NULL;
+
+    po_heap_node_t *top = heap->nodes[0];
+    po_heap_node_t *last = heap->nodes[--heap->size];
+    if (heap->size > 0)
+        sift_down(heap, 0, last);
+
+    top->index = PO_HEAP_NOT_QUEUED;
+    return top;
+}
+
+po_heap_node_t *po_indexed_heap_peek(const po_indexed_heap_t *heap) {
+    if (!heap || heap->size == 0)
+        return NULL;
+    return heap->nodes[0];
+}
+
+static int owns(const po_indexed_heap_t *heap, const po_heap_node_t *node) {
+    return heap && node && node->index < heap->size && heap->nodes[node->index] == node;
+}
+
+int po_indexed_heap_remove(po_indexed_heap_t *heap, po_heap_node_t *node) {
+    if (!owns(heap, node))
+        return -1;
+
+    size_t index = node->index;
+    po_heap_node_t *last = heap->nodes[--heap->size];
+    if (last != node)
+        restore(heap, index, last);
+
+    node->index = PO_HEAP_NOT_QUEUED;
+    return 0;
+}
+
+int po_indexed_heap_update(po_indexed_heap_t *heap, po_heap_node_t *node) {
+    if (!owns(heap, node))
+        return -1;
+
+    restore(heap, node->index, node);
+    return 0;
+}
+
+size_t po_indexed_heap_size(const po_indexed_heap_t *heap) {
+    return heap ? heap->size : 0;
+}
+
+int po_indexed_heap_is_empty(const po_indexed_heap_t *heap) {
+    return heap ? heap->size == 0 : 1;
+}
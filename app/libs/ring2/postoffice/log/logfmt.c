@@ -0,0 +1,691 @@
+/**
+ * @file logfmt.c
+ * @brief Deferred printf capture/render and the `.polog` reader and writer.
+ *
+ * Capture and render share one conversion parser, so the blob layout is
+ * defined by the format string alone and needs no per-argument tags.
+ * Render rebuilds each conversion with a normalized length modifier (all
+ * integers are widened to 64 bits at capture) and formats it with one
+ * snprintf call per argument.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
+#include "log/logfmt.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN_NONE 0
+#define LEN_HH 1
+#define LEN_H 2
+#define LEN_L 3
+#define LEN_LL 4
+#define LEN_LD 5
+#define LEN_J 6
+#define LEN_Z 7
+#define LEN_T 8
+
+#define SPEC_DIGITS_MAX 9u // keeps widths and precisions within int
+#define POLOG_MSG_MAX 4096u
+#define POLOG_STR_MAX (1u << 20)
+
+typedef struct {
+    char flags[8];
+    const char *width; // digits, unless width_star
+    size_t width_len;
+    bool width_star;
+    bool has_prec;
+    const char *prec; // digits, unless prec_star
+    size_t prec_len;
+    bool prec_star;
+    unsigned char len;
+    char conv;
+} fmt_spec_t;
+
+// Parse one conversion; @p p points just past the '%'. Returns the character
+// after the conversion, or NULL if it cannot be deferred.
+static const char *parse_spec(const char *p, fmt_spec_t *s) {
+    memset(s, 0, sizeof(*s));
+    size_t nf = 0;
+    while (*p && strchr("-+ #0'I", *p)) {
+        if (nf + 1 >= sizeof(s->flags))
+            return NULL;
+        s->flags[nf++] = *p++;
+    }
+    if (*p == '*') {
+        s->width_star = true;
+        p++;
+    } else {
+        s->width = p;
+        while (*p >= '0' && *p <= '9')
+            p++;
+        s->width_len = (size_t)(p - s->width);
+    }
+    if (*p == '.') {
+        s->has_prec = true;
+        p++;
+        if (*p == '*') {
+            s->prec_star = true;
+            p++;
+        } else {
+            s->prec = p;
+            while (*p >= '0' && *p <= '9')
+                p++;
+            s->prec_len = (size_t)(p - s->prec);
+        }
+    }
+    if (s->width_len > SPEC_DIGITS_MAX || s->prec_len > SPEC_DIGITS_MAX)
+        return NULL;
+
+    switch (*p) {
+    case 'h':
+        s->len = p[1] == 'h' ? LEN_HH : LEN_H;
+        p += s->len == LEN_HH ? 2 : 1;
+        break;
+    case 'l':
+        s->len = p[1] == 'l' ? LEN_LL : LEN_L;
+        p += s->len == LEN_LL ? 2 : 1;
+        break;
+    case 'q':
+        s->len = LEN_LL;
+        p++;
+        break;
+    case 'L':
+        s->len = LEN_LD;
+        p++;
+        break;
+    case 'j':
+        s->len = LEN_J;
+        p++;
+        break;
+    case 'z':
+    case 'Z':
+        s->len = LEN_Z;
+        p++;
+        break;
+    case 't':
+        s->len = LEN_T;
+        p++;
+        break;
+    default:
+        break;
+    }
+
+    s->conv = *p;
+    switch (s->conv) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        if (s->len == LEN_LD)
+            return NULL;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (s->len != LEN_NONE && s->len != LEN_L && s->len != LEN_LD)
+            return NULL;
+        break;
+    case 'c':
+    case 's':
+    case 'p':
+    case '%':
+        if (s->len != LEN_NONE)
+            return NULL; // wide characters and strings
+        break;
+    default:
+        return NULL; // %n, %m, end of string, unknown
+    }
+    return p + 1;
+}
+
+static inline int put_bytes(uint8_t *buf, size_t cap, size_t *n, const void *v, size_t len) {
+    if (cap - *n < len)
+        return -1;
+    memcpy(buf + *n, v, len);
+    *n += len;
+    return 0;
+}
+
+static inline int put_u64(uint8_t *buf, size_t cap, size_t *n, uint64_t v) {
+    return put_bytes(buf, cap, n, &v, sizeof(v));
+}
+
+static inline int get_bytes(const uint8_t *args, size_t argsz, size_t *a, void *v, size_t len) {
+    if (argsz - *a < len)
+        return -1;
+    memcpy(v, args + *a, len);
+    *a += len;
+    return 0;
+}
+
+static long parse_digits(const char *p, size_t n) {
+    long v = 0;
+    for (size_t i = 0; i < n; i++)
+        v = v * 10 + (p[i] - '0');
+    return v;
+}
+
+ssize_t po_logfmt_capture(const char *fmt, va_list ap, uint8_t *buf, size_t cap) {
+    size_t n = 0;
+    for (const char *p = fmt; (p = strchr(p, '%')) != NULL;) {
+        fmt_spec_t s;
+        p = parse_spec(p + 1, &s);
+        if (!p)
+            return -1;
+        if (s.conv == '%')
+            continue;
+        if (s.width_star && put_u64(buf, cap, &n, (uint64_t)(int64_t)va_arg(ap, int)) != 0)
+            return -1;
+        long prec = s.has_prec && !s.prec_star ? parse_digits(s.prec, s.prec_len) : -1;
+        if (s.prec_star) {
+            prec = va_arg(ap, int);
+            if (put_u64(buf, cap, &n, (uint64_t)(int64_t)prec) != 0)
+                return -1;
+        }
+
+        uint64_t u;
+        switch (s.conv) {
+        case 'd':
+        case 'i':
+            switch (s.len) {
+            case LEN_HH:
+                u = (uint64_t)(int64_t)(signed char)va_arg(ap, int);
+                break;
+            case LEN_H:
+                u = (uint64_t)(int64_t)(short)va_arg(ap, int);
+                break;
+            case LEN_L:
+                u = (uint64_t)(int64_t)va_arg(ap, long);
+                break;
+            case LEN_LL:
+                u = (uint64_t)(int64_t)va_arg(ap, long long);
+                break;
+            case LEN_J:
+                u = (uint64_t)(int64_t)va_arg(ap, intmax_t);
+                break;
+            case LEN_Z:
+                u = (uint64_t)(int64_t)va_arg(ap, ssize_t);
+                break;
+            case LEN_T:
+                u = (uint64_t)(int64_t)va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                u = (uint64_t)(int64_t)va_arg(ap, int);
+                break;
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch (s.len) {
+            case LEN_HH:
+                u = (unsigned char)va_arg(ap, unsigned);
+                break;
+            case LEN_H:
+                u = (unsigned short)va_arg(ap, unsigned);
+                break;
+            case LEN_L:
+                u = va_arg(ap, unsigned long);
+                break;
+            case LEN_LL:
+                u = va_arg(ap, unsigned long long);
+                break;
+            case LEN_J:
+                u = va_arg(ap, uintmax_t);
+                break;
+            case LEN_Z:
+                u = va_arg(ap, size_t);
+                break;
+            case LEN_T:
+                u = (uint64_t)va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                u = va_arg(ap, unsigned);
+                break;
+            }
+            break;
+        case 'c':
+            u = (uint64_t)(int64_t)va_arg(ap, int);
+            break;
+        case 'p':
+            u = (uint64_t)(uintptr_t)va_arg(ap, void *);
+            break;
+        case 's': {
+            const char *str = va_arg(ap, const char *);
+            if (!str)
+                str = "(null)";
+            size_t len = prec >= 0 ? strnlen(str, (size_t)prec) : strlen(str);
+            if (cap - n < sizeof(uint16_t))
+                return -1;
+            size_t room = cap - n - sizeof(uint16_t);
+            if (len > room)
+                len = room; // cut like vsnprintf would
+            if (len > UINT16_MAX)
+                len = UINT16_MAX;
+            uint16_t l16 = (uint16_t)len;
+            (void)put_bytes(buf, cap, &n, &l16, sizeof(l16));
+            (void)put_bytes(buf, cap, &n, str, len);
+            continue;
+        }
+        default: { // floating point
+            if (s.len == LEN_LD) {
+                long double ld = va_arg(ap, long double);
+                if (put_bytes(buf, cap, &n, &ld, sizeof(ld)) != 0)
+                    return -1;
+            } else {
+                double d = va_arg(ap, double);
+                if (put_bytes(buf, cap, &n, &d, sizeof(d)) != 0)
+                    return -1;
+            }
+            continue;
+        }
+        }
+        if (put_u64(buf, cap, &n, u) != 0)
+            return -1;
+    }
+    return (ssize_t)n;
+}
+
+// Rebuild a conversion as '%' flags width [.prec] @p lenmod conv, with star
+// values substituted so it always takes exactly one argument.
+static void build_spec(char *out, size_t outsz, const fmt_spec_t *s, long width, long prec,
+                       const char *lenmod) {
+    size_t o = (size_t)snprintf(out, outsz, "%%%s", s->flags);
+    if (s->width_star)
+        o += (size_t)snprintf(out + o, outsz - o, "%ld", width);
+    else
+        o += (size_t)snprintf(out + o, outsz - o, "%.*s", (int)s->width_len, s->width);
+    if (prec >= 0)
+        o += (size_t)snprintf(out + o, outsz - o, ".%ld", prec);
+    snprintf(out + o, outsz - o, "%s%c", lenmod, s->conv);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+static int fmt_ll(char *o, size_t n, const char *spec, long long v) {
+    return snprintf(o, n, spec, v);
+}
+static int fmt_ull(char *o, size_t n, const char *spec, unsigned long long v) {
+    return snprintf(o, n, spec, v);
+}
+static int fmt_int(char *o, size_t n, const char *spec, int v) {
+    return snprintf(o, n, spec, v);
+}
+static int fmt_dbl(char *o, size_t n, const char *spec, double v) {
+    return snprintf(o, n, spec, v);
+}
+static int fmt_ldbl(char *o, size_t n, const char *spec, long double v) {
+    return snprintf(o, n, spec, v);
+}
+static int fmt_ptr(char *o, size_t n, const char *spec, const void *v) {
+    return snprintf(o, n, spec, v);
+}
+#pragma GCC diagnostic pop
+
+static inline void emit(char *out, size_t outsz, size_t *o, const char *p, size_t len) {
+    size_t room = outsz - 1 - *o;
+    if (len > room)
+        len = room;
+    memcpy(out + *o, p, len);
+    *o += len;
+}
+
+size_t po_logfmt_render(const char *fmt, const uint8_t *args, size_t argsz, char *out,
+                        size_t outsz) {
+    if (!out || outsz == 0)
+        return 0;
+    size_t o = 0, a = 0;
+    const char *p = fmt ? fmt : "";
+    while (*p) {
+        const char *pct = strchr(p, '%');
+        emit(out, outsz, &o, p, pct ? (size_t)(pct - p) : strlen(p));
+        if (!pct)
+            break;
+        fmt_spec_t s;
+        const char *next = parse_spec(pct + 1, &s);
+        if (!next) {
+            emit(out, outsz, &o, pct, strlen(pct)); // never captured this way
+            break;
+        }
+        p = next;
+        if (s.conv == '%') {
+            emit(out, outsz, &o, "%", 1);
+            continue;
+        }
+
+        int64_t w = 0, pr = -1;
+        if (s.width_star && get_bytes(args, argsz, &a, &w, sizeof(w)) != 0)
+            break;
+        if (s.prec_star && get_bytes(args, argsz, &a, &pr, sizeof(pr)) != 0)
+            break;
+        if (s.has_prec && !s.prec_star)
+            pr = parse_digits(s.prec, s.prec_len);
+
+        char spec[64];
+        int rc = 0;
+        size_t room = outsz - o;
+        switch (s.conv) {
+        case 's': {
+            uint16_t len;
+            if (get_bytes(args, argsz, &a, &len, sizeof(len)) != 0 || argsz - a < len)
+                goto done;
+            build_spec(spec, sizeof(spec), &s, (long)w, len, "");
+            rc = fmt_ptr(out + o, room, spec, args + a);
+            a += len;
+            break;
+        }
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            build_spec(spec, sizeof(spec), &s, (long)w, (long)pr, s.len == LEN_LD ? "L" : "");
+            if (s.len == LEN_LD) {
+                long double ld;
+                if (get_bytes(args, argsz, &a, &ld, sizeof(ld)) != 0)
+                    goto done;
+                rc = fmt_ldbl(out + o, room, spec, ld);
+            } else {
+                double d;
+                if (get_bytes(args, argsz, &a, &d, sizeof(d)) != 0)
+                    goto done;
+                rc = fmt_dbl(out + o, room, spec, d);
+            }
+            break;
+        default: {
+            uint64_t u;
+            if (get_bytes(args, argsz, &a, &u, sizeof(u)) != 0)
+                goto done;
+            if (s.conv == 'c') {
+                build_spec(spec, sizeof(spec), &s, (long)w, (long)pr, "");
+                rc = fmt_int(out + o, room, spec, (int)(int64_t)u);
+            } else if (s.conv == 'p') {
+                build_spec(spec, sizeof(spec), &s, (long)w, (long)pr, "");
+                rc = fmt_ptr(out + o, room, spec, (const void *)(uintptr_t)u);
+            } else if (s.conv == 'd' || s.conv == 'i') {
+                build_spec(spec, sizeof(spec), &s, (long)w, (long)pr, "ll");
+                rc = fmt_ll(out + o, room, spec, (long long)(int64_t)u);
+            } else {
+                build_spec(spec, sizeof(spec), &s, (long)w, (long)pr, "ll");
+                rc = fmt_ull(out + o, room, spec, (unsigned long long)u);
+            }
+            break;
+        }
+        }
+        if (rc > 0)
+            o += (size_t)rc < room ? (size_t)rc : room - 1;
+    }
+done:
+    out[o] = '\0';
+    return o;
+}
+
+// --- .polog writer ---
+
+typedef struct {
+    uint64_t hash;
+    char *s; // NULL: free slot
+    uint32_t id;
+} intern_slot_t;
+
+struct po_polog_writer {
+    FILE *fp;
+    intern_slot_t *tab; // open addressing by content hash
+    size_t cap;         // power of two
+    uint32_t next_id;
+};
+
+static uint64_t str_hash(const char *s, size_t *len) {
+    uint64_t h = 0xcbf29ce484222325ull; // FNV-1a
+    const char *p = s;
+    for (; *p; p++)
+        h = (h ^ (uint8_t)*p) * 0x100000001b3ull;
+    *len = (size_t)(p - s);
+    return h;
+}
+
+static int intern_grow(po_polog_writer_t *w) {
+    size_t cap = w->cap ? w->cap * 2 : 64;
+    intern_slot_t *tab = calloc(cap, sizeof(*tab));
+    if (!tab)
+        return -1;
+    for (size_t i = 0; i < w->cap; i++) {
+        if (!w->tab[i].s)
+            continue;
+        size_t j = w->tab[i].hash & (cap - 1);
+        while (tab[j].s)
+            j = (j + 1) & (cap - 1);
+        tab[j] = w->tab[i];
+    }
+    free(w->tab);
+    w->tab = tab;
+    w->cap = cap;
+    return 0;
+}
+
+// ID of @p s in this session, writing its definition on first use.
+static int intern(po_polog_writer_t *w, const char *s, uint32_t *id) {
+    size_t len;
+    uint64_t h = str_hash(s, &len);
+    size_t j = h & (w->cap - 1);
+    for (; w->tab[j].s; j = (j + 1) & (w->cap - 1)) {
+        if (w->tab[j].hash == h && strcmp(w->tab[j].s, s) == 0) {
+            *id = w->tab[j].id;
+            return 0;
+        }
+    }
+    if ((size_t)w->next_id + 1 >= w->cap) {
+        errno = ENOMEM; // every earlier grow failed
+        return -1;
+    }
+    if (len > POLOG_STR_MAX)
+        len = POLOG_STR_MAX;
+    char *copy = strndup(s, len);
+    if (!copy)
+        return -1;
+    uint32_t len32 = (uint32_t)len;
+    *id = w->next_id++;
+    if (fputc(POLOG_STRING, w->fp) == EOF || fwrite(id, sizeof(*id), 1, w->fp) != 1 ||
+        fwrite(&len32, sizeof(len32), 1, w->fp) != 1 ||
+        (len && fwrite(copy, 1, len, w->fp) != len)) {
+        free(copy);
+        return -1;
+    }
+    w->tab[j] = (intern_slot_t){.hash = h, .s = copy, .id = *id};
+    if ((size_t)w->next_id * 2 > w->cap && intern_grow(w) != 0)
+        return -1; // the entry is in the table; the next grow retries
+    return 0;
+}
+
+po_polog_writer_t *po_polog_writer_open(const char *path, bool append) {
+    po_polog_writer_t *w = calloc(1, sizeof(*w));
+    if (!w)
+        return NULL;
+    if (intern_grow(w) != 0) {
+        free(w);
+        return NULL;
+    }
+    w->fp = fopen(path, append ? "ab" : "wb");
+    if (!w->fp || fwrite(POLOG_MAGIC, 1, POLOG_MAGIC_LEN, w->fp) != POLOG_MAGIC_LEN) {
+        int e = errno;
+        if (w->fp)
+            fclose(w->fp);
+        free(w->tab);
+        free(w);
+        errno = e;
+        return NULL;
+    }
+    return w;
+}
+
+int po_polog_write(po_polog_writer_t *w, po_polog_rec_hdr *h, const char *file,
+                   const char *func, const char *fmt, const void *args) {
+    if (intern(w, file ? file : "", &h->file_id) != 0 ||
+        intern(w, func ? func : "", &h->func_id) != 0 || intern(w, fmt, &h->fmt_id) != 0)
+        return -1;
+    if (fputc(POLOG_RECORD, w->fp) == EOF || fwrite(h, sizeof(*h), 1, w->fp) != 1 ||
+        (h->argsz && fwrite(args, 1, h->argsz, w->fp) != h->argsz))
+        return -1;
+    return 0;
+}
+
+int po_polog_writer_flush(po_polog_writer_t *w) {
+    return fflush(w->fp) == 0 ? 0 : -1;
+}
+
+void po_polog_writer_close(po_polog_writer_t **w) {
+    if (!w || !*w)
+        return;
+    fclose((*w)->fp);
+    for (size_t i = 0; i < (*w)->cap; i++)
+        free((*w)->tab[i].s);
+    free((*w)->tab);
+    free(*w);
+    *w = NULL;
+}
+
+// --- .polog reader ---
+
+struct po_polog_reader {
+    FILE *fp;
+    char **strs; // by ID
+    size_t nstrs;
+    uint8_t args[UINT16_MAX];
+    char msg[POLOG_MSG_MAX];
+};
+
+static void reader_reset(po_polog_reader_t *r) {
+    for (size_t i = 0; i < r->nstrs; i++)
+        free(r->strs[i]);
+    free(r->strs);
+    r->strs = NULL;
+    r->nstrs = 0;
+}
+
+static int read_magic_tail(po_polog_reader_t *r) {
+    char m[POLOG_MAGIC_LEN - 1];
+    if (fread(m, 1, sizeof(m), r->fp) != sizeof(m) ||
+        memcmp(m, POLOG_MAGIC + 1, sizeof(m)) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+po_polog_reader_t *po_polog_open(const char *path) {
+    po_polog_reader_t *r = calloc(1, sizeof(*r));
+    if (!r)
+        return NULL;
+    r->fp = fopen(path, "rb");
+    if (!r->fp || fgetc(r->fp) != POLOG_MAGIC[0] || read_magic_tail(r) != 0) {
+        int e = r->fp ? EINVAL : errno;
+        if (r->fp)
+            fclose(r->fp);
+        free(r);
+        errno = e;
+        return NULL;
+    }
+    return r;
+}
+
+static const char *reader_str(const po_polog_reader_t *r, uint32_t id) {
+    return id < r->nstrs && r->strs[id] ? r->strs[id] : NULL;
+}
+
+static int read_string(po_polog_reader_t *r) {
+    uint32_t id, len;
+    if (fread(&id, sizeof(id), 1, r->fp) != 1 || fread(&len, sizeof(len), 1, r->fp) != 1 ||
+        len > POLOG_STR_MAX || id >= POLOG_STR_MAX)
+        return -1;
+    if (id >= r->nstrs) {
+        char **grown = realloc(r->strs, (id + 1) * sizeof(*grown));
+        if (!grown)
+            return -1;
+        memset(grown + r->nstrs, 0, (id + 1 - r->nstrs) * sizeof(*grown));
+        r->strs = grown;
+        r->nstrs = id + 1;
+    }
+    char *s = malloc(len + 1u);
+    if (!s)
+        return -1;
+    if (len && fread(s, 1, len, r->fp) != len) {
+        free(s);
+        return -1;
+    }
+    s[len] = '\0';
+    free(r->strs[id]);
+    r->strs[id] = s;
+    return 0;
+}
+
+int po_polog_next(po_polog_reader_t *r, po_polog_entry *out) {
+    if (!r || !out) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (;;) {
+        int kind = fgetc(r->fp);
+        if (kind == EOF)
+            return ferror(r->fp) ? -1 : 0;
+        if (kind == POLOG_MAGIC[0]) { // appended session: IDs restart
+            reader_reset(r);
+            if (read_magic_tail(r) != 0)
+                return -1;
+            continue;
+        }
+        if (kind == POLOG_STRING) {
+            if (read_string(r) != 0)
+                goto corrupt;
+            continue;
+        }
+        if (kind != POLOG_RECORD)
+            goto corrupt;
+
+        po_polog_rec_hdr h;
+        if (fread(&h, sizeof(h), 1, r->fp) != 1 ||
+            (h.argsz && fread(r->args, 1, h.argsz, r->fp) != h.argsz))
+            goto corrupt;
+        const char *fmt = reader_str(r, h.fmt_id);
+        out->file = reader_str(r, h.file_id);
+        out->func = reader_str(r, h.func_id);
+        if (!fmt || !out->file || !out->func)
+            goto corrupt;
+        po_logfmt_render(fmt, r->args, h.argsz, r->msg, sizeof(r->msg));
+        out->ts_ns = h.ts_ns;
+        out->tid = h.tid;
+        out->category = h.category;
+        out->line = h.line;
+        out->level = h.level;
+        out->msg = r->msg;
+        return 1;
+    }
+corrupt:
+    errno = EINVAL;
+    return -1;
+}
+
+void po_polog_close(po_polog_reader_t **r) {
+    if (!r || !*r)
+        return;
+    reader_reset(*r);
+    fclose((*r)->fp);
+    free(*r);
+    *r = NULL;
+}
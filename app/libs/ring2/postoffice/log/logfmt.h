@@ -0,0 +1,135 @@
+/**
+ * @file logfmt.h
+ * @brief Deferred printf formatting and the `.polog` binary log format.
+ *
+ * In deferred mode a producer does not run `vsnprintf`: it walks the format
+ * string once and copies the raw arguments into the record
+ * (::po_logfmt_capture). The format string pointer is the message's static
+ * ID. Text is produced later, on the consumer thread or offline
+ * (::po_logfmt_render).
+ *
+ * Argument blob: each conversion appends its value in call order. Integers,
+ * pointers, `*` widths and precisions use 8 bytes, doubles 8 and long
+ * doubles `sizeof(long double)`. A `%s` string is a 2-byte length followed
+ * by its bytes, already cut to the precision. Formats using `%n`, `%m`, wide
+ * characters or unknown conversions are not captured, and the caller falls
+ * back to formatting inline.
+ *
+ * `.polog` file: a session starts with ::POLOG_MAGIC and is followed by
+ * entries, each introduced by one kind byte:
+ *  - ::POLOG_STRING: `u32 id, u32 len, bytes` defines a format, file or
+ *    function string the first time a session uses it;
+ *  - ::POLOG_RECORD: a ::po_polog_rec_hdr, then `argsz` bytes of arguments.
+ *
+ * Integers are in host byte order. Appending to a file starts a new
+ * session, and string IDs restart with it.
+ */
+
+#ifndef PO_LOG_LOGFMT_H
+#define PO_LOG_LOGFMT_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define POLOG_MAGIC "POLOG01\n"
+#define POLOG_MAGIC_LEN 8u
+#define POLOG_STRING 'S'
+#define POLOG_RECORD 'R'
+
+/** @brief Fixed part of a `.polog` record entry. */
+typedef struct po_polog_rec_hdr {
+    uint64_t ts_ns;    //!< CLOCK_REALTIME, nanoseconds.
+    uint64_t tid;      //!< Kernel thread id.
+    uint32_t category; //!< Thread category.
+    uint32_t line;     //!< Source line.
+    uint32_t file_id;  //!< String ID of the source file.
+    uint32_t func_id;  //!< String ID of the function.
+    uint32_t fmt_id;   //!< String ID of the format.
+    uint16_t argsz;    //!< Argument bytes that follow.
+    uint8_t level;     //!< po_log_level_t.
+    uint8_t pad;
+} po_polog_rec_hdr;
+
+/**
+ * @brief Pack the arguments of @p fmt into @p buf.
+ * @param[in] fmt printf format.
+ * @param[in] ap Arguments; consumed (pass a va_copy to reuse them).
+ * @param[out] buf Argument blob.
+ * @param[in] cap Capacity of @p buf (strings are cut to fit).
+ * @return Blob size, or -1 if the format is not capturable or the fixed-size
+ *         arguments do not fit.
+ * @note Thread-safe: Yes.
+ */
+ssize_t po_logfmt_capture(const char *fmt, va_list ap, uint8_t *buf, size_t cap);
+
+/**
+ * @brief Format a captured blob as `vsnprintf(out, outsz, fmt, ...)` would.
+ * @return Characters written, excluding the terminating NUL (output is
+ *         truncated to @p outsz - 1).
+ * @note Thread-safe: Yes.
+ */
+size_t po_logfmt_render(const char *fmt, const uint8_t *args, size_t argsz, char *out,
+                        size_t outsz);
+
+typedef struct po_polog_writer po_polog_writer_t;
+
+/**
+ * @brief Open (or create) a `.polog` file and start a session.
+ * @param[in] path Destination file.
+ * @param[in] append Keep existing sessions; otherwise truncate.
+ * @return Writer, or NULL (errno set).
+ */
+po_polog_writer_t *po_polog_writer_open(const char *path, bool append);
+
+/**
+ * @brief Append one record, defining its strings first if the session has
+ *        not used them yet.
+ * @param[in,out] h Header; the string IDs are filled in, the rest is taken
+ *                  as is (`argsz` bytes are read from @p args).
+ * @return 0 on success, -1 on a write or allocation error.
+ * @note Thread-safe: No (one writer per consumer).
+ */
+int po_polog_write(po_polog_writer_t *w, po_polog_rec_hdr *h, const char *file,
+                   const char *func, const char *fmt, const void *args);
+
+/** @brief Flush buffered entries to the file. */
+int po_polog_writer_flush(po_polog_writer_t *w);
+
+/** @brief Flush, close and set *w to NULL. */
+void po_polog_writer_close(po_polog_writer_t **w);
+
+/** @brief One decoded `.polog` record (pointers valid until the next read). */
+typedef struct po_polog_entry {
+    uint64_t ts_ns;
+    uint64_t tid;
+    uint32_t category;
+    uint32_t line;
+    uint8_t level;
+    const char *file;
+    const char *func;
+    const char *msg; //!< Rendered message.
+} po_polog_entry;
+
+typedef struct po_polog_reader po_polog_reader_t;
+
+/**
+ * @brief Open a `.polog` file for decoding.
+ * @return Reader, or NULL (errno set; EINVAL if the file is not a .polog).
+ */
+po_polog_reader_t *po_polog_open(const char *path);
+
+/**
+ * @brief Decode the next record.
+ * @return 1 with @p out filled, 0 at end of file, -1 on a corrupt or
+ *         truncated entry (errno=EINVAL) or read error.
+ */
+int po_polog_next(po_polog_reader_t *r, po_polog_entry *out);
+
+/** @brief Close a reader and set *r to NULL. */
+void po_polog_close(po_polog_reader_t **r);
+
+#endif // PO_LOG_LOGFMT_H
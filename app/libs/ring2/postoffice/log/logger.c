@@ -9,6 +9,8 @@
 #include "log/logger.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdalign.h>
 #include <stdarg.h>
@@ -17,10 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
+#include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <syslog.h>
 #include <time.h>
 #include <unistd.h>
@@ -35,25 +39,45 @@ static const int SYSLOG_VAL_INFO = LOG_INFO;
 #undef LOG_DEBUG
 #undef LOG_INFO
 
+#include "log/logfmt.h"
 #include "metrics/metrics.h"
-#include "perf/batcher.h"
+#include "log/logring.h"
+#include "log/logshm.h"
 #include "perf/ringbuf.h"
+#include "priority_queue/indexed_heap.h"
 
 #define MAX_RECORD_SIZE LOGGER_MSG_MAX * 2
+#define RING_BYTES_PER_RECORD 128u // ring sizing: ring_capacity short records
+#define FILE_SHOWN_MAX 63u         // text sinks show at most the path's tail
+#define DRAIN_BATCH 256u
+#define DRAIN_IDLE_MS 200
+#define THREAD_RING_RECORDS 64u // per_thread_rings default
+#define STAGE_BYTES (64u * 1024u) // text staged per batch before writing it out
+#define ROTATE_KEEP 5u            // rotate_keep default
+#define SHM_RING_RECORDS 16384u   // shm_capacity default
+#define SHM_STALL_MS 60000        // shared ring: skip a live client's reservation stuck this long
+#define FUNC_INLINE_MAX 63u       // shared-ring records: function name bytes kept
+#define CATEGORY_UNSET UINT32_MAX // thread never called po_logger_set_thread_category()
+// A shared-ring record as resolved by the consumer: message, file and function inline
+#define WIRE_RECORD_MAX                                                                            \
+    (sizeof(log_record_t) + LOGGER_MSG_MAX + FILE_SHOWN_MAX + 1 + FUNC_INLINE_MAX + 1)
 
 // Runtime level, exported for inline check in header
 volatile po_log_level_t _logger_runtime_level = LOG_INFO;
 
-// Record stored in the ring (fixed size, no heap on hot path)
+// Record stored in the byte ring, sized to its message (no heap on hot path).
+// In a shared ring file and func are NULL and their text follows msg's NUL.
 typedef struct log_record {
     struct timespec ts; // high-res timestamp
     uint64_t tid;       // thread id
-    uint8_t level;      // logger_level_t
+    const char *file;   // static string (__FILE__), never NULL in a private ring
+    const char *func;   // static string (__func__), never NULL in a private ring
+    const char *fmt;    // deferred: static format, msg holds its packed args
     uint32_t category;  // thread category
-    char file[64];      // truncated
-    char func[32];      // truncated
-    int line;
-    char msg[LOGGER_MSG_MAX]; // truncated fmt result
+    int32_t line;
+    uint16_t msglen; // bytes of msg in use (text: without the NUL)
+    uint8_t level;   // logger_level_t
+    char msg[];      // fmt result, NUL-terminated (or packed args)
 } log_record_t;
 
 typedef struct custom_sink {
@@ -63,22 +87,98 @@ typedef struct custom_sink {
 } custom_sink_t;
 
 typedef struct file_sink {
-    FILE *fp;
-    uint32_t mask;
+    int fd;        // O_APPEND: other processes' appends land between our writes
+    uint32_t mask; // categories (0 = all)
+    char *path;    // for rotation
+    time_t opened; // for age-based rotation
     struct file_sink *next;
 } file_sink_t;
 
+// Text lines of the batch being drained, written with one writev per sink
+typedef struct stage_line {
+    uint32_t off;
+    uint32_t len;
+    uint32_t category;
+} stage_line_t;
+
+typedef struct stage {
+    char *buf; // STAGE_BYTES
+    size_t len;
+    unsigned nlines;
+    stage_line_t line[DRAIN_BATCH];
+} stage_t;
+
+typedef struct bin_sink {
+    po_polog_writer_t *w;
+    pthread_mutex_t mu; // consumers and the inline FATAL/overflow paths
+    struct bin_sink *next;
+} bin_sink_t;
+
+// Merged mode: a record source the consumer merges by timestamp
+typedef struct log_source {
+    po_logring_t *ring;
+    const log_record_t *head; // consumer: oldest unwritten record (NULL = none)
+    size_t head_len;          // consumer: head's payload bytes
+    bool wire;                // records carry inline names (the shared-memory ring)
+    uint64_t cursor;          // consumer: ring position just past head
+    uint64_t done;            // consumer: ring position past the last written record
+    po_heap_node_t node;      // position in g_merge
+    atomic_bool orphaned;     // owning thread exited; free once drained
+    struct log_source *next;
+} log_source_t;
+
 // Ring and worker state
-static po_perf_ringbuf_t *g_ring = NULL;    // queue of ready records
-static po_perf_ringbuf_t *g_free = NULL;    // freelist of available records
-static po_perf_batcher_t *g_batcher = NULL; // eventfd-based batching
+static po_logring_t *g_ring = NULL; // pending records, variable length
+static po_logring_bell_t *g_bell = NULL; // consumers park here; producers ring it
+static pthread_mutex_t g_drain_mu = PTHREAD_MUTEX_INITIALIZER; // one ring consumer at a time
 static pthread_t *g_workers = NULL;
 static unsigned g_nworkers = 0;
 static po_logger_overflow_policy_t g_policy = LOGGER_OVERWRITE_OLDEST;
 static unsigned int g_sinks_mask = 0u;
+static uint32_t g_console_mask = 0u; // console categories (0 = all)
 static file_sink_t *g_file_sinks = NULL;
+static bin_sink_t *g_bin_sinks = NULL;
+static bool g_deferred = false;
+static size_t g_rotate_bytes = 0;
+static unsigned g_rotate_secs = 0;
+static unsigned g_rotate_keep = ROTATE_KEEP;
+
+// Staging: consumers fill g_fill under g_drain_mu. With async_writer the
+// writer thread owns g_handoff (the other stage) until it resets it to NULL.
+static stage_t g_stages[2];
+static stage_t *g_fill = NULL;
+static bool g_async = false;
+static stage_t *g_handoff = NULL;
+static bool g_writer_stop = false;
+static pthread_t g_writer;
+static pthread_mutex_t g_writer_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_writer_cv = PTHREAD_COND_INITIALIZER;      // handoff posted or stop
+static pthread_cond_t g_writer_idle_cv = PTHREAD_COND_INITIALIZER; // handoff written
 static atomic_int g_running = 0;
-static __thread uint32_t _po_logger_thread_category = 0;
+static uint32_t g_default_category = 0;
+static __thread uint32_t _po_logger_thread_category = CATEGORY_UNSET;
+
+// Shared-memory transport (shm_name). The serving process drains g_shm's
+// ring as one more merged source. In a client g_ring is that ring itself.
+static po_logshm_t g_shm;
+static char *g_shm_name = NULL; // serving: unlinked at shutdown
+static bool g_shm_client = false;
+static log_source_t g_shm_source;
+
+// Merged mode (per_thread_rings or serving a shared ring): thread rings
+// first, then g_shared_source, then g_shm_source
+static bool g_merged = false;
+static bool g_per_thread = false;
+static size_t g_thread_ring_bytes = 0;
+static log_source_t g_shared_source; // wraps g_ring for threads without their own
+static log_source_t *g_sources = NULL;
+static pthread_mutex_t g_sources_mu = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint g_sources_epoch = 0; // bumped when shutdown frees the thread rings
+static po_indexed_heap_t *g_merge = NULL;
+static pthread_key_t g_source_key; // destructor orphans the exiting thread's source
+static pthread_once_t g_source_key_once = PTHREAD_ONCE_INIT;
+static __thread log_source_t *t_source = NULL;
+static __thread unsigned t_source_epoch = 0;
 static alignas(PO_CACHE_LINE_MAX) atomic_ulong g_dropped_new = 0;
 static alignas(PO_CACHE_LINE_MAX) atomic_ulong g_overwritten_old = 0;
 static alignas(PO_CACHE_LINE_MAX) atomic_ulong g_processed = 0;
@@ -88,11 +188,6 @@ static int g_syslog_open = 0;
 static char *g_syslog_ident = NULL;
 static custom_sink_t *g_custom_sinks = NULL;
 
-// Preallocated pool
-static log_record_t *g_pool = NULL;
-static size_t g_pool_n = 0;
-static log_record_t g_sentinel; // shutdown marker (never in freelist)
-
 static const char *const level_metrics[] = {"logger.level.trace", "logger.level.debug",
                                             "logger.level.info",  "logger.level.warn",
                                             "logger.level.error", "logger.level.fatal"};
@@ -158,14 +253,13 @@ static inline uint64_t get_tid(void) {
 }
 
 /**
- * @brief Recycle a used log record back to the free ring.
+ * @brief The part of @p file that text sinks show.
  *
- * @param[in] r Pointer to the record to recycle.
- *
- * @note Thread-safe: Yes (lock-free).
+ * @note Thread-safe: Yes (Pure function).
  */
-static inline void recycle_record(log_record_t *r) {
-    (void)perf_ringbuf_enqueue(g_free, r);
+static inline const char *file_shown(const char *file) {
+    size_t n = strlen(file);
+    return n > FILE_SHOWN_MAX ? file + n - FILE_SHOWN_MAX : file;
 }
 
 // --- Fast Format Helpers ---
@@ -235,12 +329,14 @@ static inline char *fast_pad6(long v, char *p) {
  * @brief Format a log record into a text line.
  *
  * @param[in] r Pointer to the log record.
+ * @param[in] msg Message text (r->msg, or its rendering in deferred mode).
  * @param[out] out Output buffer.
  * @param[in] outsz Size of the output buffer.
+ * @return Length of the line, without the terminating NUL.
  *
  * @note Thread-safe: Yes (uses thread-local cache for timestamp).
  */
-static void record_format_line(const log_record_t *r, char *out, size_t outsz) {
+static size_t record_format_line(const log_record_t *r, const char *msg, char *out, size_t outsz) {
     // Format: "%s.%06ld %lu %-5s %s:%d %s() - %s\n"
     // "YYYY-MM-DD HH:MM:SS" is 19 chars
 
@@ -308,8 +404,8 @@ static void record_format_line(const log_record_t *r, char *out, size_t outsz) {
 
     *p++ = ' ';
 
-    // 5. File
-    const char *f = r->file;
+    // 5. File (tail of the path only, like the old fixed-size copy)
+    const char *f = file_shown(r->file);
     while (*f)
         *p++ = *f++;
 
@@ -321,12 +417,13 @@ static void record_format_line(const log_record_t *r, char *out, size_t outsz) {
     *p++ = ' ';
 
     // 9. Message
-    const char *m = r->msg;
+    const char *m = msg;
     while (*m)
         *p++ = *m++;
 
     *p++ = '\n';
     *p = '\0';
+    return (size_t)(p - out);
 }
 
 /**
@@ -359,43 +456,616 @@ static inline int syslog_priority_for_level(uint8_t lvl) {
 }
 
 /**
- * @brief Write a log record to all configured sinks.
+ * @brief Append a record to every binary sink, unformatted.
+ *
+ * A record formatted on the producer is stored as the literal "%s" format
+ * with its text as the only argument.
  *
  * @param[in] r Pointer to the record to write.
  *
- * @note Thread-safe: No (Called from consumer thread only).
+ * @note Thread-safe: Yes (per-sink mutex).
  */
-static void write_record(const log_record_t *r) {
-    char line[MAX_RECORD_SIZE];
-    record_format_line(r, line, sizeof(line));
+static void write_binary(const log_record_t *r) {
+    po_polog_rec_hdr h = {
+        .ts_ns = (uint64_t)r->ts.tv_sec * 1000000000ull + (uint64_t)r->ts.tv_nsec,
+        .tid = r->tid,
+        .category = r->category,
+        .line = (uint32_t)r->line,
+        .argsz = r->msglen,
+        .level = r->level,
+    };
+    const char *fmt = r->fmt;
+    const void *args = r->msg;
+    uint8_t lit[sizeof(uint16_t) + LOGGER_MSG_MAX];
+    if (!fmt) {
+        uint16_t n = r->msglen;
+        memcpy(lit, &n, sizeof(n));
+        memcpy(lit + sizeof(n), r->msg, n);
+        fmt = "%s";
+        args = lit;
+        h.argsz = (uint16_t)(sizeof(n) + n);
+    }
+    for (bin_sink_t *b = g_bin_sinks; b; b = b->next) {
+        pthread_mutex_lock(&b->mu);
+        if (po_polog_write(b->w, &h, r->file, r->func, fmt, args) != 0)
+            PO_METRIC_COUNTER_INC("logger.binary.write_error");
+        pthread_mutex_unlock(&b->mu);
+    }
+}
 
-    if (g_sinks_mask & (LOGGER_SINK_CONSOLE | LOGGER_SINK_STDERR)) {
-        ssize_t res = write(STDERR_FILENO, line, strlen(line));
-        (void)res;
+/**
+ * @brief Flush buffered binary sink output.
+ *
+ * @note Thread-safe: Yes.
+ */
+static void flush_binary(void) {
+    for (bin_sink_t *b = g_bin_sinks; b; b = b->next) {
+        pthread_mutex_lock(&b->mu);
+        (void)po_polog_writer_flush(b->w);
+        pthread_mutex_unlock(&b->mu);
     }
-    if (g_sinks_mask & LOGGER_SINK_STDOUT) {
-        ssize_t res = write(STDOUT_FILENO, line, strlen(line));
-        (void)res;
+}
+
+/**
+ * @brief Write every iovec to @p fd, resuming after short writes.
+ *
+ * @param[in] fd Destination.
+ * @param[in,out] iov Buffers (advanced in place).
+ * @param[in] n Number of buffers (at most IOV_MAX).
+ *
+ * @note Thread-safe: Yes.
+ */
+static void writev_fully(int fd, struct iovec *iov, int n) {
+    while (n > 0) {
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            PO_METRIC_COUNTER_INC("logger.sink.write_error");
+            return;
+        }
+        size_t left = (size_t)w;
+        while (n > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base = (char *)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
     }
+}
 
-    for (file_sink_t *fs = g_file_sinks; fs; fs = fs->next) {
-        if (fs->mask == 0 || (fs->mask & (1u << r->category))) {
-            fputs(line, fs->fp);
+/**
+ * @brief Move path.(N-1) .. path.1 and path up by one; path.N is replaced.
+ *
+ * @param[in] path Live log file path.
+ *
+ * @note Thread-safety: Caller holds the live file's flock.
+ */
+static void shift_rotated(const char *path) {
+    char from[PATH_MAX], to[PATH_MAX];
+    for (unsigned k = g_rotate_keep; k > 1; k--) {
+        snprintf(from, sizeof(from), "%s.%u", path, k - 1);
+        snprintf(to, sizeof(to), "%s.%u", path, k);
+        (void)rename(from, to);
+    }
+    snprintf(to, sizeof(to), "%s.1", path);
+    (void)rename(path, to);
+}
+
+/**
+ * @brief Rotate a file sink if it is due by size or age.
+ *
+ * Several processes may append to the same path. The flock on the live file
+ * lets one of them rotate; the others find the path pointing at a new inode
+ * and just reopen it. The new file replaces the old descriptor with dup2(),
+ * so threads writing through fs->fd concurrently never see a closed fd.
+ *
+ * @param[in,out] fs Sink to check.
+ *
+ * @note Thread-safety: Writer role (one caller per sink at a time).
+ */
+static void rotate_if_due(file_sink_t *fs) {
+    if (!g_rotate_bytes && !g_rotate_secs)
+        return;
+    struct stat cur, live;
+    if (fstat(fs->fd, &cur) != 0)
+        return;
+    if (stat(fs->path, &live) == 0 && live.st_ino == cur.st_ino && live.st_dev == cur.st_dev) {
+        bool due = (g_rotate_bytes && (size_t)cur.st_size >= g_rotate_bytes) ||
+                   (g_rotate_secs && time(NULL) - fs->opened >= (time_t)g_rotate_secs);
+        if (!due)
+            return;
+        (void)flock(fs->fd, LOCK_EX);
+        if (stat(fs->path, &live) == 0 && live.st_ino == cur.st_ino && live.st_dev == cur.st_dev) {
+            shift_rotated(fs->path);
+            PO_METRIC_COUNTER_INC("logger.rotate");
+        }
+        (void)flock(fs->fd, LOCK_UN);
+    }
+    int fd = open(fs->path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return; // keep writing the old file
+    if (dup2(fd, fs->fd) < 0)
+        PO_METRIC_COUNTER_INC("logger.sink.write_error");
+    close(fd);
+    fs->opened = time(NULL);
+}
+
+/**
+ * @brief Write the staged lines in @p mask's categories to @p fd in one writev.
+ *
+ * Adjacent matching lines share one iovec; mask 0 writes the whole buffer.
+ *
+ * @note Thread-safety: Writer role.
+ */
+static void emit_lines(int fd, const stage_t *st, uint32_t mask) {
+    struct iovec iov[DRAIN_BATCH];
+    int n = 0;
+    if (mask == 0) {
+        iov[n++] = (struct iovec){.iov_base = st->buf, .iov_len = st->len};
+    } else {
+        for (unsigned i = 0; i < st->nlines; i++) {
+            const stage_line_t *l = &st->line[i];
+            if (!(mask & (1u << l->category)))
+                continue;
+            char *base = st->buf + l->off;
+            if (n > 0 && (char *)iov[n - 1].iov_base + iov[n - 1].iov_len == base)
+                iov[n - 1].iov_len += l->len;
+            else
+                iov[n++] = (struct iovec){.iov_base = base, .iov_len = l->len};
         }
     }
+    writev_fully(fd, iov, n);
+}
+
+/**
+ * @brief Write a staged batch: one writev per sink.
+ *
+ * @param[in] st Stage to write.
+ *
+ * @note Thread-safety: Writer role (consumer, or the async writer thread).
+ */
+static void emit_stage(const stage_t *st) {
+    if (g_sinks_mask & (LOGGER_SINK_CONSOLE | LOGGER_SINK_STDERR))
+        emit_lines(STDERR_FILENO, st, g_console_mask);
+    if (g_sinks_mask & LOGGER_SINK_STDOUT)
+        emit_lines(STDOUT_FILENO, st, g_console_mask);
+
+    for (file_sink_t *fs = g_file_sinks; fs; fs = fs->next) {
+        rotate_if_due(fs);
+        emit_lines(fs->fd, st, fs->mask);
+    }
+}
 
+/**
+ * @brief Async writer thread: writes each handed-off stage, then frees the slot.
+ *
+ * @param[in] arg Unused.
+ * @return NULL.
+ *
+ * @note Thread-safety: Writer role.
+ */
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_writer_mu);
+    for (;;) {
+        while (!g_handoff && !g_writer_stop)
+            pthread_cond_wait(&g_writer_cv, &g_writer_mu);
+        if (!g_handoff)
+            break; // stopped, nothing pending
+        stage_t *st = g_handoff;
+        pthread_mutex_unlock(&g_writer_mu);
+        emit_stage(st);
+        pthread_mutex_lock(&g_writer_mu);
+        g_handoff = NULL;
+        pthread_cond_broadcast(&g_writer_idle_cv);
+    }
+    pthread_mutex_unlock(&g_writer_mu);
+    return NULL;
+}
+
+/**
+ * @brief Write out the staged lines, or hand them to the writer thread.
+ *
+ * With async_writer the consumer waits only if the writer is still busy with
+ * the previous stage, then keeps draining into the other one.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static void flush_stage(void) {
+    stage_t *st = g_fill;
+    if (st->nlines == 0)
+        return;
+    if (!g_async) {
+        emit_stage(st);
+        st->len = 0;
+        st->nlines = 0;
+        return;
+    }
+    pthread_mutex_lock(&g_writer_mu);
+    while (g_handoff)
+        pthread_cond_wait(&g_writer_idle_cv, &g_writer_mu);
+    g_handoff = st;
+    pthread_cond_signal(&g_writer_cv);
+    pthread_mutex_unlock(&g_writer_mu);
+    g_fill = st == &g_stages[0] ? &g_stages[1] : &g_stages[0];
+    g_fill->len = 0;
+    g_fill->nlines = 0;
+}
+
+/**
+ * @brief Render a record's text line (deferred messages are formatted here).
+ *
+ * @param[in] r Record.
+ * @param[out] text LOGGER_MSG_MAX scratch for a deferred message.
+ * @param[out] line MAX_RECORD_SIZE output.
+ * @param[out] len Line length.
+ * @return The message text.
+ *
+ * @note Thread-safe: Yes.
+ */
+static const char *render_line(const log_record_t *r, char *text, char *line, size_t *len) {
+    const char *msg = r->msg;
+    if (r->fmt) {
+        po_logfmt_render(r->fmt, (const uint8_t *)r->msg, r->msglen, text, LOGGER_MSG_MAX);
+        msg = text;
+    }
+    *len = record_format_line(r, msg, line, MAX_RECORD_SIZE);
+    return msg;
+}
+
+/**
+ * @brief Pass one rendered record to the per-record sinks (syslog, custom).
+ *
+ * @note Thread-safe: As the custom sinks are.
+ */
+static void write_per_record_sinks(const log_record_t *r, const char *msg, const char *line) {
     if ((g_sinks_mask & LOGGER_SINK_SYSLOG) && g_syslog_open)
         syslog(syslog_priority_for_level(r->level), "%s:%d %s() - %s", r->file, r->line, r->func,
-               r->msg);
+               msg);
 
     for (custom_sink_t *c = g_custom_sinks; c; c = c->next)
         c->fn(line, c->ud);
 }
 
+/**
+ * @brief Write a log record to all configured sinks.
+ *
+ * A deferred record is rendered here, once, and only if a text sink exists.
+ * Console and file output is staged and written per batch by flush_stage().
+ *
+ * @param[in] r Pointer to the record to write.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu (consumer).
+ */
+static void write_record(const log_record_t *r) {
+    if (g_bin_sinks)
+        write_binary(r);
+    if (!(g_sinks_mask & ~LOGGER_SINK_BINARY) && !g_custom_sinks)
+        return;
+
+    if (g_fill->nlines == DRAIN_BATCH || STAGE_BYTES - g_fill->len < MAX_RECORD_SIZE)
+        flush_stage();
+    stage_t *st = g_fill;
+    char text[LOGGER_MSG_MAX];
+    char *line = st->buf + st->len;
+    size_t len;
+    const char *msg = render_line(r, text, line, &len);
+    st->line[st->nlines++] =
+        (stage_line_t){.off = (uint32_t)st->len, .len = (uint32_t)len, .category = r->category};
+    st->len += len;
+
+    write_per_record_sinks(r, msg, line);
+}
+
+/**
+ * @brief Write a record to all sinks right away, bypassing the stage.
+ *
+ * For the FATAL and overflow-notice paths, which run on producer threads.
+ *
+ * @param[in] r Pointer to the record to write.
+ *
+ * @note Thread-safe: Yes (one write per sink; O_APPEND files).
+ */
+static void write_record_now(const log_record_t *r) {
+    if (g_bin_sinks)
+        write_binary(r);
+    if (!(g_sinks_mask & ~LOGGER_SINK_BINARY) && !g_custom_sinks)
+        return;
+
+    char text[LOGGER_MSG_MAX];
+    char line[MAX_RECORD_SIZE];
+    size_t len;
+    const char *msg = render_line(r, text, line, &len);
+    bool console = g_console_mask == 0 || (g_console_mask & (1u << r->category));
+    if (console && (g_sinks_mask & (LOGGER_SINK_CONSOLE | LOGGER_SINK_STDERR))) {
+        struct iovec v = {.iov_base = line, .iov_len = len};
+        writev_fully(STDERR_FILENO, &v, 1);
+    }
+    if (console && (g_sinks_mask & LOGGER_SINK_STDOUT)) {
+        struct iovec v = {.iov_base = line, .iov_len = len};
+        writev_fully(STDOUT_FILENO, &v, 1);
+    }
+    for (file_sink_t *fs = g_file_sinks; fs; fs = fs->next) {
+        if (fs->mask == 0 || (fs->mask & (1u << r->category))) {
+            struct iovec v = {.iov_base = line, .iov_len = len};
+            writev_fully(fs->fd, &v, 1);
+        }
+    }
+
+    write_per_record_sinks(r, msg, line);
+}
+
+/**
+ * @brief Write out staged text and flush the binary sinks.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static void flush_sinks(void) {
+    flush_stage();
+    flush_binary();
+}
+
+/**
+ * @brief Bytes a shared-ring record needs after its message for the inline
+ *        file and function names.
+ *
+ * @note Thread-safe: Yes (Pure function).
+ */
+static size_t wire_names_size(const char *file, const char *func) {
+    return strlen(file_shown(file)) + 1 + strnlen(func, FUNC_INLINE_MAX) + 1;
+}
+
+/**
+ * @brief Copy @p r's file and function names after its message, for a
+ *        record in the shared ring; the pointers are cleared.
+ *
+ * @param[in,out] r Filled record with room for wire_names_size() more bytes.
+ *
+ * @note Thread-safe: Yes.
+ */
+static void wire_store_names(log_record_t *r) {
+    char *p = r->msg + r->msglen + 1;
+    const char *file = file_shown(r->file);
+    size_t n = strlen(file);
+    memcpy(p, file, n + 1);
+    p += n + 1;
+    n = strnlen(r->func, FUNC_INLINE_MAX);
+    memcpy(p, r->func, n);
+    p[n] = '\0';
+    r->file = NULL;
+    r->func = NULL;
+}
+
+/**
+ * @brief Copy a shared-ring record out and point its names at the inline text.
+ *
+ * Another process wrote the record, so nothing in it is trusted: a record
+ * whose strings are not where its lengths say is rejected.
+ *
+ * @param[in] r Record in the shared ring.
+ * @param[in] len Its payload bytes.
+ * @param[out] out WIRE_RECORD_MAX bytes, aligned for log_record_t.
+ * @return @p out, or NULL if the record is malformed.
+ *
+ * @note Thread-safe: Yes.
+ */
+static const log_record_t *wire_resolve(const log_record_t *r, size_t len, log_record_t *out) {
+    if (len < sizeof(log_record_t) || len > WIRE_RECORD_MAX)
+        return NULL;
+    memcpy(out, r, len);
+    if (len < sizeof(log_record_t) + (size_t)out->msglen + 3 || out->level > LOG_FATAL ||
+        out->category >= 32)
+        return NULL;
+    char *end = (char *)out + len;
+    char *file = out->msg + out->msglen + 1;
+    char *func = memchr(file, '\0', (size_t)(end - file));
+    if (file[-1] != '\0' || !func || func + 1 >= end || end[-1] != '\0')
+        return NULL;
+    out->file = file;
+    out->func = func + 1;
+    out->fmt = NULL; // a format pointer into another process: never deferred
+    return out;
+}
+
+/**
+ * @brief Write one record to the sinks and count it.
+ *
+ * @param[in] r Record to write.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static void process_record(const log_record_t *r) {
+    write_record(r);
+    PO_METRIC_COUNTER_INC("logger.processed");
+
+    if (r->level <= LOG_FATAL)
+        PO_METRIC_COUNTER_INC(level_metrics[r->level]);
+}
+
+/**
+ * @brief Account for a drained batch of @p n records.
+ *
+ * @note Thread-safe: Yes.
+ */
+static void note_batch(size_t n) {
+    PO_METRIC_COUNTER_INC("logger.batch.count");
+    PO_METRIC_COUNTER_ADD("logger.batch.records", n);
+    atomic_fetch_add_explicit(&g_processed, n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_batches, 1, memory_order_relaxed);
+    unsigned long prev = atomic_load_explicit(&g_max_batch, memory_order_relaxed);
+    if ((unsigned long)n > prev)
+        atomic_compare_exchange_strong(&g_max_batch, &prev, (unsigned long)n);
+}
+
+/**
+ * @brief Write up to DRAIN_BATCH committed records to the sinks and release them.
+ *
+ * @return Number of records written.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static size_t drain_batch(void) {
+    uint64_t cursor = po_logring_cursor(g_ring);
+    size_t n = 0;
+    const log_record_t *r;
+    while (n < DRAIN_BATCH && (r = po_logring_peek(g_ring, &cursor, NULL)) != NULL) {
+        process_record(r);
+        n++;
+    }
+    if (n == 0)
+        return 0;
+    po_logring_release(g_ring, cursor);
+    note_batch(n);
+    return n;
+}
+
+/**
+ * @brief Heap order for the merge: source whose head record is older first.
+ *
+ * @note Thread-safe: Yes (Pure function).
+ */
+static int source_cmp(const po_heap_node_t *a, const po_heap_node_t *b) {
+    const log_record_t *x = PO_HEAP_ENTRY(a, log_source_t, node)->head;
+    const log_record_t *y = PO_HEAP_ENTRY(b, log_source_t, node)->head;
+    if (x->ts.tv_sec != y->ts.tv_sec)
+        return x->ts.tv_sec < y->ts.tv_sec ? -1 : 1;
+    return (x->ts.tv_nsec > y->ts.tv_nsec) - (x->ts.tv_nsec < y->ts.tv_nsec);
+}
+
+/**
+ * @brief Next committed record of @p s at or after s->cursor.
+ *
+ * In the shared-memory ring it first skips a reservation whose client
+ * process died (or stalled for SHM_STALL_MS) before committing, which would
+ * otherwise hold back every client's records for good.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static const log_record_t *source_peek(log_source_t *s) {
+    const log_record_t *r = po_logring_peek(s->ring, &s->cursor, &s->head_len);
+    if (!r && s->wire && po_logring_reclaim(s->ring, s->cursor, SHM_STALL_MS)) {
+        PO_METRIC_COUNTER_INC("logger.shm.reclaimed");
+        r = po_logring_peek(s->ring, &s->cursor, &s->head_len);
+    }
+    return r;
+}
+
+/**
+ * @brief drain_batch() over every source, merged by timestamp.
+ *
+ * Each round seeds a min-heap with the oldest committed record of every
+ * source and pops up to DRAIN_BATCH records. The order is exact among the
+ * records visible when they are popped. A record committed later with an
+ * older timestamp comes out in the next round. Sources of exited threads
+ * are freed once empty. Records of the shared-memory ring are copied out
+ * and checked before they are written. g_sources_mu is held only to
+ * snapshot the list: registration pushes at its head, and only the
+ * consumer unlinks.
+ *
+ * @return Number of records written.
+ *
+ * @note Thread-safety: Caller holds g_drain_mu.
+ */
+static size_t drain_merged(void) {
+    alignas(log_record_t) char wire[WIRE_RECORD_MAX];
+    pthread_mutex_lock(&g_sources_mu);
+    log_source_t **link = &g_sources;
+    while (*link) {
+        log_source_t *s = *link;
+        // An exited thread committed everything it reserved: empty means done
+        if (s != &g_shared_source && atomic_load_explicit(&s->orphaned, memory_order_acquire) &&
+            po_logring_empty(s->ring)) {
+            *link = s->next;
+            free(s->ring);
+            free(s);
+            continue;
+        }
+        link = &s->next;
+    }
+    log_source_t *first = g_sources;
+    pthread_mutex_unlock(&g_sources_mu);
+
+    for (log_source_t *s = first; s; s = s->next) {
+        s->done = s->cursor = po_logring_cursor(s->ring);
+        s->head = source_peek(s);
+        if (s->head)
+            (void)po_indexed_heap_push(g_merge, &s->node); // on ENOMEM, next round
+    }
+
+    size_t n = 0;
+    po_heap_node_t *top;
+    while (n < DRAIN_BATCH && (top = po_indexed_heap_pop(g_merge)) != NULL) {
+        log_source_t *s = PO_HEAP_ENTRY(top, log_source_t, node);
+        const log_record_t *r = s->head;
+        if (s->wire)
+            r = wire_resolve(r, s->head_len, (log_record_t *)(void *)wire);
+        if (r)
+            process_record(r);
+        else
+            PO_METRIC_COUNTER_INC("logger.shm.malformed");
+        n++;
+        s->done = s->cursor;
+        s->head = source_peek(s);
+        if (s->head)
+            (void)po_indexed_heap_push(g_merge, &s->node);
+    }
+    while (po_indexed_heap_pop(g_merge) != NULL) {
+        // leave the rest for the next round
+    }
+    for (log_source_t *s = first; s; s = s->next) {
+        if (s->done != po_logring_cursor(s->ring))
+            po_logring_release(s->ring, s->done);
+    }
+
+    if (n > 0) {
+        // Producers skip "logger.enqueue" in this mode: it would be a shared line
+        PO_METRIC_COUNTER_ADD("logger.enqueue", n);
+        note_batch(n);
+    }
+    return n;
+}
+
+/**
+ * @brief True if any source has a committed record waiting.
+ *
+ * @note Thread-safe: Yes.
+ */
+static bool sources_pending(void) {
+    bool pending = false;
+    pthread_mutex_lock(&g_sources_mu);
+    for (log_source_t *s = g_sources; s && !pending; s = s->next)
+        pending = !po_logring_empty(s->ring);
+    pthread_mutex_unlock(&g_sources_mu);
+    return pending;
+}
+
+/**
+ * @brief Park the calling consumer until a producer publishes (or timeout).
+ *
+ * @note Thread-safety: Consumer role.
+ */
+static void wait_for_records(void) {
+    if (!g_merged) {
+        po_logring_wait(g_ring, DRAIN_IDLE_MS);
+        return;
+    }
+    uint32_t seq = po_logring_bell_prepare(g_bell);
+    if (sources_pending())
+        po_logring_bell_cancel(g_bell);
+    else
+        po_logring_bell_park(g_bell, seq, DRAIN_IDLE_MS);
+}
+
 /**
  * @brief Worker thread entry point.
  *
- * Drains the batcher/ring buffer and writes records to sinks.
+ * Drains the record ring(s) in batches and writes records to sinks. With
+ * several workers they take turns on g_drain_mu, since a ring has a single
+ * consumer cursor.
  *
  * @param[in] arg Unused.
  * @return NULL.
@@ -404,75 +1074,317 @@ static void write_record(const log_record_t *r) {
  */
 static void *worker_main(void *arg) {
     (void)arg;
+    size_t (*drain)(void) = g_merged ? drain_merged : drain_batch;
 
-    if (!g_batcher)
-        return NULL;
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        pthread_mutex_lock(&g_drain_mu);
+        size_t n = drain();
+        if (n > 0)
+            flush_sinks(); // batch processed
+        pthread_mutex_unlock(&g_drain_mu);
+        if (n == 0)
+            wait_for_records();
+    }
 
-    const size_t max_batch = 256;
-    void **batch = calloc(max_batch, sizeof(void *));
-    if (!batch)
-        return NULL;
+    // Drain whatever producers committed before shutdown
+    pthread_mutex_lock(&g_drain_mu);
+    while (drain() > 0) {
+    }
+    flush_sinks();
+    pthread_mutex_unlock(&g_drain_mu);
+    return NULL;
+}
 
-    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
-        ssize_t n = perf_batcher_next(g_batcher, batch);
-        if (n <= 0) {
-            if (!atomic_load_explicit(&g_running, memory_order_relaxed))
-                break;
-            continue; // spurious wake
-        }
+/**
+ * @brief Allocate and initialize a ring of @p bytes data bytes.
+ *
+ * @return The ring (free() it), or NULL on allocation failure.
+ *
+ * @note Thread-safe: Yes.
+ */
+static po_logring_t *alloc_ring(size_t bytes) {
+    size_t footprint = (po_logring_footprint(bytes) + 63u) & ~(size_t)63u;
+    void *mem = aligned_alloc(64, footprint);
+    return mem ? po_logring_init(mem, bytes) : NULL;
+}
 
-        PO_METRIC_COUNTER_INC("logger.batch.count");
-        PO_METRIC_COUNTER_ADD("logger.batch.records", n);
-        atomic_fetch_add_explicit(&g_batches, 1, memory_order_relaxed);
-        unsigned long prev = atomic_load_explicit(&g_max_batch, memory_order_relaxed);
-        if ((unsigned long)n > prev)
-            atomic_compare_exchange_strong(&g_max_batch, &prev, (unsigned long)n);
+/**
+ * @brief Ring bytes for @p records short records (power of two, >= PO_LOGRING_MIN).
+ *
+ * @note Thread-safe: Yes (Pure function).
+ */
+static size_t ring_bytes_for(size_t records) {
+    size_t bytes = PO_LOGRING_MIN;
+    while (bytes < records * RING_BYTES_PER_RECORD)
+        bytes <<= 1;
+    return bytes;
+}
 
-        for (ssize_t i = 0; i < n; ++i) {
-            log_record_t *r = (log_record_t *)batch[i];
-            if (r == &g_sentinel)
-                continue; // shutdown wake
+/**
+ * @brief pthread key destructor: mark the exiting thread's source orphaned.
+ *
+ * @param[in] p The thread's log_source_t.
+ *
+ * @note Thread-safe: Yes.
+ */
+static void source_orphan(void *p) {
+    pthread_mutex_lock(&g_sources_mu);
+    if (t_source == p && t_source_epoch == atomic_load(&g_sources_epoch))
+        atomic_store_explicit(&t_source->orphaned, true, memory_order_release);
+    pthread_mutex_unlock(&g_sources_mu);
+}
 
-            write_record(r);
-            PO_METRIC_COUNTER_INC("logger.processed");
+static void source_key_create(void) {
+    (void)pthread_key_create(&g_source_key, source_orphan);
+}
 
-            if (r->level <= LOG_FATAL)
-                PO_METRIC_COUNTER_INC(level_metrics[r->level]);
+/**
+ * @brief Give the calling thread its own ring and register it for merging.
+ *
+ * @return The new ring, or the shared ring if allocation fails.
+ *
+ * @note Thread-safe: Yes.
+ */
+static po_logring_t *register_source(void) {
+    pthread_once(&g_source_key_once, source_key_create);
+    log_source_t *s = calloc(1, sizeof(*s));
+    if (!s || !(s->ring = alloc_ring(g_thread_ring_bytes))) {
+        free(s);
+        return g_ring;
+    }
+    s->node = (po_heap_node_t)PO_HEAP_NODE_INIT;
+
+    pthread_mutex_lock(&g_sources_mu);
+    s->next = g_sources;
+    g_sources = s;
+    t_source = s;
+    t_source_epoch = atomic_load(&g_sources_epoch);
+    pthread_mutex_unlock(&g_sources_mu);
+    (void)pthread_setspecific(g_source_key, s);
+    return s->ring;
+}
 
-            atomic_fetch_add_explicit(&g_processed, 1, memory_order_relaxed);
-            recycle_record(r);
+/**
+ * @brief Ring the calling thread produces into.
+ *
+ * @note Thread-safe: Yes.
+ */
+static inline po_logring_t *producer_ring(void) {
+    if (!g_per_thread)
+        return g_ring;
+    if (t_source && t_source_epoch == atomic_load_explicit(&g_sources_epoch, memory_order_relaxed))
+        return t_source->ring;
+    return register_source();
+}
+
+/**
+ * @brief Free every thread ring (consumers already stopped).
+ *
+ * @note Thread-safe: No.
+ */
+static void free_sources(void) {
+    pthread_mutex_lock(&g_sources_mu);
+    log_source_t *s = g_sources;
+    while (s) {
+        log_source_t *next = s->next;
+        if (s != &g_shared_source && s != &g_shm_source) {
+            free(s->ring);
+            free(s);
         }
+        s = next;
+    }
+    g_sources = NULL;
+    atomic_fetch_add(&g_sources_epoch, 1); // live threads re-register on next use
+    pthread_mutex_unlock(&g_sources_mu);
+    po_indexed_heap_destroy(g_merge);
+    g_merge = NULL;
+}
 
-        // Batch processed, flush file sinks if active
-        for (file_sink_t *fs = g_file_sinks; fs; fs = fs->next) {
-            fflush(fs->fp);
+/**
+ * @brief Free the text staging buffers.
+ *
+ * @note Thread-safe: No.
+ */
+static void free_stages(void) {
+    for (int i = 0; i < 2; i++) {
+        free(g_stages[i].buf);
+        g_stages[i] = (stage_t){0};
+    }
+    g_fill = NULL;
+}
+
+/**
+ * @brief Allocate the text staging buffer(s): two with async_writer, else one.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ *
+ * @note Thread-safe: No.
+ */
+static int alloc_stages(void) {
+    for (int i = 0; i < (g_async ? 2 : 1); i++) {
+        g_stages[i] = (stage_t){.buf = malloc(STAGE_BYTES)};
+        if (!g_stages[i].buf) {
+            free_stages();
+            return -1;
         }
     }
+    g_fill = &g_stages[0];
+    g_handoff = NULL;
+    return 0;
+}
 
-    // Drain all remaining records from the ringbuf directly.
-    // We can't use perf_batcher_next() here because it blocks on the eventfd
-    // when there are no more events, even if records remain in the ringbuf.
-    void *p;
-    while (perf_ringbuf_dequeue(g_ring, &p) == 0) {
-        log_record_t *r = (log_record_t *)p;
-        if (r != &g_sentinel) {
-            write_record(r);
-            PO_METRIC_COUNTER_INC("logger.processed");
+/**
+ * @brief Stop the consumers after they drain everything committed, then the
+ *        async writer after it writes the last stage.
+ *
+ * @note Thread-safe: No.
+ */
+static void stop_consumers(void) {
+    atomic_store_explicit(&g_running, 0, memory_order_relaxed);
+    po_logring_bell_wake_all(g_bell);
+    for (unsigned i = 0; i < g_nworkers; i++)
+        pthread_join(g_workers[i], NULL);
+    free(g_workers);
+    g_workers = NULL;
+    g_nworkers = 0;
 
-            if (r->level <= LOG_FATAL)
-                PO_METRIC_COUNTER_INC(level_metrics[r->level]);
+    if (g_async) {
+        pthread_mutex_lock(&g_writer_mu);
+        g_writer_stop = true;
+        pthread_cond_signal(&g_writer_cv);
+        pthread_mutex_unlock(&g_writer_mu);
+        pthread_join(g_writer, NULL);
+    }
+}
 
-            recycle_record(r);
-        }
+/**
+ * @brief Free the rings, merge state and staging buffers; unlink a served
+ *        shared ring.
+ *
+ * @note Thread-safe: No (consumers already stopped).
+ */
+static void release_rings(void) {
+    if (g_merged)
+        free_sources();
+    if (g_shm_name) {
+        po_logshm_close(&g_shm, g_shm_name);
+        free(g_shm_name);
+        g_shm_name = NULL;
     }
+    free_stages();
+    free(g_ring);
+    g_ring = NULL;
+    g_bell = NULL;
+    g_merged = false;
+}
 
-    // Final flush
-    for (file_sink_t *fs = g_file_sinks; fs; fs = fs->next) {
-        fflush(fs->fp);
+/**
+ * @brief Create the shared ring @p name and add it to the merged sources.
+ *
+ * Consumers then park on its bell, which producers in every process ring.
+ *
+ * @param[in] name shm_open() name.
+ * @param[in] records Short records it should hold (0 = SHM_RING_RECORDS).
+ * @return 0 on success, -1 on error (errno set).
+ *
+ * @note Thread-safe: No.
+ */
+static int serve_shm(const char *name, size_t records) {
+    g_shm_name = strdup(name);
+    if (!g_shm_name)
+        return -1;
+    if (po_logshm_create(&g_shm, name, ring_bytes_for(records ? records : SHM_RING_RECORDS)) !=
+        0) {
+        free(g_shm_name);
+        g_shm_name = NULL;
+        return -1;
     }
+    g_shm_source = (log_source_t){.ring = g_shm.ring, .wire = true, .node = PO_HEAP_NODE_INIT};
+    g_shared_source.next = &g_shm_source;
+    g_bell = &g_shm.ring->bell;
+    return 0;
+}
 
-    free(batch);
-    return NULL;
+/**
+ * @brief Become a client of the shared ring @p name: log straight into it.
+ *
+ * No consumer, stage or sink: records are formatted here (a format pointer
+ * means nothing in the serving process) and dropped when the ring is full,
+ * since only the serving process may release records.
+ *
+ * @return 0 on success, -1 if the ring cannot be attached.
+ *
+ * @note Thread-safe: No.
+ */
+static int attach_shm(const char *name) {
+    if (po_logshm_attach(&g_shm, name) != 0)
+        return -1;
+    g_shm_client = true;
+    g_ring = g_shm.ring;
+    g_bell = &g_ring->bell;
+    g_merged = false;
+    g_per_thread = false;
+    g_deferred = false;
+    g_policy = LOGGER_DROP_NEW;
+    g_async = false;
+    g_nworkers = 0;
+    PO_METRIC_COUNTER_INC("logger.init");
+    return 0;
+}
+
+/**
+ * @brief Close and free every file sink.
+ *
+ * @note Thread-safe: No.
+ */
+static void close_file_sinks(void) {
+    file_sink_t *fs = g_file_sinks;
+    while (fs) {
+        file_sink_t *next = fs->next;
+        close(fs->fd);
+        free(fs->path);
+        free(fs);
+        fs = next;
+    }
+    g_file_sinks = NULL;
+}
+
+/**
+ * @brief Close and free every binary sink.
+ *
+ * @note Thread-safe: No.
+ */
+static void close_bin_sinks(void) {
+    bin_sink_t *b = g_bin_sinks;
+    while (b) {
+        bin_sink_t *next = b->next;
+        po_polog_writer_close(&b->w);
+        pthread_mutex_destroy(&b->mu);
+        free(b);
+        b = next;
+    }
+    g_bin_sinks = NULL;
+}
+
+/**
+ * @brief Create the parent directories of a sink path (best effort).
+ *
+ * @param[in] path File path.
+ *
+ * @note Thread-safe: Yes.
+ */
+static void make_parent_dirs(const char *path) {
+    char *dir = strdup(path);
+    if (dir) {
+        char *slash = strrchr(dir, '/');
+        if (slash) {
+            *slash = '\0';
+            // Ignore errors here; straightforward open will fail if mkdir failed, checking that is
+            // enough
+            mkdir_p(dir);
+        }
+        free(dir);
+    }
 }
 
 // --- Public API ---
@@ -487,75 +1399,69 @@ int po_logger_init(const po_logger_config_t *cfg) {
 
     _logger_runtime_level = cfg->level;
     g_policy = cfg->policy;
+    g_deferred = cfg->deferred_format;
+    g_per_thread = cfg->per_thread_rings;
     g_nworkers = cfg->consumers ? cfg->consumers : 1;
+    g_async = cfg->async_writer;
+    g_rotate_bytes = cfg->rotate_bytes;
+    g_rotate_secs = cfg->rotate_seconds;
+    g_rotate_keep = cfg->rotate_keep ? cfg->rotate_keep : ROTATE_KEEP;
+    g_default_category = cfg->default_category;
 
     g_sinks_mask = 0u; // reset sinks and counters
-    file_sink_t *fs = g_file_sinks;
-    while (fs) {
-        file_sink_t *next = fs->next;
-        if (fs->fp)
-            fclose(fs->fp);
-        free(fs);
-        fs = next;
-    }
-    g_file_sinks = NULL;
+    g_console_mask = 0u;
+    close_file_sinks();
+    close_bin_sinks();
     atomic_store_explicit(&g_dropped_new, 0ul, memory_order_relaxed);
     atomic_store_explicit(&g_overwritten_old, 0ul, memory_order_relaxed);
 
     size_t cacheline = cfg->cacheline_bytes;
     perf_ringbuf_set_cacheline(cacheline);
 
-    // Create ring with metrics enabled
-    g_ring = perf_ringbuf_create(cfg->ring_capacity, PERF_RINGBUF_METRICS);
+    if (cfg->shm_name && !cfg->shm_serve) {
+        if (attach_shm(cfg->shm_name) == 0)
+            return 0;
+        // Nobody serves the ring (e.g. a standalone run): log privately
+        PO_METRIC_COUNTER_INC("logger.shm.attach_failed");
+    }
+
+    // One byte ring sized for ring_capacity short records; a record takes
+    // only its header plus the bytes its message needs.
+    g_ring = alloc_ring(ring_bytes_for(cfg->ring_capacity));
     if (!g_ring)
         return -1;
-
-    g_pool_n = cfg->ring_capacity;
-    g_pool = calloc(g_pool_n, sizeof(*g_pool));
-    if (!g_pool) {
-        perf_ringbuf_destroy(&g_ring);
+    g_bell = &g_ring->bell;
+    g_merged = g_per_thread || (cfg->shm_name && cfg->shm_serve);
+    if (alloc_stages() != 0) {
+        release_rings();
         return -1;
     }
 
-    // Free list also gets metrics enabled?
-    // Actually the logger logic handles "no_free_record" metrics manually.
-    // But ringbuf metrics will track generic enqueue/dequeue.
-    // Let's enable it for full "autonomous" compliance.
-    g_free = perf_ringbuf_create(cfg->ring_capacity, PERF_RINGBUF_METRICS);
-    if (!g_free) {
-        free(g_pool);
-        g_pool = NULL;
-        g_pool_n = 0;
-        perf_ringbuf_destroy(&g_ring);
-        return -1;
+    if (g_merged) {
+        g_thread_ring_bytes = ring_bytes_for(
+            cfg->thread_ring_capacity ? cfg->thread_ring_capacity : THREAD_RING_RECORDS);
+        g_merge = po_indexed_heap_create(source_cmp, 64);
+        if (!g_merge) {
+            release_rings();
+            return -1;
+        }
+        g_shared_source = (log_source_t){.ring = g_ring, .node = PO_HEAP_NODE_INIT};
+        g_sources = &g_shared_source;
     }
-
-    g_batcher = perf_batcher_create(g_ring, 256, PERF_BATCHER_METRICS);
-    if (!g_batcher) {
-        perf_ringbuf_destroy(&g_free);
-        g_free = NULL;
-        free(g_pool);
-        g_pool = NULL;
-        g_pool_n = 0;
-        perf_ringbuf_destroy(&g_ring);
-        g_ring = NULL;
+    if (cfg->shm_name && cfg->shm_serve && serve_shm(cfg->shm_name, cfg->shm_capacity) != 0) {
+        release_rings();
         return -1;
     }
 
-    for (size_t i = 0; i < g_pool_n - 1; i++)
-        perf_ringbuf_enqueue(g_free, &g_pool[i]);
-
     g_workers = calloc(g_nworkers, sizeof(*g_workers));
     if (!g_workers) {
-        perf_batcher_destroy(&g_batcher);
-        perf_ringbuf_destroy(&g_free);
-        perf_ringbuf_destroy(&g_ring);
-        free(g_pool);
-        g_pool = NULL;
-        g_pool_n = 0;
+        release_rings();
         return -1;
     }
 
+    g_writer_stop = false;
+    if (g_async)
+        pthread_create(&g_writer, NULL, writer_main, NULL);
     atomic_store_explicit(&g_running, 1, memory_order_relaxed);
     for (unsigned i = 0; i < g_nworkers; i++)
         pthread_create(&g_workers[i], NULL, worker_main, NULL);
@@ -574,40 +1480,18 @@ void po_logger_shutdown(void) {
         return;
 
     PO_METRIC_COUNTER_INC("logger.shutdown");
-    atomic_store_explicit(&g_running, 0, memory_order_relaxed);
-
-    for (unsigned i = 0; i < g_nworkers; i++) {
-        if (g_batcher)
-            perf_batcher_enqueue(g_batcher, &g_sentinel);
-        else
-            perf_ringbuf_enqueue(g_ring, &g_sentinel);
+    if (g_shm_client) {
+        po_logshm_close(&g_shm, NULL); // the serving process owns the name
+        g_shm_client = false;
+        g_ring = NULL;
+        g_bell = NULL;
+    } else {
+        stop_consumers();
+        release_rings();
     }
-    for (unsigned i = 0; i < g_nworkers; i++)
-        pthread_join(g_workers[i], NULL);
 
-    free(g_workers);
-    g_workers = NULL;
-    g_nworkers = 0;
-    if (g_batcher)
-        perf_batcher_destroy(&g_batcher);
-
-    perf_ringbuf_destroy(&g_ring);
-    perf_ringbuf_destroy(&g_free);
-    free(g_pool);
-    g_pool = NULL;
-    g_pool_n = 0;
-
-    if (g_file_sinks) {
-        file_sink_t *fsur = g_file_sinks;
-        while (fsur) {
-            file_sink_t *next = fsur->next;
-            fflush(fsur->fp);
-            fclose(fsur->fp);
-            free(fsur);
-            fsur = next;
-        }
-        g_file_sinks = NULL;
-    }
+    close_file_sinks();
+    close_bin_sinks();
     if (g_syslog_open) {
         closelog();
         g_syslog_open = 0;
@@ -642,6 +1526,8 @@ po_log_level_t po_logger_get_level(void) {
 }
 
 int po_logger_add_sink_console(bool use_stderr) {
+    if (g_shm_client)
+        return 0; // the serving process owns the sinks
     if (use_stderr) {
         g_sinks_mask |= LOGGER_SINK_STDERR;
     } else {
@@ -650,35 +1536,36 @@ int po_logger_add_sink_console(bool use_stderr) {
     return 0;
 }
 
+int po_logger_add_sink_console_categorized(bool use_stderr, uint32_t category_mask) {
+    g_console_mask = category_mask;
+    return po_logger_add_sink_console(use_stderr);
+}
+
 int po_logger_add_sink_file(const char *path, bool append) {
     return po_logger_add_sink_file_categorized(path, append, 0u);
 }
 
 int po_logger_add_sink_file_categorized(const char *path, bool append, uint32_t category_mask) {
-    // Attempt to create parent directories
-    char *dir = strdup(path);
-    if (dir) {
-        char *slash = strrchr(dir, '/');
-        if (slash) {
-            *slash = '\0';
-            // Ignore errors here; straightforward fopen will fail if mkdir failed, checking that is
-            // enough
-            mkdir_p(dir);
-        }
-        free(dir);
-    }
+    if (g_shm_client)
+        return 0;
+    make_parent_dirs(path);
 
-    const char *mode = append ? "a" : "w";
-    FILE *fp = fopen(path, mode);
-    if (!fp)
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (append ? 0 : O_TRUNC);
+    int fd = open(path, flags, 0644);
+    if (fd < 0)
         return -1;
 
     file_sink_t *sink = malloc(sizeof(file_sink_t));
-    if (!sink) {
-        fclose(fp);
+    char *copy = strdup(path);
+    if (!sink || !copy) {
+        free(sink);
+        free(copy);
+        close(fd);
         return -1;
     }
-    sink->fp = fp;
+    sink->fd = fd;
+    sink->path = copy;
+    sink->opened = time(NULL);
     sink->mask = category_mask;
     sink->next = g_file_sinks;
     g_file_sinks = sink;
@@ -687,7 +1574,29 @@ int po_logger_add_sink_file_categorized(const char *path, bool append, uint32_t
     return 0;
 }
 
+int po_logger_add_sink_binary(const char *path, bool append) {
+    if (g_shm_client)
+        return 0;
+    make_parent_dirs(path);
+    bin_sink_t *b = calloc(1, sizeof(*b));
+    if (!b)
+        return -1;
+    b->w = po_polog_writer_open(path, append);
+    if (!b->w) {
+        free(b);
+        return -1;
+    }
+    pthread_mutex_init(&b->mu, NULL);
+    b->next = g_bin_sinks;
+    g_bin_sinks = b;
+
+    g_sinks_mask |= LOGGER_SINK_BINARY;
+    return 0;
+}
+
 int po_logger_add_sink_syslog(const char *ident) {
+    if (g_shm_client)
+        return 0;
     if (!g_syslog_open) {
         if (g_syslog_ident) {
             free(g_syslog_ident);
@@ -706,6 +1615,8 @@ int po_logger_add_sink_syslog(const char *ident) {
 }
 
 int po_logger_add_sink_custom(void (*fn)(const char *line, void *udata), void *udata) {
+    if (g_shm_client)
+        return 0;
     custom_sink_t *c = malloc(sizeof(*c));
     if (!c)
         return -1;
@@ -722,116 +1633,187 @@ void po_logger_set_thread_category(uint32_t category) {
 }
 
 /**
- * @brief Enqueue a record to the logger ring buffer.
+ * @brief Check if an overflow notice should be emitted.
  *
- * Handles overflow policy (drop new vs overwrite old).
+ * Uses a power-of-two check to limit the rate of overflow logging.
  *
- * @param[in] rec Pointer to the record to enqueue.
+ * @param[in] v Current count of dropped/overwritten events.
+ * @return 1 if notice should be emitted, 0 otherwise.
  *
- * @note Thread-safety: Yes (lock-free).
+ * @note Thread-safe: Yes (Pure function).
  */
-static void enqueue_record(log_record_t *rec) {
-    if (g_batcher) {
-        if (perf_batcher_enqueue(g_batcher, rec) == 0) {
-            PO_METRIC_COUNTER_INC("logger.enqueue");
-            return;
-        }
-    } else if (perf_ringbuf_enqueue(g_ring, rec) == 0) {
-        PO_METRIC_COUNTER_INC("logger.enqueue");
-        return;
-    }
+static inline int should_emit_overflow_notice(unsigned long v) {
+    return (v != 0UL) && ((v & (v - 1UL)) == 0UL);
+}
 
-    if (g_policy == LOGGER_DROP_NEW) {
-        PO_METRIC_COUNTER_INC("logger.drop_new");
-        atomic_fetch_add_explicit(&g_dropped_new, 1, memory_order_relaxed);
-        recycle_record(rec);
-        return;
-    }
+/**
+ * @brief Fill in the fixed fields of a record; the message is left empty.
+ *
+ * @param[out] r Record to fill.
+ * @param[in] level Log level.
+ * @param[in] file Static source file name (Nullable).
+ * @param[in] line Source line.
+ * @param[in] func Static function name (Nullable).
+ *
+ * @note Thread-safe: Yes.
+ */
+static inline void fill_record(log_record_t *r, po_log_level_t level, const char *file, int line,
+                               const char *func) {
+    clock_gettime(CLOCK_REALTIME, &r->ts);
+    r->tid = get_tid();
+    r->file = file ? file : "";
+    r->func = func ? func : "";
+    r->fmt = NULL;
+    uint32_t category = _po_logger_thread_category;
+    r->category = category != CATEGORY_UNSET ? category : g_default_category;
+    r->line = line;
+    r->msglen = 0;
+    r->level = (uint8_t)level;
+    r->msg[0] = '\0';
+}
 
-    void *old;
-    if (perf_ringbuf_dequeue(g_ring, &old) == 0) {
-        PO_METRIC_COUNTER_INC("logger.overwrite_old");
-        atomic_fetch_add_explicit(&g_overwritten_old, 1, memory_order_relaxed);
-        recycle_record((log_record_t *)old);
-    }
-    if (g_batcher) {
-        if (perf_batcher_enqueue(g_batcher, rec) == 0)
-            PO_METRIC_COUNTER_INC("logger.enqueue");
-    } else if (perf_ringbuf_enqueue(g_ring, rec) == 0)
-        PO_METRIC_COUNTER_INC("logger.enqueue");
+/**
+ * @brief Reserve in @p ring: lock-free for the shared ring, plain stores in
+ *        a thread's own ring.
+ *
+ * @param[out] tag The reservation's tag, for ring_commit().
+ *
+ * @note Thread-safe: Yes.
+ */
+static inline void *ring_reserve(po_logring_t *ring, size_t len, uint64_t *tag) {
+    return ring == g_ring ? po_logring_reserve(ring, len, tag)
+                          : po_logring_reserve_single(ring, len, tag);
 }
 
 /**
- * @brief Check if an overflow notice should be emitted.
+ * @brief Publish a filled record and wake a parked consumer if needed.
  *
- * Uses a power-of-two check to limit the rate of overflow logging.
+ * Consumers always park on g_bell, whichever ring the record is in.
  *
- * @param[in] v Current count of dropped/overwritten events.
- * @return 1 if notice should be emitted, 0 otherwise.
+ * @note Thread-safe: Yes.
+ */
+static inline void ring_commit(po_logring_t *ring, log_record_t *r, uint64_t tag) {
+    po_logring_publish(ring, r, tag);
+    po_logring_bell_ring(g_bell);
+}
+
+/**
+ * @brief Copy a record built on the stack into @p ring and commit it.
  *
- * @note Thread-safe: Yes (Pure function).
+ * @param[in] ring Ring to queue into.
+ * @param[in] src Filled record (text message).
+ * @return true if queued, false if the ring is full.
+ *
+ * @note Thread-safe: Yes.
  */
-static inline int should_emit_overflow_notice(unsigned long v) {
-    return (v != 0UL) && ((v & (v - 1UL)) == 0UL);
+static bool enqueue_copy(po_logring_t *ring, const log_record_t *src) {
+    size_t len = sizeof(log_record_t) + src->msglen + 1;
+    size_t names = g_shm_client ? wire_names_size(src->file, src->func) : 0;
+    uint64_t tag;
+    log_record_t *r = ring_reserve(ring, len + names, &tag);
+    if (!r)
+        return false;
+    memcpy(r, src, len);
+    if (g_shm_client)
+        wire_store_names(r);
+    ring_commit(ring, r, tag);
+    return true;
 }
 
 /**
- * @brief Populate a record with overflow information.
+ * @brief Queue a record reporting overflow counters, or write it inline if
+ *        the ring is still full.
  *
- * @param[out] rec Record to fill.
+ * @param[in] ring Calling thread's ring.
  * @param[in] dropped Number of dropped new messages.
  * @param[in] overwritten Number of overwritten old messages.
  *
  * @note Thread-safe: Yes.
  */
-static inline void fill_overflow_notice(log_record_t *rec, unsigned long dropped,
-                                        unsigned long overwritten) {
-    clock_gettime(CLOCK_REALTIME, &rec->ts);
-    rec->tid = get_tid();
-    rec->level = (uint8_t)LOG_ERROR;
-    rec->category = 0;
-    rec->line = 0;
-    rec->file[0] = '\0';
-    strncpy(rec->func, "logger", sizeof(rec->func) - 1);
-    rec->func[sizeof(rec->func) - 1] = '\0';
-    snprintf(rec->msg, sizeof(rec->msg),
-             "logger overflow: dropped_new=%lu overwritten_old=%lu (policy=%s)", dropped,
-             overwritten, g_policy == LOGGER_DROP_NEW ? "DROP_NEW" : "OVERWRITE_OLDEST");
+static void emit_overflow_notice(po_logring_t *ring, unsigned long dropped,
+                                 unsigned long overwritten) {
+    PO_METRIC_COUNTER_INC("logger.overflow.notice");
+
+    char text[128];
+    int n = snprintf(text, sizeof(text),
+                     "logger overflow: dropped_new=%lu overwritten_old=%lu (policy=%s)", dropped,
+                     overwritten, g_policy == LOGGER_DROP_NEW ? "DROP_NEW" : "OVERWRITE_OLDEST");
+    size_t len = n < 0 ? 0 : ((size_t)n < sizeof(text) ? (size_t)n : sizeof(text) - 1);
+
+    alignas(log_record_t) char local[sizeof(log_record_t) + sizeof(text)];
+    log_record_t *w = (log_record_t *)(void *)local;
+    fill_record(w, LOG_ERROR, NULL, 0, "logger");
+    w->msglen = (uint16_t)len;
+    memcpy(w->msg, text, len);
+    w->msg[len] = '\0';
+    if (!enqueue_copy(ring, w))
+        write_record_now(w);
+}
+
+/**
+ * @brief Reserve ring space for a record with @p msgsz message bytes.
+ *
+ * Handles overflow policy (drop new vs overwrite old). To overwrite, the
+ * producer briefly takes the consumer's place and releases the oldest
+ * committed records; if a consumer is draining right now, it drops instead.
+ *
+ * @param[in] ring Calling thread's ring.
+ * @param[in] msgsz Bytes needed after the fixed fields.
+ * @param[out] tag The reservation's tag, for ring_commit().
+ * @return Record to fill and commit, or NULL if the message is dropped.
+ *
+ * @note Thread-safety: Yes (lock-free unless overwriting).
+ */
+static log_record_t *reserve_record(po_logring_t *ring, size_t msgsz, uint64_t *tag) {
+    size_t len = sizeof(log_record_t) + msgsz;
+    log_record_t *rec = ring_reserve(ring, len, tag);
+    if (rec)
+        return rec;
+
+    unsigned long overwritten = 0;
+    bool notice = false;
+    if (g_policy == LOGGER_OVERWRITE_OLDEST && pthread_mutex_trylock(&g_drain_mu) == 0) {
+        uint64_t cursor = po_logring_cursor(ring);
+        while (!rec && po_logring_peek(ring, &cursor, NULL)) {
+            po_logring_release(ring, cursor);
+            PO_METRIC_COUNTER_INC("logger.overwrite_old");
+            overwritten =
+                atomic_fetch_add_explicit(&g_overwritten_old, 1, memory_order_relaxed) + 1UL;
+            notice = notice || should_emit_overflow_notice(overwritten);
+            rec = ring_reserve(ring, len, tag);
+        }
+        pthread_mutex_unlock(&g_drain_mu);
+    }
+
+    unsigned long dropped = atomic_load_explicit(&g_dropped_new, memory_order_relaxed);
+    if (!rec) {
+        PO_METRIC_COUNTER_INC("logger.drop_new");
+        dropped = atomic_fetch_add_explicit(&g_dropped_new, 1, memory_order_relaxed) + 1UL;
+        notice = notice || should_emit_overflow_notice(dropped);
+    }
+    if (notice)
+        emit_overflow_notice(ring, dropped,
+                             atomic_load_explicit(&g_overwritten_old, memory_order_relaxed));
+    return rec;
 }
 
 void po_logger_logv(po_log_level_t level, const char *file, int line, const char *func,
                     const char *fmt, va_list ap) {
     // 1. FATAL Handling (Synchronous Crash Path)
     if (level == LOG_FATAL) {
-        log_record_t r;
-        clock_gettime(CLOCK_REALTIME, &r.ts);
-        r.tid = get_tid();
-        r.level = (uint8_t)level;
-        r.category = _po_logger_thread_category;
-        r.line = line;
-
-        // Populate file/func
-        if (file) {
-            size_t len = strlen(file);
-            size_t cap = sizeof(r.file);
-            size_t n = (len >= cap) ? (cap - 1) : len;
-            const char *src = (len >= cap) ? (file + len - n) : file;
-            memcpy(r.file, src, n);
-            r.file[n] = '\0';
-        } else
-            r.file[0] = '\0';
-
-        if (func) {
-            strncpy(r.func, func, sizeof(r.func) - 1);
-            r.func[sizeof(r.func) - 1] = '\0';
-        } else
-            r.func[0] = '\0';
+        alignas(log_record_t) char local[sizeof(log_record_t) + LOGGER_MSG_MAX];
+        log_record_t *r = (log_record_t *)(void *)local;
+        fill_record(r, level, file, line, func);
 
         // Format message
-        vsnprintf(r.msg, sizeof(r.msg), fmt, ap);
+        int n = vsnprintf(r->msg, LOGGER_MSG_MAX, fmt, ap);
+        size_t len = n < 0 ? 0 : ((size_t)n < LOGGER_MSG_MAX ? (size_t)n : LOGGER_MSG_MAX - 1);
+        r->msglen = (uint16_t)len;
 
-        // Synchronous write to ensure valid output before crash
-        write_record(&r);
+        // Synchronous write to ensure valid output before crash. A client has
+        // no sinks: the serving process writes it (the ring outlives us).
+        if (!g_shm_client || !enqueue_copy(g_ring, r))
+            write_record_now(r);
 
         // Bye
         abort();
@@ -840,79 +1822,45 @@ void po_logger_logv(po_log_level_t level, const char *file, int line, const char
     if (!g_ring)
         return; // not initialized yet
 
-    void *ptr = NULL; // obtain a record from freelist (non-blocking)
-    if (perf_ringbuf_dequeue(g_free, &ptr) != 0) {
-        PO_METRIC_COUNTER_INC("logger.no_free_record");
-
-        unsigned long dropped =
-            atomic_fetch_add_explicit(&g_dropped_new, 1, memory_order_relaxed) + 1UL;
-        if (should_emit_overflow_notice(dropped)) {
-            PO_METRIC_COUNTER_INC("logger.overflow.notice");
-
-            log_record_t w2;
-            unsigned long overwritten =
-                atomic_load_explicit(&g_overwritten_old, memory_order_relaxed);
-            fill_overflow_notice(&w2, dropped, overwritten);
-            write_record(&w2);
-        }
-
-        return;
-    }
-
-    log_record_t *r = (log_record_t *)ptr;
-
-    clock_gettime(CLOCK_REALTIME, &r->ts);
-    r->tid = get_tid();
-    r->level = (uint8_t)level;
-    r->category = _po_logger_thread_category;
-    r->line = line;
-
-    if (file) {
-        size_t len = strlen(file);
-        size_t cap = sizeof(r->file);
-        size_t n = (len >= cap) ? (cap - 1) : len;
-        const char *src = (len >= cap) ? (file + len - n) : file;
-        memcpy(r->file, src, n);
-        r->file[n] = '\0';
-    } else
-        r->file[0] = '\0';
-
-    if (func) {
-        strncpy(r->func, func, sizeof(r->func) - 1);
-        r->func[sizeof(r->func) - 1] = '\0';
-    } else
-        r->func[0] = '\0';
-
+    // Build the message first: the ring needs its exact size up front
+    char msg[LOGGER_MSG_MAX];
+    const char *packed_fmt = NULL;
+    size_t msglen = 0;
+    msg[0] = '\0';
     if (fmt && *fmt) {
         va_list ap_copy;
         va_copy(ap_copy, ap);
-        vsnprintf(r->msg, sizeof(r->msg), fmt, ap_copy);
+        ssize_t packed = -1;
+        if (g_deferred) // raw arguments now, text on the consumer
+            packed = po_logfmt_capture(fmt, ap_copy, (uint8_t *)msg, sizeof(msg));
         va_end(ap_copy);
-    } else {
-        r->msg[0] = '\0';
-    }
-
-    enqueue_record(r);
-
-    unsigned long dropped = atomic_load_explicit(&g_dropped_new, memory_order_relaxed);
-    unsigned long overwritten = atomic_load_explicit(&g_overwritten_old, memory_order_relaxed);
-    if (should_emit_overflow_notice(dropped) || should_emit_overflow_notice(overwritten)) {
-        PO_METRIC_COUNTER_INC("logger.overflow.notice");
-
-        void *p2 = NULL;
-        if (perf_ringbuf_dequeue(g_free, &p2) == 0) {
-            log_record_t *w = (log_record_t *)p2;
-            fill_overflow_notice(w, dropped, overwritten);
-            if (perf_ringbuf_enqueue(g_ring, w) != 0) {
-                write_record(w);
-                recycle_record(w);
-            }
+        if (packed >= 0) {
+            packed_fmt = fmt;
+            msglen = (size_t)packed;
         } else {
-            log_record_t w2;
-            fill_overflow_notice(&w2, dropped, overwritten);
-            write_record(&w2);
+            va_copy(ap_copy, ap);
+            int n = vsnprintf(msg, sizeof(msg), fmt, ap_copy);
+            va_end(ap_copy);
+            msglen = n < 0 ? 0 : ((size_t)n < sizeof(msg) ? (size_t)n : sizeof(msg) - 1);
         }
     }
+
+    po_logring_t *ring = producer_ring();
+    size_t names = g_shm_client ? wire_names_size(file ? file : "", func ? func : "") : 0;
+    uint64_t tag;
+    log_record_t *r = reserve_record(ring, msglen + 1 + names, &tag); // + NUL for text sinks
+    if (!r)
+        return;
+    fill_record(r, level, file, line, func);
+    r->fmt = packed_fmt;
+    r->msglen = (uint16_t)msglen;
+    memcpy(r->msg, msg, msglen);
+    r->msg[msglen] = '\0';
+    if (g_shm_client)
+        wire_store_names(r);
+    ring_commit(ring, r, tag);
+    if (!g_merged && !g_shm_client) // else the serving consumer counts it
+        PO_METRIC_COUNTER_INC("logger.enqueue");
 }
 
 void po_logger_log(po_log_level_t level, const char *file, int line, const char *func,
@@ -945,6 +1893,65 @@ int po_logger_level_from_str(const char *str) {
     return -1;
 }
 
+/**
+ * @brief Write the committed records of one ring to @p fd (async-signal-safe).
+ *
+ * @param[in] fd Destination.
+ * @param[in] ring Ring to walk.
+ */
+static void dump_ring(int fd, const po_logring_t *ring) {
+    // Walk committed records without releasing them: no locks, no stores.
+    // Bounded by the ring size in case a consumer moves the tail meanwhile.
+    uint64_t start = po_logring_cursor(ring);
+    uint64_t cursor = start;
+    const log_record_t *r;
+    while (cursor - start < ring->cap && (r = po_logring_peek(ring, &cursor, NULL)) != NULL) {
+        const char *lvl = "UNKNOWN";
+        switch (r->level) {
+        case LOG_TRACE:
+            lvl = "TRACE";
+            break;
+        case LOG_DEBUG:
+            lvl = "DEBUG";
+            break;
+        case LOG_INFO:
+            lvl = "INFO ";
+            break;
+        case LOG_WARN:
+            lvl = "WARN ";
+            break;
+        case LOG_ERROR:
+            lvl = "ERROR";
+            break;
+        case LOG_FATAL:
+            lvl = "FATAL";
+            break;
+        }
+
+        // [LEVEL] func - msg
+        if (write(fd, "[", 1) < 0) {
+        }
+        if (write(fd, lvl, 5) < 0) {
+        }
+        if (write(fd, "] ", 2) < 0) {
+        }
+
+        if (r->func && r->func[0]) { // NULL: shared-ring record (names inline)
+            if (write(fd, r->func, strlen(r->func)) < 0) {
+            }
+            if (write(fd, " - ", 3) < 0) {
+            }
+        }
+
+        // Deferred records hold packed arguments: show the format instead
+        const char *text = r->fmt ? r->fmt : r->msg;
+        if (write(fd, text, strlen(text)) < 0) {
+        }
+        if (write(fd, "\n", 1) < 0) {
+        }
+    }
+}
+
 void po_logger_crash_dump(int fd) {
     // Async-signal-safe dump. Avoids snprintf, localtime, malloc.
     // Uses write() and strlen() (which is generally safe) directly.
@@ -952,52 +1959,14 @@ void po_logger_crash_dump(int fd) {
     if (write(fd, header, strlen(header)) < 0) {
     }
 
-    void *p;
-    while (g_ring && perf_ringbuf_dequeue(g_ring, &p) == 0) {
-        log_record_t *r = (log_record_t *)p;
-        if (r && r != &g_sentinel) {
-            const char *lvl = "UNKNOWN";
-            switch (r->level) {
-            case LOG_TRACE:
-                lvl = "TRACE";
-                break;
-            case LOG_DEBUG:
-                lvl = "DEBUG";
-                break;
-            case LOG_INFO:
-                lvl = "INFO ";
-                break;
-            case LOG_WARN:
-                lvl = "WARN ";
-                break;
-            case LOG_ERROR:
-                lvl = "ERROR";
-                break;
-            case LOG_FATAL:
-                lvl = "FATAL";
-                break;
-            }
-
-            // [LEVEL] func - msg
-            if (write(fd, "[", 1) < 0) {
-            }
-            if (write(fd, lvl, 5) < 0) {
-            }
-            if (write(fd, "] ", 2) < 0) {
-            }
-
-            if (r->func[0]) {
-                if (write(fd, r->func, strlen(r->func)) < 0) {
-                }
-                if (write(fd, " - ", 3) < 0) {
-                }
-            }
-
-            if (write(fd, r->msg, strlen(r->msg)) < 0) {
-            }
-            if (write(fd, "\n", 1) < 0) {
-            }
-        }
+    if (g_shm_client) {
+        // Our records are in the shared ring: the serving process writes them
+    } else if (g_merged) {
+        // Unlocked walk of the source list: a crashing process may hold g_sources_mu
+        for (const log_source_t *s = g_sources; s; s = s->next)
+            dump_ring(fd, s->ring);
+    } else if (g_ring) {
+        dump_ring(fd, g_ring);
     }
     const char *footer = "--- End of Pending Logs ---\n";
     if (write(fd, footer, strlen(footer)) < 0) {
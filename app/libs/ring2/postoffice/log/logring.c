@@ -0,0 +1,307 @@
+/**
+ * @file logring.c
+ * @brief Variable-length record ring (see logring.h).
+ *
+ * Header (one 64-bit word): bit 63 committed, bit 62 padding, bits 40-61
+ * the pid of the reserving process (so the consumer can tell when the owner
+ * has died), bits 27-39 the lap of the ring the record starts in, bits 3-26
+ * the record's size including the header (a multiple of PO_LOGRING_ALIGN),
+ * bits 0-2 the alignment slack after the payload, which gives the exact
+ * payload length. A reservation writes all but bit 63; zero means nothing
+ * has been reserved there yet.
+ *
+ * A commit CASes the commit bit into exactly the header its reservation
+ * wrote (the tag), and po_logring_reclaim() CASes an uncommitted header
+ * into padding, so exactly one of them wins. Once the bytes are released
+ * and reserved again, the header carries a later lap, so a late commit of
+ * the reclaimed reservation cannot mistake the new one for its own.
+ *
+ * Wakeup protocol (as in perf/batcher.c, with a futex instead of an
+ * eventfd so it works across processes): a consumer clears wake_pending,
+ * samples wake_seq, announces itself in sleepers, re-checks its ring(s) and
+ * sleeps on wake_seq. After publishing, a producer fences and, if anyone is
+ * announced, the first one to set wake_pending bumps wake_seq and wakes the
+ * sleepers. The seq_cst fences mean either the producer sees the
+ * announcement or the consumer's re-check sees the record. Producers only
+ * read the bell's line until a consumer actually parks.
+ */
+
+#include "log/logring.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HDR_COMMIT (1ull << 63)
+#define HDR_PAD (1ull << 62)
+#define HDR_OWNER_SHIFT 40
+#define HDR_OWNER_MASK 0x3fffffull // pids stay below 2^22 (PID_MAX_LIMIT)
+#define HDR_LAP_SHIFT 27
+#define HDR_LAP_MASK 0x1fffull
+#define HDR_SLACK_MASK ((uint64_t)PO_LOGRING_ALIGN - 1u)
+#define HDR_SIZE_MASK (((1ull << HDR_LAP_SHIFT) - 1u) & ~HDR_SLACK_MASK)
+
+#define SPIN_POLLS 256u
+
+_Static_assert(sizeof(atomic_uint) == sizeof(uint32_t), "futex word must be 32 bits");
+
+typedef struct {
+    _Atomic uint64_t word;
+} rec_hdr_t;
+
+_Static_assert(sizeof(rec_hdr_t) == PO_LOGRING_HDR, "record header size");
+_Static_assert(PO_LOGRING_MAX <= HDR_SIZE_MASK, "record size field too narrow");
+
+static inline rec_hdr_t *hdr_at(const po_logring_t *r, uint64_t pos) {
+    return (rec_hdr_t *)(void *)((unsigned char *)r->data + (pos & (r->cap - 1)));
+}
+
+static inline uint32_t record_size(size_t len) {
+    size_t mask = PO_LOGRING_ALIGN - 1;
+    return (uint32_t)((PO_LOGRING_HDR + len + mask) & ~mask);
+}
+
+static inline pid_t hdr_owner(uint64_t word) {
+    return (pid_t)((word >> HDR_OWNER_SHIFT) & HDR_OWNER_MASK);
+}
+
+static atomic_int g_pid; // this process, for reservation headers (0: look it up)
+
+static void forget_pid(void) {
+    atomic_store_explicit(&g_pid, 0, memory_order_relaxed);
+}
+
+static void watch_forks(void) {
+    pthread_atfork(NULL, NULL, forget_pid);
+}
+
+// getpid() is a system call; reservations take it from a cache a fork resets
+static int32_t owner_pid(void) {
+    int pid = atomic_load_explicit(&g_pid, memory_order_relaxed);
+    if (pid == 0) {
+        static pthread_once_t once = PTHREAD_ONCE_INIT;
+        pthread_once(&once, watch_forks);
+        pid = (int)getpid();
+        atomic_store_explicit(&g_pid, pid, memory_order_relaxed);
+    }
+    return pid;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Mark [head, head + pad + record_size(len)) as ours: the padding, if any,
+// is committed at once; the record is reserved in the owner's name.
+static void *claim(po_logring_t *r, uint64_t head, uint64_t pad, size_t len, uint64_t *tag) {
+    if (pad)
+        atomic_store_explicit(&hdr_at(r, head)->word, HDR_COMMIT | HDR_PAD | pad,
+                              memory_order_release);
+    uint64_t pos = head + pad;
+    uint32_t size = record_size(len);
+    uint64_t lap = (pos >> __builtin_ctzll(r->cap)) & HDR_LAP_MASK;
+    uint64_t owner = (uint64_t)(uint32_t)owner_pid() & HDR_OWNER_MASK;
+    *tag = owner << HDR_OWNER_SHIFT | lap << HDR_LAP_SHIFT | size |
+           (size - PO_LOGRING_HDR - (uint32_t)len);
+    rec_hdr_t *h = hdr_at(r, pos);
+    atomic_store_explicit(&h->word, *tag, memory_order_release);
+    return h + 1;
+}
+
+// Shared (non-private) futex ops: the ring may live in a MAP_SHARED region.
+static long futex_wait(atomic_uint *addr, uint32_t expected, const struct timespec *timeout) {
+    return syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static long futex_wake(atomic_uint *addr, int count) {
+    return syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+size_t po_logring_footprint(size_t cap) {
+    return sizeof(po_logring_t) + cap;
+}
+
+po_logring_t *po_logring_init(void *mem, size_t cap) {
+    if (!mem || cap < PO_LOGRING_MIN || (cap & (cap - 1)) || cap > PO_LOGRING_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+    po_logring_t *r = mem;
+    memset(r, 0, po_logring_footprint(cap));
+    r->cap = cap;
+    return r;
+}
+
+void *po_logring_reserve(po_logring_t *r, size_t len, uint64_t *tag) {
+    if (len > r->cap / 4) {
+        errno = EMSGSIZE;
+        return NULL;
+    }
+    uint32_t need = record_size(len);
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint64_t pad;
+    for (;;) {
+        uint64_t off = head & (r->cap - 1);
+        pad = off + need > r->cap ? r->cap - off : 0;
+        // Acquire: the consumer zeroed what it released before moving tail
+        uint64_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head + pad + need - tail > r->cap) {
+            errno = EAGAIN;
+            return NULL;
+        }
+        if (atomic_compare_exchange_weak_explicit(&r->head, &head, head + pad + need,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+    return claim(r, head, pad, len, tag);
+}
+
+void *po_logring_reserve_single(po_logring_t *r, size_t len, uint64_t *tag) {
+    if (len > r->cap / 4) {
+        errno = EMSGSIZE;
+        return NULL;
+    }
+    uint32_t need = record_size(len);
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint64_t off = head & (r->cap - 1);
+    uint64_t pad = off + need > r->cap ? r->cap - off : 0;
+    if (head + pad + need - r->tail_cache > r->cap) {
+        r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head + pad + need - r->tail_cache > r->cap) {
+            errno = EAGAIN;
+            return NULL;
+        }
+    }
+    atomic_store_explicit(&r->head, head + pad + need, memory_order_relaxed);
+    return claim(r, head, pad, len, tag);
+}
+
+bool po_logring_publish(po_logring_t *r, void *payload, uint64_t tag) {
+    (void)r;
+    rec_hdr_t *h = (rec_hdr_t *)payload - 1;
+    // Anything else there: the consumer reclaimed it (and maybe reused it)
+    return atomic_compare_exchange_strong_explicit(&h->word, &tag, tag | HDR_COMMIT,
+                                                   memory_order_release, memory_order_relaxed);
+}
+
+bool po_logring_commit(po_logring_t *r, void *payload, uint64_t tag) {
+    bool ok = po_logring_publish(r, payload, tag);
+    po_logring_bell_ring(&r->bell);
+    return ok;
+}
+
+const void *po_logring_peek(const po_logring_t *r, uint64_t *cursor, size_t *len) {
+    for (;;) {
+        const rec_hdr_t *h = hdr_at(r, *cursor);
+        uint64_t word = atomic_load_explicit(&h->word, memory_order_acquire);
+        if (!(word & HDR_COMMIT))
+            return NULL;
+        *cursor += word & HDR_SIZE_MASK;
+        if (word & HDR_PAD)
+            continue;
+        if (len)
+            *len = (word & HDR_SIZE_MASK) - PO_LOGRING_HDR - (word & HDR_SLACK_MASK);
+        return h + 1;
+    }
+}
+
+bool po_logring_reclaim(po_logring_t *r, uint64_t cursor, int timeout_ms) {
+    rec_hdr_t *h = hdr_at(r, cursor);
+    uint64_t word = atomic_load_explicit(&h->word, memory_order_acquire);
+    if (word == 0 || (word & HDR_COMMIT))
+        return false; // not reserved yet, or readable
+    uint64_t now = now_ns();
+    if (r->stall_ns == 0 || r->stall_at != cursor) {
+        // First sighting: its producer is most likely still filling it in
+        r->stall_at = cursor;
+        r->stall_ns = now;
+        return false;
+    }
+    pid_t owner = hdr_owner(word);
+    int saved = errno;
+    bool dead = owner > 0 && kill(owner, 0) != 0 && errno == ESRCH;
+    errno = saved;
+    if (!dead && (timeout_ms < 0 || now - r->stall_ns < (uint64_t)timeout_ms * 1000000u))
+        return false;
+    r->stall_ns = 0;
+    return atomic_compare_exchange_strong_explicit(&h->word, &word,
+                                                   HDR_COMMIT | HDR_PAD | (word & HDR_SIZE_MASK),
+                                                   memory_order_acq_rel, memory_order_acquire);
+}
+
+uint64_t po_logring_cursor(const po_logring_t *r) {
+    return atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+void po_logring_release(po_logring_t *r, uint64_t cursor) {
+    uint64_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    while (tail < cursor) {
+        uint64_t off = tail & (r->cap - 1);
+        uint64_t n = cursor - tail < r->cap - off ? cursor - tail : r->cap - off;
+        memset(r->data + off, 0, n);
+        tail += n;
+    }
+    atomic_store_explicit(&r->tail, cursor, memory_order_release);
+}
+
+bool po_logring_empty(const po_logring_t *r) {
+    uint64_t cursor = po_logring_cursor(r);
+    return po_logring_peek(r, &cursor, NULL) == NULL;
+}
+
+void po_logring_bell_ring(po_logring_bell_t *b) {
+    // Pairs with the fence in po_logring_bell_prepare()
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&b->sleepers, memory_order_relaxed) > 0 &&
+        !atomic_exchange_explicit(&b->wake_pending, 1, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&b->wake_seq, 1, memory_order_relaxed);
+        futex_wake(&b->wake_seq, INT_MAX);
+    }
+}
+
+uint32_t po_logring_bell_prepare(po_logring_bell_t *b) {
+    atomic_store_explicit(&b->wake_pending, 0, memory_order_relaxed);
+    uint32_t seq = atomic_load_explicit(&b->wake_seq, memory_order_relaxed);
+    atomic_fetch_add_explicit(&b->sleepers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    return seq;
+}
+
+void po_logring_bell_park(po_logring_bell_t *b, uint32_t seq, int timeout_ms) {
+    struct timespec ts = {.tv_sec = timeout_ms / 1000,
+                          .tv_nsec = (long)(timeout_ms % 1000) * 1000000L};
+    futex_wait(&b->wake_seq, seq, timeout_ms >= 0 ? &ts : NULL);
+    po_logring_bell_cancel(b);
+}
+
+void po_logring_bell_cancel(po_logring_bell_t *b) {
+    atomic_fetch_sub_explicit(&b->sleepers, 1, memory_order_relaxed);
+}
+
+void po_logring_bell_wake_all(po_logring_bell_t *b) {
+    atomic_fetch_add(&b->wake_seq, 1);
+    futex_wake(&b->wake_seq, INT_MAX);
+}
+
+void po_logring_wait(po_logring_t *r, int timeout_ms) {
+    for (unsigned i = 0; i < SPIN_POLLS; i++) {
+        if (!po_logring_empty(r))
+            return;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    uint32_t seq = po_logring_bell_prepare(&r->bell);
+    if (po_logring_empty(r))
+        po_logring_bell_park(&r->bell, seq, timeout_ms);
+    else
+        po_logring_bell_cancel(&r->bell);
+}
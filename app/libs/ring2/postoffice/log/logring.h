@@ -0,0 +1,185 @@
+/**
+ * @file logring.h
+ * @brief Variable-length record ring with reserve/commit semantics.
+ *
+ * One contiguous byte buffer. A producer reserves space for a record by
+ * advancing @c head with a CAS and at once writes the record's 8-byte
+ * header: its size, the ring lap and the producing process, marked reserved.
+ * That header value is the reservation's tag. The producer fills the record
+ * in place, then commits it by setting the commit bit in the header, but
+ * only if the header still holds its tag. The
+ * consumer reads headers in order from @c tail. It stops at the first
+ * uncommitted one, so records become visible in reservation order even
+ * though producers commit out of order. Released bytes are zeroed before
+ * @c tail moves past them. A header slot therefore reads as empty until a
+ * producer reserves it.
+ *
+ * A producer that dies between reserve and commit would hold back every
+ * later record. Since the reserved header already carries the size, the
+ * consumer can give such a reservation up with po_logring_reclaim() and
+ * skip it like padding. If the producer was only stalled, its late commit
+ * finds a different header (padding, zero, or a later lap's reservation)
+ * and does nothing. Its late payload writes are not fenced off, though:
+ * they can land in whatever record reuses those bytes.
+ *
+ * A record never wraps. When it would cross the end of the buffer, the same
+ * reservation also covers a padding record up to the end, which the consumer
+ * skips.
+ *
+ * Everything is addressed by offsets from the ring itself, with no pointers
+ * inside, so a ring can live in memory shared between processes. Waiting
+ * uses a shared futex. The wakeup state is a separate po_logring_bell_t. A
+ * consumer draining several rings can park on one bell of its own, and the
+ * producers ring that bell instead of the ring's.
+ */
+
+#ifndef PO_LOG_LOGRING_H
+#define PO_LOG_LOGRING_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PO_LOGRING_ALIGN 8u                  // record and payload alignment
+#define PO_LOGRING_HDR 8u                    // per-record header bytes
+#define PO_LOGRING_MIN 4096u                 // smallest data area
+#define PO_LOGRING_MAX (64u * 1024u * 1024u) // largest data area
+
+/** @brief Consumer wakeup state (sleeper count and futex word). */
+typedef struct po_logring_bell {
+    atomic_uint sleepers;     //!< Consumers parked or about to park.
+    atomic_uint wake_seq;     //!< Futex word bumped to wake them.
+    atomic_uint wake_pending; //!< A producer already bumped wake_seq.
+} po_logring_bell_t;
+
+/** @brief Ring control block, followed by @c cap data bytes. */
+typedef struct po_logring {
+    alignas(64) _Atomic uint64_t head; //!< Bytes reserved by producers (monotonic).
+    uint64_t tail_cache;               //!< Single-producer mode: last tail seen.
+    alignas(64) _Atomic uint64_t tail; //!< Bytes released by the consumer (monotonic).
+    uint64_t stall_at;                 //!< Consumer: position of an uncommitted record.
+    uint64_t stall_ns;                 //!< Consumer: when it was found there (0 = none).
+    alignas(64) po_logring_bell_t bell;
+    uint64_t cap; //!< Data bytes, a power of two.
+    alignas(64) unsigned char data[];
+} po_logring_t;
+
+/**
+ * @brief Bytes needed for a ring with @p cap data bytes.
+ * @note Thread-safe: Yes.
+ */
+size_t po_logring_footprint(size_t cap);
+
+/**
+ * @brief Initialize a ring in caller-provided, 64-byte aligned memory.
+ * @param[in] mem At least po_logring_footprint(@p cap) bytes; need not be zeroed.
+ * @param[in] cap Data bytes (a power of two, PO_LOGRING_MIN to PO_LOGRING_MAX).
+ * @return The ring (== @p mem), or NULL with errno=EINVAL.
+ */
+po_logring_t *po_logring_init(void *mem, size_t cap);
+
+/**
+ * @brief Reserve a record of @p len payload bytes.
+ * @param[out] tag The reservation's tag, to pass to po_logring_commit().
+ * @return Payload pointer (PO_LOGRING_ALIGN aligned), or NULL when the ring
+ *         lacks room (errno=EAGAIN) or @p len exceeds a quarter of the ring
+ *         (errno=EMSGSIZE). Every reservation must be committed.
+ * @note Thread-safe: Yes (any number of producers).
+ */
+void *po_logring_reserve(po_logring_t *r, size_t len, uint64_t *tag);
+
+/**
+ * @brief po_logring_reserve() for a ring with exactly one producer thread.
+ *
+ * No CAS, and the consumer's tail is re-read only when the cached copy says
+ * the ring may be full, so the producer touches no line the consumer writes.
+ * @note Thread-safe: One producer per ring (do not mix with po_logring_reserve()).
+ */
+void *po_logring_reserve_single(po_logring_t *r, size_t len, uint64_t *tag);
+
+/**
+ * @brief Publish a reserved record and wake a parked consumer if needed.
+ * @return false if the consumer gave the reservation up (see po_logring_publish()).
+ * @note Thread-safe: Yes.
+ */
+bool po_logring_commit(po_logring_t *r, void *payload, uint64_t tag);
+
+/**
+ * @brief Publish a reserved record without waking anyone; follow it with
+ *        po_logring_bell_ring() on whichever bell the consumer parks on.
+ * @param[in] tag What the reservation returned for @p payload.
+ * @return false, having changed nothing, if the consumer already gave the
+ *         reservation up (the record is lost).
+ * @note Thread-safe: Yes.
+ */
+bool po_logring_publish(po_logring_t *r, void *payload, uint64_t tag);
+
+/**
+ * @brief Next committed record at or after @p *cursor, without releasing it.
+ * @param[in,out] cursor Consumer position (start from po_logring_cursor());
+ *                       advanced past the record on success.
+ * @param[out] len Payload bytes (Nullable).
+ * @return Payload pointer, or NULL if the next record is not committed yet.
+ * @note Thread-safe: One consumer at a time.
+ */
+const void *po_logring_peek(const po_logring_t *r, uint64_t *cursor, size_t *len);
+
+/**
+ * @brief Give up an abandoned reservation at @p cursor (where peek stopped).
+ *
+ * A reservation counts as abandoned once an earlier call found it and its
+ * owner process has since exited. One whose owner is alive is only given up
+ * after it has stayed uncommitted for @p timeout_ms (< 0: never). It then
+ * reads as padding. A producer that was only stalled loses its record, and
+ * its payload writes may land in whatever reuses those bytes, so set
+ * @p timeout_ms far above any legitimate stall.
+ * @return true if the reservation was given up (peek again).
+ * @note Thread-safe: One consumer at a time.
+ */
+bool po_logring_reclaim(po_logring_t *r, uint64_t cursor, int timeout_ms);
+
+/** @brief Consumer start position (the current tail). */
+uint64_t po_logring_cursor(const po_logring_t *r);
+
+/**
+ * @brief Give back every byte before @p cursor to producers.
+ * @note Thread-safe: One consumer at a time.
+ */
+void po_logring_release(po_logring_t *r, uint64_t cursor);
+
+/** @brief True if no committed record is waiting at the tail. */
+bool po_logring_empty(const po_logring_t *r);
+
+/**
+ * @brief Park until a producer commits or @p timeout_ms passes.
+ * @return Immediately if a record is already waiting.
+ */
+void po_logring_wait(po_logring_t *r, int timeout_ms);
+
+/**
+ * @brief Wake the bell's parked consumers if any (after a publish).
+ * @note Thread-safe: Yes.
+ */
+void po_logring_bell_ring(po_logring_bell_t *b);
+
+/**
+ * @brief Announce that the caller is about to park on @p b.
+ *
+ * The caller must then re-check its rings and either park with
+ * po_logring_bell_park() or back out with po_logring_bell_cancel().
+ * @return Sequence number to pass to po_logring_bell_park().
+ */
+uint32_t po_logring_bell_prepare(po_logring_bell_t *b);
+
+/** @brief Sleep until rung or @p timeout_ms (< 0: forever) passes. */
+void po_logring_bell_park(po_logring_bell_t *b, uint32_t seq, int timeout_ms);
+
+/** @brief Undo po_logring_bell_prepare() without sleeping. */
+void po_logring_bell_cancel(po_logring_bell_t *b);
+
+/** @brief Wake every consumer parked on @p b (e.g. for shutdown). */
+void po_logring_bell_wake_all(po_logring_bell_t *b);
+
+#endif // PO_LOG_LOGRING_H
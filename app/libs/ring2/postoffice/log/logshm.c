@@ -0,0 +1,129 @@
+/**
+ * @file logshm.c
+ * @brief Shared-memory log ring (see logshm.h).
+ *
+ * Follows perf.c: shm_open + ftruncate + MAP_SHARED, a creator that zeroes
+ * and initializes the region, and attachers that poll a ready flag.
+ */
+
+#include "log/logshm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOGSHM_MAGIC 0x504f4c52u // "POLR"
+#define LOGSHM_VERSION 2u // 2: record headers name their owner; creator pid
+#define ATTACH_POLLS 1000 // 1 ms each
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t cap;
+    int32_t creator;   // the draining process
+    atomic_bool ready; // set last by the creator
+} shm_hdr_t;
+
+#define RING_OFFSET 64u
+
+_Static_assert(sizeof(shm_hdr_t) <= RING_OFFSET, "header fits before the ring");
+
+static size_t mapping_size(size_t cap) {
+    return RING_OFFSET + po_logring_footprint(cap);
+}
+
+int po_logshm_create(po_logshm_t *shm, const char *name, size_t cap) {
+    shm_unlink(name); // a crashed run's object; attached processes keep their mapping
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0)
+        return -1;
+    size_t size = mapping_size(cap);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = e;
+        return -1;
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the object
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+
+    shm_hdr_t *h = base;
+    po_logring_t *ring = po_logring_init((char *)base + RING_OFFSET, cap);
+    if (!ring) {
+        munmap(base, size);
+        shm_unlink(name);
+        errno = EINVAL;
+        return -1;
+    }
+    h->magic = LOGSHM_MAGIC;
+    h->version = LOGSHM_VERSION;
+    h->cap = cap;
+    h->creator = (int32_t)getpid();
+    atomic_store_explicit(&h->ready, true, memory_order_release);
+
+    *shm = (po_logshm_t){.base = base, .size = size, .ring = ring};
+    return 0;
+}
+
+int po_logshm_attach(po_logshm_t *shm, const char *name) {
+    int fd = shm_open(name, O_RDWR, 0666);
+    if (fd < 0)
+        return -1;
+
+    // The creator truncates before it maps, so wait for the full header
+    struct stat st;
+    int polls = 0;
+    while (fstat(fd, &st) == 0 && (size_t)st.st_size < RING_OFFSET && polls++ < ATTACH_POLLS)
+        usleep(1000);
+    if ((size_t)st.st_size < RING_OFFSET) {
+        close(fd);
+        errno = ETIMEDOUT;
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+
+    shm_hdr_t *h = base;
+    while (!atomic_load_explicit(&h->ready, memory_order_acquire) && polls++ < ATTACH_POLLS)
+        usleep(1000);
+    int err = 0;
+    if (!atomic_load_explicit(&h->ready, memory_order_acquire))
+        err = ETIMEDOUT;
+    else if (h->magic != LOGSHM_MAGIC || h->version != LOGSHM_VERSION ||
+             mapping_size(h->cap) != size)
+        err = EPROTO;
+    else if (kill(h->creator, 0) != 0 && errno == ESRCH)
+        err = EOWNERDEAD; // a crashed run's ring: nobody would ever drain it
+    if (err) {
+        munmap(base, size);
+        errno = err;
+        return -1;
+    }
+
+    *shm = (po_logshm_t){
+        .base = base, .size = size, .ring = (po_logring_t *)(void *)((char *)base + RING_OFFSET)};
+    return 0;
+}
+
+void po_logshm_close(po_logshm_t *shm, const char *name) {
+    if (shm->base)
+        munmap(shm->base, shm->size);
+    if (name)
+        shm_unlink(name);
+    *shm = (po_logshm_t){0};
+}
@@ -0,0 +1,57 @@
+/**
+ * @file logshm.h
+ * @brief A po_logring_t in a named POSIX shared memory object.
+ *
+ * One process creates the object and drains the ring; any number of other
+ * processes attach and reserve/commit into it. The creator is the only
+ * consumer and parks on the ring's own bell, which producers in every
+ * process ring through the shared futex.
+ *
+ * The mapping starts with a small header (magic, size, creator pid, ready
+ * flag), so an attacher can wait for the creator to finish initializing and
+ * can reject a stale object of a different layout, or one left behind by a
+ * creator that crashed. The ring follows at the next cache line.
+ */
+
+#ifndef PO_LOG_LOGSHM_H
+#define PO_LOG_LOGSHM_H
+
+#include <stddef.h>
+
+#include "log/logring.h"
+
+/** @brief A mapped shared log ring (process-local handle). */
+typedef struct po_logshm {
+    void *base;         //!< Mapping (header + ring).
+    size_t size;        //!< Mapping bytes.
+    po_logring_t *ring; //!< The ring inside the mapping.
+} po_logshm_t;
+
+/**
+ * @brief Create (or replace a stale) shared object @p name holding a ring of
+ *        @p cap data bytes, and map it.
+ * @param[out] shm Handle to fill.
+ * @param[in] name shm_open() name ("/...").
+ * @param[in] cap Data bytes (a power of two, at least PO_LOGRING_MIN).
+ * @return 0 on success, -1 with errno set.
+ * @note Thread-safe: No.
+ */
+int po_logshm_create(po_logshm_t *shm, const char *name, size_t cap);
+
+/**
+ * @brief Map an existing shared ring, waiting up to 1 s for its creator.
+ * @return 0 on success, -1 with errno set (ENOENT: no such object,
+ *         ETIMEDOUT: creator never finished, EPROTO: unknown layout,
+ *         EOWNERDEAD: its creator has exited without unlinking it).
+ * @note Thread-safe: No.
+ */
+int po_logshm_attach(po_logshm_t *shm, const char *name);
+
+/**
+ * @brief Unmap the ring; the creator also passes @p name to unlink it.
+ * @param[in] name Object to unlink (Nullable: keep it).
+ * @note Thread-safe: No.
+ */
+void po_logshm_close(po_logshm_t *shm, const char *name);
+
+#endif // PO_LOG_LOGSHM_H
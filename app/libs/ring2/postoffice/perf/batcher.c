@@ -2,6 +2,7 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -14,13 +15,37 @@
 #include "perf/ringbuf.h"
 #include "metrics/metrics.h"
 
+// Adaptive spin budget (ring polls) before a consumer parks
+#define BATCHER_SPIN_MIN 16u
+#define BATCHER_SPIN_MAX 4096u
+
+/*
+ * Wakeup protocol: a consumer that finds the ring empty announces itself in
+ * `sleepers`, re-checks the ring, then blocks on the eventfd. A producer only
+ * writes the eventfd when it can claim (decrement) an announced sleeper, so
+ * while consumers are busy draining, enqueue is a ring push plus one fence
+ * and a load. The seq_cst fences on both sides guarantee that either the
+ * producer sees the announcement or the consumer's re-check sees the item.
+ */
 struct perf_batcher {
     po_perf_ringbuf_t *rb;
     int efd;
     size_t batch_size;
     perf_batcher_flags_t flags;
+    atomic_uint sleepers;             // Announced and not yet claimed by a producer
+    atomic_uint spin_limit;
+    atomic_uint_fast64_t signals;     // eventfd writes
+    atomic_uint_fast64_t parks;       // eventfd reads
 };
 
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
 po_perf_batcher_t *perf_batcher_create(po_perf_ringbuf_t *rb, size_t batch_size, perf_batcher_flags_t flags) {
     if (batch_size == 0) {
         errno = EINVAL;
@@ -34,6 +59,10 @@ po_perf_batcher_t *perf_batcher_create(po_perf_ringbuf_t *rb, size_t batch_size,
     b->rb = rb;
     b->batch_size = batch_size;
     b->flags = flags;
+    atomic_init(&b->sleepers, 0);
+    atomic_init(&b->spin_limit, BATCHER_SPIN_MIN);
+    atomic_init(&b->signals, 0);
+    atomic_init(&b->parks, 0);
 
     // Create an eventfd for producer->consumer signaling
     b->efd = eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE);
@@ -49,6 +78,8 @@ po_perf_batcher_t *perf_batcher_create(po_perf_ringbuf_t *rb, size_t batch_size,
         PO_METRIC_COUNTER_CREATE("batcher.full");
         PO_METRIC_COUNTER_CREATE("batcher.flush");
         PO_METRIC_COUNTER_CREATE("batcher.next");
+        PO_METRIC_COUNTER_CREATE("batcher.signal");
+        PO_METRIC_COUNTER_CREATE("batcher.park");
     }
 
     return b;
@@ -88,23 +119,39 @@ int perf_batcher_enqueue(po_perf_batcher_t *restrict b, void *restrict item) {
         return -1;
     }
 
-    // Signal consumer: increment counter by 1
-    uint64_t inc = 1;
-    ssize_t ret;
-    do {
-        ret = write(b->efd, &inc, sizeof(inc));
-    } while (ret < 0 && errno == EINTR);
-
-    if (ret != sizeof(inc)) {
-        // if this fails, we consider it an internal error but item is enqueued
-        // return 0 to avoid double-free by caller
-        errno = EIO;
-        return 0;
-    }
-
     if (b->flags & PERF_BATCHER_METRICS)
         PO_METRIC_COUNTER_INC("batcher.enqueue");
 
+    // Pairs with the fence in perf_batcher_next(): we see its announcement or
+    // it sees our item.
+    atomic_thread_fence(memory_order_seq_cst);
+    unsigned int sleepers = atomic_load_explicit(&b->sleepers, memory_order_relaxed);
+    while (sleepers > 0) {
+        if (!atomic_compare_exchange_weak_explicit(&b->sleepers, &sleepers, sleepers - 1,
+                                                   memory_order_relaxed, memory_order_relaxed))
+            continue;
+
+        // Claimed one parked consumer: it now waits for exactly one token
+        uint64_t inc = 1;
+        ssize_t ret;
+        do {
+            ret = write(b->efd, &inc, sizeof(inc));
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret != sizeof(inc)) {
+            // Hand the claim back so a later producer retries the wakeup. The
+            // item is enqueued: return 0 to avoid double-free by caller.
+            atomic_fetch_add(&b->sleepers, 1);
+            errno = EIO;
+            return 0;
+        }
+
+        atomic_fetch_add_explicit(&b->signals, 1, memory_order_relaxed);
+        if (b->flags & PERF_BATCHER_METRICS)
+            PO_METRIC_COUNTER_INC("batcher.signal");
+        break;
+    }
+
     return 0;
 }
 
@@ -163,25 +210,88 @@ int perf_batcher_flush(po_perf_batcher_t *b, int fd) {
     return 0;
 }
 
+size_t perf_batcher_drain(po_perf_batcher_t *restrict b, void **restrict out) {
+    if (b->rb == NULL)
+        return 0;
+    return perf_ringbuf_dequeue_batch(b->rb, out, b->batch_size);
+}
+
+/**
+ * @brief Poll the ring for a while before parking.
+ *
+ * The budget doubles when polling finds work and halves when the consumer
+ * parks anyway, so an idle consumer converges to a short spin and a busy one
+ * rarely touches the eventfd.
+ */
+static bool spin_for_item(po_perf_batcher_t *b) {
+    unsigned int limit = atomic_load_explicit(&b->spin_limit, memory_order_relaxed);
+    for (unsigned int i = 0; i < limit; i++) {
+        if (perf_ringbuf_count(b->rb) > 0) {
+            if (limit < BATCHER_SPIN_MAX)
+                atomic_store_explicit(&b->spin_limit, limit * 2, memory_order_relaxed);
+            return true;
+        }
+        cpu_relax();
+    }
+    if (limit > BATCHER_SPIN_MIN)
+        atomic_store_explicit(&b->spin_limit, limit / 2, memory_order_relaxed);
+    return false;
+}
+
+// Block until a producer hands us a wakeup token.
+static int park(po_perf_batcher_t *b) {
+    uint64_t cnt;
+    ssize_t ret;
+    do {
+        ret = read(b->efd, &cnt, sizeof(cnt));
+    } while (ret < 0 && errno == EINTR);
+    if (ret != sizeof(cnt))
+        return -1; // efd closed or error
+
+    atomic_fetch_add_explicit(&b->parks, 1, memory_order_relaxed);
+    if (b->flags & PERF_BATCHER_METRICS)
+        PO_METRIC_COUNTER_INC("batcher.park");
+    return 0;
+}
+
 ssize_t perf_batcher_next(po_perf_batcher_t *restrict b, void **restrict out) {
     if (b->rb == NULL || b->efd < 0) {
         errno = EINVAL;
         return -1;
     }
 
-    // Block until at least one event arrives
-    uint64_t cnt;
-    if (read(b->efd, &cnt, sizeof(cnt)) != sizeof(cnt))
-        return -1; // efd closed or error
-
-    // Now drain up to batch_size items
-    size_t n = 0;
-    for (; n < b->batch_size; n++) {
-        void *item;
-        if (perf_ringbuf_dequeue(b->rb, &item) < 0)
-            break; // empty
+    size_t n;
+    for (;;) {
+        n = perf_batcher_drain(b, out);
+        if (n > 0)
+            break;
+        if (spin_for_item(b))
+            continue;
+
+        atomic_fetch_add(&b->sleepers, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        n = perf_batcher_drain(b, out);
+        if (n > 0) {
+            // Withdraw the announcement; if a producer already claimed it, its
+            // token is on the way and must be consumed to keep counts paired.
+            unsigned int s = atomic_load_explicit(&b->sleepers, memory_order_relaxed);
+            bool withdrawn = false;
+            while (s > 0 && !(withdrawn = atomic_compare_exchange_weak_explicit(
+                                  &b->sleepers, &s, s - 1, memory_order_relaxed,
+                                  memory_order_relaxed))) {
+            }
+            if (!withdrawn && park(b) < 0)
+                return -1;
+            break;
+        }
 
-        out[n] = item;
+        if (park(b) < 0)
+            return -1;
+        // Woken: may legitimately come back empty (another consumer got there
+        // first, or a shutdown sentinel went to someone else).
+        n = perf_batcher_drain(b, out);
+        break;
     }
 
     if (b->flags & PERF_BATCHER_METRICS) {
@@ -193,6 +303,11 @@ ssize_t perf_batcher_next(po_perf_batcher_t *restrict b, void **restrict out) {
     return (ssize_t)n;
 }
 
+void perf_batcher_get_stats(const po_perf_batcher_t *b, perf_batcher_stats_t *out) {
+    out->signals = atomic_load_explicit(&b->signals, memory_order_relaxed);
+    out->parks = atomic_load_explicit(&b->parks, memory_order_relaxed);
+}
+
 bool perf_batcher_is_empty(const po_perf_batcher_t *b) {
     if (!b->rb)
         return true;
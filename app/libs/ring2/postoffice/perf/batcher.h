@@ -6,19 +6,16 @@
  *        internal eventfd.
  *
  * The batcher pairs a lightweight pointer ring (see @ref perf/ringbuf.h) with
- * an `eventfd(2)` used purely as a wake / counting semaphore from producer to
- * consumer. Each successful enqueue increments the eventfd counter by 1; the
- * consumer thread blocks inside ::perf_batcher_next() performing a blocking
- * `read(2)` on that eventfd until at least one item is available, after which
- * it drains up to the configured @c batch_size items from the underlying ring
- * in a single call.
+ * an `eventfd(2)` used purely as a wake semaphore from producer to consumer.
+ * A consumer in ::perf_batcher_next() drains up to @c batch_size items in one
+ * claim; when the ring is empty it polls briefly, then announces that it is
+ * parking and blocks in `read(2)` on the eventfd. Producers write the eventfd
+ * only when they can claim such an announcement, so a consumer that keeps up
+ * costs producers no syscalls at all.
  *
  * Threading model:
- *  - Intended for exactly one producer thread calling ::perf_batcher_enqueue()
- *    and one consumer thread calling ::perf_batcher_next().
- *  - The underlying ring buffer is single-producer / single-consumer (SPSC);
- *    using multiple producers or multiple consumers requires external
- *    synchronization (e.g. a mutex) around enqueue / next calls.
+ *  - Any number of producers and consumers (the ring is MPMC); each wakeup
+ *    token releases exactly one parked consumer.
  *
  * Ownership / lifetime:
  *  - The caller allocates / owns the ring buffer and passes a pointer to
@@ -32,16 +29,18 @@
  *    signaling failure sets @c errno = EIO; on misuse (destroyed / NULL members)
  *    sets @c errno = EINVAL.
  *  - ::perf_batcher_next(): returns -1 with @c errno if the eventfd read fails
- *    (EBADF if already closed, EINTR if interrupted, etc.). Partial draining
- *    is normal – it returns the number of items actually dequeued (>=1).
+ *    (EBADF if already closed, etc.; EINTR is retried). Partial draining is
+ *    normal – it returns the number of items actually dequeued, which is 0
+ *    when a wakeup found the ring already emptied by another consumer.
  *  - ::perf_batcher_flush(): returns -1 on write / argument errors; see the
  *    detailed notes in its documentation (it is not a full drain guarantee).
  *
  * Performance notes:
- *  - Enqueue is O(1) with a single atomic / index manipulation + an eventfd
- *    write (8 bytes) per item.
- *  - Consumer amortizes the cost of the blocking wake across up to
- *    @c batch_size dequeued items.
+ *  - Enqueue is O(1): a ring push, a fence and a load; the eventfd write
+ *    happens only when a consumer is parked.
+ *  - The consumer reads the eventfd only when it actually parks and takes
+ *    up to @c batch_size items per ring claim.
+ *  - ::perf_batcher_get_stats() reports both syscall counts.
  *
  * @see perf/ringbuf.h
  */
@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -20,15 +21,30 @@
 #include <postoffice/perf/cache.h>
 #include <postoffice/hashtable/hashtable.h>
 
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
 // -----------------------------------------------------------------------------
 // Constants & Configuration
 // -----------------------------------------------------------------------------
 #define SHM_NAME "/postoffice_metrics_shm"
-#define MAX_METRIC_NAME 64
+#define MAX_METRIC_NAME PO_PERF_METRIC_NAME_MAX
 #define MAX_COUNTERS 2048
+#define MAX_SHARDED_COUNTERS 64
+#define MAX_COUNTER_SHARDS 256 // CPUs beyond this wrap around (still correct, just shared)
 #define MAX_TIMERS 512
 #define MAX_HISTOGRAMS 128
 #define MAX_HIST_BINS 32
+#define MAX_HDR_HISTOGRAMS 64 // Every timer takes one for its latency distribution
+
+// Log-linear layout: values below HDR_SUB_COUNT get exact buckets, every power
+// of two above is split into HDR_SUB_COUNT linear sub-buckets (<= 1/32 = 3.1%
+// relative error) up to UINT64_MAX.
+#define HDR_SUB_BITS 5
+#define HDR_SUB_COUNT (1u << HDR_SUB_BITS)
+#define HDR_BUCKETS ((64 - HDR_SUB_BITS + 1) * HDR_SUB_COUNT)
 
 // -----------------------------------------------------------------------------
 // Shared Memory Structures
@@ -36,27 +52,40 @@
 
 typedef struct {
     char name[MAX_METRIC_NAME];
-    char _pad1[PO_CACHE_LINE_MAX - (MAX_METRIC_NAME % PO_CACHE_LINE_MAX)];
+    atomic_uint shard; // 0: plain counter, n: uses shm->shards[n - 1] (read-mostly)
+    char _pad1[PO_CACHE_LINE_MAX - (MAX_METRIC_NAME % PO_CACHE_LINE_MAX) - sizeof(atomic_uint)];
 
-    atomic_uint_fast64_t value;
+    atomic_uint_fast64_t value; // Plain counters; sharded ones keep pre-sharding increments here
     char _pad2[PO_CACHE_LINE_MAX - sizeof(atomic_uint_fast64_t)];
 } shm_counter_t __attribute__((aligned(PO_CACHE_LINE_MAX)));
 
+// One cache line per CPU so increments from different cores never share a line
+typedef struct {
+    atomic_uint_fast64_t value;
+    char _pad[PO_CACHE_LINE_MAX - sizeof(atomic_uint_fast64_t)];
+} shm_counter_shard_t __attribute__((aligned(PO_CACHE_LINE_MAX)));
+
+typedef struct {
+    shm_counter_shard_t cpu[MAX_COUNTER_SHARDS];
+} shm_sharded_counter_t;
+
 typedef struct {
     char name[MAX_METRIC_NAME];
     char _pad1[PO_CACHE_LINE_MAX - (MAX_METRIC_NAME % PO_CACHE_LINE_MAX)];
 
-    struct timespec start; // "Last start" timestamp (caveat: thread-safety on start is caller responsibility)
-    char _pad2[PO_CACHE_LINE_MAX - sizeof(struct timespec)];
-
+    // Start stamps live on the caller's stack or in thread-local storage,
+    // never here, so concurrent scopes of one timer cannot clobber each other.
     atomic_uint_fast64_t total_ns;
-    char _pad3[PO_CACHE_LINE_MAX - sizeof(atomic_uint_fast64_t)];
+    atomic_uint_fast64_t count;
+    atomic_uint hist; // 0: none, n: latency distribution in shm->histograms[n - 1]
+    char _pad2[PO_CACHE_LINE_MAX - 2 * sizeof(atomic_uint_fast64_t) - sizeof(atomic_uint)];
 } shm_timer_t __attribute__((aligned(PO_CACHE_LINE_MAX)));
 
 typedef struct {
     char name[MAX_METRIC_NAME];
-    char _pad1[PO_CACHE_LINE_MAX - (MAX_METRIC_NAME % PO_CACHE_LINE_MAX)];
-    
+    atomic_uint hdr; // 0: threshold bins below, n: log-linear in shm->hdr_histograms[n - 1]
+    char _pad1[PO_CACHE_LINE_MAX - (MAX_METRIC_NAME % PO_CACHE_LINE_MAX) - sizeof(atomic_uint)];
+
     size_t nbins;
     uint64_t bins[MAX_HIST_BINS];
     atomic_uint_fast64_t counts[MAX_HIST_BINS];
@@ -67,6 +96,16 @@ typedef struct {
                  sizeof(atomic_uint_fast64_t) * MAX_HIST_BINS) % PO_CACHE_LINE_MAX)];
 } shm_histogram_t __attribute__((aligned(PO_CACHE_LINE_MAX)));
 
+typedef struct {
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t min; // UINT64_MAX until the first record
+    atomic_uint_fast64_t max;
+    char _pad[PO_CACHE_LINE_MAX - 4 * sizeof(atomic_uint_fast64_t)];
+
+    atomic_uint_fast64_t buckets[HDR_BUCKETS];
+} shm_hdr_histogram_t __attribute__((aligned(PO_CACHE_LINE_MAX)));
+
 typedef struct {
     pthread_mutex_t lock; // Protects allocation/registration
     bool initialized;     // True if the creator has finished initializing
@@ -79,6 +118,12 @@ typedef struct {
 
     atomic_size_t num_histograms;
     shm_histogram_t histograms[MAX_HISTOGRAMS];
+
+    atomic_size_t num_sharded;
+    shm_sharded_counter_t shards[MAX_SHARDED_COUNTERS];
+
+    atomic_size_t num_hdr_histograms;
+    shm_hdr_histogram_t hdr_histograms[MAX_HDR_HISTOGRAMS];
 } perf_shm_t;
 
 // -----------------------------------------------------------------------------
@@ -148,6 +193,68 @@ static struct {
 // Internal Helpers
 // -----------------------------------------------------------------------------
 
+// Start stamps of PO_METRIC_TIMER_START/STOP pairs, one per timer per thread
+static __thread uint64_t tls_timer_start[MAX_TIMERS];
+
+static int histogram_alloc(const char *name, const uint64_t *bins, size_t nbins);
+static int find_histogram_index(const char *name);
+
+// -----------------------------------------------------------------------------
+// Clock
+// -----------------------------------------------------------------------------
+
+#define PERF_TSC_CALIBRATION_NS 2000000ULL
+
+// Timers read the clock twice per scope. With an invariant TSC (constant
+// rate, synchronized across cores) that is a rdtsc scaled by a multiplier
+// calibrated once per process against CLOCK_MONOTONIC; otherwise the vDSO
+// CLOCK_MONOTONIC. CLOCK_MONOTONIC_COARSE is cheaper still, but its 1-4 ms
+// tick would round most timed scopes down to zero.
+static struct {
+    pthread_once_t once;
+    bool use_tsc;
+    uint64_t tsc_mult; // ns per cycle, 32.32 fixed point
+} clk = {.once = PTHREAD_ONCE_INIT};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void clock_calibrate(void) {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+        return; // No invariant TSC
+
+    uint64_t ns0 = monotonic_ns();
+    uint64_t tsc0 = __rdtsc();
+    uint64_t ns1;
+    do {
+        ns1 = monotonic_ns();
+    } while (ns1 - ns0 < PERF_TSC_CALIBRATION_NS);
+    uint64_t tsc1 = __rdtsc();
+
+    if (tsc1 > tsc0) {
+        clk.tsc_mult = (uint64_t)(((unsigned __int128)(ns1 - ns0) << 32) / (tsc1 - tsc0));
+        clk.use_tsc = clk.tsc_mult != 0;
+    }
+#endif
+}
+
+static inline uint64_t clock_ns(void) {
+#if defined(__x86_64__)
+    if (clk.use_tsc)
+        return (uint64_t)(((unsigned __int128)__rdtsc() * clk.tsc_mult) >> 32);
+#endif
+    return monotonic_ns();
+}
+
+uint64_t po_perf_now_ns(void) {
+    return clock_ns();
+}
+
 /**
  * @brief Find existing counter index or allocate new one.
  *
@@ -273,6 +380,8 @@ static int find_or_alloc_timer(const char *name) {
     strncpy(t->name, name, MAX_METRIC_NAME - 1);
     t->name[MAX_METRIC_NAME - 1] = '\0';
     atomic_init(&t->total_ns, 0);
+    atomic_init(&t->count, 0);
+    atomic_init(&t->hist, 0);
 
     // Store in hash table
     po_hashtable_put(ctx.timer_map, t->name, (void *)(intptr_t)(count + 1));
@@ -280,6 +389,14 @@ static int find_or_alloc_timer(const char *name) {
     atomic_store(&ctx.shm->num_timers, count + 1);
     pthread_mutex_unlock(&ctx.shm->lock);
     pthread_rwlock_unlock(&ctx.hash_rwlock);
+
+    // Latency distribution under the same name; best effort, the timer keeps
+    // total and count if the log-linear slots are exhausted.
+    if (histogram_alloc(t->name, NULL, 0) == 0 || errno == EEXIST) {
+        int h = find_histogram_index(t->name);
+        if (h >= 0 && atomic_load(&ctx.shm->histograms[h].hdr))
+            atomic_store(&t->hist, (unsigned int)h + 1);
+    }
     return (int)count;
 }
 
@@ -325,53 +442,149 @@ int po_perf_histogram_lookup(const char *name) {
 // Internal Fast-Path Functions (operate on indices, no lookup)
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Add to a counter, on the calling CPU's slot if the counter is sharded.
+ *
+ * sched_getcpu() is served from the rseq area on recent glibc, so it costs a
+ * load. A thread migrating between the lookup and the add only lands on
+ * another CPU's line, which the atomic add keeps correct.
+ */
+static inline void counter_add(shm_counter_t *c, uint64_t delta) {
+    unsigned int shard = atomic_load_explicit(&c->shard, memory_order_relaxed);
+    if (shard) {
+        int cpu = sched_getcpu();
+        size_t slot = cpu > 0 ? (size_t)cpu % MAX_COUNTER_SHARDS : 0;
+        atomic_fetch_add_explicit(&ctx.shm->shards[shard - 1].cpu[slot].value, delta,
+                                  memory_order_relaxed);
+    } else {
+        atomic_fetch_add(&c->value, delta);
+    }
+}
+
+/**
+ * @brief Current total of a counter (sums the per-CPU slots of sharded ones).
+ */
+static uint64_t counter_total(const shm_counter_t *c) {
+    uint64_t total = atomic_load(&c->value);
+    unsigned int shard = atomic_load(&c->shard);
+    if (shard) {
+        const shm_sharded_counter_t *sc = &ctx.shm->shards[shard - 1];
+        for (size_t i = 0; i < MAX_COUNTER_SHARDS; i++)
+            total += atomic_load_explicit(&sc->cpu[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
 void po_perf_counter_inc_by_idx(int idx) {
     if (idx >= 0 && ctx.shm) {
-        atomic_fetch_add(&ctx.shm->counters[idx].value, 1);
+        counter_add(&ctx.shm->counters[idx], 1);
     }
 }
 
 void po_perf_counter_add_by_idx(int idx, uint64_t delta) {
     if (idx >= 0 && ctx.shm) {
-        atomic_fetch_add(&ctx.shm->counters[idx].value, delta);
+        counter_add(&ctx.shm->counters[idx], delta);
     }
 }
 
-// Define clock ID if not available (for inline functions)
-#ifndef CLOCK_MONOTONIC_COARSE
-    #define CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC
-#endif
+/**
+ * @brief Log-linear bucket of a value: O(1), one clz and a shift.
+ */
+static inline size_t hdr_bucket(uint64_t value) {
+    if (value < HDR_SUB_COUNT) return (size_t)value;
+    unsigned int shift = 63u - (unsigned int)__builtin_clzll(value) - HDR_SUB_BITS;
+    return (size_t)(shift + 1) * HDR_SUB_COUNT + (size_t)((value >> shift) & (HDR_SUB_COUNT - 1));
+}
 
-void po_perf_timer_start_by_idx(int idx) {
-    if (idx >= 0 && ctx.shm) {
-        clock_gettime(CLOCK_MONOTONIC, &ctx.shm->timers[idx].start);
+/**
+ * @brief Largest value that falls into bucket @p b.
+ */
+static uint64_t hdr_bucket_upper(size_t b) {
+    if (b < HDR_SUB_COUNT) return (uint64_t)b;
+    unsigned int shift = (unsigned int)(b / HDR_SUB_COUNT) - 1;
+    uint64_t lower = (uint64_t)(HDR_SUB_COUNT + b % HDR_SUB_COUNT) << shift;
+    return lower + ((UINT64_C(1) << shift) - 1);
+}
+
+static void hdr_record(shm_hdr_histogram_t *h, uint64_t value) {
+    atomic_fetch_add_explicit(&h->buckets[hdr_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+
+    uint64_t cur = atomic_load_explicit(&h->min, memory_order_relaxed);
+    while (value < cur &&
+           !atomic_compare_exchange_weak_explicit(&h->min, &cur, value, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+    cur = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > cur &&
+           !atomic_compare_exchange_weak_explicit(&h->max, &cur, value, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
     }
 }
 
-void po_perf_timer_stop_by_idx(int idx) {
-    if (idx >= 0 && ctx.shm) {
-        struct timespec end;
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        struct timespec start = ctx.shm->timers[idx].start;
-        uint64_t diff = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL +
-                        (uint64_t)(end.tv_nsec - start.tv_nsec);
-        atomic_fetch_add(&ctx.shm->timers[idx].total_ns, diff);
+/**
+ * @brief Record into a histogram of either kind. Values above the last
+ *        threshold of a binned histogram are counted in its last bin.
+ */
+static void histogram_record(shm_histogram_t *h, uint64_t value) {
+    unsigned int hdr = atomic_load_explicit(&h->hdr, memory_order_relaxed);
+    if (hdr) {
+        hdr_record(&ctx.shm->hdr_histograms[hdr - 1], value);
+        return;
+    }
+    for (size_t i = 0; i < h->nbins; i++) {
+        if (value <= h->bins[i]) {
+            atomic_fetch_add(&h->counts[i], 1);
+            return;
+        }
     }
+    atomic_fetch_add(&h->counts[h->nbins - 1], 1);
 }
 
 void po_perf_histogram_record_by_idx(int idx, uint64_t value) {
     if (idx >= 0 && ctx.shm) {
-        shm_histogram_t *h = &ctx.shm->histograms[idx];
-        for (size_t i = 0; i < h->nbins; i++) {
-            if (value <= h->bins[i]) {
-                atomic_fetch_add(&h->counts[i], 1);
-                return;
-            }
-        }
-        atomic_fetch_add(&h->counts[h->nbins], 1);
+        histogram_record(&ctx.shm->histograms[idx], value);
     }
 }
 
+void po_perf_timer_record_by_idx(int idx, uint64_t elapsed_ns) {
+    if (idx < 0 || idx >= MAX_TIMERS || !ctx.shm) return;
+
+    shm_timer_t *t = &ctx.shm->timers[idx];
+    atomic_fetch_add_explicit(&t->total_ns, elapsed_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->count, 1, memory_order_relaxed);
+    unsigned int hist = atomic_load_explicit(&t->hist, memory_order_relaxed);
+    if (hist) histogram_record(&ctx.shm->histograms[hist - 1], elapsed_ns);
+}
+
+void po_perf_timer_start_by_idx(int idx) {
+    if (idx >= 0 && idx < MAX_TIMERS) {
+        tls_timer_start[idx] = clock_ns();
+    }
+}
+
+void po_perf_timer_stop_by_idx(int idx) {
+    if (idx < 0 || idx >= MAX_TIMERS) return;
+
+    uint64_t start = tls_timer_start[idx];
+    if (start == 0) return; // Stop without a start on this thread
+    tls_timer_start[idx] = 0;
+
+    uint64_t now = clock_ns();
+    po_perf_timer_record_by_idx(idx, now > start ? now - start : 0);
+}
+
+po_perf_timer_scope_t po_perf_timer_begin_by_idx(int idx) {
+    return (po_perf_timer_scope_t){.idx = idx, .start_ns = idx >= 0 ? clock_ns() : 0};
+}
+
+void po_perf_timer_end(const po_perf_timer_scope_t *scope) {
+    if (!scope || scope->idx < 0) return;
+    uint64_t now = clock_ns();
+    po_perf_timer_record_by_idx(scope->idx, now > scope->start_ns ? now - scope->start_ns : 0);
+}
+
 // -----------------------------------------------------------------------------
 // Public Initialization
 // -----------------------------------------------------------------------------
@@ -383,6 +596,8 @@ int po_perf_init(size_t expected_counters, size_t expected_timers, size_t expect
 
     if (ctx.is_initialized) return 0; // Already initialized in this process
 
+    pthread_once(&clk.once, clock_calibrate);
+
     // Open with create permission (always)
     ctx.shm_fd = shm_open(SHM_NAME, O_RDWR | O_CREAT, 0666);
     if (ctx.shm_fd < 0) {
@@ -434,6 +649,8 @@ int po_perf_init(size_t expected_counters, size_t expected_timers, size_t expect
         atomic_init(&ctx.shm->num_counters, 0);
         atomic_init(&ctx.shm->num_timers, 0);
         atomic_init(&ctx.shm->num_histograms, 0);
+        atomic_init(&ctx.shm->num_sharded, 0);
+        atomic_init(&ctx.shm->num_hdr_histograms, 0);
 
         // Mark as initialized so attachers can proceed
         ctx.shm->initialized = true; 
@@ -525,11 +742,35 @@ int po_perf_counter_create(const char *name) {
     return find_or_alloc_counter(name) >= 0 ? 0 : -1;
 }
 
+int po_perf_counter_create_sharded(const char *name) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+    if (strlen(name) >= MAX_METRIC_NAME) { errno = EINVAL; return -1; }
+
+    int idx = find_or_alloc_counter(name);
+    if (idx < 0) return -1;
+
+    shm_counter_t *c = &ctx.shm->counters[idx];
+    pthread_mutex_lock(&ctx.shm->lock);
+    if (atomic_load(&c->shard) == 0) {
+        size_t n = atomic_load(&ctx.shm->num_sharded);
+        if (n >= MAX_SHARDED_COUNTERS) {
+            pthread_mutex_unlock(&ctx.shm->lock);
+            errno = ENOMEM;
+            return -1;
+        }
+        // Slots are zero from creation; publishing the index switches writers over
+        atomic_store(&ctx.shm->num_sharded, n + 1);
+        atomic_store(&c->shard, (unsigned int)n + 1);
+    }
+    pthread_mutex_unlock(&ctx.shm->lock);
+    return 0;
+}
+
 void po_perf_counter_inc(const char *name) {
     if (!ctx.is_initialized) return;
     int idx = find_or_alloc_counter(name);
     if (idx >= 0) {
-        atomic_fetch_add(&ctx.shm->counters[idx].value, 1);
+        counter_add(&ctx.shm->counters[idx], 1);
     }
 }
 
@@ -537,10 +778,39 @@ void po_perf_counter_add(const char *name, uint64_t delta) {
     if (!ctx.is_initialized) return;
     int idx = find_or_alloc_counter(name);
     if (idx >= 0) {
-        atomic_fetch_add(&ctx.shm->counters[idx].value, delta);
+        counter_add(&ctx.shm->counters[idx], delta);
     }
 }
 
+int po_perf_counter_value(const char *name, uint64_t *out) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+
+    size_t count = atomic_load(&ctx.shm->num_counters);
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(ctx.shm->counters[i].name, name, MAX_METRIC_NAME) == 0) {
+            *out = counter_total(&ctx.shm->counters[i]);
+            return 0;
+        }
+    }
+    errno = ENOENT;
+    return -1;
+}
+
+size_t po_perf_counter_snapshot(po_perf_counter_sample_t *out, size_t max) {
+    if (!ctx.is_initialized || !out) return 0;
+
+    size_t count = atomic_load(&ctx.shm->num_counters);
+    if (count > max) count = max;
+    for (size_t i = 0; i < count; i++) {
+        const shm_counter_t *c = &ctx.shm->counters[i];
+        memcpy(out[i].name, c->name, MAX_METRIC_NAME);
+        out[i].name[MAX_METRIC_NAME - 1] = '\0';
+        out[i].value = counter_total(c);
+        out[i].sharded = atomic_load(&c->shard) != 0;
+    }
+    return count;
+}
+
 int po_perf_timer_create(const char *name) {
     if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
     if (strlen(name) >= MAX_METRIC_NAME) { errno = EINVAL; return -1; }
@@ -548,18 +818,12 @@ int po_perf_timer_create(const char *name) {
 }
 
 
-// Define clock ID if not available
-#ifndef CLOCK_MONOTONIC
-    #define CLOCK_MONOTONIC 1
-#endif
-
 int po_perf_timer_start(const char *name) {
     if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
     int idx = find_or_alloc_timer(name);
     if (idx < 0) return -1;
 
-    // Use HIGH RES clock for precision as requested
-    clock_gettime(CLOCK_MONOTONIC, &ctx.shm->timers[idx].start);
+    po_perf_timer_start_by_idx(idx);
     return 0;
 }
 
@@ -568,23 +832,31 @@ int po_perf_timer_stop(const char *name) {
     int idx = find_or_alloc_timer(name);
     if (idx < 0) return -1;
 
-    struct timespec end;
-    clock_gettime(CLOCK_MONOTONIC, &end);
-
-    struct timespec start = ctx.shm->timers[idx].start;
-    uint64_t diff = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL +
-                    (uint64_t)(end.tv_nsec - start.tv_nsec);
-
-    atomic_fetch_add(&ctx.shm->timers[idx].total_ns, diff);
+    po_perf_timer_stop_by_idx(idx);
     return 0;
 }
 
-
-int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbins) {
+int po_perf_timer_value(const char *name, uint64_t *total_ns, uint64_t *count) {
     if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
-    if (nbins > MAX_HIST_BINS || nbins == 0) { errno = EINVAL; return -1; }
-    if (strlen(name) >= MAX_METRIC_NAME) { errno = EINVAL; return -1; }
 
+    size_t n = atomic_load(&ctx.shm->num_timers);
+    for (size_t i = 0; i < n; i++) {
+        const shm_timer_t *t = &ctx.shm->timers[i];
+        if (strncmp(t->name, name, MAX_METRIC_NAME) == 0) {
+            *total_ns = atomic_load(&t->total_ns);
+            *count = atomic_load(&t->count);
+            return 0;
+        }
+    }
+    errno = ENOENT;
+    return -1;
+}
+
+
+/**
+ * @brief Register a histogram in SHM: threshold bins, or log-linear if @p bins is NULL.
+ */
+static int histogram_alloc(const char *name, const uint64_t *bins, size_t nbins) {
     // Acquire write lock for hash table + SHM lock for allocation
     pthread_rwlock_wrlock(&ctx.hash_rwlock);
 
@@ -611,7 +883,8 @@ int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbin
         }
     }
 
-    if (count >= MAX_HISTOGRAMS) {
+    size_t nhdr = atomic_load(&ctx.shm->num_hdr_histograms);
+    if (count >= MAX_HISTOGRAMS || (!bins && nhdr >= MAX_HDR_HISTOGRAMS)) {
         pthread_mutex_unlock(&ctx.shm->lock);
         pthread_rwlock_unlock(&ctx.hash_rwlock);
         errno = ENOMEM;
@@ -621,9 +894,18 @@ int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbin
     shm_histogram_t *h = &ctx.shm->histograms[count];
     strncpy(h->name, name, MAX_METRIC_NAME - 1);
     h->name[MAX_METRIC_NAME - 1] = '\0';
-    h->nbins = nbins;
-    memcpy(h->bins, bins, nbins * sizeof(uint64_t));
     for (size_t i = 0; i < MAX_HIST_BINS; i++) atomic_init(&h->counts[i], 0);
+    if (bins) {
+        h->nbins = nbins;
+        memcpy(h->bins, bins, nbins * sizeof(uint64_t));
+        atomic_store(&h->hdr, 0);
+    } else {
+        shm_hdr_histogram_t *hh = &ctx.shm->hdr_histograms[nhdr];
+        h->nbins = 0;
+        atomic_store(&hh->min, UINT64_MAX);
+        atomic_store(&ctx.shm->num_hdr_histograms, nhdr + 1);
+        atomic_store(&h->hdr, (unsigned int)nhdr + 1);
+    }
 
     // Store in hash table
     po_hashtable_put(ctx.histogram_map, h->name, (void *)(intptr_t)(count + 1));
@@ -634,26 +916,152 @@ int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbin
     return 0;
 }
 
+int po_perf_histogram_create(const char *name, const uint64_t *bins, size_t nbins) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+    if (nbins > MAX_HIST_BINS || nbins == 0) { errno = EINVAL; return -1; }
+    if (strlen(name) >= MAX_METRIC_NAME) { errno = EINVAL; return -1; }
+    return histogram_alloc(name, bins, nbins);
+}
+
+int po_perf_histogram_create_hdr(const char *name) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+    if (strlen(name) >= MAX_METRIC_NAME) { errno = EINVAL; return -1; }
+    return histogram_alloc(name, NULL, 0);
+}
+
 int po_perf_histogram_record(const char *name, uint64_t value) {
     if (!ctx.is_initialized) return -1;
 
     int idx = get_histogram_index(name);
     if (idx < 0) return -1;
 
-    shm_histogram_t *h = &ctx.shm->histograms[idx];
+    histogram_record(&ctx.shm->histograms[idx], value);
+    return 0;
+}
 
-    // Linear scan buckets
-    for (size_t i = 0; i < h->nbins; i++) {
-        if (value <= h->bins[i]) {
-            atomic_fetch_add(&h->counts[i], 1);
-            return 0;
+/**
+ * @brief Value at percentile @p p of a histogram (0 when empty).
+ *
+ * Log-linear histograms return the upper edge of the bucket holding the
+ * ranked sample, clamped to the recorded min/max; binned ones return the
+ * threshold of the bin (so overflowed samples report the last threshold).
+ */
+static uint64_t histogram_percentile(const shm_histogram_t *h, double p) {
+    if (p < 0.0) p = 0.0;
+    if (p > 100.0) p = 100.0;
+
+    unsigned int hdr = atomic_load(&h->hdr);
+    if (hdr) {
+        const shm_hdr_histogram_t *hh = &ctx.shm->hdr_histograms[hdr - 1];
+        // Sum buckets rather than trusting count: records in flight may have
+        // bumped one but not yet the other.
+        uint64_t total = 0;
+        for (size_t b = 0; b < HDR_BUCKETS; b++)
+            total += atomic_load_explicit(&hh->buckets[b], memory_order_relaxed);
+        if (total == 0) return 0;
+
+        uint64_t rank = (uint64_t)(p / 100.0 * (double)total + 0.5);
+        if (rank == 0) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t min = atomic_load(&hh->min);
+        uint64_t max = atomic_load(&hh->max);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < HDR_BUCKETS; b++) {
+            seen += atomic_load_explicit(&hh->buckets[b], memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t v = hdr_bucket_upper(b);
+                if (v > max) v = max;
+                return v < min ? min : v;
+            }
         }
+        return max;
     }
-    // Last bucket
-    atomic_fetch_add(&h->counts[h->nbins - 1], 1);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < h->nbins; i++) total += atomic_load(&h->counts[i]);
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)total + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < h->nbins; i++) {
+        seen += atomic_load(&h->counts[i]);
+        if (seen >= rank) return h->bins[i];
+    }
+    return h->bins[h->nbins - 1];
+}
+
+/**
+ * @brief Find a histogram in SHM by name (covers ones created by other processes).
+ */
+static int find_histogram_index(const char *name) {
+    size_t count = atomic_load(&ctx.shm->num_histograms);
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(ctx.shm->histograms[i].name, name, MAX_METRIC_NAME) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+static const shm_histogram_t *find_histogram(const char *name) {
+    int idx = find_histogram_index(name);
+    return idx >= 0 ? &ctx.shm->histograms[idx] : NULL;
+}
+
+int po_perf_histogram_percentile(const char *name, double p, uint64_t *out) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+
+    const shm_histogram_t *h = find_histogram(name);
+    if (!h) { errno = ENOENT; return -1; }
+    *out = histogram_percentile(h, p);
+    return 0;
+}
+
+static void histogram_summarize(const shm_histogram_t *h, po_perf_histogram_summary_t *s) {
+    memcpy(s->name, h->name, MAX_METRIC_NAME);
+    s->name[MAX_METRIC_NAME - 1] = '\0';
+
+    unsigned int hdr = atomic_load(&h->hdr);
+    s->hdr = hdr != 0;
+    if (hdr) {
+        const shm_hdr_histogram_t *hh = &ctx.shm->hdr_histograms[hdr - 1];
+        s->count = atomic_load(&hh->count);
+        s->sum = atomic_load(&hh->sum);
+        s->min = s->count ? atomic_load(&hh->min) : 0;
+        s->max = atomic_load(&hh->max);
+    } else {
+        s->count = 0;
+        for (size_t i = 0; i < h->nbins; i++) s->count += atomic_load(&h->counts[i]);
+        s->sum = 0;
+        s->min = 0;
+        s->max = 0;
+    }
+    s->p50 = histogram_percentile(h, 50.0);
+    s->p90 = histogram_percentile(h, 90.0);
+    s->p99 = histogram_percentile(h, 99.0);
+    s->p999 = histogram_percentile(h, 99.9);
+}
+
+int po_perf_histogram_summary(const char *name, po_perf_histogram_summary_t *out) {
+    if (!ctx.is_initialized) { errno = PERF_ENOTINIT; return -1; }
+
+    const shm_histogram_t *h = find_histogram(name);
+    if (!h) { errno = ENOENT; return -1; }
+    histogram_summarize(h, out);
     return 0;
 }
 
+size_t po_perf_histogram_snapshot(po_perf_histogram_summary_t *out, size_t max) {
+    if (!ctx.is_initialized || !out) return 0;
+
+    size_t count = atomic_load(&ctx.shm->num_histograms);
+    if (count > max) count = max;
+    for (size_t i = 0; i < count; i++)
+        histogram_summarize(&ctx.shm->histograms[i], &out[i]);
+    return count;
+}
+
 int po_perf_flush(void) {
     // No-op for SHM as updates are immediate
     return 0;
@@ -732,6 +1140,10 @@ int po_perf_report(FILE *out) {
             print_line(out, "-- Counters -- (allocation failed)");
         } else {
             memcpy(local_c, ctx.shm->counters, nc * sizeof(shm_counter_t));
+            // Fold per-CPU slots into the copy so sorting/printing sees totals
+            for (size_t i = 0; i < nc; i++) {
+                atomic_store(&local_c[i].value, counter_total(&ctx.shm->counters[i]));
+            }
             po_sort(local_c, nc, sizeof(shm_counter_t), compare_shm_counters);
             for (size_t i = 0; i < nc; i++) {
                 print_line(out, "%s: %lu", local_c[i].name, (unsigned long)atomic_load(&local_c[i].value));
@@ -756,7 +1168,11 @@ int po_perf_report(FILE *out) {
             memcpy(local_t, ctx.shm->timers, nt * sizeof(shm_timer_t));
             po_sort(local_t, nt, sizeof(shm_timer_t), compare_shm_timers);
             for (size_t i = 0; i < nt; i++) {
-                print_line(out, "%s: %lu ns", local_t[i].name, (unsigned long)atomic_load(&local_t[i].total_ns));
+                uint64_t total = atomic_load(&local_t[i].total_ns);
+                uint64_t n = atomic_load(&local_t[i].count);
+                print_line(out, "%s: %lu ns (count=%lu, avg=%lu ns)", local_t[i].name,
+                           (unsigned long)total, (unsigned long)n,
+                           (unsigned long)(n ? total / n : 0));
             }
             free(local_t);
         }
@@ -776,6 +1192,16 @@ int po_perf_report(FILE *out) {
             memcpy(local_h, ctx.shm->histograms, nh * sizeof(shm_histogram_t));
             po_sort(local_h, nh, sizeof(shm_histogram_t), compare_shm_histograms);
             for (size_t i = 0; i < nh; i++) {
+                if (atomic_load(&local_h[i].hdr)) {
+                    po_perf_histogram_summary_t s;
+                    histogram_summarize(&local_h[i], &s);
+                    print_line(out,
+                               "%s: count=%lu min=%lu p50=%lu p90=%lu p99=%lu p99.9=%lu max=%lu",
+                               s.name, (unsigned long)s.count, (unsigned long)s.min,
+                               (unsigned long)s.p50, (unsigned long)s.p90, (unsigned long)s.p99,
+                               (unsigned long)s.p999, (unsigned long)s.max);
+                    continue;
+                }
                 print_line(out, "%s:", local_h[i].name);
                 for (size_t b = 0; b < local_h[i].nbins; b++) {
                     print_line(out, "  <= %lu: %lu", (unsigned long)local_h[i].bins[b],
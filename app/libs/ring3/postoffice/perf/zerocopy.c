@@ -112,8 +112,8 @@ perf_zcpool_t *perf_zcpool_create(size_t buf_count, size_t buf_size, perf_zcpool
     if (flags & PERF_ZCPOOL_METRICS) {
         PO_METRIC_COUNTER_CREATE("zcpool.create");
         PO_METRIC_COUNTER_CREATE("zcpool.destroy");
-        PO_METRIC_COUNTER_CREATE("zcpool.acquire");
-        PO_METRIC_COUNTER_CREATE("zcpool.release");
+        PO_METRIC_COUNTER_CREATE_SHARDED("zcpool.acquire");
+        PO_METRIC_COUNTER_CREATE_SHARDED("zcpool.release");
         PO_METRIC_COUNTER_CREATE("zcpool.exhausted");
         PO_METRIC_COUNTER_INC("zcpool.create");
     }
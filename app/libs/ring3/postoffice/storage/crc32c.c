@@ -0,0 +1,104 @@
+/**
+ * @file crc32c.c
+ * @brief CRC32C with an SSE4.2 fast path and a slicing-by-8 fallback.
+ */
+
+#include "storage/crc32c.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // reflected Castagnoli polynomial
+
+static uint32_t crc_table[8][256];
+static pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+static void crc_table_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1u) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        crc_table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = crc_table[0][n];
+        for (int t = 1; t < 8; t++) {
+            c = crc_table[0][c & 0xFFu] ^ (c >> 8);
+            crc_table[t][n] = c;
+        }
+    }
+}
+
+uint32_t po_crc32c_sw(uint32_t crc, const void *buf, size_t len) {
+    pthread_once(&crc_table_once, crc_table_init);
+    const uint8_t *p = (const uint8_t *)buf;
+    uint32_t c = ~crc;
+
+    while (len >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= c;
+        c = crc_table[7][lo & 0xFFu] ^ crc_table[6][(lo >> 8) & 0xFFu] ^
+            crc_table[5][(lo >> 16) & 0xFFu] ^ crc_table[4][lo >> 24] ^
+            crc_table[3][hi & 0xFFu] ^ crc_table[2][(hi >> 8) & 0xFFu] ^
+            crc_table[1][(hi >> 16) & 0xFFu] ^ crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--)
+        c = crc_table[0][(c ^ *p++) & 0xFFu] ^ (c >> 8);
+    return ~c;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) static uint32_t crc32c_hw(uint32_t crc, const void *buf,
+                                                            size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    uint64_t c = ~crc;
+
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        c = __builtin_ia32_crc32di(c, w);
+        p += 8;
+        len -= 8;
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (len--)
+        c32 = __builtin_ia32_crc32qi(c32, *p++);
+    return ~c32;
+}
+#endif
+
+// 0 = not probed yet, 1 = software, 2 = SSE4.2
+static atomic_int crc_impl;
+
+static int crc_probe(void) {
+    int impl = 1;
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2))
+        impl = 2;
+#endif
+    atomic_store_explicit(&crc_impl, impl, memory_order_relaxed);
+    return impl;
+}
+
+int po_crc32c_hw_available(void) {
+    int impl = atomic_load_explicit(&crc_impl, memory_order_relaxed);
+    return (impl ? impl : crc_probe()) == 2;
+}
+
+uint32_t po_crc32c(uint32_t crc, const void *buf, size_t len) {
+#if defined(__x86_64__)
+    if (po_crc32c_hw_available())
+        return crc32c_hw(crc, buf, len);
+#endif
+    return po_crc32c_sw(crc, buf, len);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file crc32c.h
+ * @ingroup logstore
+ * @brief CRC32C (Castagnoli) checksums for log records.
+ *
+ * Uses the SSE4.2 `crc32` instruction when the CPU supports it (checked once
+ * at first use) and a slicing-by-8 table implementation otherwise. Both
+ * produce identical results, so files written on one machine verify on any
+ * other.
+ *
+ * Checksums chain: `po_crc32c(po_crc32c(0, a, n), b, m)` equals the checksum
+ * of `a` followed by `b`.
+ */
+
+#ifndef POSTOFFICE_STORAGE_CRC32C_H
+#define POSTOFFICE_STORAGE_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Extend @p crc (0 to start) with @p len bytes at @p buf.
+ * @note Thread-safe: Yes.
+ */
+uint32_t po_crc32c(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief Portable implementation, regardless of CPU support (tests, benchmarks).
+ */
+uint32_t po_crc32c_sw(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief Non-zero if ::po_crc32c() uses the hardware instruction.
+ */
+int po_crc32c_hw_available(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POSTOFFICE_STORAGE_CRC32C_H
@@ -89,6 +89,10 @@ struct db_bucket {
     MDB_dbi dbi;
 };
 
+struct db_txn {
+    MDB_txn *txn;
+};
+
 //----------------------------------------------------------------------
 // db_env_open
 //----------------------------------------------------------------------
@@ -244,6 +248,103 @@ int db_put(db_bucket_t *bucket, const void *key, size_t keylen, const void *val,
     return 0;
 }
 
+//----------------------------------------------------------------------
+// db_txn_begin / db_txn_put / db_txn_commit / db_txn_abort
+//----------------------------------------------------------------------
+
+int db_txn_begin(db_bucket_t *bucket, db_txn_t **out_txn) {
+    db_txn_t *t = malloc(sizeof(*t));
+    if (!t) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    int rc = mdb_txn_begin(bucket->env, NULL, 0, &t->txn);
+    if (rc != MDB_SUCCESS) {
+        free(t);
+        errno = _map_lmdb_error(rc);
+        return -1;
+    }
+
+    *out_txn = t;
+    return 0;
+}
+
+int db_txn_put(db_txn_t *txn, db_bucket_t *bucket, const void *key, size_t keylen,
+               const void *val, size_t vallen) {
+    if (keylen == 0 || (!val && vallen)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    MDB_val mdb_key = {.mv_size = keylen, .mv_data = (void *)key};
+    MDB_val mdb_val = {.mv_size = vallen, .mv_data = (void *)val};
+
+    int rc = mdb_put(txn->txn, bucket->dbi, &mdb_key, &mdb_val, 0);
+    if (rc != MDB_SUCCESS) {
+        errno = _map_lmdb_error(rc);
+        return -1;
+    }
+
+    return 0;
+}
+
+int db_txn_commit(db_txn_t **txn) {
+    if (!*txn) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int rc = mdb_txn_commit((*txn)->txn);
+    free(*txn);
+    *txn = NULL;
+    if (rc != MDB_SUCCESS) {
+        errno = _map_lmdb_error(rc);
+        return -1;
+    }
+
+    return 0;
+}
+
+void db_txn_abort(db_txn_t **txn) {
+    if (!*txn)
+        return;
+
+    mdb_txn_abort((*txn)->txn);
+    free(*txn);
+    *txn = NULL;
+}
+
+//----------------------------------------------------------------------
+// db_put_many
+//----------------------------------------------------------------------
+
+int db_put_many(db_bucket_t *bucket, const db_kv_t *items, size_t count) {
+    if (count == 0)
+        return 0;
+    if (!items) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    db_txn_t *txn;
+    if (db_txn_begin(bucket, &txn) != 0)
+        return -1;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!items[i].key ||
+            db_txn_put(txn, bucket, items[i].key, items[i].keylen, items[i].val,
+                       items[i].vallen) != 0) {
+            int saved = items[i].key ? errno : EINVAL;
+            db_txn_abort(&txn);
+            errno = saved;
+            return -1;
+        }
+    }
+
+    return db_txn_commit(&txn);
+}
+
 //----------------------------------------------------------------------
 // db_get
 //----------------------------------------------------------------------
@@ -330,6 +431,28 @@ int db_delete(db_bucket_t *bucket, const void *key, size_t keylen) {
     return 0;
 }
 
+//----------------------------------------------------------------------
+// db_count
+//----------------------------------------------------------------------
+
+int db_count(db_bucket_t *bucket, size_t *out_count) {
+    MDB_txn *txn;
+    int rc = mdb_txn_begin(bucket->env, NULL, MDB_RDONLY, &txn);
+    if (rc != MDB_SUCCESS) {
+        errno = _map_lmdb_error(rc);
+        return -1;
+    }
+    MDB_stat st;
+    rc = mdb_stat(txn, bucket->dbi, &st);
+    mdb_txn_abort(txn);
+    if (rc != MDB_SUCCESS) {
+        errno = _map_lmdb_error(rc);
+        return -1;
+    }
+    *out_count = st.ms_entries;
+    return 0;
+}
+
 //----------------------------------------------------------------------
 // db_iterate
 //----------------------------------------------------------------------
@@ -338,6 +461,17 @@ int db_iterate(db_bucket_t *bucket,
                int (*cb)(const void *key, size_t keylen, const void *val, size_t vallen,
                          void *udata),
                void *udata) {
+    return db_iterate_from(bucket, NULL, 0, cb, udata);
+}
+
+//----------------------------------------------------------------------
+// db_iterate_from
+//----------------------------------------------------------------------
+
+int db_iterate_from(db_bucket_t *bucket, const void *start, size_t startlen,
+                    int (*cb)(const void *key, size_t keylen, const void *val, size_t vallen,
+                              void *udata),
+                    void *udata) {
     MDB_txn *txn;
     MDB_cursor *cursor;
     int rc = mdb_txn_begin(bucket->env, NULL, MDB_RDONLY, &txn);
@@ -353,9 +487,9 @@ int db_iterate(db_bucket_t *bucket,
         return -1;
     }
 
-    MDB_val key;
+    MDB_val key = {.mv_size = startlen, .mv_data = (void *)start};
     MDB_val val;
-    rc = mdb_cursor_get(cursor, &key, &val, MDB_FIRST);
+    rc = mdb_cursor_get(cursor, &key, &val, startlen ? MDB_SET_RANGE : MDB_FIRST);
     for (; rc == MDB_SUCCESS; rc = mdb_cursor_get(cursor, &key, &val, MDB_NEXT)) {
         int stop = cb(key.mv_data, key.mv_size, val.mv_data, val.mv_size, udata);
         if (stop) {
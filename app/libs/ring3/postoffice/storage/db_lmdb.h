@@ -8,8 +8,10 @@
  * ------------
  *  - Each bucket maps to an LMDB named database (DBI) inside a shared
  *    environment.
- *  - All operations open short-lived read or write transactions and commit
- *    synchronously; no long-running transactions are exposed here.
+ *  - Single-key operations open short-lived read or write transactions and
+ *    commit synchronously. Bulk writers group puts into one commit with
+ *    ::db_put_many() or an explicit ::db_txn_t; each commit costs a page
+ *    flush, so this is the fast path for batched writes.
  *  - Values returned by ::db_get() are malloc() allocated; caller must free.
  *  - Error codes are negative `DB_E*` constants (defined alongside wrapper) or
  *    LMDB status codes translated; DB_ENOTFOUND indicates missing key.
@@ -35,6 +37,17 @@ typedef struct db_env db_env_t;
 /** Opaque handle for a named "bucket" (database) within an environment. */
 typedef struct db_bucket db_bucket_t;
 
+/** Opaque handle for a write transaction spanning several puts. */
+typedef struct db_txn db_txn_t;
+
+/** Key/value pair for ::db_put_many(). */
+typedef struct {
+    const void *key;
+    size_t keylen;
+    const void *val;
+    size_t vallen;
+} db_kv_t;
+
 /**
  * @brief Open or create the on‑disk LMDB environment.
  *
@@ -88,6 +101,55 @@ void db_bucket_close(db_bucket_t **bucket);
 int db_put(db_bucket_t *bucket, const void *key, size_t keylen, const void *val, size_t vallen)
     __nonnull((1, 2, 4));
 
+/**
+ * @brief Put several key/value pairs in one write transaction.
+ *
+ * Either all pairs are committed or none is (the transaction is aborted on the
+ * first failing put).
+ *
+ * @param bucket   The bucket handle.
+ * @param items    Pairs to store; keys must be non-empty.
+ * @param count    Number of pairs (0 is a no-op).
+ * @return 0 on success, -1 on error (errno = DB_E* or EINVAL).
+ */
+int db_put_many(db_bucket_t *bucket, const db_kv_t *items, size_t count) __nonnull((1));
+
+/**
+ * @brief Begin a write transaction on the bucket's environment.
+ *
+ * LMDB allows one write transaction per environment at a time: other writers
+ * (including ::db_put()) block until it is committed or aborted. The
+ * transaction belongs to the calling thread.
+ *
+ * @param bucket   Any bucket of the environment.
+ * @param out_txn  Receives the transaction handle.
+ * @return 0 on success, -1 on error (errno = DB_E*).
+ */
+int db_txn_begin(db_bucket_t *bucket, db_txn_t **out_txn) __nonnull((1, 2));
+
+/**
+ * @brief Put a key/value pair inside an open transaction.
+ *
+ * A failed put leaves the transaction unusable; abort it.
+ *
+ * @return 0 on success, -1 on error (errno = DB_E* or EINVAL).
+ */
+int db_txn_put(db_txn_t *txn, db_bucket_t *bucket, const void *key, size_t keylen,
+               const void *val, size_t vallen) __nonnull((1, 2, 3));
+
+/**
+ * @brief Commit and free the transaction; *txn is set to NULL.
+ *
+ * @return 0 on success, -1 on error (errno = DB_E*). The handle is freed
+ *         either way.
+ */
+int db_txn_commit(db_txn_t **txn) __nonnull((1));
+
+/**
+ * @brief Abort and free the transaction (no-op if *txn is NULL).
+ */
+void db_txn_abort(db_txn_t **txn) __nonnull((1));
+
 /**
  * @brief Retrieve a value for the given key.
  *
@@ -114,6 +176,15 @@ int db_get(db_bucket_t *bucket, const void *key, size_t keylen, void **out_value
  */
 int db_delete(db_bucket_t *bucket, const void *key, size_t keylen) __nonnull((1, 2));
 
+/**
+ * @brief Number of key/value pairs in the bucket (read from the btree header).
+ *
+ * @param bucket    The bucket handle.
+ * @param out_count Receives the entry count.
+ * @return 0 on success, or DB_E* on error.
+ */
+int db_count(db_bucket_t *bucket, size_t *out_count) __nonnull((1, 2));
+
 /**
  * @brief Iterate all key/value pairs in the bucket in lex order.
  *
@@ -131,6 +202,25 @@ int db_iterate(db_bucket_t *bucket,
                          void *udata),
                void *udata) __nonnull((1, 2));
 
+/**
+ * @brief Iterate key/value pairs in lex order starting at the first key >= @p start.
+ *
+ * Same contract as db_iterate(); a NULL or empty @p start begins at the first
+ * key. Each call runs in its own read transaction, so callers resuming a long
+ * walk in chunks do not pin old pages in between.
+ *
+ * @param bucket   The bucket handle.
+ * @param start    Lower bound key bytes (inclusive), or NULL.
+ * @param startlen Length of @p start.
+ * @param cb       Callback invoked for each KV pair.
+ * @param udata    User pointer passed through to `cb`.
+ * @return 0 on full iteration, or `cb`'s non‑zero value, or DB_E* on error.
+ */
+int db_iterate_from(db_bucket_t *bucket, const void *start, size_t startlen,
+                    int (*cb)(const void *key, size_t keylen, const void *val, size_t vallen,
+                              void *udata),
+                    void *udata) __nonnull((1, 4));
+
 #ifdef __cplusplus
 }
 #endif
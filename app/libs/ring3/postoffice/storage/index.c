@@ -1,55 +1,237 @@
 /**
  * @file index.c
+ * @brief Open-addressing (Swiss-table style) key -> (offset,length) index.
+ *
+ * Slots are laid out in groups of 16, each with a control byte that is either
+ * EMPTY, DELETED or the low 7 bits of the key's hash. A lookup hashes the key
+ * once and compares that fingerprint against a whole group of control bytes
+ * in one step (SSE2, or a portable loop), touching only the slots whose
+ * fingerprint matches. Groups are probed triangularly and a group that still
+ * has an EMPTY byte ends the search.
+ *
+ * Keys up to IDX_INLINE_KEY bytes live in the slot itself; longer keys go to
+ * a key arena, and the slot keeps their full hash so a fingerprint collision
+ * rarely costs an arena access. The arena is repacked on every rehash.
  */
 
 #include "storage/index.h"
 
+#include <errno.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "hashtable/hashtable.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define IDX_GROUP 16u
+#define IDX_INLINE_KEY 16u
+#define IDX_ARENA_MIN 4096u
+#define CTRL_EMPTY 0x80u
+#define CTRL_DELETED 0xFEu // full slots have the high bit clear
 
 typedef struct {
-    void *key;
-    size_t keylen;
     uint64_t offset;
     uint32_t len;
-} idx_entry_t;
+    uint32_t klen;
+    union {
+        uint8_t bytes[IDX_INLINE_KEY]; // klen <= IDX_INLINE_KEY
+        struct {
+            uint64_t at;   // arena offset
+            uint64_t hash; // full hash, checked before the arena
+        } ext;
+    } key;
+} idx_slot_t;
+
+_Static_assert(sizeof(idx_slot_t) == 32, "index slot should stay at 32 bytes");
 
 struct po_index {
-    po_hashtable_t *ht;
+    uint8_t *ctrl;     // cap control bytes
+    idx_slot_t *slots; // cap slots
+    size_t cap;        // power of two, multiple of IDX_GROUP
+    size_t used;       // live entries
+    size_t tombs;      // DELETED control bytes
+    uint8_t *arena;    // keys longer than IDX_INLINE_KEY
+    size_t arena_len;
+    size_t arena_cap;
+    size_t arena_dead; // bytes of removed keys, dropped on rehash
 };
 
-static int cmp_bin(const void *a, const void *b) {
-    const idx_entry_t *ea = (const idx_entry_t *)a;
-    const idx_entry_t *eb = (const idx_entry_t *)b;
-    if (ea->keylen != eb->keylen)
-        return 1;
-    return ea->key && eb->key ? memcmp(ea->key, eb->key, ea->keylen) : 1;
+static inline uint64_t mix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t load64(const uint8_t *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// Word-at-a-time multiply-fold hash; the tail is read as one (overlapping)
+// word instead of byte by byte.
+uint64_t po_index_hash(const void *key, size_t n) {
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (uint64_t)n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        h = mix(h ^ load64(p + i), 0xBF58476D1CE4E5B9ull);
+    if (i < n) {
+        uint64_t w = 0;
+        if (n >= 8)
+            w = load64(p + n - 8);
+        else
+            memcpy(&w, p, n);
+        h = mix(h ^ w, 0x94D049BB133111EBull);
+    }
+    return mix(h, 0x9E3779B97F4A7C15ull);
+}
+
+// Bit i set where control byte i of the group equals @p b.
+static inline uint32_t match_byte(const uint8_t *group, uint8_t b) {
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)(const void *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)b)));
+#else
+    uint32_t m = 0;
+    for (unsigned i = 0; i < IDX_GROUP; i++)
+        m |= (uint32_t)(group[i] == b) << i;
+    return m;
+#endif
+}
+
+// Bit i set where slot i of the group is EMPTY or DELETED.
+static inline uint32_t match_free(const uint8_t *group) {
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(const void *)group));
+#else
+    uint32_t m = 0;
+    for (unsigned i = 0; i < IDX_GROUP; i++)
+        m |= (uint32_t)(group[i] >> 7) << i;
+    return m;
+#endif
+}
+
+static inline uint8_t fingerprint(uint64_t h) {
+    return (uint8_t)(h & 0x7Fu);
+}
+
+static inline const uint8_t *slot_key(const po_index_t *idx, const idx_slot_t *s) {
+    return s->klen <= IDX_INLINE_KEY ? s->key.bytes : idx->arena + s->key.ext.at;
+}
+
+static idx_slot_t *find(const po_index_t *idx, const void *key, size_t klen, uint64_t h) {
+    size_t gmask = idx->cap / IDX_GROUP - 1;
+    size_t g = (size_t)(h >> 7) & gmask;
+    uint8_t fp = fingerprint(h);
+    for (size_t step = 1; step <= gmask + 1; step++) {
+        const uint8_t *group = idx->ctrl + g * IDX_GROUP;
+        for (uint32_t m = match_byte(group, fp); m; m &= m - 1) {
+            idx_slot_t *s = &idx->slots[g * IDX_GROUP + (unsigned)__builtin_ctz(m)];
+            if (s->klen != klen)
+                continue;
+            if (klen > IDX_INLINE_KEY && s->key.ext.hash != h)
+                continue;
+            if (memcmp(slot_key(idx, s), key, klen) == 0)
+                return s;
+        }
+        if (match_byte(group, CTRL_EMPTY))
+            return NULL;
+        g = (g + step) & gmask; // triangular: visits every group once
+    }
+    return NULL;
+}
+
+// First EMPTY or DELETED slot on the probe sequence of @p h.
+static size_t find_free(const uint8_t *ctrl, size_t cap, uint64_t h) {
+    size_t gmask = cap / IDX_GROUP - 1;
+    size_t g = (size_t)(h >> 7) & gmask;
+    for (size_t step = 1;; step++) {
+        uint32_t m = match_free(ctrl + g * IDX_GROUP);
+        if (m)
+            return g * IDX_GROUP + (unsigned)__builtin_ctz(m);
+        g = (g + step) & gmask; // the load limit keeps free slots around
+    }
+}
+
+static int arena_reserve(po_index_t *idx, size_t n) {
+    if (idx->arena_len + n <= idx->arena_cap)
+        return 0;
+    size_t cap = idx->arena_cap ? idx->arena_cap : IDX_ARENA_MIN;
+    while (cap < idx->arena_len + n)
+        cap *= 2;
+    uint8_t *grown = realloc(idx->arena, cap);
+    if (!grown) {
+        errno = ENOMEM;
+        return -1;
+    }
+    idx->arena = grown;
+    idx->arena_cap = cap;
+    return 0;
 }
 
-static unsigned long hash_bin(const void *a) {
-    const idx_entry_t *e = (const idx_entry_t *)a;
-    const unsigned char *p = (const unsigned char *)e->key;
-    unsigned long h = 1469598103934665603UL; // FNV-1a 64
-    for (size_t i = 0; i < e->keylen; ++i) {
-        h ^= p[i];
-        h *= 1099511628211UL;
+// Move every entry into a table of @p cap slots, packing the arena.
+static int rehash(po_index_t *idx, size_t cap) {
+    uint8_t *ctrl = malloc(cap);
+    idx_slot_t *slots = malloc(cap * sizeof(*slots));
+    size_t arena_need = idx->arena_len - idx->arena_dead;
+    uint8_t *arena = arena_need ? malloc(arena_need) : NULL;
+    if (!ctrl || !slots || (arena_need && !arena)) {
+        free(ctrl);
+        free(slots);
+        free(arena);
+        errno = ENOMEM;
+        return -1;
     }
-    return (unsigned long)h;
+    memset(ctrl, CTRL_EMPTY, cap);
+    size_t arena_len = 0;
+    for (size_t i = 0; i < idx->cap; i++) {
+        if (idx->ctrl[i] & 0x80u)
+            continue;
+        const idx_slot_t *s = &idx->slots[i];
+        int inline_key = s->klen <= IDX_INLINE_KEY;
+        uint64_t h = inline_key ? po_index_hash(s->key.bytes, s->klen) : s->key.ext.hash;
+        size_t at = find_free(ctrl, cap, h);
+        ctrl[at] = fingerprint(h);
+        slots[at] = *s;
+        if (!inline_key) {
+            memcpy(arena + arena_len, idx->arena + s->key.ext.at, s->klen);
+            slots[at].key.ext.at = arena_len;
+            arena_len += s->klen;
+        }
+    }
+    free(idx->ctrl);
+    free(idx->slots);
+    free(idx->arena);
+    idx->ctrl = ctrl;
+    idx->slots = slots;
+    idx->cap = cap;
+    idx->tombs = 0;
+    idx->arena = arena;
+    idx->arena_len = arena_len;
+    idx->arena_cap = arena_need;
+    idx->arena_dead = 0;
+    return 0;
 }
 
 po_index_t *po_index_create(size_t expected_entries) {
     po_index_t *idx = calloc(1, sizeof(*idx));
     if (!idx)
         return NULL;
-    idx->ht =
-        po_hashtable_create_sized(cmp_bin, hash_bin, expected_entries ? expected_entries : 128);
-    if (!idx->ht) {
+    size_t cap = IDX_GROUP;
+    while (cap / 8 * 7 < expected_entries)
+        cap *= 2;
+    idx->ctrl = malloc(cap);
+    idx->slots = malloc(cap * sizeof(*idx->slots));
+    if (!idx->ctrl || !idx->slots) {
+        free(idx->ctrl);
+        free(idx->slots);
         free(idx);
         return NULL;
     }
+    memset(idx->ctrl, CTRL_EMPTY, cap);
+    idx->cap = cap;
     return idx;
 }
 
@@ -57,74 +239,95 @@ void po_index_destroy(po_index_t **pidx) {
     if (!*pidx)
         return;
     po_index_t *idx = *pidx;
-    po_hashtable_iter_t *it = po_hashtable_iterator(idx->ht);
-    while (it && po_hashtable_iter_next(it)) {
-        idx_entry_t *e = po_hashtable_iter_key(it);
-        free(e->key);
-        free(e);
-    }
-    free(it);
-    po_hashtable_destroy(&idx->ht);
+    free(idx->ctrl);
+    free(idx->slots);
+    free(idx->arena);
     free(idx);
     *pidx = NULL;
 }
 
 int po_index_put(po_index_t *idx, const void *key, size_t keylen, uint64_t offset, uint32_t len) {
-    if (!idx || !key || keylen == 0)
+    if (!idx || !key || keylen == 0 || keylen > UINT32_MAX) {
+        errno = EINVAL;
         return -1;
-    idx_entry_t lookup = {.key = (void *)key, .keylen = keylen};
-    idx_entry_t *existing = po_hashtable_get(idx->ht, &lookup);
-    if (existing) {
-        existing->offset = offset;
-        existing->len = len;
+    }
+    uint64_t h = po_index_hash(key, keylen);
+    idx_slot_t *s = find(idx, key, keylen, h);
+    if (s) {
+        s->offset = offset;
+        s->len = len;
         return 0;
     }
-    idx_entry_t *e = calloc(1, sizeof(*e));
-    if (!e)
-        return -1;
-    e->key = malloc(keylen);
-    if (!e->key) {
-        free(e);
-        return -1;
+
+    // Keep at least 1/8 of the slots EMPTY so probes stay short and end.
+    // Mostly tombstones: rehash in place; otherwise double.
+    if (idx->used + idx->tombs + 1 > idx->cap / 8 * 7) {
+        size_t cap = idx->used + 1 > idx->cap / 16 * 7 ? idx->cap * 2 : idx->cap;
+        if (rehash(idx, cap) != 0)
+            return -1;
     }
-    memcpy(e->key, key, keylen);
-    e->keylen = keylen;
-    e->offset = offset;
-    e->len = len;
-    int ins = po_hashtable_put(idx->ht, e, e);
-    if (ins < 0) { // allocation or resize failure
-        free(e->key);
-        free(e);
+    if (keylen > IDX_INLINE_KEY && arena_reserve(idx, keylen) != 0)
         return -1;
+
+    size_t at = find_free(idx->ctrl, idx->cap, h);
+    if (idx->ctrl[at] == CTRL_DELETED)
+        idx->tombs--;
+    s = &idx->slots[at];
+    s->offset = offset;
+    s->len = len;
+    s->klen = (uint32_t)keylen;
+    if (keylen <= IDX_INLINE_KEY) {
+        memcpy(s->key.bytes, key, keylen);
+    } else {
+        memcpy(idx->arena + idx->arena_len, key, keylen);
+        s->key.ext.at = idx->arena_len;
+        s->key.ext.hash = h;
+        idx->arena_len += keylen;
     }
-    // ins==1 new, ins==0 replaced (shouldn't happen given uniqueness) both success
+    idx->ctrl[at] = fingerprint(h);
+    idx->used++;
     return 0;
 }
 
 int po_index_get(const po_index_t *idx, const void *key, size_t keylen, uint64_t *out_offset,
                  uint32_t *out_len) {
-    if (!idx || !key || keylen == 0)
+    if (!idx || !key || keylen == 0) {
+        errno = EINVAL;
         return -1;
-    idx_entry_t lookup = {.key = (void *)key, .keylen = keylen};
-    idx_entry_t *e = po_hashtable_get(idx->ht, &lookup);
-    if (!e)
+    }
+    const idx_slot_t *s = find(idx, key, keylen, po_index_hash(key, keylen));
+    if (!s) {
+        errno = ENOENT;
         return -1;
+    }
     if (out_offset)
-        *out_offset = e->offset;
+        *out_offset = s->offset;
     if (out_len)
-        *out_len = e->len;
+        *out_len = s->len;
     return 0;
 }
 
 int po_index_remove(po_index_t *idx, const void *key, size_t keylen) {
-    if (!idx || !key || keylen == 0)
+    if (!idx || !key || keylen == 0) {
+        errno = EINVAL;
         return -1;
-    idx_entry_t lookup = {.key = (void *)key, .keylen = keylen};
-    idx_entry_t *e = po_hashtable_get(idx->ht, &lookup);
-    if (!e)
+    }
+    idx_slot_t *s = find(idx, key, keylen, po_index_hash(key, keylen));
+    if (!s) {
+        errno = ENOENT;
         return -1;
-    po_hashtable_remove(idx->ht, e);
-    free(e->key);
-    free(e);
+    }
+    size_t at = (size_t)(s - idx->slots);
+    // A group that still has an EMPTY byte never ended a probe that went on
+    // past it, so the slot can become EMPTY again; otherwise leave a tombstone.
+    if (match_byte(idx->ctrl + at / IDX_GROUP * IDX_GROUP, CTRL_EMPTY)) {
+        idx->ctrl[at] = CTRL_EMPTY;
+    } else {
+        idx->ctrl[at] = CTRL_DELETED;
+        idx->tombs++;
+    }
+    if (s->klen > IDX_INLINE_KEY)
+        idx->arena_dead += s->klen;
+    idx->used--;
     return 0;
 }
@@ -12,17 +12,25 @@
  * Characteristics
  * --------------
  *  - In-memory only (rebuilt from log scan if needed at startup).
- *  - O(1) expected operations using an internal hash table (open addressed).
- *  - Keys/values (offset,len) pairs stored by value; key bytes are copied so
- *    caller buffers may be transient.
+ *  - O(1) expected operations using a Swiss-table style open-addressing
+ *    table: 32-byte slots in groups of 16, one control byte per slot holding
+ *    a 7-bit hash fingerprint, and whole groups matched at once (SSE2 when
+ *    available). The table doubles at 7/8 load, so it costs roughly 40-75
+ *    bytes per entry.
+ *  - Keys up to 16 bytes are stored inline in the slot; longer keys are
+ *    copied into a key arena (repacked on rehash). Caller buffers may be
+ *    transient.
  *  - Not thread-safe; external synchronization required if accessed from
  *    multiple threads concurrently (logstore coordinates access internally).
+ *    get never modifies the table, so concurrent readers are safe.
  *
  * Error Handling
  * --------------
  *  - put returns 0 on success, -1 on allocation failure (errno=ENOMEM).
- *  - get returns 0 on success, -1 if key absent (errno=ENOENT).
+ *  - get returns 0 on success, -1 if key absent (errno=ENOENT); either out
+ *    pointer may be NULL.
  *  - remove returns 0 on success, -1 if key absent (errno=ENOENT).
+ *  - Empty keys and NULL arguments fail with errno=EINVAL.
  *
  * @see logstore.h For higher-level append/get operations that delegate here.
  */
@@ -47,6 +55,14 @@ int po_index_get(const po_index_t *idx, const void *key, size_t keylen, uint64_t
                  uint32_t *out_len);
 int po_index_remove(po_index_t *idx, const void *key, size_t keylen);
 
+/**
+ * @brief 64-bit hash of a key, as used by the index.
+ *
+ * Exposed so structures kept alongside the index (the logstore's Bloom
+ * filter) hash keys the same way without a second implementation.
+ */
+uint64_t po_index_hash(const void *key, size_t keylen);
+
 #ifdef __cplusplus
 }
 #endif
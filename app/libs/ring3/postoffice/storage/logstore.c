@@ -7,6 +7,7 @@
 #endif
 
 // Standard headers needed for open/close & API functions
+#include <endian.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h> // For INT64_MAX
@@ -26,6 +27,7 @@
 #include "metrics/metrics.h"
 #include "storage/logstore.h"
 #include "storage/logstore_internal.h"
+#include "utils/errors.h"
 
 // Configuration defaults (tunable via po_logstore_cfg)
 #ifndef LS_MAX_KEY_DEFAULT
@@ -44,7 +46,7 @@
 // Background fsync logic moved to logstore_worker.c
 
 struct preload_ud {
-    po_index_t *idx;
+    po_logstore_t *ls;
 };
 
 /**
@@ -63,7 +65,11 @@ static int preload_cb(const void *k, size_t klen, const void *v, size_t vlen, vo
         uint32_t len;
         memcpy(&off, v, 8);
         memcpy(&len, (const uint8_t *)v + 8, 4);
-        (void)po_index_put(((struct preload_ud *)ud)->idx, k, klen, off, len);
+        po_logstore_t *ls = ((struct preload_ud *)ud)->ls;
+        if (ls->bloom)
+            _ls_bloom_add(ls->bloom, k, klen);
+        (void)po_index_put(ls->mem_idx, k, klen, off, len);
+        _ls_note_live(ls, off, LS_REC_SIZE(klen, len));
     }
     return 0;
 }
@@ -72,20 +78,11 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
     PO_METRIC_COUNTER_INC("logstore.open.attempt");
     if (!cfg || !cfg->dir || !cfg->bucket)
         return NULL;
-    char path[512];
-    snprintf(path, sizeof(path), "%s/aof.log", cfg->dir);
-    int fd = open(path, O_CREAT | O_RDWR, 0664); // need read for pread()
-    if (fd < 0) {
-        LOG_ERROR("logstore: open(%s) failed", path);
-        PO_METRIC_COUNTER_INC("logstore.open.fail");
-        return NULL;
-    }
 
     db_env_t *env = NULL;
     if (db_env_open(cfg->dir, 8, cfg->map_size, &env) != 0) {
         LOG_ERROR("logstore: db_env_open failed");
         PO_METRIC_COUNTER_INC("logstore.open.fail");
-        close(fd);
         return NULL;
     }
     db_bucket_t *idx = NULL;
@@ -93,21 +90,50 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
         LOG_ERROR("logstore: db_bucket_open(%s) failed", cfg->bucket);
         PO_METRIC_COUNTER_INC("logstore.open.fail");
         db_env_close(&env);
-        close(fd);
+        return NULL;
+    }
+
+    char meta_name[256];
+    snprintf(meta_name, sizeof(meta_name), "%s.meta", cfg->bucket);
+    db_bucket_t *meta = NULL;
+    if (db_bucket_open(env, meta_name, &meta) != 0) {
+        LOG_ERROR("logstore: db_bucket_open(%s) failed", meta_name);
+        PO_METRIC_COUNTER_INC("logstore.open.fail");
+        db_bucket_close(&idx);
+        db_env_close(&env);
         return NULL;
     }
 
     po_logstore_t *ls = calloc(1, sizeof(*ls));
     if (!ls) {
+        db_bucket_close(&meta);
         db_bucket_close(&idx);
         db_env_close(&env);
-        close(fd);
         PO_METRIC_COUNTER_INC("logstore.open.fail");
         return NULL;
     }
-    ls->fd = fd;
+    ls->dir_fd = -1;
     ls->env = env;
     ls->idx = idx;
+    ls->meta = meta;
+    pthread_rwlock_init(&ls->idx_lock, NULL);
+    pthread_rwlock_init(&ls->seg_lock, NULL);
+    pthread_mutex_init(&ls->tail_lock, NULL);
+    pthread_mutex_init(&ls->dir_mu, NULL);
+    pthread_cond_init(&ls->pub_cv, NULL);
+    pthread_mutex_init(&ls->idx_mu, NULL);
+    pthread_cond_init(&ls->idx_cv, NULL);
+    pthread_mutex_init(&ls->compact_mu, NULL);
+    pthread_cond_init(&ls->compact_cv, NULL);
+    pthread_mutex_init(&ls->compact_busy, NULL);
+    ls->fsync_policy = cfg->fsync_policy;
+    ls->mmap_reads = cfg->mmap_reads;
+    ls->io_backend = cfg->io_backend;
+    if (_ls_gc_init(ls) != 0 || _ls_segments_open(ls, cfg) != 0) {
+        po_logstore_close(&ls);
+        PO_METRIC_COUNTER_INC("logstore.open.fail");
+        return NULL;
+    }
     size_t cap = cfg->ring_capacity ? cfg->ring_capacity : 1024;
     
     ls->q = perf_ringbuf_create(cap, PERF_RINGBUF_METRICS);
@@ -129,13 +155,8 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
         PO_METRIC_COUNTER_INC("logstore.open.fail");
         return NULL;
     }
-    pthread_rwlock_init(&ls->idx_lock, NULL);
     ls->batch_size = cfg->batch_size ? cfg->batch_size : 32;
-    ls->fsync_policy = cfg->fsync_policy;
     atomic_store(&ls->seq, 0);
-    // preload in-memory index from LMDB to speed up reads
-    struct preload_ud u = {.idx = ls->mem_idx};
-    (void)db_iterate(ls->idx, preload_cb, &u);
     atomic_store(&ls->running, 1);
     if (ls->fsync_policy == PO_LS_FSYNC_INTERVAL && cfg->fsync_interval_ms > 0) {
         ls->fsync_interval_ns = (uint64_t)cfg->fsync_interval_ms * 1000000ull;
@@ -161,8 +182,17 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
     if (ls->max_value_bytes > LS_HARD_VALUE_MAX)
         ls->max_value_bytes = LS_HARD_VALUE_MAX;
 
-    // Optional rebuild on open moved to separate module
+    // Restore the record sequence from the checkpoint and, if configured,
+    // re-index the records written after it.
     (void)_ls_rebuild_on_open(ls, cfg);
+    // Preload the in-memory index from LMDB to speed up reads; whatever bytes
+    // it does not claim as live count as dead for compaction.
+    _ls_reset_accounting(ls);
+    // Without the filter every in-memory miss just asks LMDB
+    if (_ls_bloom_open(ls, cfg->bloom_keys) != 0)
+        LOG_WARN("logstore: no Bloom filter for negative lookups (errno=%d)", errno);
+    struct preload_ud u = {.ls = ls};
+    (void)db_iterate(ls->idx, preload_cb, &u);
     ls->nworkers = cfg->workers ? cfg->workers : 1;
     ls->workers = calloc(ls->nworkers, sizeof(pthread_t));
     if (!ls->workers) {
@@ -170,7 +200,9 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
         return NULL;
     }
     for (unsigned i = 0; i < ls->nworkers; ++i) {
+        atomic_fetch_add(&ls->workers_live, 1);
         if (pthread_create(&ls->workers[i], NULL, _ls_worker_main, ls) != 0) {
+            atomic_fetch_sub(&ls->workers_live, 1);
             ls->nworkers = i; // only join started
             po_logstore_close(&ls);
             PO_METRIC_COUNTER_INC("logstore.open.fail");
@@ -195,6 +227,8 @@ po_logstore_t *po_logstore_open_cfg(const po_logstore_cfg *cfg) {
             atomic_store(&ls->fsync_thread_run, 0);
         }
     }
+    if (_ls_compactor_start(ls, cfg) != 0)
+        LOG_WARN("logstore: compactor thread not started");
     return ls;
 }
 
@@ -216,13 +250,13 @@ void po_logstore_close(po_logstore_t **pls) {
         return;
     PO_METRIC_COUNTER_INC("logstore.close.calls");
     po_logstore_t *ls = *pls;
+    _ls_compactor_stop(ls);
     atomic_store(&ls->running, 0);
-    // enqueue sentinel to wake worker if blocked on eventfd
-    append_req_t *sent = calloc(1, sizeof(*sent));
-    if (sent) {
-        ls->sentinel = sent;
-        (void)perf_batcher_enqueue(ls->b, sent);
-    }
+    // enqueue sentinel to wake a worker if blocked on eventfd; each exiting
+    // worker wakes the next
+    append_req_t *sent = ls->b && ls->nworkers ? calloc(1, sizeof(*sent)) : NULL;
+    if (sent && perf_batcher_enqueue(ls->b, sent) != 0)
+        free(sent);
     for (unsigned i = 0; i < ls->nworkers; ++i) {
         pthread_join(ls->workers[i], NULL);
     }
@@ -232,21 +266,18 @@ void po_logstore_close(po_logstore_t **pls) {
         if (perf_ringbuf_dequeue(ls->q, &tmp) != 0)
             break;
         append_req_t *req = (append_req_t *)tmp;
-        if (req && req != ls->sentinel) {
+        if (req) {
             // append_req_t uses a single allocation layout
             // [append_req_t][key bytes][value bytes]; only free top-level.
+            if (!_ls_req_is_sentinel(req))
+                atomic_fetch_sub(&ls->outstanding_reqs, 1);
             free(req);
-            atomic_fetch_sub(&ls->outstanding_reqs, 1);
         }
     }
     if (ls->background_fsync) {
         atomic_store(&ls->fsync_thread_run, 0);
         pthread_join(ls->fsync_thread, NULL);
     }
-    if (ls->sentinel) {
-        free(ls->sentinel);
-        ls->sentinel = NULL;
-    }
     if (ls->workers) {
         free(ls->workers);
         ls->workers = NULL;
@@ -257,13 +288,25 @@ void po_logstore_close(po_logstore_t **pls) {
         perf_ringbuf_destroy(&ls->q);
     if (ls->idx)
         db_bucket_close(&ls->idx);
+    if (ls->meta)
+        db_bucket_close(&ls->meta);
     if (ls->env)
         db_env_close(&ls->env);
-    if (ls->fd >= 0)
-        close(ls->fd);
+    _ls_segments_close(ls);
     if (ls->mem_idx)
         po_index_destroy(&ls->mem_idx);
+    _ls_bloom_close(ls);
     pthread_rwlock_destroy(&ls->idx_lock);
+    pthread_rwlock_destroy(&ls->seg_lock);
+    pthread_mutex_destroy(&ls->tail_lock);
+    pthread_mutex_destroy(&ls->dir_mu);
+    pthread_cond_destroy(&ls->pub_cv);
+    pthread_mutex_destroy(&ls->idx_mu);
+    pthread_cond_destroy(&ls->idx_cv);
+    pthread_mutex_destroy(&ls->compact_mu);
+    pthread_cond_destroy(&ls->compact_cv);
+    pthread_mutex_destroy(&ls->compact_busy);
+    _ls_gc_destroy(ls);
     size_t leaks = atomic_load(&ls->outstanding_reqs);
     if (leaks != 0) {
         LOG_ERROR("logstore: %zu outstanding append requests at close (freed defensively)", leaks);
@@ -273,8 +316,9 @@ void po_logstore_close(po_logstore_t **pls) {
     *pls = NULL;
 }
 
-int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
-                       size_t vallen) {
+// Queue one record; @p out_ticket, if set, receives its group commit ticket.
+static int enqueue(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
+                   size_t vallen, po_logstore_token *out_ticket) {
     if (!ls || !key ||
         _ls_validate_lengths(keylen, vallen, ls->max_key_bytes, ls->max_value_bytes) != 0) {
         PO_METRIC_COUNTER_INC("logstore.append.invalid");
@@ -295,6 +339,8 @@ int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const
     r->v = (uint8_t *)r + sizeof(append_req_t) + keylen;
     r->klen = keylen;
     r->vlen = vallen;
+    uint64_t ticket = out_ticket ? atomic_fetch_add(&ls->gc_next_ticket, 1) + 1 : 0;
+    r->ticket = ticket;
     memcpy(r->k, key, keylen);
     memcpy(r->v, val, vallen);
     atomic_fetch_add(&ls->outstanding_reqs, 1);
@@ -316,6 +362,12 @@ int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const
     int attempt = 0;
     while (perf_batcher_enqueue(ls->b, r) < 0) {
         if (ls->never_overwrite || !atomic_load(&ls->running)) {
+            if (ticket) {
+                // Nothing to make durable; let later tickets' frontier pass it
+                pthread_mutex_lock(&ls->tail_lock);
+                _ls_gc_mark(ls, ticket, 1);
+                pthread_mutex_unlock(&ls->tail_lock);
+            }
             atomic_fetch_sub(&ls->outstanding_reqs, 1);
             free(r);
             PO_METRIC_COUNTER_INC("logstore.append.enqueue_fail");
@@ -332,83 +384,204 @@ int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const
     }
     PO_METRIC_COUNTER_INC("logstore.append.ok");
     PO_METRIC_COUNTER_ADD("logstore.append.bytes", (keylen + vallen));
+    if (out_ticket)
+        *out_ticket = ticket;
     return 0;
 }
 
-int po_logstore_get(po_logstore_t *ls, const void *key, size_t keylen, void **out_val,
-                    size_t *out_len) {
-    if (!ls || !key || keylen == 0 || keylen > ls->max_key_bytes)
+int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
+                       size_t vallen) {
+    return enqueue(ls, key, keylen, val, vallen, NULL);
+}
+
+int po_logstore_append_async(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
+                             size_t vallen, po_logstore_token *out_token) {
+    if (!out_token) {
+        errno = EINVAL;
         return -1;
-    // fast path: consult in-memory index under read lock
-    uint64_t off = 0;
-    uint32_t len = 0;
+    }
+    return enqueue(ls, key, keylen, val, vallen, out_token);
+}
+
+// Read the value of @p key's record at @p loc (its value must be @p len bytes
+// long). The whole record is fetched with one pread, sized for a v2 header; a
+// v1 record is shorter, so it fits as well.
+static int read_value(po_logstore_t *ls, const void *key, size_t keylen, uint64_t loc,
+                      uint32_t len, void **out_val) {
+    size_t want = LS_REC_HDR_SIZE + keylen + len;
+    uint8_t *buf = malloc(want);
+    if (!buf)
+        return -1;
+    ssize_t rd = _ls_pread(ls, buf, want, loc);
+    if (rd < 0) {
+        int saved = errno;
+        free(buf);
+        errno = saved;
+        return -1;
+    }
+
+    ls_rec_t r;
+    if (_ls_rec_decode(buf, (size_t)rd, &r) != 0 || r.klen != keylen || r.vlen != len ||
+        (size_t)rd < r.hdr_size + keylen + len) {
+        free(buf);
+        errno = EIO;
+        return -1;
+    }
+    uint8_t *kv = buf + r.hdr_size;
+    if (memcmp(kv, key, keylen) != 0 || _ls_rec_verify(&r, buf, kv) != 0) {
+        PO_METRIC_COUNTER_INC("logstore.get.corrupt");
+        free(buf);
+        errno = EIO;
+        return -1;
+    }
+
+    memmove(buf, kv + keylen, len);
+    *out_val = buf;
+    return 0;
+}
+
+// Current (location, value length) of a key: memory index, then LMDB unless
+// the Bloom filter rules the key out.
+static int lookup(po_logstore_t *ls, const void *key, size_t keylen, uint64_t *off,
+                  uint32_t *len) {
     pthread_rwlock_rdlock(&ls->idx_lock);
-    int have = po_index_get(ls->mem_idx, key, keylen, &off, &len);
+    int have = po_index_get(ls->mem_idx, key, keylen, off, len);
+    int maybe = have == 0 || !ls->bloom || _ls_bloom_may_contain(ls->bloom, key, keylen);
     pthread_rwlock_unlock(&ls->idx_lock);
-    if (have != 0) {
-        // fallback to LMDB
-        void *tmp = NULL;
-        size_t tmplen = 0;
-        int rc = db_get(ls->idx, key, keylen, &tmp, &tmplen);
-        if (rc != 0)
-            return -1;
-        if (tmplen != 12) {
-            free(tmp);
-            return -1;
+    if (have == 0)
+        return 0;
+    if (!maybe) {
+        atomic_fetch_add_explicit(&ls->bloom_negatives, 1, memory_order_relaxed);
+        PO_METRIC_COUNTER_INC("logstore.bloom.definite_miss");
+        errno = DB_ENOTFOUND; // as db_get() would report
+        return -1;
+    }
+
+    void *tmp = NULL;
+    size_t tmplen = 0;
+    if (db_get(ls->idx, key, keylen, &tmp, &tmplen) != 0) {
+        if (errno == DB_ENOTFOUND && ls->bloom) {
+            atomic_fetch_add_explicit(&ls->bloom_false_pos, 1, memory_order_relaxed);
+            PO_METRIC_COUNTER_INC("logstore.bloom.false_positive");
         }
-        memcpy(&off, tmp, 8);
-        memcpy(&len, (uint8_t *)tmp + 8, 4);
-        free(tmp);
-        // optionally backfill mem index
-        pthread_rwlock_wrlock(&ls->idx_lock);
-        (void)po_index_put(ls->mem_idx, key, keylen, off, len);
-        pthread_rwlock_unlock(&ls->idx_lock);
-    }
-    PO_METRIC_COUNTER_INC("logstore.get.hit_mem");
-    // read from file
-    uint32_t hdr[2];
-    if (pread(ls->fd, hdr, sizeof(hdr), (off_t)off) != (ssize_t)sizeof(hdr))
         return -1;
-    uint32_t kl = hdr[0];
-    uint32_t vl = hdr[1];
-    // Check for reasonable key and value lengths
-    if (kl > LS_HARD_KEY_MAX || vl > LS_HARD_VALUE_MAX || vl != len)
+    }
+    if (tmplen != 12) {
+        free(tmp);
         return -1;
+    }
+    memcpy(off, tmp, 8);
+    memcpy(len, (uint8_t *)tmp + 8, 4);
+    free(tmp);
+    // optionally backfill mem index
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    (void)po_index_put(ls->mem_idx, key, keylen, *off, *len);
+    pthread_rwlock_unlock(&ls->idx_lock);
+    return 0;
+}
 
-    // Check for potential overflow in offset calculation
-    const uint64_t offset = off + sizeof(kl) + sizeof(vl) + kl;
-    // Check if offset would exceed maximum possible off_t value
-    if (offset > (uint64_t)INT64_MAX)
+int po_logstore_get(po_logstore_t *ls, const void *key, size_t keylen, void **out_val,
+                    size_t *out_len) {
+    if (!ls || !key || keylen == 0 || keylen > ls->max_key_bytes)
         return -1;
+    // A compaction may unlink the segment between the index lookup and the
+    // read (ENOENT); by then the index points at the copy, so look up again.
+    for (int attempt = 0;; attempt++) {
+        uint64_t off = 0;
+        uint32_t len = 0;
+        if (lookup(ls, key, keylen, &off, &len) != 0)
+            return -1;
+        PO_METRIC_COUNTER_INC("logstore.get.hit_mem");
+        if (read_value(ls, key, keylen, off, len, out_val) != 0) {
+            if (errno == ENOENT && attempt < 3)
+                continue;
+            return -1;
+        }
+        *out_len = len;
+        PO_METRIC_COUNTER_INC("logstore.get.ok");
+        PO_METRIC_COUNTER_ADD("logstore.get.bytes", len);
+        return 0;
+    }
+}
 
-    void *buf = malloc(vl);
-    if (!buf)
+// Point @p view at the value of @p key's record inside a pinned mapping.
+static int map_value(po_logstore_t *ls, const void *key, size_t keylen, uint64_t loc,
+                     uint32_t len, po_logstore_view *view) {
+    ls_map_t *m = NULL;
+    size_t avail = 0;
+    const uint8_t *p = _ls_map_pin(ls, loc, &avail, &m);
+    if (!p)
         return -1;
-
-    // Safe cast since we've already checked against INT64_MAX
-    off_t val_off = (off_t)offset;
-    ssize_t bytes_read = pread(ls->fd, buf, vl, val_off);
-    if (bytes_read < 0 || (size_t)bytes_read != vl) {
-        free(buf);
+    ls_rec_t r;
+    if (_ls_rec_decode(p, avail < LS_REC_HDR_SIZE ? avail : LS_REC_HDR_SIZE, &r) != 0 ||
+        r.klen != keylen || r.vlen != len || r.hdr_size + keylen + len > avail ||
+        memcmp(p + r.hdr_size, key, keylen) != 0) {
+        _ls_map_unpin(m);
+        errno = EIO;
         return -1;
     }
-    *out_val = buf;
-    *out_len = vl;
-    PO_METRIC_COUNTER_INC("logstore.get.ok");
-    PO_METRIC_COUNTER_ADD("logstore.get.bytes", vl);
+    view->data = p + r.hdr_size + keylen;
+    view->len = len;
+    view->_pin = m;
+    view->_copy = 0;
     return 0;
 }
 
+int po_logstore_get_view(po_logstore_t *ls, const void *key, size_t keylen,
+                         po_logstore_view *out_view) {
+    if (!ls || !key || !out_view || keylen == 0 || keylen > ls->max_key_bytes) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(out_view, 0, sizeof(*out_view));
+    for (int attempt = 0;; attempt++) {
+        uint64_t off = 0;
+        uint32_t len = 0;
+        if (lookup(ls, key, keylen, &off, &len) != 0)
+            return -1;
+        int rc;
+        if (ls->mmap_reads) {
+            rc = map_value(ls, key, keylen, off, len, out_view);
+        } else {
+            void *buf = NULL;
+            rc = read_value(ls, key, keylen, off, len, &buf);
+            if (rc == 0)
+                *out_view = (po_logstore_view){buf, len, buf, 1};
+        }
+        if (rc != 0) {
+            if (errno == ENOENT && attempt < 3)
+                continue; // segment compacted away: the index has moved on
+            return -1;
+        }
+        if (out_view->_copy)
+            PO_METRIC_COUNTER_INC("logstore.view.copies");
+        else
+            PO_METRIC_COUNTER_INC("logstore.view.mapped");
+        return 0;
+    }
+}
+
+void po_logstore_view_release(po_logstore_view *view) {
+    if (!view || !view->_pin)
+        return;
+    if (view->_copy)
+        free(view->_pin);
+    else
+        _ls_map_unpin((ls_map_t *)view->_pin);
+    memset(view, 0, sizeof(*view));
+}
+
 // --- Logger integration ---
 // Provide a custom sink that appends formatted lines to the logstore
 static void _ls_logger_sink(const char *line, void *ud) {
     po_logstore_t *ls = (po_logstore_t *)ud;
     // Key: 16 bytes [ts_ns(8)][seq(8)] as binary; we don't have raw ts,
-    // so we use a monotonic seq and current time.
+    // so we use a monotonic seq and current time. Both are big-endian so the
+    // index orders lines by time and po_logstore_scan() can select a window.
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
-    uint64_t ts_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
-    uint64_t seq = atomic_fetch_add(&ls->seq, 1);
+    uint64_t ts_ns = htobe64((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+    uint64_t seq = htobe64(atomic_fetch_add(&ls->seq, 1));
     uint8_t key[16];
     memcpy(key, &ts_ns, 8);
     memcpy(key + 8, &seq, 8);
@@ -422,6 +595,28 @@ int po_logstore_attach_logger(po_logstore_t *ls) {
     return po_logger_add_sink_custom(_ls_logger_sink, ls);
 }
 
+int po_logstore_get_space_stats(po_logstore_t *ls, po_logstore_space_stats *out) {
+    if (!ls || !out) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    out->segments = ls->nsegs;
+    for (size_t i = 0; i < ls->nsegs; i++) {
+        uint64_t size = atomic_load(&ls->segs[i]->size);
+        uint64_t dead = atomic_load(&ls->segs[i]->dead);
+        out->total_bytes += size;
+        out->dead_bytes += dead < size ? dead : size;
+    }
+    pthread_rwlock_unlock(&ls->seg_lock);
+    out->live_bytes = out->total_bytes - out->dead_bytes;
+    out->compactions = atomic_load(&ls->compact_runs);
+    out->copied_bytes = atomic_load(&ls->compact_copied);
+    out->reclaimed_bytes = atomic_load(&ls->compact_reclaimed);
+    return 0;
+}
+
 // Forward to modular implementation
 int po_logstore_integrity_scan(po_logstore_t *ls, int prune_nonexistent,
                                po_logstore_integrity_stats *out_stats) {
@@ -435,7 +630,14 @@ int po_logstore_debug_put_index(po_logstore_t *ls, const void *key, size_t keyle
     uint8_t iv[12];
     memcpy(iv, &offset, 8);
     memcpy(iv + 8, &len, 4);
-    if (db_put(ls->idx, key, keylen, iv, sizeof iv) != 0)
+    // Like a flush: filter first, then LMDB, with no filter rebuild in between
+    pthread_mutex_lock(&ls->idx_mu);
+    pthread_rwlock_rdlock(&ls->idx_lock);
+    _ls_bloom_note_key(ls, key, keylen);
+    pthread_rwlock_unlock(&ls->idx_lock);
+    int rc = db_put(ls->idx, key, keylen, iv, sizeof iv);
+    pthread_mutex_unlock(&ls->idx_mu);
+    if (rc != 0)
         return -1;
     pthread_rwlock_wrlock(&ls->idx_lock);
     (void)po_index_put(ls->mem_idx, key, keylen, offset, len);
@@ -8,7 +8,8 @@
  * ========
  * The log store consists of:
  *  - A preallocated / append-only data file (or sequence) storing variable
- *    length records: [key_len][val_len][key bytes][value bytes].
+ *    length records: a 32-byte header (magic, CRC32C, sequence number,
+ *    key/value lengths, flags) followed by the key and value bytes.
  *  - An LMDB database mapping key -> (file_offset, value_length) enabling
  *    O(log n) (LMDB btree) lookups independent of append batching.
  *  - An in-memory batching queue (perf ring buffer) + background flush worker
@@ -23,6 +24,14 @@
  * and updates LMDB within a single batch transaction. Gets perform a key
  * lookup in LMDB followed by an on-demand read from the data file.
  *
+ * With `workers > 1` several flush threads drain the queue. Each reserves a
+ * byte range at the segment tail for its batch and writes it without holding
+ * the tail, so batches are written in parallel. They are then published
+ * (made readable, indexed and checkpointed) in reservation order, so the
+ * index never points past a gap in the log. Batches taken by different
+ * workers can reach the log in either order; keep a single worker when the
+ * order of rewrites of the same key matters.
+ *
  * Durability Policies (see po_logstore_fsync_policy_t)
  * -----------------------------------------------------
  *  - NONE: never fsync – highest throughput, risk of data loss on crash.
@@ -30,12 +39,49 @@
  *  - INTERVAL: fsync at most once per configured time interval.
  *  - EVERY_N: fsync after every N flush batches.
  *
+ * With `io_backend = PO_LS_IO_URING` each worker submits a batch's write and
+ * the policy's sync as one linked io_uring chain and waits for the write only:
+ * the index is published on write completion, as with pwritev, while the
+ * fdatasync finishes in the background and the next batch is written. Where
+ * io_uring is unavailable the worker logs a warning and uses pwritev.
+ *
+ * Independently of the policy, ::po_logstore_append_async() returns a token
+ * that ::po_logstore_wait_durable() turns into a per-record durability
+ * guarantee: batches carrying tokens are always synced, and one sync releases
+ * every waiter whose token it covers (group commit).
+ *
+ * Segments & Compaction
+ * ---------------------
+ * With `segment_bytes` set, data lives in `aof.NNNNNN.log` files and the
+ * active one is sealed once it reaches the threshold (a pre-existing
+ * `aof.log` is adopted as segment 0). Overwriting a key leaves the old record
+ * as dead bytes; with `background_compact` a thread rewrites the live records
+ * of sealed segments whose dead share reaches `compact_min_dead_pct` into the
+ * active segment, repoints the index and unlinks the old file, pacing its I/O
+ * to `compact_rate_bytes` per second. Without `segment_bytes` the store is a
+ * single `aof.log` that is never compacted.
+ *
  * Rebuild / Integrity
  * -------------------
- * If `rebuild_on_open` is set in the config, the store scans the entire data
- * file reconstructing index entries (optionally truncating a corrupt tail when
- * `truncate_on_rebuild` is non-zero). This enables crash recovery when the
- * index is stale or missing.
+ * Each index commit also records a checkpoint (the end of the last indexed
+ * record) in the same LMDB transaction. If `rebuild_on_open` is set, the store
+ * re-indexes the records written after the checkpoint, stopping at the first
+ * one whose checksum or sequence number does not fit (a torn tail), and
+ * optionally truncates what follows when `truncate_on_rebuild` is non-zero.
+ * Reopening therefore costs a scan of the unindexed tail only; stores written
+ * before checkpoints existed, or `rebuild_full`, scan every segment from byte
+ * 0. Records in the older `[key_len][val_len]` format remain readable.
+ * ::po_logstore_get() verifies the checksum of the record it returns.
+ *
+ * Lookups go to the in-memory index first. On a miss, a Bloom filter over
+ * every indexed key answers definite misses, and only the rest read LMDB
+ * (see ::po_logstore_get_bloom_stats()).
+ *
+ * Ordered Scans
+ * -------------
+ * ::po_logstore_scan() and ::po_logstore_scan_prefix() walk a key range in
+ * order through the LMDB index, prefetching each batch's values from the log
+ * in file order (see ::po_logstore_scan()).
  *
  * Error Handling
  * --------------
@@ -72,6 +118,14 @@ typedef enum po_logstore_fsync_policy {
     PO_LS_FSYNC_EVERY_N = 3,    //!< fsync() after every N drained batches (see fsync_every_n)
 } po_logstore_fsync_policy_t;
 
+/**
+ * @brief How flush workers submit writes and syncs.
+ */
+typedef enum po_logstore_io_backend {
+    PO_LS_IO_PWRITEV = 0, //!< pwritev() then fsync() on the worker thread (default)
+    PO_LS_IO_URING = 1,   //!< io_uring write linked to an async fdatasync; falls back to pwritev
+} po_logstore_io_backend_t;
+
 /**
  * @brief Configuration for ::po_logstore_open_cfg().
  *
@@ -86,12 +140,21 @@ typedef struct po_logstore_cfg {
     po_logstore_fsync_policy_t fsync_policy; //!< Durability policy.
     unsigned fsync_interval_ms;              //!< Interval (ms) when policy == PO_LS_FSYNC_INTERVAL.
     unsigned fsync_every_n;                  //!< N for policy == PO_LS_FSYNC_EVERY_N (0 => treated as 1).
-    int rebuild_on_open;                     //!< Non-zero: scan data file to rebuild index.
+    int rebuild_on_open;                     //!< Non-zero: re-index records past the checkpoint.
     int truncate_on_rebuild;                 //!< Non-zero: truncate corrupt tail discovered during rebuild.
+    int rebuild_full;                        //!< Non-zero: rebuild from byte 0, ignoring the checkpoint.
     int background_fsync;                    //!< Non-zero: perform interval fsync in background thread.
     size_t max_key_bytes;                    //!< Max allowed key length (0 => internal default / limit).
     size_t max_value_bytes;                  //!< Max allowed value length (0 => internal default / limit).
-    unsigned workers;                        //!< Parallel flush workers (0 => 1). Experimental.
+    unsigned workers;                        //!< Parallel flush workers (0 => 1).
+    size_t segment_bytes;                    //!< Roll to a new segment past this size (0 => single aof.log).
+    int background_compact;                  //!< Non-zero: compact sealed segments in a background thread.
+    unsigned compact_min_dead_pct;           //!< Dead share (%) that makes a segment a victim (0 => 50).
+    size_t compact_rate_bytes;               //!< Compaction read budget in bytes/s (0 => 8 MiB/s).
+    unsigned compact_interval_ms;            //!< Pause between victim scans (0 => 100 ms).
+    int mmap_reads;                          //!< Non-zero: serve views from read-only mappings.
+    po_logstore_io_backend_t io_backend;     //!< Flush write/sync submission backend.
+    size_t bloom_keys;                       //!< Min Bloom filter capacity in keys (0 => 64Ki).
 } po_logstore_cfg;
 
 /**
@@ -151,6 +214,51 @@ void po_logstore_close(po_logstore_t **ls);
 int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
                        size_t vallen);
 
+/**
+ * @brief Durability token of an async append (see ::po_logstore_append_async()).
+ *
+ * Tokens increase in the order appends are queued; waiting for one covers
+ * every earlier token as well.
+ */
+typedef uint64_t po_logstore_token;
+
+/**
+ * @brief Append like ::po_logstore_append() and return a durability token.
+ *
+ * The record is queued exactly as a plain append; in addition, the batch that
+ * carries it is followed by a sync regardless of the fsync policy. Appends
+ * from many producers that queue while one sync runs share the next, so each
+ * caller gets per-record durability at the cost of one sync per batch
+ * (group commit).
+ *
+ * @param[in] ls Store handle.
+ * @param[in] key Key data.
+ * @param[in] keylen Key length.
+ * @param[in] val Value data.
+ * @param[in] vallen Value length.
+ * @param[out] out_token Receives the token for ::po_logstore_wait_durable().
+ * @return 0 on success (enqueued), -1 on error as ::po_logstore_append().
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_append_async(po_logstore_t *ls, const void *key, size_t keylen, const void *val,
+                             size_t vallen, po_logstore_token *out_token);
+
+/**
+ * @brief Block until the record behind @p token, and every earlier one, is on disk.
+ *
+ * Tokens need not be waited for, and may be waited for more than once. A
+ * failed write or sync is sticky: from then on every token issued at or after
+ * the first one it may have lost reports EIO.
+ *
+ * @param[in] ls Store handle (must stay open for the duration of the wait).
+ * @param[in] token Token from ::po_logstore_append_async().
+ * @param[in] timeout_ms Maximum wait in milliseconds (negative: no limit).
+ * @return 0 once durable, -1 on error (errno = EINVAL unknown token,
+ *         ETIMEDOUT, or EIO).
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_wait_durable(po_logstore_t *ls, po_logstore_token token, int timeout_ms);
+
 /**
  * @brief Retrieve value for a key (point-in-time consistent with flushed state).
  *
@@ -165,12 +273,117 @@ int po_logstore_append(po_logstore_t *ls, const void *key, size_t keylen, const
  * @param[out] out_val Output pointer to allocated value buffer (set on success).
  * @param[out] out_len Output length of value in bytes.
  * @return 0 on success (value found), -1 if not found or on error (errno = ENOENT
- *         for missing, or LMDB / I/O error code).
+ *         for missing, EIO if the record fails its checksum, or LMDB / I/O
+ *         error code).
  * @note Thread-safe: Yes.
  */
 int po_logstore_get(po_logstore_t *ls, const void *key, size_t keylen, void **out_val,
                     size_t *out_len);
 
+/**
+ * @brief Borrowed, read-only value returned by ::po_logstore_get_view().
+ *
+ * Valid until ::po_logstore_view_release(), even if the key is overwritten,
+ * its segment is compacted away or the store is closed meanwhile.
+ */
+typedef struct po_logstore_view {
+    const void *data; //!< Value bytes (do not write or free).
+    size_t len;       //!< Value length in bytes.
+    void *_pin;       //!< Internal: mapping reference or private copy.
+    int _copy;        //!< Internal: non-zero if _pin is a private copy.
+} po_logstore_view;
+
+/**
+ * @brief Retrieve a value without copying it.
+ *
+ * With `mmap_reads` configured the view points straight into a read-only
+ * mapping of the data file, pinned by a reference count: no system call and
+ * no allocation once the segment is mapped (segments are remapped as they
+ * grow). Otherwise the view owns a private copy, as ::po_logstore_get()
+ * would return. Views check the record header and key but not the value
+ * checksum, which would mean reading every byte; use ::po_logstore_get() or
+ * ::po_logstore_integrity_scan() for verified reads.
+ *
+ * @param[in] ls       Store handle.
+ * @param[in] key      Key bytes.
+ * @param[in] keylen   Key length in bytes.
+ * @param[out] out_view Receives the view; release it with ::po_logstore_view_release().
+ * @return 0 on success, -1 if not found or on error (errno = EINVAL, EIO, or
+ *         LMDB / I/O error code).
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_get_view(po_logstore_t *ls, const void *key, size_t keylen,
+                         po_logstore_view *out_view);
+
+/**
+ * @brief Drop a view's pin (no-op on a zeroed or already released view).
+ * @note Thread-safe: Yes (each view released once).
+ */
+void po_logstore_view_release(po_logstore_view *view);
+
+typedef struct po_logstore_scan po_logstore_scan_t; //!< Opaque ordered scan cursor
+
+/**
+ * @brief One record produced by ::po_logstore_scan_next().
+ *
+ * Both pointers stay valid until the next call on the scan or its close.
+ */
+typedef struct po_logstore_scan_item {
+    const void *key; //!< Key bytes.
+    size_t keylen;   //!< Key length in bytes.
+    const void *val; //!< Value bytes.
+    size_t vallen;   //!< Value length in bytes.
+} po_logstore_scan_item;
+
+/**
+ * @brief Start a scan of the keys in [@p lo, @p hi), in key order.
+ *
+ * Keys compare bytewise, a shorter key sorting before its extensions (LMDB
+ * order), so big-endian integer keys scan numerically. The index is read a
+ * batch at a time, each batch in its own LMDB read transaction, and the
+ * values of a batch are fetched in log order with readahead hints, so memory
+ * stays bounded (about a megabyte) however large the range. Records flushed
+ * while the scan runs may or may not be returned; pending appends are not.
+ *
+ * @param[in] ls    Store handle (must outlive the scan).
+ * @param[in] lo    Inclusive lower bound, or NULL with @p lolen 0 for the first key.
+ * @param[in] lolen Length of @p lo.
+ * @param[in] hi    Exclusive upper bound, or NULL for no upper bound.
+ * @param[in] hilen Length of @p hi.
+ * @return Scan handle, or NULL on error (errno = EINVAL or ENOMEM).
+ * @note Thread-safe: Yes (each scan used by one thread at a time).
+ */
+po_logstore_scan_t *po_logstore_scan(po_logstore_t *ls, const void *lo, size_t lolen,
+                                     const void *hi, size_t hilen);
+
+/**
+ * @brief Start a scan of every key that begins with @p prefix (all keys if empty).
+ * @return Scan handle, or NULL on error (errno = EINVAL or ENOMEM).
+ * @note Thread-safe: Yes (each scan used by one thread at a time).
+ */
+po_logstore_scan_t *po_logstore_scan_prefix(po_logstore_t *ls, const void *prefix,
+                                            size_t prefixlen);
+
+/**
+ * @brief Produce the next record of a scan.
+ *
+ * Values are checksum-verified as by ::po_logstore_get(). A record that fails
+ * verification is reported as an error and skipped, so the caller may keep
+ * calling to continue past it.
+ *
+ * @param[in] scan Scan handle.
+ * @param[out] out Receives the record.
+ * @return 1 if a record was produced, 0 at the end of the range, -1 on error
+ *         (errno = EIO for a corrupt record, or LMDB / I/O error code).
+ * @note Thread-safe: No (per scan).
+ */
+int po_logstore_scan_next(po_logstore_scan_t *scan, po_logstore_scan_item *out);
+
+/**
+ * @brief Release a scan (no-op if *scan is NULL); *scan is set to NULL.
+ */
+void po_logstore_scan_close(po_logstore_scan_t **scan);
+
 /**
  * @brief Attach a logger sink that appends each formatted log line.
  *
@@ -197,7 +410,7 @@ typedef struct po_logstore_integrity_stats {
  * @brief Validate LMDB index entries against on-disk data file structure.
  *
  * Each key's referenced (offset,len) pair is checked to ensure it lies within
- * the file and corresponds to a syntactically valid record header. When
+ * the file and corresponds to a record of that key whose checksum matches. When
  * @p prune_nonexistent is non-zero, stale index entries referencing missing or
  * corrupt records are removed. Scanning continues in the presence of corrupt
  * entries unless a fatal I/O error occurs.
@@ -212,6 +425,60 @@ typedef struct po_logstore_integrity_stats {
 int po_logstore_integrity_scan(po_logstore_t *ls, int prune_nonexistent,
                                po_logstore_integrity_stats *out_stats);
 
+/**
+ * @brief Space accounting across all segments.
+ *
+ * Dead bytes are records shadowed by a newer version of their key (plus any
+ * torn tail found at open); they are released when their segment is compacted.
+ */
+typedef struct po_logstore_space_stats {
+    size_t segments;          //!< Segment files in use (including the active one).
+    uint64_t total_bytes;     //!< Bytes on disk across segments.
+    uint64_t live_bytes;      //!< Bytes of records the index points at.
+    uint64_t dead_bytes;      //!< total_bytes - live_bytes.
+    uint64_t compactions;     //!< Segments compacted and unlinked.
+    uint64_t copied_bytes;    //!< Live bytes rewritten by compaction.
+    uint64_t reclaimed_bytes; //!< Net bytes released by compaction.
+} po_logstore_space_stats;
+
+/**
+ * @brief Snapshot segment space accounting.
+ * @return 0 on success, -1 on invalid arguments (errno=EINVAL).
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_get_space_stats(po_logstore_t *ls, po_logstore_space_stats *out);
+
+/**
+ * @brief Negative-lookup filter statistics.
+ *
+ * Lookups that miss the in-memory index consult a Bloom filter holding every
+ * indexed key before LMDB; a definite miss returns without touching LMDB.
+ */
+typedef struct po_logstore_bloom_stats {
+    size_t bytes;             //!< Filter size in bytes.
+    size_t keys;              //!< Keys added (approximately distinct).
+    uint64_t definite_misses; //!< Lookups answered by the filter alone.
+    uint64_t false_positives; //!< Lookups the filter passed that LMDB did not find.
+    double fp_rate;           //!< false_positives / (false_positives + definite_misses).
+} po_logstore_bloom_stats;
+
+/**
+ * @brief Snapshot Bloom filter statistics.
+ * @return 0 on success, -1 on invalid arguments (errno=EINVAL).
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_get_bloom_stats(po_logstore_t *ls, po_logstore_bloom_stats *out);
+
+/**
+ * @brief Synchronously compact every sealed segment at or above @p min_dead_pct.
+ *
+ * Runs in the calling thread without rate limiting (the background compactor
+ * is paused meanwhile). Useful for maintenance windows and tests.
+ * @return Number of segments compacted, or -1 if the first one failed.
+ * @note Thread-safe: Yes.
+ */
+int po_logstore_compact(po_logstore_t *ls, unsigned min_dead_pct);
+
 /**
  * @brief DEBUG: Insert raw (offset,len) index entry without writing to log.
  *
@@ -0,0 +1,197 @@
+/**
+ * @file logstore_bloom.c
+ * @brief Blocked Bloom filter that answers definite misses without LMDB.
+ *
+ * Every key that reaches the LMDB index is added first, so a negative answer
+ * is always right and po_logstore_get() can return not-found without a read
+ * transaction. Keys are never removed (a pruned key only costs a false
+ * positive). The filter is split into 64-byte blocks: a key's hash picks one
+ * block and sets one bit in each of its eight words, so a probe touches a
+ * single cache line.
+ *
+ * It is sized at open for twice the stored keys and rebuilt from LMDB at
+ * double the size once more keys than that have been added. The new filter is
+ * installed as bloom_next under idx_mu, when no batch sits between its filter
+ * update and its index commit: every key noted from then on goes into both
+ * filters, and every key noted before is already in LMDB. The flush worker
+ * then fills it from LMDB with idx_mu dropped, so other batches keep
+ * committing, and swaps it in.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log/logger.h"
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+
+#define LS_BLOOM_BITS_PER_KEY 12u
+#define LS_BLOOM_MIN_KEYS 65536u
+
+// One multiplier per word: word i gets bit (lo32(h) * salt[i]) >> 26 (Impala/Parquet
+// split-block layout, widened to 64-bit words).
+static const uint32_t bloom_salt[LS_BLOOM_BLOCK_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+static inline _Atomic uint64_t *bloom_block(const ls_bloom_t *b, uint64_t h) {
+    return b->words + (size_t)(h >> 32 & (b->nblocks - 1)) * LS_BLOOM_BLOCK_WORDS;
+}
+
+static inline uint64_t bloom_bit(uint64_t h, unsigned i) {
+    return UINT64_C(1) << (((uint32_t)h * bloom_salt[i]) >> 26);
+}
+
+static ls_bloom_t *bloom_create(size_t keys) {
+    size_t blocks = 1;
+    while (blocks * LS_BLOOM_BLOCK_WORDS * 64 < keys * LS_BLOOM_BITS_PER_KEY)
+        blocks *= 2;
+    ls_bloom_t *b = calloc(1, sizeof(*b));
+    if (!b)
+        return NULL;
+    b->words = calloc(blocks * LS_BLOOM_BLOCK_WORDS, sizeof(uint64_t));
+    if (!b->words) {
+        free(b);
+        return NULL;
+    }
+    b->nblocks = blocks;
+    b->capacity = blocks * LS_BLOOM_BLOCK_WORDS * 64 / LS_BLOOM_BITS_PER_KEY;
+    return b;
+}
+
+static void bloom_destroy(ls_bloom_t *b) {
+    if (!b)
+        return;
+    free((void *)b->words);
+    free(b);
+}
+
+void _ls_bloom_add(ls_bloom_t *b, const void *key, size_t klen) {
+    uint64_t h = po_index_hash(key, klen);
+    _Atomic uint64_t *w = bloom_block(b, h);
+    uint64_t fresh = 0;
+    for (unsigned i = 0; i < LS_BLOOM_BLOCK_WORDS; i++) {
+        uint64_t bit = bloom_bit(h, i);
+        fresh |= ~atomic_fetch_or_explicit(&w[i], bit, memory_order_relaxed) & bit;
+    }
+    if (fresh)
+        atomic_fetch_add_explicit(&b->keys, 1, memory_order_relaxed);
+}
+
+int _ls_bloom_may_contain(const ls_bloom_t *b, const void *key, size_t klen) {
+    uint64_t h = po_index_hash(key, klen);
+    _Atomic uint64_t *w = bloom_block(b, h);
+    for (unsigned i = 0; i < LS_BLOOM_BLOCK_WORDS; i++) {
+        uint64_t bit = bloom_bit(h, i);
+        if (!(atomic_load_explicit(&w[i], memory_order_relaxed) & bit))
+            return 0;
+    }
+    return 1;
+}
+
+static int add_cb(const void *k, size_t klen, const void *v, size_t vlen, void *ud) {
+    (void)v;
+    (void)vlen;
+    _ls_bloom_add((ls_bloom_t *)ud, k, klen);
+    return 0;
+}
+
+int _ls_bloom_open(po_logstore_t *ls, size_t min_keys) {
+    size_t stored = 0;
+    if (db_count(ls->idx, &stored) != 0)
+        return -1;
+    if (min_keys == 0)
+        min_keys = LS_BLOOM_MIN_KEYS;
+    size_t keys = stored * 2 > min_keys ? stored * 2 : min_keys;
+    ls->bloom = bloom_create(keys);
+    if (!ls->bloom) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+void _ls_bloom_close(po_logstore_t *ls) {
+    bloom_destroy(ls->bloom_next);
+    ls->bloom_next = NULL;
+    bloom_destroy(ls->bloom);
+    ls->bloom = NULL;
+}
+
+void _ls_bloom_note_key(po_logstore_t *ls, const void *key, size_t klen) {
+    if (ls->bloom)
+        _ls_bloom_add(ls->bloom, key, klen);
+    if (ls->bloom_next)
+        _ls_bloom_add(ls->bloom_next, key, klen);
+}
+
+void _ls_bloom_note(po_logstore_t *ls, append_req_t **reqs, size_t n) {
+    pthread_rwlock_rdlock(&ls->idx_lock);
+    for (size_t i = 0; i < n; i++)
+        _ls_bloom_note_key(ls, reqs[i]->k, reqs[i]->klen);
+    pthread_rwlock_unlock(&ls->idx_lock);
+}
+
+int _ls_bloom_grow_if_full(po_logstore_t *ls) {
+    ls_bloom_t *old = ls->bloom; // only replaced under idx_mu, which we hold
+    if (!old || ls->bloom_next ||
+        atomic_load_explicit(&old->keys, memory_order_relaxed) <= old->capacity)
+        return 0;
+    ls_bloom_t *grown = bloom_create(old->capacity * 2);
+    if (!grown) {
+        // Still correct, only less selective: try again at twice the keys
+        old->capacity *= 2;
+        LOG_WARN("logstore: Bloom filter rebuild failed (errno=%d)", ENOMEM);
+        return 0;
+    }
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    ls->bloom_next = grown;
+    pthread_rwlock_unlock(&ls->idx_lock);
+    return 1;
+}
+
+void _ls_bloom_rebuild(po_logstore_t *ls) {
+    // Nobody else replaces bloom_next while it is pending; notes only OR bits in
+    ls_bloom_t *grown = ls->bloom_next;
+    int rc = db_iterate(ls->idx, add_cb, grown);
+    int err = errno;
+
+    pthread_mutex_lock(&ls->idx_mu);
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    ls_bloom_t *drop = grown;
+    if (rc == 0) {
+        drop = ls->bloom;
+        ls->bloom = grown;
+    } else {
+        ls->bloom->capacity *= 2;
+    }
+    ls->bloom_next = NULL;
+    pthread_rwlock_unlock(&ls->idx_lock);
+    pthread_mutex_unlock(&ls->idx_mu);
+    bloom_destroy(drop);
+    if (rc == 0)
+        PO_METRIC_COUNTER_INC("logstore.bloom.grow");
+    else
+        LOG_WARN("logstore: Bloom filter rebuild failed (errno=%d)", err);
+}
+
+int po_logstore_get_bloom_stats(po_logstore_t *ls, po_logstore_bloom_stats *out) {
+    if (!ls || !out) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    pthread_rwlock_rdlock(&ls->idx_lock);
+    if (ls->bloom) {
+        out->bytes = ls->bloom->nblocks * LS_BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+        out->keys = atomic_load_explicit(&ls->bloom->keys, memory_order_relaxed);
+    }
+    pthread_rwlock_unlock(&ls->idx_lock);
+    out->definite_misses = atomic_load(&ls->bloom_negatives);
+    out->false_positives = atomic_load(&ls->bloom_false_pos);
+    uint64_t probes = out->definite_misses + out->false_positives;
+    out->fp_rate = probes ? (double)out->false_positives / (double)probes : 0.0;
+    return 0;
+}
@@ -0,0 +1,391 @@
+/**
+ * @file logstore_compact.c
+ * @brief Background compaction of sealed log segments.
+ *
+ * A sealed segment whose dead share (bytes of records shadowed by newer
+ * versions) reaches the configured threshold is read sequentially in chunks.
+ * Records the index still points at are appended to the active segment and
+ * their index entries repointed in one LMDB commit; once the whole segment is
+ * processed and the copies are fsynced, the file is unlinked.
+ *
+ * Each chunk is checked and copied under tail_lock and idx_mu, so no newer
+ * version of a key can be written between the liveness check and the index
+ * swap, and the copies land in the log after every older version
+ * (rebuild-by-scan keeps picking the latest). Chunk reads are paced to
+ * compact_rate_bytes per second so flush workers only ever wait for one chunk.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+
+#define LS_COMPACT_CHUNK (64u * 1024u)
+#define LS_COMPACT_DEFAULT_PCT 50u
+#define LS_COMPACT_DEFAULT_RATE (8ull * 1024 * 1024) // bytes/s
+#define LS_COMPACT_DEFAULT_INTERVAL_MS 100u
+
+typedef struct {
+    uint64_t old_loc; // location in the victim segment
+    uint32_t kl;
+    uint32_t vl;
+    size_t at; // key start in the chunk buffer, then record start in the output
+} compact_rec_t;
+
+// Sleep up to @p ns; returns 0 if the compactor was asked to stop meanwhile.
+static int compact_sleep(po_logstore_t *ls, uint64_t ns) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t t = (uint64_t)deadline.tv_nsec + ns;
+    deadline.tv_sec += (time_t)(t / 1000000000ull);
+    deadline.tv_nsec = (long)(t % 1000000000ull);
+
+    pthread_mutex_lock(&ls->compact_mu);
+    while (ls->compact_run) {
+        if (pthread_cond_timedwait(&ls->compact_cv, &ls->compact_mu, &deadline) == ETIMEDOUT)
+            break;
+    }
+    int run = ls->compact_run;
+    pthread_mutex_unlock(&ls->compact_mu);
+    return run;
+}
+
+static int compact_stopping(po_logstore_t *ls) {
+    pthread_mutex_lock(&ls->compact_mu);
+    int stop = ls->background_compact && !ls->compact_run;
+    pthread_mutex_unlock(&ls->compact_mu);
+    return stop;
+}
+
+// Current index location of a key (memory index, LMDB on a miss).
+static int lookup_loc(po_logstore_t *ls, const void *key, size_t klen, uint64_t *loc) {
+    uint32_t len;
+    pthread_rwlock_rdlock(&ls->idx_lock);
+    int rc = po_index_get(ls->mem_idx, key, klen, loc, &len);
+    pthread_rwlock_unlock(&ls->idx_lock);
+    if (rc == 0)
+        return 0;
+
+    void *iv = NULL;
+    size_t ivlen = 0;
+    if (db_get(ls->idx, key, klen, &iv, &ivlen) != 0)
+        return -1;
+    rc = ivlen == 12 ? 0 : -1;
+    if (rc == 0)
+        memcpy(loc, iv, 8);
+    free(iv);
+    return rc;
+}
+
+// Copy the still-live records of one parsed chunk to the active segment and
+// repoint the index. Copies get a fresh v2 header (new sequence number, so the
+// log stays in sequence order for recovery) assembled in @p out, which holds
+// at least the v2 size of every record in the chunk.
+static int copy_chunk(po_logstore_t *ls, const uint8_t *buf, compact_rec_t *recs, size_t nrec,
+                      uint8_t *out, db_kv_t *kvs, uint8_t (*ivs)[12], uint64_t *copied) {
+    pthread_mutex_lock(&ls->tail_lock);
+    // With flush writes in flight, newer versions of these keys could be
+    // published and indexed after the liveness check: let them land first.
+    _ls_tail_quiesce(ls);
+    pthread_mutex_lock(&ls->idx_mu);
+    _ls_index_turn(ls, ls->resv_next);
+
+    size_t live = 0, packed = 0;
+    for (size_t i = 0; i < nrec; i++) {
+        uint64_t loc;
+        const uint8_t *key = buf + recs[i].at;
+        if (lookup_loc(ls, key, recs[i].kl, &loc) != 0 || loc != recs[i].old_loc)
+            continue; // shadowed or deleted
+        ls_rec_hdr_t hdr;
+        _ls_rec_encode(&hdr, ls->next_seq++, LS_REC_F_COMPACTED, key, recs[i].kl,
+                       key + recs[i].kl, recs[i].vl);
+        memcpy(out + packed, &hdr, sizeof(hdr));
+        memcpy(out + packed + sizeof(hdr), key, (size_t)recs[i].kl + recs[i].vl);
+        recs[live] = recs[i];
+        recs[live].at = packed;
+        packed += (size_t)LS_REC_SIZE(recs[i].kl, recs[i].vl);
+        live++;
+    }
+    if (live == 0) {
+        pthread_mutex_unlock(&ls->idx_mu);
+        pthread_mutex_unlock(&ls->tail_lock);
+        return 0;
+    }
+
+    // Nothing is in flight, so the reservation is next in turn and neither it
+    // nor the publication gives up tail_lock (or waits for its index turn).
+    ls_resv_t r;
+    _ls_tail_reserve(ls, packed, &r);
+    ls_segment_t *act = r.seg;
+    uint64_t base = r.off;
+    size_t done = 0;
+    while (done < packed) {
+        ssize_t w = pwrite(act->fd, out + done, packed - done, (off_t)(base + done));
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            break;
+        done += (size_t)w;
+    }
+    if (!_ls_tail_publish(ls, &r, done == packed)) {
+        _ls_index_turn_done(ls);
+        pthread_mutex_unlock(&ls->idx_mu);
+        pthread_mutex_unlock(&ls->tail_lock);
+        LOG_ERROR("logstore: compaction write to segment %u failed", act->id);
+        return -1;
+    }
+
+    for (size_t i = 0; i < live; i++) {
+        uint64_t loc = LS_LOC(act->id, base + recs[i].at);
+        memcpy(ivs[i], &loc, 8);
+        memcpy(ivs[i] + 8, &recs[i].vl, 4);
+        kvs[i] = (db_kv_t){out + recs[i].at + LS_REC_HDR_SIZE, recs[i].kl, ivs[i], 12};
+    }
+    int rc = _ls_index_commit(ls, kvs, live, LS_LOC(act->id, base + packed), ls->next_seq);
+    if (rc != 0) {
+        // Index still points at the victim: the copies are just dead bytes.
+        _ls_index_turn_done(ls);
+        pthread_mutex_unlock(&ls->idx_mu);
+        pthread_mutex_unlock(&ls->tail_lock);
+        LOG_ERROR("logstore: compaction index commit failed (errno=%d)", errno);
+        return -1;
+    }
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    for (size_t i = 0; i < live; i++) {
+        uint64_t loc;
+        memcpy(&loc, ivs[i], 8);
+        (void)po_index_put(ls->mem_idx, kvs[i].key, recs[i].kl, loc, recs[i].vl);
+    }
+    pthread_rwlock_unlock(&ls->idx_lock);
+    _ls_index_turn_done(ls);
+    pthread_mutex_unlock(&ls->idx_mu);
+    pthread_mutex_unlock(&ls->tail_lock);
+
+    *copied += packed;
+    return 0;
+}
+
+int _ls_compact_segment(po_logstore_t *ls, uint32_t id, int throttle) {
+    uint64_t end;
+    if (_ls_segment_size(ls, id, &end) != 0)
+        return -1;
+
+    size_t cap = LS_COMPACT_CHUNK;
+    size_t max_recs = cap / LS_REC_V1_HDR_SIZE + 1;
+    uint8_t *buf = malloc(cap);
+    uint8_t *out = NULL;
+    size_t out_cap = 0;
+    compact_rec_t *recs = malloc(max_recs * sizeof(*recs));
+    db_kv_t *kvs = malloc(max_recs * sizeof(*kvs));
+    uint8_t(*ivs)[12] = malloc(max_recs * sizeof(*ivs));
+    int rc = -1;
+    if (!buf || !recs || !kvs || !ivs)
+        goto out;
+
+    uint64_t pos = 0, copied = 0;
+    while (pos < end) {
+        if (compact_stopping(ls))
+            goto out;
+        uint64_t t0 = _ls_now_ns();
+        size_t want = end - pos < cap ? (size_t)(end - pos) : cap;
+        ssize_t n = _ls_pread(ls, buf, want, LS_LOC(id, pos));
+        if (n <= 0)
+            goto out;
+
+        size_t at = 0, nrec = 0, need = 0, big = 0;
+        int torn = 0;
+        while (at < (size_t)n && nrec < max_recs) {
+            ls_rec_t r;
+            size_t left = (size_t)n - at;
+            if (_ls_rec_decode(buf + at, left, &r) != 0) {
+                if (left < LS_REC_HDR_SIZE && pos + at + left == end)
+                    torn = 1; // header cut short at the end of the segment
+                else if (left >= LS_REC_HDR_SIZE) {
+                    LOG_WARN("logstore: segment %u corrupt at %lu; not compacting", id,
+                             (unsigned long)(pos + at));
+                    goto out;
+                }
+                break; // header straddles the chunk boundary
+            }
+            size_t rs = r.hdr_size + (size_t)r.klen + r.vlen;
+            if (at + rs > (size_t)n) {
+                if (pos + at + rs > end)
+                    torn = 1;
+                else
+                    big = rs;
+                break;
+            }
+            if (_ls_rec_verify(&r, buf + at, buf + at + r.hdr_size) != 0) {
+                LOG_WARN("logstore: segment %u record at %lu fails its checksum; not compacting",
+                         id, (unsigned long)(pos + at));
+                goto out;
+            }
+            recs[nrec++] = (compact_rec_t){LS_LOC(id, pos + at), r.klen, r.vlen, at + r.hdr_size};
+            need += (size_t)LS_REC_SIZE(r.klen, r.vlen);
+            at += rs;
+        }
+
+        if (nrec == 0) {
+            if (torn)
+                break; // torn tail: nothing live past here
+            if (!big)
+                goto out; // short read: retry on the next run
+            uint8_t *grown = realloc(buf, big); // record larger than the chunk
+            if (!grown)
+                goto out;
+            buf = grown;
+            cap = big;
+            continue;
+        }
+
+        if (need > out_cap) {
+            uint8_t *grown = realloc(out, need);
+            if (!grown)
+                goto out;
+            out = grown;
+            out_cap = need;
+        }
+        if (copy_chunk(ls, buf, recs, nrec, out, kvs, ivs, &copied) != 0)
+            goto out;
+        pos += at;
+        if (torn)
+            break;
+
+        if (throttle && ls->compact_rate_bytes) {
+            uint64_t budget = (uint64_t)at * 1000000000ull / ls->compact_rate_bytes;
+            uint64_t spent = _ls_now_ns() - t0;
+            if (spent < budget && !compact_sleep(ls, budget - spent))
+                goto out;
+        }
+    }
+
+    // The copies, and the entry of a segment they rolled into, must be durable
+    // before the only other copy disappears.
+    if (_ls_fsync_active(ls) != 0 || _ls_settle_dir(ls) != 0) {
+        LOG_ERROR("logstore: cannot settle copies of segment %u; keeping it", id);
+        goto out;
+    }
+    pthread_mutex_lock(&ls->tail_lock);
+    rc = _ls_segment_drop(ls, id);
+    pthread_mutex_unlock(&ls->tail_lock);
+    if (rc == 0) {
+        uint64_t reclaimed = end > copied ? end - copied : 0;
+        atomic_fetch_add(&ls->compact_runs, 1);
+        atomic_fetch_add(&ls->compact_copied, copied);
+        atomic_fetch_add(&ls->compact_reclaimed, reclaimed);
+        PO_METRIC_COUNTER_INC("logstore.compact.runs");
+        PO_METRIC_COUNTER_ADD("logstore.compact.copied_bytes", copied);
+        PO_METRIC_COUNTER_ADD("logstore.compact.reclaimed_bytes", reclaimed);
+        LOG_INFO("logstore: compacted segment %u: %lu bytes, %lu live copied, %lu reclaimed", id,
+                 (unsigned long)end, (unsigned long)copied, (unsigned long)reclaimed);
+    }
+
+out:
+    free(ivs);
+    free(kvs);
+    free(recs);
+    free(out);
+    free(buf);
+    return rc;
+}
+
+// Sealed segment with the highest dead share at or above @p min_pct.
+static int pick_victim(po_logstore_t *ls, unsigned min_pct, uint32_t *out_id,
+                       uint64_t *out_dead_pct) {
+    int found = 0;
+    uint64_t best = 0;
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    for (size_t i = 0; i + 1 < ls->nsegs; i++) {
+        uint64_t size = atomic_load(&ls->segs[i]->size);
+        uint64_t dead = atomic_load(&ls->segs[i]->dead);
+        uint64_t pct = size ? (dead >= size ? 100 : dead * 100 / size) : 100;
+        if (pct >= min_pct && (!found || pct > best)) {
+            found = 1;
+            best = pct;
+            *out_id = ls->segs[i]->id;
+        }
+    }
+    pthread_rwlock_unlock(&ls->seg_lock);
+    *out_dead_pct = best;
+    return found ? 0 : -1;
+}
+
+static void *_ls_compact_thread_main(void *arg) {
+    po_logstore_t *ls = (po_logstore_t *)arg;
+    while (compact_sleep(ls, ls->compact_interval_ns)) {
+        uint32_t id;
+        uint64_t pct;
+        pthread_mutex_lock(&ls->compact_busy);
+        while (pick_victim(ls, ls->compact_min_dead_pct, &id, &pct) == 0) {
+            PO_METRIC_HISTO_RECORD("logstore.compact.dead_pct", pct);
+            if (_ls_compact_segment(ls, id, 1) != 0)
+                break; // retry on the next interval
+        }
+        pthread_mutex_unlock(&ls->compact_busy);
+    }
+    return NULL;
+}
+
+int _ls_compactor_start(po_logstore_t *ls, const po_logstore_cfg *cfg) {
+    ls->compact_min_dead_pct =
+        cfg->compact_min_dead_pct ? cfg->compact_min_dead_pct : LS_COMPACT_DEFAULT_PCT;
+    ls->compact_rate_bytes = cfg->compact_rate_bytes ? cfg->compact_rate_bytes
+                                                     : LS_COMPACT_DEFAULT_RATE;
+    ls->compact_interval_ns =
+        (uint64_t)(cfg->compact_interval_ms ? cfg->compact_interval_ms
+                                            : LS_COMPACT_DEFAULT_INTERVAL_MS) *
+        1000000ull;
+    if (!cfg->background_compact || !ls->segment_bytes)
+        return 0;
+
+    PO_METRIC_HISTO_CREATE_HDR("logstore.compact.dead_pct");
+    ls->compact_run = 1;
+    ls->background_compact = 1;
+    if (pthread_create(&ls->compact_thread, NULL, _ls_compact_thread_main, ls) != 0) {
+        ls->compact_run = 0;
+        ls->background_compact = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void _ls_compactor_stop(po_logstore_t *ls) {
+    if (!ls->background_compact)
+        return;
+    pthread_mutex_lock(&ls->compact_mu);
+    ls->compact_run = 0;
+    pthread_cond_broadcast(&ls->compact_cv);
+    pthread_mutex_unlock(&ls->compact_mu);
+    pthread_join(ls->compact_thread, NULL);
+    ls->background_compact = 0;
+}
+
+int po_logstore_compact(po_logstore_t *ls, unsigned min_dead_pct) {
+    if (!ls) {
+        errno = EINVAL;
+        return -1;
+    }
+    int compacted = 0;
+    uint32_t id;
+    uint64_t pct;
+    pthread_mutex_lock(&ls->compact_busy);
+    while (pick_victim(ls, min_dead_pct, &id, &pct) == 0) {
+        if (_ls_compact_segment(ls, id, 0) != 0) {
+            if (!compacted)
+                compacted = -1;
+            break;
+        }
+        compacted++;
+    }
+    pthread_mutex_unlock(&ls->compact_busy);
+    return compacted;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file logstore_durable.c
+ * @brief Group commit: durability tickets for po_logstore_append_async().
+ *
+ * Every async append carries a ticket, handed out in increasing order when
+ * the request is queued. Workers mark tickets as written under tail_lock and
+ * keep `gc_written`, the highest ticket below which every ticket is written
+ * (tickets can be written out of order: a producer may queue after a later
+ * ticket, and workers race for the tail). A sync that starts after a marking
+ * makes everything up to the `gc_written` value seen then durable, so one
+ * fsync releases every waiter at or below it: a batch holding any ticket is
+ * always followed by a sync, and producers that queue while it runs share
+ * the next one. When a roll created a segment file since the last sync, that
+ * sync also fsyncs the directory before publishing, so a record in the fresh
+ * file is not reported durable while its directory entry could still be lost.
+ *
+ * Marks past `gc_written` live in a ring of bits indexed by ticket, grown when
+ * a mark lands further ahead than it covers.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log/logger.h"
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+
+#define LS_GC_BITS_MIN 4096u
+
+int _ls_gc_init(po_logstore_t *ls) {
+    ls->gc_bits_len = LS_GC_BITS_MIN;
+    ls->gc_bits = calloc(ls->gc_bits_len / 64, sizeof(uint64_t));
+    if (!ls->gc_bits)
+        return -1;
+    pthread_mutex_init(&ls->gc_mu, NULL);
+    pthread_cond_init(&ls->gc_cv, NULL);
+    return 0;
+}
+
+void _ls_gc_destroy(po_logstore_t *ls) {
+    if (!ls->gc_bits)
+        return;
+    free(ls->gc_bits);
+    ls->gc_bits = NULL;
+    pthread_mutex_destroy(&ls->gc_mu);
+    pthread_cond_destroy(&ls->gc_cv);
+}
+
+static int bit_get(const uint64_t *bits, size_t len, uint64_t t) {
+    size_t i = (size_t)(t & (len - 1));
+    return (int)((bits[i / 64] >> (i % 64)) & 1u);
+}
+
+static void bit_put(uint64_t *bits, size_t len, uint64_t t, int on) {
+    size_t i = (size_t)(t & (len - 1));
+    if (on)
+        bits[i / 64] |= UINT64_C(1) << (i % 64);
+    else
+        bits[i / 64] &= ~(UINT64_C(1) << (i % 64));
+}
+
+// Re-home the marks for (gc_written, gc_written + old len] in a ring covering
+// at least @p span tickets.
+static int grow(po_logstore_t *ls, uint64_t span) {
+    size_t len = ls->gc_bits_len;
+    while (len < span)
+        len *= 2;
+    uint64_t *bits = calloc(len / 64, sizeof(uint64_t));
+    if (!bits)
+        return -1;
+    for (uint64_t t = ls->gc_written + 1; t <= ls->gc_written + ls->gc_bits_len; t++) {
+        if (bit_get(ls->gc_bits, ls->gc_bits_len, t))
+            bit_put(bits, len, t, 1);
+    }
+    free(ls->gc_bits);
+    ls->gc_bits = bits;
+    ls->gc_bits_len = len;
+    return 0;
+}
+
+// Lower the failure watermark to @p ticket (every ticket from it on fails).
+static void fail_from(po_logstore_t *ls, uint64_t ticket) {
+    uint64_t cur = atomic_load(&ls->gc_failed_from);
+    while ((cur == 0 || ticket < cur) &&
+           !atomic_compare_exchange_weak(&ls->gc_failed_from, &cur, ticket)) {
+    }
+}
+
+static void wake(po_logstore_t *ls) {
+    if (atomic_load(&ls->gc_waiters) == 0)
+        return;
+    pthread_mutex_lock(&ls->gc_mu);
+    pthread_cond_broadcast(&ls->gc_cv);
+    pthread_mutex_unlock(&ls->gc_mu);
+}
+
+void _ls_gc_mark(po_logstore_t *ls, uint64_t ticket, int written) {
+    if (ticket == 0)
+        return; // plain append
+    if (!written) {
+        fail_from(ls, ticket);
+        wake(ls);
+    }
+    if (ticket <= ls->gc_written)
+        return;
+    if (ticket - ls->gc_written > ls->gc_bits_len &&
+        grow(ls, 2 * (ticket - ls->gc_written)) != 0) {
+        // Without room to record the mark the frontier could never pass it
+        LOG_ERROR("logstore: group commit ticket window exhausted at %llu",
+                  (unsigned long long)ticket);
+        fail_from(ls, ls->gc_written + 1);
+        wake(ls);
+        return;
+    }
+    bit_put(ls->gc_bits, ls->gc_bits_len, ticket, 1);
+    while (bit_get(ls->gc_bits, ls->gc_bits_len, ls->gc_written + 1)) {
+        bit_put(ls->gc_bits, ls->gc_bits_len, ls->gc_written + 1, 0);
+        ls->gc_written++;
+    }
+}
+
+void _ls_gc_durable(po_logstore_t *ls, uint64_t upto) {
+    uint64_t cur = atomic_load(&ls->gc_durable);
+    while (upto > cur && !atomic_compare_exchange_weak(&ls->gc_durable, &cur, upto)) {
+    }
+    if (upto > cur) {
+        PO_METRIC_COUNTER_INC("logstore.durable.group_syncs");
+        wake(ls);
+    }
+}
+
+void _ls_gc_sync_failed(po_logstore_t *ls) {
+    // Dirty pages may be gone after a failed sync: nothing past the durable
+    // frontier can be promised any more.
+    fail_from(ls, atomic_load(&ls->gc_durable) + 1);
+    wake(ls);
+}
+
+// 0: durable, 1: pending, -1: failed (errno = EIO)
+static int ticket_state(po_logstore_t *ls, uint64_t ticket) {
+    uint64_t failed = atomic_load(&ls->gc_failed_from);
+    if (failed != 0 && ticket >= failed) {
+        errno = EIO;
+        return -1;
+    }
+    return atomic_load(&ls->gc_durable) >= ticket ? 0 : 1;
+}
+
+int po_logstore_wait_durable(po_logstore_t *ls, po_logstore_token token, int timeout_ms) {
+    if (!ls || token == 0 || token > atomic_load(&ls->gc_next_ticket)) {
+        errno = EINVAL;
+        return -1;
+    }
+    int st = ticket_state(ls, token);
+    if (st <= 0)
+        return st;
+
+    PO_METRIC_COUNTER_INC("logstore.durable.waits");
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t t = (uint64_t)deadline.tv_nsec + (uint64_t)timeout_ms * UINT64_C(1000000);
+        deadline.tv_sec += (time_t)(t / 1000000000ull);
+        deadline.tv_nsec = (long)(t % 1000000000ull);
+    }
+    pthread_mutex_lock(&ls->gc_mu);
+    atomic_fetch_add(&ls->gc_waiters, 1);
+    while ((st = ticket_state(ls, token)) == 1) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&ls->gc_cv, &ls->gc_mu);
+        } else if (pthread_cond_timedwait(&ls->gc_cv, &ls->gc_mu, &deadline) == ETIMEDOUT) {
+            if ((st = ticket_state(ls, token)) == 1) {
+                PO_METRIC_COUNTER_INC("logstore.durable.timeouts");
+                errno = ETIMEDOUT;
+                st = -1;
+            }
+            break;
+        }
+    }
+    atomic_fetch_sub(&ls->gc_waiters, 1);
+    pthread_mutex_unlock(&ls->gc_mu);
+    return st;
+}
@@ -13,99 +13,74 @@ struct scan_ud {
     po_logstore_t *ls;
     int prune;
     po_logstore_integrity_stats *st;
-    off_t end;
 };
 
+static void _prune(struct scan_ud *s, const void *k, size_t klen) {
+    if (!s->prune)
+        return;
+    (void)db_delete(s->ls->idx, k, klen);
+
+    pthread_rwlock_wrlock(&s->ls->idx_lock);
+    (void)po_index_remove(s->ls->mem_idx, k, klen);
+    pthread_rwlock_unlock(&s->ls->idx_lock);
+
+    s->st->pruned++;
+}
+
 static int _integrity_cb(const void *k, size_t klen, const void *v, size_t vlen, void *pud) {
-    (void)klen;
     struct scan_ud *s = (struct scan_ud *)pud;
 
-    uint64_t off;
+    uint64_t loc;
     uint32_t len;
-    uint32_t kl_real;
-    uint32_t vl_real;
     s->st->scanned++;
     if (vlen != 12) {
         s->st->errors++;
         return 0;
     }
 
-    memcpy(&off, v, 8);
+    memcpy(&loc, v, 8);
     memcpy(&len, (const uint8_t *)v + 8, 4);
-    if (off + sizeof(uint32_t) * 2 > (uint64_t)s->end) {
-        if (s->prune) {
-            (void)db_delete(s->ls->idx, k, klen);
-
-            pthread_rwlock_wrlock(&s->ls->idx_lock);
-            (void)po_index_remove(s->ls->mem_idx, k, klen);
-            pthread_rwlock_unlock(&s->ls->idx_lock);
-
-            s->st->pruned++;
-        }
-
+    // Offsets below are relative to the record's segment; end = 0 if it is gone
+    uint64_t end = 0;
+    (void)_ls_segment_size(s->ls, LS_LOC_SEG(loc), &end);
+    uint64_t off = LS_LOC_OFF(loc);
+    if (off + LS_REC_V1_HDR_SIZE > end) {
+        _prune(s, k, klen);
         return 0;
     }
 
-    if (pread(s->ls->fd, &kl_real, sizeof(kl_real), (off_t)off) != (ssize_t)sizeof(kl_real) ||
-        pread(s->ls->fd, &vl_real, sizeof(vl_real), (off_t)(off + sizeof(uint32_t))) !=
-            (ssize_t)sizeof(vl_real)) {
+    uint8_t hdr[LS_REC_HDR_SIZE];
+    ls_rec_t r;
+    ssize_t rd = _ls_pread(s->ls, hdr, sizeof(hdr), loc);
+    if (rd < 0) {
         s->st->errors++;
         return 0;
     }
-
-    if (off + sizeof(uint32_t) * 2 + kl_real + vl_real > (uint64_t)s->end) {
-        if (s->prune) {
-            (void)db_delete(s->ls->idx, k, klen);
-
-            pthread_rwlock_wrlock(&s->ls->idx_lock);
-            (void)po_index_remove(s->ls->mem_idx, k, klen);
-            pthread_rwlock_unlock(&s->ls->idx_lock);
-
-            s->st->pruned++;
-        }
-
+    if (_ls_rec_decode(hdr, (size_t)rd, &r) != 0 ||
+        off + r.hdr_size + r.klen + r.vlen > end || r.klen != klen || r.vlen != len) {
+        _prune(s, k, klen);
         return 0;
     }
 
-    if (kl_real != klen) {
-        if (s->prune) {
-            (void)db_delete(s->ls->idx, k, klen);
-
-            pthread_rwlock_wrlock(&s->ls->idx_lock);
-            (void)po_index_remove(s->ls->mem_idx, k, klen);
-            pthread_rwlock_unlock(&s->ls->idx_lock);
-
-            s->st->pruned++;
-        }
-
-        return 0;
-    }
-
-    void *kbuf = malloc(kl_real);
-    if (!kbuf) {
+    size_t body = (size_t)r.klen + r.vlen;
+    uint8_t *kv = malloc(body);
+    if (!kv) {
         s->st->errors++;
         return 0;
     }
-
-    if (pread(s->ls->fd, kbuf, kl_real, (off_t)(off + sizeof(uint32_t) * 2)) != (ssize_t)kl_real) {
-        free(kbuf);
+    if (_ls_pread(s->ls, kv, body, loc + r.hdr_size) != (ssize_t)body) {
+        free(kv);
         s->st->errors++;
         return 0;
     }
 
-    int key_match = (memcmp(kbuf, k, kl_real) == 0);
-    free(kbuf);
-    if (!key_match || vl_real != len) {
-        if (s->prune) {
-            (void)db_delete(s->ls->idx, k, klen);
-
-            pthread_rwlock_wrlock(&s->ls->idx_lock);
-            (void)po_index_remove(s->ls->mem_idx, k, klen);
-            pthread_rwlock_unlock(&s->ls->idx_lock);
-
-            s->st->pruned++;
-        }
-
+    int key_match = memcmp(kv, k, klen) == 0;
+    int crc_ok = _ls_rec_verify(&r, hdr, kv) == 0;
+    free(kv);
+    if (!crc_ok)
+        s->st->errors++; // corrupt data, not just a stale entry
+    if (!key_match || !crc_ok) {
+        _prune(s, k, klen);
         return 0;
     }
 
@@ -119,11 +94,7 @@ int _ls_integrity_scan(po_logstore_t *ls, int prune_nonexistent,
         return -1;
 
     po_logstore_integrity_stats stats = {0};
-    off_t end = lseek(ls->fd, 0, SEEK_END);
-    if (end < 0)
-        return -1;
-
-    struct scan_ud ud = {ls, prune_nonexistent, &stats, end};
+    struct scan_ud ud = {ls, prune_nonexistent, &stats};
     (void)db_iterate(ls->idx, _integrity_cb, &ud);
 
     if (out_stats)
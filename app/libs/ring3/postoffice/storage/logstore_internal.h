@@ -20,6 +20,7 @@ extern "C" {
 #include <stdatomic.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "perf/batcher.h"
 #include "perf/cache.h"
@@ -32,19 +33,117 @@ extern "C" {
 #define LS_HARD_KEY_MAX (32u * 1024u * 1024u)    /* 32 MiB */
 #define LS_HARD_VALUE_MAX (128u * 1024u * 1024u) /* 128 MiB */
 
+// Record format v2: a 32-byte header followed by key and value bytes.
+//   u32 magic | u32 crc32c | u64 seq | u32 key_len | u32 val_len | u8 flags | 7 reserved (0)
+// The CRC covers header bytes 8..31, the key and the value. Version 1 records
+// are a bare [u32 key_len][u32 val_len] header; since key_len never exceeds
+// LS_HARD_KEY_MAX, a leading magic word cannot be mistaken for one.
+#define LS_REC_MAGIC 0x32524F50u // "POR2" little-endian
+#define LS_REC_HDR_SIZE 32u
+#define LS_REC_V1_HDR_SIZE (2u * sizeof(uint32_t))
+#define LS_REC_SIZE(kl, vl) ((uint64_t)LS_REC_HDR_SIZE + (uint64_t)(kl) + (uint64_t)(vl))
+#define LS_REC_CRC_FROM 8u // first header byte covered by the CRC
+
+// Record flags
+#define LS_REC_F_COMPACTED 0x01u // rewritten by compaction (seq is the copy's)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;
+    uint64_t seq;
+    uint32_t klen;
+    uint32_t vlen;
+    uint8_t flags;
+    uint8_t reserved[7];
+} ls_rec_hdr_t;
+
+_Static_assert(sizeof(ls_rec_hdr_t) == LS_REC_HDR_SIZE, "v2 record header must be 32 bytes");
+
+// Decoded header of either version.
+typedef struct {
+    unsigned version;  // 1 or 2
+    uint32_t hdr_size; // bytes before the key
+    uint32_t klen;
+    uint32_t vlen;
+    uint64_t seq;      // 0 for v1
+    uint8_t flags;     // 0 for v1
+    uint32_t crc;      // stored checksum (v2)
+} ls_rec_t;
+
+// Record locations stored in the index pack the segment id above a 40-bit file
+// offset (1 TiB per segment). Segment 0 is the legacy single aof.log, so its
+// locations are plain file offsets.
+#define LS_LOC_SEG_SHIFT 40
+#define LS_LOC(seg, off) (((uint64_t)(seg) << LS_LOC_SEG_SHIFT) | (uint64_t)(off))
+#define LS_LOC_SEG(loc) ((uint32_t)((loc) >> LS_LOC_SEG_SHIFT))
+#define LS_LOC_OFF(loc) ((loc) & ((UINT64_C(1) << LS_LOC_SEG_SHIFT) - 1))
+
+// Read-only mapping of a segment for zero-copy views. The segment holds one
+// reference and every view another; the last release unmaps it, so views stay
+// valid after compaction unlinks the segment or the store is closed.
+typedef struct {
+    uint8_t *base;
+    size_t len; // may extend past EOF for the active segment; never read there
+    atomic_uint refs;
+} ls_map_t;
+
+// One data file. Sealed segments are immutable until the compactor unlinks
+// them; only the active (highest id) segment grows.
+typedef struct {
+    uint32_t id;
+    int fd;
+    atomic_uint_fast64_t size; // bytes published (readable, indexed); file size at open
+    atomic_uint_fast64_t dead; // bytes of records shadowed by newer versions
+    ls_map_t *map;             // current read mapping (mmap_reads), guarded by seg_lock
+    uint64_t tail;             // end of the reserved space (>= size), guarded by tail_lock
+    int poisoned;              // a failed write left a hole below tail, guarded by tail_lock
+} ls_segment_t;
+
+// A range of the active segment reserved by one writer. Ranges are reserved
+// under tail_lock, written without it (flush workers in parallel) and
+// published in reservation order, so size, the index and the checkpoint only
+// ever cover a gap-free prefix of the segment.
+typedef struct {
+    ls_segment_t *seg;
+    uint64_t off;
+    uint64_t len;
+    uint64_t turn; // publication order
+} ls_resv_t;
+
+// Split-block Bloom filter over every key in the LMDB index: a negative
+// answer is a definite miss, so lookups need not ask LMDB. Each key sets one
+// bit in each word of a single 64-byte block. Bits are set with atomic OR
+// under idx_lock held for reading; the filter is replaced (grown) under
+// idx_lock held for writing.
+#define LS_BLOOM_BLOCK_WORDS 8u
+typedef struct {
+    _Atomic uint64_t *words; // nblocks * LS_BLOOM_BLOCK_WORDS
+    size_t nblocks;          // power of two
+    size_t capacity;         // keys it is sized for; grown past this
+    atomic_size_t keys;      // adds that set a new bit (~distinct keys)
+} ls_bloom_t;
+
+// Per-worker io_uring ring (logstore_uring.c)
+typedef struct ls_uring ls_uring_t;
+
 // Internal append request
 typedef struct {
     void *k;
     size_t klen;
     void *v;
     size_t vlen;
+    uint64_t ticket; // group commit ticket (0: plain append)
 } append_req_t;
 
+// Shutdown wakeups are zeroed requests; real appends always carry a key.
+static inline int _ls_req_is_sentinel(const append_req_t *r) {
+    return r->k == NULL;
+}
+
 struct po_logstore {
     // ========================================================================
     // COLD FIELDS (rarely accessed after initialization)
     // ========================================================================
-    int fd;                                  // append-only file descriptor
     db_env_t *env;                           // LMDB environment
     db_bucket_t *idx;                        // LMDB bucket for index
     po_perf_ringbuf_t *q;                    // submission queue
@@ -52,10 +151,13 @@ struct po_logstore {
     pthread_t *workers;                      // flush worker thread(s)
     unsigned nworkers;                       // number of workers
     po_index_t *mem_idx;                     // fast path in-memory index
-    pthread_rwlock_t idx_lock;               // RW lock protecting mem_idx
+    pthread_rwlock_t idx_lock;               // RW lock protecting mem_idx and bloom
+    ls_bloom_t *bloom;                       // negative lookups (NULL: not built)
+    ls_bloom_t *bloom_next;                  // larger filter being filled (idx_mu + idx_lock)
+    atomic_uint_fast64_t bloom_negatives;    // lookups answered by the filter alone
+    atomic_uint_fast64_t bloom_false_pos;    // filter passed, LMDB had no entry
     size_t batch_size;                       // configured batch size
     po_logstore_fsync_policy_t fsync_policy; // durability policy
-    append_req_t *sentinel;                  // sentinel request for shutdown
     uint64_t fsync_interval_ns;              // interval (ns) for interval policy
     unsigned fsync_every_n;                  // threshold for EVERY_N policy
     int background_fsync;                    // background fsync thread enabled
@@ -64,13 +166,73 @@ struct po_logstore {
     size_t max_value_bytes;                  // configured max value size
     int never_overwrite; // if set, append returns -1 when full instead of retrying
 
+    // Segments (sorted by id; last = active). seg_lock guards the array and
+    // every fd in it. Writers of the active segment (flush workers, compactor)
+    // reserve ranges of it and publish them (size) under tail_lock in
+    // reservation order, then commit their index entries and the checkpoint
+    // under idx_mu in the same order, so index update order always matches
+    // the on-disk record order. Lock order: tail_lock, idx_mu, idx_lock.
+    char dir[256];                // data directory
+    int dir_fd;                   // open on dir, to fsync entry changes (-1: none)
+    atomic_uint dir_gen;          // bumped when a roll creates a segment file
+    atomic_uint dir_synced;       // dir_gen covered by the last directory fsync
+    pthread_mutex_t dir_mu;       // serialises directory fsyncs
+    ls_segment_t **segs;          // segment table
+    size_t nsegs;                 // segments in table
+    size_t segs_cap;              // table capacity
+    size_t segment_bytes;         // roll threshold (0 = single legacy aof.log)
+    int mmap_reads;               // serve views from read-only mappings
+    po_logstore_io_backend_t io_backend; // requested flush backend
+    atomic_uint uring_workers;           // workers that got an io_uring ring
+    pthread_rwlock_t seg_lock;    // guards segs/nsegs and segment fds
+    pthread_mutex_t tail_lock;    // serializes tail reservation and publication
+    uint64_t resv_next;           // turn of the next reservation (tail_lock)
+    uint64_t pub_next;            // turn allowed to publish next (tail_lock)
+    pthread_cond_t pub_cv;        // publishers and quiescers wait here with tail_lock
+    pthread_mutex_t idx_mu;       // serializes index commits (LMDB and mem_idx)
+    uint64_t idx_next;            // turn allowed to commit its index entries next (idx_mu)
+    pthread_cond_t idx_cv;        // committers wait here for their turn with idx_mu
+
+    // Recovery checkpoint: every record before it has its index entry in LMDB.
+    // next_seq is guarded by tail_lock, ckpt_stale by idx_mu.
+    db_bucket_t *meta;  // LMDB bucket holding the checkpoint
+    uint64_t next_seq;  // sequence number of the next record written
+    int ckpt_stale;     // an index commit failed: stop advancing the checkpoint
+
+    // Group commit (logstore_durable.c). gc_written and gc_bits are guarded
+    // by tail_lock; waiters sleep on gc_cv.
+    uint64_t gc_written;                    // every ticket <= this is written
+    uint64_t gc_settled;                    // gc_written at the last publication
+    uint64_t *gc_bits;                      // written marks past gc_written (ring of bits)
+    size_t gc_bits_len;                     // ring size in bits (power of two)
+    atomic_uint_fast64_t gc_durable;        // every ticket <= this is synced
+    atomic_uint_fast64_t gc_failed_from;    // first ticket that may be lost (0: none)
+    atomic_uint gc_waiters;                 // threads in po_logstore_wait_durable()
+    pthread_mutex_t gc_mu;
+    pthread_cond_t gc_cv;
+
+    // Background compaction (sealed segments only)
+    int background_compact;            // compactor thread started
+    pthread_t compact_thread;          // compactor thread
+    pthread_mutex_t compact_mu;        // guards compact_run for the timed wait
+    pthread_cond_t compact_cv;         // wakes the compactor early on close
+    pthread_mutex_t compact_busy;      // one compaction at a time
+    int compact_run;                   // compactor keep-running flag
+    unsigned compact_min_dead_pct;     // victim threshold (dead % of segment)
+    uint64_t compact_rate_bytes;       // I/O budget in bytes per second
+    uint64_t compact_interval_ns;      // pause between victim scans
+    atomic_uint_fast64_t compact_runs;        // segments compacted
+    atomic_uint_fast64_t compact_copied;      // live bytes rewritten
+    atomic_uint_fast64_t compact_reclaimed;   // bytes released by unlinking
+
     // ========================================================================
     // HOT FIELDS (frequently accessed, isolated on separate cache lines)
     // ========================================================================
 
     // Updated by producers (enqueue path)
-    atomic_uint_fast64_t seq; // sequence for logger sink keys
-    char _pad1[PO_CACHE_LINE_MAX - sizeof(atomic_uint_fast64_t)];
+    atomic_uint_fast64_t seq;            // sequence for logger sink keys
+    atomic_uint_fast64_t gc_next_ticket; // last group commit ticket handed out
+    char _pad1[PO_CACHE_LINE_MAX - 2 * sizeof(atomic_uint_fast64_t)];
 
     // Updated by workers (flush path)
     atomic_uint_fast64_t metric_batches_flushed;
@@ -89,9 +251,10 @@ struct po_logstore {
 
     // Control flags (read frequently, written rarely)
     atomic_int running;          // running flag
+    atomic_uint workers_live;    // flush workers not yet exited
     atomic_int worker_ready;     // at least one worker entered main loop
     atomic_int fsync_thread_run; // background fsync running flag
-    char _pad6[PO_CACHE_LINE_MAX - 3 * sizeof(_Atomic int)];
+    char _pad6[PO_CACHE_LINE_MAX - 3 * sizeof(_Atomic int) - sizeof(atomic_uint)];
 
     // Timing fields (updated by fsync thread)
     uint64_t last_fsync_ns;       // last fsync timestamp
@@ -113,6 +276,78 @@ static inline int _ls_validate_lengths(size_t klen, size_t vlen, size_t maxk, si
     return 0;
 }
 
+// Segments (logstore_segment.c)
+int _ls_segments_open(po_logstore_t *ls, const po_logstore_cfg *cfg);
+void _ls_segments_close(po_logstore_t *ls);
+ls_segment_t *_ls_active_segment(po_logstore_t *ls); // caller holds tail_lock
+void _ls_tail_reserve(po_logstore_t *ls, uint64_t len,
+                      ls_resv_t *out);       // caller holds tail_lock; may roll or wait
+int _ls_tail_publish(po_logstore_t *ls, const ls_resv_t *r,
+                     int wrote);             // caller holds tail_lock; 1: range is valid records
+void _ls_tail_quiesce(po_logstore_t *ls);    // caller holds tail_lock; waits out reservations
+void _ls_index_turn(po_logstore_t *ls, uint64_t turn); // caller holds idx_mu; waits for turn
+void _ls_index_turn_done(po_logstore_t *ls); // caller holds idx_mu; lets the next turn commit
+ssize_t _ls_pread(po_logstore_t *ls, void *buf, size_t n, uint64_t loc); // ENOENT: segment gone
+void _ls_fadvise_willneed(po_logstore_t *ls, uint64_t loc, uint64_t len); // best-effort readahead
+int _ls_segment_size(po_logstore_t *ls, uint32_t id, uint64_t *out);
+void _ls_note_dead(po_logstore_t *ls, uint64_t loc, uint64_t bytes);
+void _ls_reset_accounting(po_logstore_t *ls);                        // open: all bytes dead
+void _ls_note_live(po_logstore_t *ls, uint64_t loc, uint64_t bytes); // open: claim live record
+int _ls_fsync_active(po_logstore_t *ls);
+int _ls_sync_dir(po_logstore_t *ls); // make segment creates/renames/unlinks durable
+int _ls_settle_dir(po_logstore_t *ls); // sync the directory if a roll created a file since
+int _ls_segment_drop(po_logstore_t *ls, uint32_t id); // caller holds tail_lock; unlinks a sealed one
+const uint8_t *_ls_map_pin(po_logstore_t *ls, uint64_t loc, size_t *out_avail,
+                           ls_map_t **out_map); // mapped bytes at loc up to the written size
+void _ls_map_unpin(ls_map_t *map);
+
+// io_uring flush backend (logstore_uring.c)
+ls_uring_t *_ls_uring_open(po_logstore_t *ls); // NULL (errno) if io_uring is unavailable
+ssize_t _ls_uring_writev(ls_uring_t *u, int fd, const struct iovec *iov, unsigned cnt,
+                         uint64_t off, int sync,
+                         uint64_t durable_upto); // sync: link an fdatasync, not waited for
+int _ls_uring_sync_active(ls_uring_t *u,
+                          uint64_t durable_upto); // unlinked fdatasync of the active segment
+void _ls_uring_settle(ls_uring_t *u);             // waits for in-flight syncs
+void _ls_uring_close(ls_uring_t *u);              // settles, then frees
+
+// Group commit (logstore_durable.c)
+int _ls_gc_init(po_logstore_t *ls);
+void _ls_gc_destroy(po_logstore_t *ls);
+void _ls_gc_mark(po_logstore_t *ls, uint64_t ticket, int written); // caller holds tail_lock
+void _ls_gc_durable(po_logstore_t *ls, uint64_t upto); // tickets <= upto reached disk
+void _ls_gc_sync_failed(po_logstore_t *ls);
+
+// Negative-lookup filter (logstore_bloom.c)
+int _ls_bloom_open(po_logstore_t *ls, size_t min_keys); // sized from the LMDB entry count
+void _ls_bloom_close(po_logstore_t *ls);
+void _ls_bloom_add(ls_bloom_t *b, const void *key, size_t klen); // caller holds idx_lock
+int _ls_bloom_may_contain(const ls_bloom_t *b, const void *key,
+                          size_t klen);                     // caller holds idx_lock
+void _ls_bloom_note_key(po_logstore_t *ls, const void *key, size_t klen); // idx_lock held
+void _ls_bloom_note(po_logstore_t *ls, append_req_t **reqs, size_t n); // before indexing
+// Caller holds idx_mu. Once the filter is full, installs a larger one that
+// takes every new key and returns 1: fill it with _ls_bloom_rebuild() after
+// dropping idx_mu.
+int _ls_bloom_grow_if_full(po_logstore_t *ls);
+void _ls_bloom_rebuild(po_logstore_t *ls); // adds the LMDB keys, then swaps it in
+
+// Records (logstore_record.c)
+void _ls_rec_encode(ls_rec_hdr_t *h, uint64_t seq, uint8_t flags, const void *k, uint32_t kl,
+                    const void *v, uint32_t vl);
+int _ls_rec_decode(const void *buf, size_t n, ls_rec_t *out); // -1: not a record header
+int _ls_rec_verify(const ls_rec_t *r, const void *hdr, const void *kv); // kv: key then value
+
+// Recovery checkpoint (logstore_rebuild.c)
+int _ls_checkpoint_load(po_logstore_t *ls, uint64_t *out_loc, uint64_t *out_next_seq);
+int _ls_index_commit(po_logstore_t *ls, const db_kv_t *kvs, size_t n, uint64_t end_loc,
+                     uint64_t next_seq); // caller holds idx_mu; next_seq: after end_loc
+
+// Compaction (logstore_compact.c)
+int _ls_compactor_start(po_logstore_t *ls, const po_logstore_cfg *cfg);
+void _ls_compactor_stop(po_logstore_t *ls);
+int _ls_compact_segment(po_logstore_t *ls, uint32_t id, int throttle);
+
 uint64_t _ls_now_ns(void);                                              // time helper
 void *_ls_worker_main(void *arg);                                       // worker thread
 void *_ls_fsync_thread_main(void *arg);                                 // fsync thread
@@ -0,0 +1,342 @@
+/**
+ * @file logstore_scan.c
+ * @brief Ordered range and prefix scans over the LMDB index.
+ *
+ * The index is walked in key order one batch at a time, each batch in its own
+ * read transaction that resumes after the last key returned, so a scan never
+ * pins LMDB pages and holds at most one batch of records. A batch's values are
+ * fetched in log order rather than key order: record extents are sorted,
+ * merged into runs, announced with POSIX_FADV_WILLNEED and read with one pread
+ * per run. Records are then verified as by po_logstore_get() and handed out in
+ * key order.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+#include "utils/errors.h"
+
+#define LS_SCAN_BATCH 256u          // index entries per batch
+#define LS_SCAN_BYTES (1u << 20)    // record bytes per batch (at least one record)
+#define LS_SCAN_RUN_GAP (4u * 1024) // extents closer than this share one read
+
+typedef struct {
+    uint64_t loc;
+    uint32_t klen;
+    uint32_t vlen;
+    size_t key_at;  // in keys
+    size_t rec_at;  // record start in data
+    size_t rec_got; // bytes of the record read (0: not read)
+} scan_ent_t;
+
+typedef struct {
+    uint64_t start; // location of the first byte
+    uint64_t end;
+    size_t first; // range of by_loc covered
+    size_t count;
+} scan_run_t;
+
+struct po_logstore_scan {
+    po_logstore_t *ls;
+    uint8_t *from; // the next batch starts at the first key >= from ...
+    size_t from_len;
+    int from_excl; // ... or > from, once a batch has returned it
+    uint8_t *hi;   // exclusive upper bound (NULL: none)
+    size_t hi_len;
+    int exhausted; // no keys left in range after the current batch
+    int failed;    // errno of a batch that could not be loaded (sticky)
+
+    scan_ent_t ents[LS_SCAN_BATCH];
+    scan_ent_t *by_loc[LS_SCAN_BATCH];
+    scan_run_t runs[LS_SCAN_BATCH];
+    size_t n, pos;
+    uint64_t rec_bytes; // record bytes of the batch being collected
+    uint8_t *keys;
+    size_t keys_len, keys_cap;
+    uint8_t *data;
+    size_t data_cap;
+    void *spill; // value re-read by po_logstore_get() for the current item
+};
+
+// LMDB's default order: bytewise, a prefix sorting first.
+static int key_cmp(const void *a, size_t alen, const void *b, size_t blen) {
+    int c = memcmp(a, b, alen < blen ? alen : blen);
+    if (c)
+        return c;
+    return (alen > blen) - (alen < blen);
+}
+
+static int grow(uint8_t **buf, size_t *cap, size_t need) {
+    if (need <= *cap)
+        return 0;
+    size_t c = *cap ? *cap : 4096;
+    while (c < need)
+        c *= 2;
+    uint8_t *p = realloc(*buf, c);
+    if (!p) {
+        errno = ENOMEM;
+        return -1;
+    }
+    *buf = p;
+    *cap = c;
+    return 0;
+}
+
+enum { COLLECT_DONE = 1, COLLECT_FULL, COLLECT_NOMEM };
+
+static int collect_cb(const void *k, size_t klen, const void *v, size_t vlen, void *ud) {
+    po_logstore_scan_t *sc = (po_logstore_scan_t *)ud;
+    if (sc->from_excl && klen == sc->from_len && memcmp(k, sc->from, klen) == 0)
+        return 0; // returned by the previous batch
+    if (sc->hi && key_cmp(k, klen, sc->hi, sc->hi_len) >= 0)
+        return COLLECT_DONE;
+    if (vlen != 12)
+        return 0; // not an index entry
+    uint64_t loc;
+    uint32_t len;
+    memcpy(&loc, v, 8);
+    memcpy(&len, (const uint8_t *)v + 8, 4);
+    uint64_t bytes = LS_REC_SIZE(klen, len);
+    if (sc->n == LS_SCAN_BATCH || (sc->n > 0 && sc->rec_bytes + bytes > LS_SCAN_BYTES))
+        return COLLECT_FULL;
+    if (grow(&sc->keys, &sc->keys_cap, sc->keys_len + klen) != 0)
+        return COLLECT_NOMEM;
+
+    scan_ent_t *e = &sc->ents[sc->n++];
+    *e = (scan_ent_t){.loc = loc, .klen = (uint32_t)klen, .vlen = len, .key_at = sc->keys_len};
+    memcpy(sc->keys + sc->keys_len, k, klen);
+    sc->keys_len += klen;
+    sc->rec_bytes += bytes;
+    return 0;
+}
+
+static int cmp_loc(const void *a, const void *b) {
+    uint64_t x = (*(scan_ent_t *const *)a)->loc, y = (*(scan_ent_t *const *)b)->loc;
+    return (x > y) - (x < y);
+}
+
+// Read the records of the batch in log order, one pread per run of nearby
+// extents. A run that cannot be read leaves its records unread; they fall
+// back to a point lookup when handed out.
+static int load_values(po_logstore_scan_t *sc) {
+    for (size_t i = 0; i < sc->n; i++)
+        sc->by_loc[i] = &sc->ents[i];
+    qsort(sc->by_loc, sc->n, sizeof(sc->by_loc[0]), cmp_loc);
+
+    size_t nruns = 0, need = 0;
+    for (size_t i = 0; i < sc->n; i++) {
+        const scan_ent_t *e = sc->by_loc[i];
+        uint64_t end = e->loc + LS_REC_SIZE(e->klen, e->vlen);
+        scan_run_t *r = nruns ? &sc->runs[nruns - 1] : NULL;
+        if (r && LS_LOC_SEG(e->loc) == LS_LOC_SEG(r->start) && e->loc <= r->end + LS_SCAN_RUN_GAP) {
+            if (end > r->end)
+                r->end = end;
+            r->count++;
+            continue;
+        }
+        sc->runs[nruns++] = (scan_run_t){.start = e->loc, .end = end, .first = i, .count = 1};
+    }
+    for (size_t i = 0; i < nruns; i++) {
+        need += (size_t)(sc->runs[i].end - sc->runs[i].start);
+        _ls_fadvise_willneed(sc->ls, sc->runs[i].start, sc->runs[i].end - sc->runs[i].start);
+    }
+    if (grow(&sc->data, &sc->data_cap, need) != 0)
+        return -1;
+
+    size_t at = 0;
+    for (size_t i = 0; i < nruns; i++) {
+        const scan_run_t *r = &sc->runs[i];
+        size_t want = (size_t)(r->end - r->start);
+        ssize_t rd = _ls_pread(sc->ls, sc->data + at, want, r->start);
+        size_t got = rd > 0 ? (size_t)rd : 0;
+        for (size_t j = r->first; j < r->first + r->count; j++) {
+            scan_ent_t *e = sc->by_loc[j];
+            size_t rel = (size_t)(e->loc - r->start);
+            e->rec_at = at + rel;
+            e->rec_got = got > rel ? got - rel : 0;
+        }
+        at += want;
+    }
+    PO_METRIC_COUNTER_ADD("logstore.scan.read_runs", nruns);
+    return 0;
+}
+
+static int load_batch(po_logstore_scan_t *sc) {
+    sc->n = sc->pos = 0;
+    sc->keys_len = 0;
+    sc->rec_bytes = 0;
+    int rc = db_iterate_from(sc->ls->idx, sc->from, sc->from_len, collect_cb, sc);
+    if (rc == COLLECT_NOMEM || rc < 0) {
+        sc->n = 0;
+        return -1;
+    }
+    if (rc != COLLECT_FULL)
+        sc->exhausted = 1;
+    if (sc->n == 0)
+        return 0;
+
+    // Resume after the last key of this batch
+    const scan_ent_t *last = &sc->ents[sc->n - 1];
+    uint8_t *from = realloc(sc->from, last->klen);
+    if (!from) {
+        sc->n = 0;
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(from, sc->keys + last->key_at, last->klen);
+    sc->from = from;
+    sc->from_len = last->klen;
+    sc->from_excl = 1;
+
+    PO_METRIC_COUNTER_INC("logstore.scan.batches");
+    return load_values(sc);
+}
+
+// Value of @p e from the batch buffer if the record there checks out. -1 with
+// errno = EIO for a corrupt record, -2 if the record was not (fully) read or
+// is no longer this key's (its segment was compacted away meanwhile).
+static int batch_value(po_logstore_scan_t *sc, const scan_ent_t *e, const uint8_t **out) {
+    const uint8_t *rec = sc->data + e->rec_at;
+    const uint8_t *key = sc->keys + e->key_at;
+    ls_rec_t r;
+    if (e->rec_got == 0 || _ls_rec_decode(rec, e->rec_got, &r) != 0 || r.klen != e->klen ||
+        r.vlen != e->vlen || r.hdr_size + (size_t)e->klen + e->vlen > e->rec_got ||
+        memcmp(rec + r.hdr_size, key, e->klen) != 0)
+        return -2;
+    if (_ls_rec_verify(&r, rec, rec + r.hdr_size) != 0) {
+        PO_METRIC_COUNTER_INC("logstore.scan.corrupt");
+        errno = EIO;
+        return -1;
+    }
+    *out = rec + r.hdr_size + e->klen;
+    return 0;
+}
+
+int po_logstore_scan_next(po_logstore_scan_t *sc, po_logstore_scan_item *out) {
+    if (!sc || !out) {
+        errno = EINVAL;
+        return -1;
+    }
+    free(sc->spill);
+    sc->spill = NULL;
+    for (;;) {
+        if (sc->failed) {
+            errno = sc->failed;
+            return -1;
+        }
+        if (sc->pos == sc->n) {
+            if (sc->exhausted)
+                return 0;
+            if (load_batch(sc) != 0) {
+                sc->failed = errno ? errno : EIO;
+                return -1;
+            }
+            continue;
+        }
+        const scan_ent_t *e = &sc->ents[sc->pos++];
+        const void *key = sc->keys + e->key_at;
+        const uint8_t *val = NULL;
+        size_t vlen = e->vlen;
+        int rc = batch_value(sc, e, &val);
+        if (rc == -1)
+            return -1;
+        if (rc == -2) {
+            // Moved since the index was read: look the key up again
+            void *buf = NULL;
+            if (po_logstore_get(sc->ls, key, e->klen, &buf, &vlen) != 0) {
+                if (errno == DB_ENOTFOUND)
+                    continue; // removed meanwhile (integrity prune)
+                return -1;
+            }
+            sc->spill = buf;
+            val = buf;
+            PO_METRIC_COUNTER_INC("logstore.scan.reread");
+        }
+        *out = (po_logstore_scan_item){key, e->klen, val, vlen};
+        PO_METRIC_COUNTER_INC("logstore.scan.records");
+        return 1;
+    }
+}
+
+po_logstore_scan_t *po_logstore_scan(po_logstore_t *ls, const void *lo, size_t lolen,
+                                     const void *hi, size_t hilen) {
+    if (!ls || (lolen && !lo) || (hi && hilen > LS_HARD_KEY_MAX) || lolen > LS_HARD_KEY_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+    po_logstore_scan_t *sc = calloc(1, sizeof(*sc));
+    if (!sc) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    sc->ls = ls;
+    if (lolen) {
+        sc->from = malloc(lolen);
+        if (!sc->from)
+            goto oom;
+        memcpy(sc->from, lo, lolen);
+        sc->from_len = lolen;
+    }
+    if (hi) {
+        sc->hi = malloc(hilen + 1); // non-NULL even for an empty bound
+        if (!sc->hi)
+            goto oom;
+        memcpy(sc->hi, hi, hilen);
+        sc->hi_len = hilen;
+        if (hilen == 0 || (lolen && key_cmp(lo, lolen, hi, hilen) >= 0))
+            sc->exhausted = 1; // empty range
+    }
+    return sc;
+
+oom:
+    po_logstore_scan_close(&sc);
+    errno = ENOMEM;
+    return NULL;
+}
+
+po_logstore_scan_t *po_logstore_scan_prefix(po_logstore_t *ls, const void *prefix,
+                                            size_t prefixlen) {
+    if (prefixlen && !prefix) {
+        errno = EINVAL;
+        return NULL;
+    }
+    // Keys starting with the prefix are [prefix, successor): drop trailing
+    // 0xFF bytes and increment the last remaining one. An all-0xFF prefix has
+    // no successor, so its range is unbounded above.
+    const uint8_t *p = (const uint8_t *)prefix;
+    size_t n = prefixlen;
+    while (n > 0 && p[n - 1] == 0xFF)
+        n--;
+    if (n == 0)
+        return po_logstore_scan(ls, prefix, prefixlen, NULL, 0);
+    uint8_t *succ = malloc(n);
+    if (!succ) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    memcpy(succ, p, n);
+    succ[n - 1]++;
+    po_logstore_scan_t *sc = po_logstore_scan(ls, prefix, prefixlen, succ, n);
+    free(succ);
+    return sc;
+}
+
+void po_logstore_scan_close(po_logstore_scan_t **psc) {
+    if (!psc || !*psc)
+        return;
+    po_logstore_scan_t *sc = *psc;
+    free(sc->from);
+    free(sc->hi);
+    free(sc->keys);
+    free(sc->data);
+    free(sc->spill);
+    free(sc);
+    *psc = NULL;
+}
@@ -0,0 +1,495 @@
+/**
+ * @file logstore_segment.c
+ * @brief Segment table: discovery, rolling, positional reads and space accounting.
+ *
+ * A store is either a single legacy `aof.log` (segment 0, never rolls) or a
+ * sequence of `aof.NNNNNN.log` files. The numbered layout is used when a roll
+ * threshold is configured or numbered files already exist; a leftover
+ * `aof.log` is then adopted as `aof.000000.log` so its index offsets stay
+ * valid.
+ *
+ * Writers reserve ranges past the active segment's tail under tail_lock,
+ * write them concurrently and publish them in reservation order. Their index
+ * commits then take the same turns under idx_mu, so a slow LMDB commit holds
+ * up later commits but not reservations, writes or publications. A failed
+ * range fails the ones after it in the segment too; once everything in flight
+ * is published, the space is reused from the last published record on.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+
+static void segment_path(const po_logstore_t *ls, uint32_t id, int legacy, char *out, size_t n) {
+    if (legacy)
+        snprintf(out, n, "%s/aof.log", ls->dir);
+    else
+        snprintf(out, n, "%s/aof.%06u.log", ls->dir, id);
+}
+
+// Parse "aof.NNNNNN.log"; returns 0 and the id on a match.
+static int parse_segment_name(const char *name, uint32_t *out_id) {
+    unsigned id = 0;
+    int end = 0;
+    if (strlen(name) != sizeof("aof.000000.log") - 1)
+        return -1;
+    if (sscanf(name, "aof.%6u.log%n", &id, &end) != 1 || end != (int)strlen(name))
+        return -1;
+    *out_id = id;
+    return 0;
+}
+
+// Open (creating if needed) a segment file and append it to the table; sets
+// *created if the file is new, so its directory entry still needs a sync.
+// Caller guarantees ids are added in increasing order or sorts afterwards.
+static int add_segment(po_logstore_t *ls, uint32_t id, int legacy, int *created) {
+    char path[512];
+    segment_path(ls, id, legacy, path, sizeof(path));
+    int fd = open(path, O_RDWR | O_CLOEXEC); // need read for pread()
+    if (fd < 0 && errno == ENOENT) {
+        fd = open(path, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0664);
+        *created |= fd >= 0;
+    }
+    if (fd < 0) {
+        LOG_ERROR("logstore: open(%s) failed", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (ls->nsegs == ls->segs_cap) {
+        size_t cap = ls->segs_cap ? ls->segs_cap * 2 : 8;
+        ls_segment_t **segs = realloc(ls->segs, cap * sizeof(*segs));
+        if (!segs) {
+            close(fd);
+            errno = ENOMEM;
+            return -1;
+        }
+        ls->segs = segs;
+        ls->segs_cap = cap;
+    }
+    ls_segment_t *seg = calloc(1, sizeof(*seg));
+    if (!seg) {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+    seg->id = id;
+    seg->fd = fd;
+    atomic_store(&seg->size, (uint64_t)st.st_size);
+    atomic_store(&seg->dead, 0);
+    seg->tail = (uint64_t)st.st_size;
+    ls->segs[ls->nsegs++] = seg;
+    return 0;
+}
+
+static int cmp_segment(const void *a, const void *b) {
+    const ls_segment_t *sa = *(ls_segment_t *const *)a;
+    const ls_segment_t *sb = *(ls_segment_t *const *)b;
+    return (sa->id > sb->id) - (sa->id < sb->id);
+}
+
+// Binary search; caller holds seg_lock (or is the only thread).
+static ls_segment_t *find_segment(const po_logstore_t *ls, uint32_t id) {
+    size_t lo = 0, hi = ls->nsegs;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint32_t mid_id = ls->segs[mid]->id;
+        if (mid_id == id)
+            return ls->segs[mid];
+        if (mid_id < id)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+int _ls_segments_open(po_logstore_t *ls, const po_logstore_cfg *cfg) {
+    snprintf(ls->dir, sizeof(ls->dir), "%s", cfg->dir);
+    ls->segment_bytes = cfg->segment_bytes;
+    ls->dir_fd = open(ls->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (ls->dir_fd < 0) {
+        LOG_ERROR("logstore: open(%s) failed", ls->dir);
+        return -1;
+    }
+
+    DIR *d = opendir(ls->dir);
+    if (!d)
+        return -1;
+    int have_zero = 0, changed = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        uint32_t id;
+        if (parse_segment_name(de->d_name, &id) != 0)
+            continue;
+        if (add_segment(ls, id, 0, &changed) != 0) {
+            closedir(d);
+            return -1;
+        }
+        have_zero |= id == 0;
+    }
+    closedir(d);
+
+    if (ls->nsegs == 0 && ls->segment_bytes == 0) {
+        // Legacy single-file layout
+        if (add_segment(ls, 0, 1, &changed) != 0)
+            return -1;
+        return changed ? _ls_sync_dir(ls) : 0;
+    }
+
+    char legacy[512], zero[512];
+    segment_path(ls, 0, 1, legacy, sizeof(legacy));
+    segment_path(ls, 0, 0, zero, sizeof(zero));
+    if (!have_zero && access(legacy, F_OK) == 0) {
+        if (rename(legacy, zero) != 0) {
+            LOG_ERROR("logstore: cannot adopt %s as %s", legacy, zero);
+            return -1;
+        }
+        LOG_INFO("logstore: adopted legacy %s as segment 0", legacy);
+        have_zero = 1;
+        changed = 1;
+        if (add_segment(ls, 0, 0, &changed) != 0)
+            return -1;
+    }
+    if (ls->nsegs == 0 && add_segment(ls, 0, 0, &changed) != 0)
+        return -1;
+
+    qsort(ls->segs, ls->nsegs, sizeof(*ls->segs), cmp_segment);
+    return changed ? _ls_sync_dir(ls) : 0;
+}
+
+int _ls_sync_dir(po_logstore_t *ls) {
+    if (fsync(ls->dir_fd) == 0)
+        return 0;
+    LOG_ERROR("logstore: fsync of directory %s failed (errno=%d)", ls->dir, errno);
+    return -1;
+}
+
+int _ls_settle_dir(po_logstore_t *ls) {
+    if (atomic_load(&ls->dir_synced) == atomic_load(&ls->dir_gen))
+        return 0;
+    // dir_synced only advances once the fsync returned, so a caller that sees
+    // it caught up never publishes ahead of a sync still in progress.
+    pthread_mutex_lock(&ls->dir_mu);
+    unsigned gen = atomic_load(&ls->dir_gen);
+    int rc = 0;
+    if (atomic_load(&ls->dir_synced) != gen) {
+        rc = _ls_sync_dir(ls);
+        if (rc == 0)
+            atomic_store(&ls->dir_synced, gen);
+    }
+    pthread_mutex_unlock(&ls->dir_mu);
+    return rc;
+}
+
+void _ls_segments_close(po_logstore_t *ls) {
+    for (size_t i = 0; i < ls->nsegs; i++) {
+        if (ls->segs[i]->map)
+            _ls_map_unpin(ls->segs[i]->map);
+        close(ls->segs[i]->fd);
+        free(ls->segs[i]);
+    }
+    free(ls->segs);
+    ls->segs = NULL;
+    ls->nsegs = 0;
+    ls->segs_cap = 0;
+    if (ls->dir_fd >= 0)
+        close(ls->dir_fd);
+    ls->dir_fd = -1;
+}
+
+ls_segment_t *_ls_active_segment(po_logstore_t *ls) {
+    // The table only changes under tail_lock (roll, drop), so the last entry is
+    // stable for tail_lock holders without taking seg_lock.
+    return ls->segs[ls->nsegs - 1];
+}
+
+// Seal the active segment and start the next one. Caller holds tail_lock and
+// has waited out every reservation, so all writes to the old segment landed.
+static int roll(po_logstore_t *ls) {
+    ls_segment_t *act = _ls_active_segment(ls);
+    // Later fsyncs only target the active segment: settle the sealed one now
+    // (also for pending group commit tickets, whatever the policy).
+    if (ls->fsync_policy != PO_LS_FSYNC_NONE || ls->gc_written > atomic_load(&ls->gc_durable)) {
+        if (fdatasync(act->fd) != 0)
+            _ls_gc_sync_failed(ls);
+    }
+
+    int created = 0;
+    pthread_rwlock_wrlock(&ls->seg_lock);
+    int rc = add_segment(ls, act->id + 1, 0, &created);
+    pthread_rwlock_unlock(&ls->seg_lock);
+    if (rc != 0) {
+        LOG_ERROR("logstore: segment roll after %u failed; continuing in place", act->id);
+        return -1;
+    }
+    // Records synced into the new file are only reachable once its entry is:
+    // the next sync covering them settles the directory first (_ls_settle_dir)
+    if (created)
+        atomic_fetch_add(&ls->dir_gen, 1);
+    PO_METRIC_COUNTER_INC("logstore.segment.rolls");
+    return 0;
+}
+
+void _ls_tail_reserve(po_logstore_t *ls, uint64_t len, ls_resv_t *out) {
+    for (;;) {
+        ls_segment_t *act = _ls_active_segment(ls);
+        int full = ls->segment_bytes != 0 && act->tail >= ls->segment_bytes;
+        if (!act->poisoned && !full)
+            break;
+        if (ls->pub_next != ls->resv_next) {
+            // Writes past a hole, or into a segment about to be sealed, land first
+            pthread_cond_wait(&ls->pub_cv, &ls->tail_lock);
+            continue;
+        }
+        if (act->poisoned) {
+            // Every range past the hole was failed on publication: reuse the
+            // space from the last published record on.
+            act->tail = atomic_load(&act->size);
+            act->poisoned = 0;
+            continue;
+        }
+        if (roll(ls) != 0)
+            break;
+    }
+    ls_segment_t *act = _ls_active_segment(ls);
+    out->seg = act;
+    out->off = act->tail;
+    out->len = len;
+    out->turn = ls->resv_next++;
+    act->tail += len;
+}
+
+int _ls_tail_publish(po_logstore_t *ls, const ls_resv_t *r, int wrote) {
+    if (ls->pub_next != r->turn) {
+        PO_METRIC_COUNTER_INC("logstore.flush.publish_waits");
+        do {
+            pthread_cond_wait(&ls->pub_cv, &ls->tail_lock);
+        } while (ls->pub_next != r->turn);
+    }
+    ls_segment_t *seg = r->seg;
+    // Once a range fails, later ones in the segment are dropped too: the
+    // published prefix must stay gap-free for readers and recovery.
+    int ok = wrote && !seg->poisoned;
+    if (ok)
+        atomic_store(&seg->size, r->off + r->len);
+    else
+        seg->poisoned = 1;
+    ls->pub_next++;
+    pthread_cond_broadcast(&ls->pub_cv);
+    return ok;
+}
+
+void _ls_tail_quiesce(po_logstore_t *ls) {
+    while (ls->pub_next != ls->resv_next)
+        pthread_cond_wait(&ls->pub_cv, &ls->tail_lock);
+}
+
+void _ls_index_turn(po_logstore_t *ls, uint64_t turn) {
+    if (ls->idx_next != turn) {
+        PO_METRIC_COUNTER_INC("logstore.flush.index_waits");
+        do {
+            pthread_cond_wait(&ls->idx_cv, &ls->idx_mu);
+        } while (ls->idx_next != turn);
+    }
+}
+
+void _ls_index_turn_done(po_logstore_t *ls) {
+    ls->idx_next++;
+    pthread_cond_broadcast(&ls->idx_cv);
+}
+
+ssize_t _ls_pread(po_logstore_t *ls, void *buf, size_t n, uint64_t loc) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, LS_LOC_SEG(loc));
+    if (!seg) {
+        pthread_rwlock_unlock(&ls->seg_lock);
+        errno = ENOENT;
+        return -1;
+    }
+    ssize_t rd = pread(seg->fd, buf, n, (off_t)LS_LOC_OFF(loc));
+    pthread_rwlock_unlock(&ls->seg_lock);
+    return rd;
+}
+
+void _ls_fadvise_willneed(po_logstore_t *ls, uint64_t loc, uint64_t len) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, LS_LOC_SEG(loc));
+    if (seg)
+        (void)posix_fadvise(seg->fd, (off_t)LS_LOC_OFF(loc), (off_t)len, POSIX_FADV_WILLNEED);
+    pthread_rwlock_unlock(&ls->seg_lock);
+}
+
+int _ls_segment_size(po_logstore_t *ls, uint32_t id, uint64_t *out) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, id);
+    if (seg)
+        *out = atomic_load(&seg->size);
+    pthread_rwlock_unlock(&ls->seg_lock);
+    if (!seg) {
+        errno = ENOENT;
+        return -1;
+    }
+    return 0;
+}
+
+void _ls_note_dead(po_logstore_t *ls, uint64_t loc, uint64_t bytes) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, LS_LOC_SEG(loc));
+    if (seg)
+        atomic_fetch_add(&seg->dead, bytes);
+    pthread_rwlock_unlock(&ls->seg_lock);
+    PO_METRIC_COUNTER_ADD("logstore.space.dead_bytes", bytes);
+}
+
+void _ls_note_live(po_logstore_t *ls, uint64_t loc, uint64_t bytes) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, LS_LOC_SEG(loc));
+    if (seg) {
+        uint64_t dead = atomic_load(&seg->dead);
+        atomic_store(&seg->dead, dead > bytes ? dead - bytes : 0);
+    }
+    pthread_rwlock_unlock(&ls->seg_lock);
+}
+
+void _ls_reset_accounting(po_logstore_t *ls) {
+    // Everything is dead until the index preload claims it as live.
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    for (size_t i = 0; i < ls->nsegs; i++)
+        atomic_store(&ls->segs[i]->dead, atomic_load(&ls->segs[i]->size));
+    pthread_rwlock_unlock(&ls->seg_lock);
+}
+
+int _ls_fsync_active(po_logstore_t *ls) {
+    pthread_rwlock_rdlock(&ls->seg_lock);
+    int rc = fsync(ls->segs[ls->nsegs - 1]->fd);
+    pthread_rwlock_unlock(&ls->seg_lock);
+    return rc;
+}
+
+int _ls_segment_drop(po_logstore_t *ls, uint32_t id) {
+    pthread_rwlock_wrlock(&ls->seg_lock);
+    ls_segment_t *seg = find_segment(ls, id);
+    if (!seg || seg == ls->segs[ls->nsegs - 1]) {
+        pthread_rwlock_unlock(&ls->seg_lock);
+        errno = seg ? EBUSY : ENOENT;
+        return -1;
+    }
+    size_t i = 0;
+    while (ls->segs[i] != seg)
+        i++;
+    memmove(&ls->segs[i], &ls->segs[i + 1], (ls->nsegs - i - 1) * sizeof(*ls->segs));
+    ls->nsegs--;
+    pthread_rwlock_unlock(&ls->seg_lock);
+
+    // No reader can reach the fd any more: lookups of moved records see ENOENT
+    // and retry against the updated index.
+    char path[512];
+    segment_path(ls, id, 0, path, sizeof(path));
+    if (seg->map)
+        _ls_map_unpin(seg->map); // views keep the bytes alive past the unlink
+    close(seg->fd);
+    if (unlink(path) != 0)
+        LOG_WARN("logstore: unlink(%s) failed", path);
+    free(seg);
+    return 0;
+}
+
+#define LS_MAP_MIN_ACTIVE (1u << 20)
+
+// Replace the segment's mapping with one covering @p size bytes. The active
+// segment is mapped with room to grow (past EOF, which is never read) so it is
+// remapped only each time its size doubles. Caller holds seg_lock for writing.
+static ls_map_t *remap_segment(po_logstore_t *ls, ls_segment_t *seg, uint64_t size) {
+    size_t len = (size_t)size;
+    if (seg == ls->segs[ls->nsegs - 1]) {
+        len = len * 2 > LS_MAP_MIN_ACTIVE ? len * 2 : LS_MAP_MIN_ACTIVE;
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        len = (len + page - 1) / page * page;
+    }
+    ls_map_t *m = malloc(sizeof(*m));
+    if (!m)
+        return NULL;
+    void *base = mmap(NULL, len, PROT_READ, MAP_SHARED, seg->fd, 0);
+    if (base == MAP_FAILED) {
+        int saved = errno;
+        LOG_WARN("logstore: mmap of segment %u (%zu bytes) failed", seg->id, len);
+        free(m);
+        errno = saved;
+        return NULL;
+    }
+    m->base = base;
+    m->len = len;
+    atomic_init(&m->refs, 1);
+    if (seg->map)
+        _ls_map_unpin(seg->map);
+    seg->map = m;
+    PO_METRIC_COUNTER_INC("logstore.view.remaps");
+    return m;
+}
+
+// Bytes below a segment's size never change (appends only go past it, and
+// truncation happens at open only), so they are safe to map even in the
+// active segment.
+const uint8_t *_ls_map_pin(po_logstore_t *ls, uint64_t loc, size_t *out_avail,
+                           ls_map_t **out_map) {
+    uint64_t off = LS_LOC_OFF(loc);
+    for (int exclusive = 0; exclusive < 2; exclusive++) {
+        if (exclusive)
+            pthread_rwlock_wrlock(&ls->seg_lock);
+        else
+            pthread_rwlock_rdlock(&ls->seg_lock);
+        ls_segment_t *seg = find_segment(ls, LS_LOC_SEG(loc));
+        if (!seg) {
+            pthread_rwlock_unlock(&ls->seg_lock);
+            errno = ENOENT;
+            return NULL;
+        }
+        uint64_t size = atomic_load(&seg->size);
+        if (off >= size) {
+            pthread_rwlock_unlock(&ls->seg_lock);
+            errno = EIO;
+            return NULL;
+        }
+        ls_map_t *m = seg->map;
+        if ((!m || m->len < size) && exclusive)
+            m = remap_segment(ls, seg, size);
+        if (m && m->len >= size) {
+            atomic_fetch_add(&m->refs, 1);
+            pthread_rwlock_unlock(&ls->seg_lock);
+            *out_avail = (size_t)(size - off);
+            *out_map = m;
+            return m->base + off;
+        }
+        pthread_rwlock_unlock(&ls->seg_lock);
+        if (exclusive && !m)
+            return NULL; // remap failed
+    }
+    errno = EIO;
+    return NULL;
+}
+
+void _ls_map_unpin(ls_map_t *map) {
+    if (atomic_fetch_sub(&map->refs, 1) == 1) {
+        munmap(map->base, map->len);
+        free(map);
+    }
+}
@@ -0,0 +1,317 @@
+/**
+ * @file logstore_uring.c
+ * @brief Minimal io_uring ring for the flush workers (raw syscalls, no liburing).
+ *
+ * Each worker owns one ring. A batch is submitted as a vectored write,
+ * optionally linked to an `fdatasync`; the worker waits only for the write's
+ * completion (so it can publish the index) and reaps sync completions as they
+ * arrive, letting batch N+1 be written while batch N is still syncing. At most
+ * LS_URING_MAX_SYNCS syncs are left in flight; the worker settles them once
+ * the queue runs dry, and closing the ring waits for them.
+ * A completed sync advances the group commit frontier it was submitted with.
+ * When other workers' writes may still be in flight the sync cannot ride on
+ * the write; it is then submitted on its own after the batch is published.
+ *
+ * Requires Linux 5.5+ (IORING_FEAT_NODROP is used as the version probe);
+ * otherwise, or when io_uring is blocked (seccomp, sysctl), opening fails and
+ * the worker keeps using pwritev + fsync.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "log/logger.h"
+#include "metrics/metrics.h"
+#include "storage/logstore_internal.h"
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define LS_HAVE_URING 1
+#endif
+
+#ifdef LS_HAVE_URING
+
+#define LS_URING_ENTRIES 16u
+#define LS_URING_MAX_SYNCS 4u
+#define LS_URING_WRITE 1u // user_data of writes; syncs carry (durable_upto << 1)
+
+struct ls_uring {
+    po_logstore_t *ls;
+    int fd;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_len;
+    void *cq_ring; // == sq_ring with IORING_FEAT_SINGLE_MMAP
+    size_t cq_ring_len;
+    size_t sqes_len;
+    unsigned syncs_inflight;
+};
+
+static void unmap_rings(ls_uring_t *u) {
+    if (u->sqes)
+        munmap(u->sqes, u->sqes_len);
+    if (u->cq_ring && u->cq_ring != u->sq_ring)
+        munmap(u->cq_ring, u->cq_ring_len);
+    if (u->sq_ring)
+        munmap(u->sq_ring, u->sq_ring_len);
+}
+
+ls_uring_t *_ls_uring_open(po_logstore_t *ls) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, LS_URING_ENTRIES, &p);
+    if (fd < 0)
+        return NULL;
+    if (!(p.features & IORING_FEAT_NODROP)) {
+        close(fd);
+        errno = ENOSYS;
+        return NULL;
+    }
+    ls_uring_t *u = calloc(1, sizeof(*u));
+    if (!u) {
+        close(fd);
+        return NULL;
+    }
+    u->ls = ls;
+    u->fd = fd;
+    u->sq_ring_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_ring_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (u->cq_ring_len > u->sq_ring_len)
+            u->sq_ring_len = u->cq_ring_len;
+        u->cq_ring_len = u->sq_ring_len;
+    }
+    u->sq_ring = mmap(NULL, u->sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED) {
+        u->sq_ring = NULL;
+        goto fail;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cq_ring = u->sq_ring;
+    } else {
+        u->cq_ring = mmap(NULL, u->cq_ring_len, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (u->cq_ring == MAP_FAILED) {
+            u->cq_ring = NULL;
+            goto fail;
+        }
+    }
+    u->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                   IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        u->sqes = NULL;
+        goto fail;
+    }
+    uint8_t *sq = (uint8_t *)u->sq_ring, *cq = (uint8_t *)u->cq_ring;
+    u->sq_tail = (unsigned *)(void *)(sq + p.sq_off.tail);
+    u->sq_mask = (unsigned *)(void *)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(void *)(sq + p.sq_off.array);
+    u->cq_head = (unsigned *)(void *)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned *)(void *)(cq + p.cq_off.tail);
+    u->cq_mask = (unsigned *)(void *)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(void *)(cq + p.cq_off.cqes);
+    return u;
+
+fail:;
+    int saved = errno;
+    unmap_rings(u);
+    close(fd);
+    free(u);
+    errno = saved;
+    return NULL;
+}
+
+// Queue one SQE. At most two are queued before each submission, so with
+// LS_URING_ENTRIES slots the SQ can never be full.
+static struct io_uring_sqe *push(ls_uring_t *u) {
+    unsigned tail = *u->sq_tail;
+    unsigned idx = tail & *u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[idx] = idx;
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+static int enter(ls_uring_t *u, unsigned submit, unsigned wait) {
+    while (submit || wait) {
+        long rc = syscall(__NR_io_uring_enter, u->fd, submit, wait,
+                          wait ? IORING_ENTER_GETEVENTS : 0u, NULL, 0);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        submit -= (unsigned)rc < submit ? (unsigned)rc : submit;
+        wait = 0; // GETEVENTS returned: at least one completion is ready
+    }
+    return 0;
+}
+
+// Consume all ready completions; returns 1 if the write's was among them.
+static int reap(ls_uring_t *u, int32_t *write_res) {
+    int seen = 0;
+    unsigned head = *u->cq_head;
+    while (head != __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+        const struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+        if (cqe->user_data == LS_URING_WRITE) {
+            *write_res = cqe->res;
+            seen = 1;
+        } else {
+            u->syncs_inflight--;
+            if (cqe->res == -ECANCELED) {
+                // the linked write failed or was short; already reported
+            } else if (cqe->res < 0) {
+                LOG_ERROR("logstore: io_uring fdatasync failed (errno=%d)", -cqe->res);
+                PO_METRIC_COUNTER_INC("logstore.io.uring_sync_errors");
+                _ls_gc_sync_failed(u->ls);
+            } else {
+                PO_METRIC_COUNTER_INC("logstore.io.uring_syncs");
+                _ls_gc_durable(u->ls, cqe->user_data >> 1);
+            }
+        }
+        head++;
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+    return seen;
+}
+
+ssize_t _ls_uring_writev(ls_uring_t *u, int fd, const struct iovec *iov, unsigned cnt,
+                         uint64_t off, int sync, uint64_t durable_upto) {
+    int32_t res = 0;
+    while (sync && u->syncs_inflight >= LS_URING_MAX_SYNCS) {
+        if (enter(u, 0, 1) != 0)
+            return -1;
+        (void)reap(u, &res);
+    }
+
+    struct io_uring_sqe *w = push(u);
+    w->opcode = IORING_OP_WRITEV;
+    w->fd = fd;
+    w->addr = (uint64_t)(uintptr_t)iov;
+    w->len = cnt;
+    w->off = off;
+    w->user_data = LS_URING_WRITE;
+    unsigned queued = 1;
+    if (sync) {
+        w->flags |= IOSQE_IO_LINK; // the sync starts only once the write is done
+        struct io_uring_sqe *s = push(u);
+        s->opcode = IORING_OP_FSYNC;
+        s->fd = fd;
+        s->fsync_flags = IORING_FSYNC_DATASYNC;
+        s->user_data = durable_upto << 1;
+        u->syncs_inflight++;
+        queued++;
+    }
+    if (enter(u, queued, 1) != 0)
+        return -1;
+    while (!reap(u, &res)) {
+        if (enter(u, 0, 1) != 0)
+            return -1;
+    }
+    if (res < 0) {
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+int _ls_uring_sync_active(ls_uring_t *u, uint64_t durable_upto) {
+    int32_t res = 0;
+    while (u->syncs_inflight >= LS_URING_MAX_SYNCS) {
+        if (enter(u, 0, 1) != 0)
+            return -1;
+        (void)reap(u, &res);
+    }
+    // The file is resolved at submission, so a later roll or drop cannot
+    // redirect the sync.
+    pthread_rwlock_rdlock(&u->ls->seg_lock);
+    struct io_uring_sqe *s = push(u);
+    s->opcode = IORING_OP_FSYNC;
+    s->fd = u->ls->segs[u->ls->nsegs - 1]->fd;
+    s->fsync_flags = IORING_FSYNC_DATASYNC;
+    s->user_data = durable_upto << 1;
+    u->syncs_inflight++;
+    int rc = enter(u, 1, 0);
+    pthread_rwlock_unlock(&u->ls->seg_lock);
+    if (rc != 0)
+        u->syncs_inflight--;
+    return rc;
+}
+
+void _ls_uring_settle(ls_uring_t *u) {
+    int32_t res = 0;
+    (void)reap(u, &res);
+    while (u->syncs_inflight > 0) {
+        if (enter(u, 0, 1) != 0)
+            break;
+        (void)reap(u, &res);
+    }
+}
+
+void _ls_uring_close(ls_uring_t *u) {
+    if (!u)
+        return;
+    _ls_uring_settle(u);
+    unmap_rings(u);
+    close(u->fd);
+    free(u);
+}
+
+#else // !LS_HAVE_URING
+
+ls_uring_t *_ls_uring_open(po_logstore_t *ls) {
+    (void)ls;
+    errno = ENOSYS;
+    return NULL;
+}
+
+ssize_t _ls_uring_writev(ls_uring_t *u, int fd, const struct iovec *iov, unsigned cnt,
+                         uint64_t off, int sync, uint64_t durable_upto) {
+    (void)u;
+    (void)fd;
+    (void)iov;
+    (void)cnt;
+    (void)off;
+    (void)sync;
+    (void)durable_upto;
+    errno = ENOSYS;
+    return -1;
+}
+
+int _ls_uring_sync_active(ls_uring_t *u, uint64_t durable_upto) {
+    (void)u;
+    (void)durable_upto;
+    errno = ENOSYS;
+    return -1;
+}
+
+void _ls_uring_settle(ls_uring_t *u) {
+    (void)u;
+}
+
+void _ls_uring_close(ls_uring_t *u) {
+    (void)u;
+}
+
+#endif // LS_HAVE_URING
@@ -44,258 +44,350 @@ uint64_t _ls_now_ns(void) {
     return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
 }
 
+// Index value layout: 8-byte file offset followed by 4-byte value length
+#define LS_IDX_VAL_SIZE 12u
+
+// Point the in-memory index at a new record version, charging the shadowed
+// one to its segment's dead bytes. Caller holds idx_lock for writing.
+static void _ls_mem_index_publish(po_logstore_t *ls, const void *key, size_t klen, uint64_t loc,
+                                  uint32_t vl) {
+    uint64_t old_loc;
+    uint32_t old_len;
+    if (po_index_get(ls->mem_idx, key, klen, &old_loc, &old_len) == 0)
+        _ls_note_dead(ls, old_loc, LS_REC_SIZE(klen, old_len));
+    (void)po_index_put(ls->mem_idx, key, klen, loc, vl);
+}
+
+// Persist the index entries of a written batch, ending at @p end_loc, with one
+// LMDB commit (instead of one commit per record) that also advances the
+// recovery checkpoint, and publish them to the in-memory index under a single
+// write-lock acquisition. Caller holds idx_mu in the batch's turn. Returns 1
+// when the caller must run _ls_bloom_rebuild() once it has dropped idx_mu.
+static int _ls_index_batch(po_logstore_t *ls, append_req_t **reqs, size_t n,
+                            const uint64_t *offs, const uint32_t *lens, uint64_t end_loc,
+                            uint64_t end_seq) {
+    _ls_bloom_note(ls, reqs, n); // before LMDB, so the filter never misses a key
+    uint8_t *ivs = malloc(n * LS_IDX_VAL_SIZE);
+    db_kv_t *kvs = malloc(n * sizeof(*kvs));
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t one[LS_IDX_VAL_SIZE];
+        uint8_t *iv = ivs ? ivs + i * LS_IDX_VAL_SIZE : one;
+        memcpy(iv, &offs[i], 8);
+        memcpy(iv + 8, &lens[i], 4);
+        if (ivs && kvs)
+            kvs[i] = (db_kv_t){reqs[i]->k, reqs[i]->klen, iv, LS_IDX_VAL_SIZE};
+        else if (db_put(ls->idx, reqs[i]->k, reqs[i]->klen, iv, LS_IDX_VAL_SIZE) != 0) // OOM
+            ls->ckpt_stale = 1;
+    }
+    if (ivs && kvs) {
+        if (_ls_index_commit(ls, kvs, n, end_loc, end_seq) == 0)
+            PO_METRIC_COUNTER_INC("logstore.index.commits");
+        else
+            LOG_ERROR("logstore: index commit of %zu entries failed (errno=%d)", n, errno);
+    }
+    free(kvs);
+    free(ivs);
+
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    for (size_t i = 0; i < n; ++i)
+        _ls_mem_index_publish(ls, reqs[i]->k, reqs[i]->klen, offs[i], lens[i]);
+    pthread_rwlock_unlock(&ls->idx_lock);
+    return _ls_bloom_grow_if_full(ls);
+}
+
+// Whether the fsync policy calls for a sync after the batch being flushed.
+static int _ls_sync_due(po_logstore_t *ls) {
+    switch (ls->fsync_policy) {
+    case PO_LS_FSYNC_EACH_BATCH:
+        return 1;
+    case PO_LS_FSYNC_EVERY_N:
+        if (++ls->batches_since_fsync < (ls->fsync_every_n ? ls->fsync_every_n : 1))
+            return 0;
+        ls->batches_since_fsync = 0;
+        return 1;
+    case PO_LS_FSYNC_INTERVAL: {
+        uint64_t now = _ls_now_ns();
+        if (now - ls->last_fsync_ns < ls->fsync_interval_ns)
+            return 0;
+        ls->last_fsync_ns = now;
+        return 1;
+    }
+    case PO_LS_FSYNC_NONE:
+    default:
+        return 0;
+    }
+}
+
+// Sync the active segment, and the directory entry of a freshly rolled one;
+// on success every ticket <= @p upto is durable.
+static void _ls_sync_publish(po_logstore_t *ls, uint64_t upto) {
+    if (_ls_fsync_active(ls) == 0 && _ls_settle_dir(ls) == 0)
+        _ls_gc_durable(ls, upto);
+    else
+        _ls_gc_sync_failed(ls);
+}
+
+// Write one reserved range at @p off. With a ring and @p link_sync, an
+// fdatasync covering tickets <= @p upto is chained to the write.
+static ssize_t _ls_write_range(ls_uring_t *ring, int fd, const struct iovec *iov, size_t cnt,
+                               uint64_t off, int link_sync, uint64_t upto) {
+    if (ring)
+        return _ls_uring_writev(ring, fd, iov, (unsigned)cnt, off, link_sync, upto);
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__GLIBC__)
+    ssize_t w = pwritev(fd, iov, (int)cnt, (off_t)off);
+    if (w >= 0 || (errno != ENOSYS && errno != EINVAL))
+        return w;
+#endif
+    // No pwritev (or more vectors than IOV_MAX): one positional write per
+    // vector, as lseek + writev would race the other workers.
+    uint64_t done = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+        ssize_t w1 = pwrite(fd, iov[i].iov_base, iov[i].iov_len, (off_t)(off + done));
+        if (w1 < 0)
+            return -1;
+        done += (uint64_t)w1;
+        if ((size_t)w1 < iov[i].iov_len)
+            break;
+    }
+    return (ssize_t)done;
+}
+
+// Allocation-failure fallback: each record gets its own reservation, write and
+// index commit.
+static void _ls_flush_each(po_logstore_t *ls, append_req_t **reqs, size_t n) {
+    int has_ticket = 0, grow = 0;
+    uint64_t upto = 0;
+    for (size_t i = 0; i < n; ++i) {
+        append_req_t *req = reqs[i];
+        uint32_t kl = (uint32_t)req->klen, vl = (uint32_t)req->vlen;
+        ls_resv_t r;
+        ls_rec_hdr_t hdr;
+        pthread_mutex_lock(&ls->tail_lock);
+        _ls_tail_reserve(ls, LS_REC_SIZE(kl, vl), &r);
+        _ls_rec_encode(&hdr, ls->next_seq++, 0, req->k, kl, req->v, vl);
+        uint64_t end_seq = ls->next_seq;
+        uint64_t loc = LS_LOC(r.seg->id, r.off);
+        pthread_mutex_unlock(&ls->tail_lock);
+
+        struct iovec rec[3] = {
+            {.iov_base = &hdr, .iov_len = sizeof(hdr)},
+            {.iov_base = req->k, .iov_len = req->klen},
+            {.iov_base = req->v, .iov_len = req->vlen},
+        };
+        ssize_t w = _ls_write_range(NULL, r.seg->fd, rec, 3, r.off, 0, 0);
+
+        pthread_mutex_lock(&ls->tail_lock);
+        int ok = _ls_tail_publish(ls, &r, w >= 0 && (uint64_t)w == r.len);
+        pthread_mutex_unlock(&ls->tail_lock);
+
+        pthread_mutex_lock(&ls->idx_mu);
+        _ls_index_turn(ls, r.turn);
+        if (!ok) {
+            LOG_ERROR("logstore: record write failed");
+        } else {
+            uint8_t iv[LS_IDX_VAL_SIZE];
+            memcpy(iv, &loc, 8);
+            memcpy(iv + 8, &vl, 4);
+            db_kv_t kv = {req->k, req->klen, iv, sizeof iv};
+            _ls_bloom_note(ls, &req, 1);
+            (void)_ls_index_commit(ls, &kv, 1, loc + r.len, end_seq);
+            pthread_rwlock_wrlock(&ls->idx_lock);
+            _ls_mem_index_publish(ls, req->k, req->klen, loc, vl);
+            pthread_rwlock_unlock(&ls->idx_lock);
+            grow |= _ls_bloom_grow_if_full(ls);
+        }
+        _ls_index_turn_done(ls);
+        pthread_mutex_unlock(&ls->idx_mu);
+
+        pthread_mutex_lock(&ls->tail_lock);
+        _ls_gc_mark(ls, req->ticket, ok);
+        ls->gc_settled = ls->gc_written;
+        upto = ls->gc_written;
+        pthread_mutex_unlock(&ls->tail_lock);
+        has_ticket |= req->ticket != 0;
+    }
+    if (ls->fsync_policy == PO_LS_FSYNC_EACH_BATCH || has_ticket)
+        _ls_sync_publish(ls, upto);
+    if (grow)
+        _ls_bloom_rebuild(ls);
+}
+
+// Persist one batch of (non-sentinel) requests. Only the reservation, the
+// publication and the ticket marks hold tail_lock; the write runs in parallel
+// with other workers', and the index commit only waits for earlier batches'
+// index commits.
+static void _ls_flush_batch(po_logstore_t *ls, ls_uring_t *ring, append_req_t **reqs,
+                            size_t n) {
+    size_t iov_cnt = n * 3u;
+    struct iovec *iov = malloc(sizeof(struct iovec) * iov_cnt);
+    uint64_t *offs = malloc(sizeof(uint64_t) * n);
+    uint32_t *lens = malloc(sizeof(uint32_t) * n);
+    ls_rec_hdr_t *hdrs = malloc(sizeof(ls_rec_hdr_t) * n);
+
+    // Check if the test hook requests a failure
+    if (po_test_logstore_fail_vector_alloc(0) || !iov || !offs || !lens || !hdrs) {
+        // Allocation failure for vectorized flush path: free any partial allocations
+        // and fall back to the per-record write path to ensure requests are not leaked.
+        free(iov);
+        free(offs);
+        free(lens);
+        free(hdrs);
+        _ls_flush_each(ls, reqs, n);
+        return;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += LS_REC_SIZE(reqs[i]->klen, reqs[i]->vlen);
+
+    pthread_mutex_lock(&ls->tail_lock);
+    ls_resv_t r;
+    _ls_tail_reserve(ls, total, &r);
+    // A linked io_uring sync cannot cover the directory entry of a segment
+    // rolled since its last sync: such batches take _ls_sync_publish().
+    ls_uring_t *sync_ring =
+        atomic_load(&ls->dir_synced) == atomic_load(&ls->dir_gen) ? ring : NULL;
+    // With no other range in flight, tickets can be marked before the write
+    // so that an io_uring sync linked to it covers them. Otherwise an earlier
+    // range may still be unwritten: they are marked on publication and synced
+    // after it.
+    int early = sync_ring && r.turn == ls->pub_next;
+    int has_ticket = 0;
+    uint64_t cur = r.off;
+    for (size_t i = 0; i < n; ++i) {
+        append_req_t *req = reqs[i];
+        uint32_t vl = (uint32_t)req->vlen;
+        _ls_rec_encode(&hdrs[i], ls->next_seq++, 0, req->k, (uint32_t)req->klen, req->v, vl);
+        lens[i] = vl;
+        offs[i] = LS_LOC(r.seg->id, cur);
+        iov[3 * i] = (struct iovec){.iov_base = &hdrs[i], .iov_len = sizeof(hdrs[i])};
+        iov[3 * i + 1] = (struct iovec){.iov_base = req->k, .iov_len = req->klen};
+        iov[3 * i + 2] = (struct iovec){.iov_base = req->v, .iov_len = req->vlen};
+        cur += LS_REC_SIZE(req->klen, vl);
+        if (early)
+            _ls_gc_mark(ls, req->ticket, 1);
+        has_ticket |= req->ticket != 0;
+    }
+    uint64_t end_seq = ls->next_seq;
+    uint64_t end_loc = LS_LOC(r.seg->id, cur);
+    // Group commit: a batch holding tickets is always synced
+    int sync = _ls_sync_due(ls) || has_ticket;
+    uint64_t upto = ls->gc_written;
+    pthread_mutex_unlock(&ls->tail_lock);
+
+    // With io_uring the linked sync completes in the background; only the
+    // write is waited for.
+    ssize_t w = _ls_write_range(ring, r.seg->fd, iov, iov_cnt, r.off, early && sync, upto);
+
+    pthread_mutex_lock(&ls->tail_lock);
+    int wrote = _ls_tail_publish(ls, &r, w >= 0 && (uint64_t)w == total);
+    pthread_mutex_unlock(&ls->tail_lock);
+
+    // The LMDB commit syncs: under idx_mu, later batches reserve, write and
+    // publish meanwhile and only their own index commits wait behind it.
+    pthread_mutex_lock(&ls->idx_mu);
+    _ls_index_turn(ls, r.turn);
+    int grow = 0;
+    if (wrote)
+        grow = _ls_index_batch(ls, reqs, n, offs, lens, end_loc, end_seq);
+    else
+        LOG_ERROR("logstore: pwritev/writev failed");
+    _ls_index_turn_done(ls);
+    pthread_mutex_unlock(&ls->idx_mu);
+
+    // Marked once indexed, so a durable ticket's record is also found by get()
+    pthread_mutex_lock(&ls->tail_lock);
+    for (size_t i = 0; i < n; ++i) {
+        if (!early || !wrote)
+            _ls_gc_mark(ls, reqs[i]->ticket, wrote);
+    }
+    ls->gc_settled = ls->gc_written;
+    if (!early)
+        upto = ls->gc_written;
+    pthread_mutex_unlock(&ls->tail_lock);
+
+    if (wrote && sync && !early) {
+        if (!sync_ring || _ls_uring_sync_active(sync_ring, upto) != 0)
+            _ls_sync_publish(ls, upto);
+    }
+    // After the sync, so that this batch's waiters are not held up either
+    if (grow)
+        _ls_bloom_rebuild(ls);
+    free(iov);
+    free(offs);
+    free(lens);
+    free(hdrs);
+}
+
 // Worker thread: drains batched append requests and persists them.
 void *_ls_worker_main(void *arg) {
     po_logstore_t *ls = (po_logstore_t *)arg;
     void **batch = malloc(sizeof(void *) * ls->batch_size);
-    if (!batch)
-        return NULL;
+
+    ls_uring_t *ring = NULL;
+    if (batch && ls->io_backend == PO_LS_IO_URING) {
+        ring = _ls_uring_open(ls);
+        if (ring) {
+            atomic_fetch_add(&ls->uring_workers, 1);
+        } else {
+            LOG_WARN("logstore: io_uring unavailable (errno=%d); flushing with pwritev", errno);
+            PO_METRIC_COUNTER_INC("logstore.io.uring_fallback");
+        }
+    }
 
     PO_METRIC_TIMER_CREATE("logstore.flush.ns");
-    static const uint64_t _flush_bins[] = {1000,   5000,    10000,   50000,   100000,
-                                           500000, 1000000, 5000000, 10000000};
-    PO_METRIC_HISTO_CREATE("logstore.flush.latency", _flush_bins,
-                           sizeof(_flush_bins) / sizeof(_flush_bins[0]));
+    PO_METRIC_HISTO_CREATE_HDR("logstore.flush.latency");
     atomic_store(&ls->worker_ready, 1); // signal readiness so open() can proceed
 
-    for (;;) {
+    while (batch) {
+        if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0)
+            break;
         ssize_t n = perf_batcher_next(ls->b, batch);
         if (n < 0) {
             struct timespec ts = {.tv_sec = 0, .tv_nsec = 1 * 1000 * 1000};
             nanosleep(&ts, NULL);
-            if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0)
-                break;
             continue;
         }
-        if (n == 0) {
-            if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0)
-                break;
-            continue; // spurious wake
-        }
-        PO_METRIC_COUNTER_INC("logstore.flush.batch_count");
-        PO_METRIC_COUNTER_ADD("logstore.flush.batch_records", n);
-        PO_METRIC_TIMER_START("logstore.flush.ns");
-        PO_METRIC_TICK(_flush_start);
-        if (n == 1) {
-            append_req_t *only = (append_req_t *)batch[0];
-            if (only && only->k == NULL && only->v == NULL) {
-                free(only); // sentinel
-                ls->sentinel = NULL;
-                if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0)
-                    break;
-                else {
-                    PO_METRIC_TIMER_STOP("logstore.flush.ns");
-                    PO_METRIC_HISTO_RECORD("logstore.flush.latency", 0);
-                    continue;
-                }
-            }
-        }
-
-        // Count live records (skip sentinel if present)
-        int sentinel_seen = 0;
-        ssize_t live = 0;
+        // Shutdown sentinels only wake the worker: drop them from the batch
+        size_t live = 0;
         for (ssize_t i = 0; i < n; ++i) {
             append_req_t *req = (append_req_t *)batch[i];
-            if (req == ls->sentinel) {
-                sentinel_seen = 1;
-                continue;
-            }
-            live++;
-        }
-        if (live == 0 && sentinel_seen) {
-            if (ls->sentinel) {
-                free(ls->sentinel);
-                ls->sentinel = NULL;
-            }
-            if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0)
-                break;
-            continue;
-        }
-
-        off_t base = lseek(ls->fd, 0, SEEK_END);
-        if (base < 0) {
-            LOG_ERROR("logstore: lseek failed");
-            base = 0;
-        }
-
-        size_t iov_cnt = (size_t)live * 4u;
-        struct iovec *iov = malloc(sizeof(struct iovec) * iov_cnt);
-        uint64_t *offs = malloc(sizeof(uint64_t) * (size_t)live);
-        uint32_t *lens = malloc(sizeof(uint32_t) * (size_t)live);
-        uint32_t *kls_arr = malloc(sizeof(uint32_t) * (size_t)live);
-
-        // Check if the test hook requests a failure
-        if (po_test_logstore_fail_vector_alloc(0)) {
-            // Simulate allocation failure by freeing any partial buffers and nulling pointers.
-            if (iov)
-                free(iov);
-            if (offs)
-                free(offs);
-            if (lens)
-                free(lens);
-            if (kls_arr)
-                free(kls_arr);
-            iov = NULL;
-            offs = NULL;
-            lens = NULL;
-            kls_arr = NULL;
-        }
-        if (!iov || !offs || !lens || !kls_arr) {
-            // Allocation failure for vectorized flush path: free any partial allocations
-            // and fall back to the per-record write path to ensure requests are not leaked.
-            if (iov)
-                free(iov);
-            if (offs)
-                free(offs);
-            if (lens)
-                free(lens);
-            if (kls_arr)
-                free(kls_arr);
-            iov = NULL;
-            offs = NULL;
-            lens = NULL;
-            kls_arr = NULL;
-
-            for (ssize_t i = 0; i < n; ++i) {
-                append_req_t *req = (append_req_t *)batch[i];
-                if (req == ls->sentinel)
-                    continue;
-                uint32_t kl = (uint32_t)req->klen, vl = (uint32_t)req->vlen;
-                off_t off = lseek(ls->fd, 0, SEEK_END);
-                if (off < 0)
-                    off = 0;
-                if (write(ls->fd, &kl, sizeof(kl)) != (ssize_t)sizeof(kl))
-                    LOG_ERROR("logstore: write kl failed");
-                if (write(ls->fd, &vl, sizeof(vl)) != (ssize_t)sizeof(vl))
-                    LOG_ERROR("logstore: write vl failed");
-                if (write(ls->fd, req->k, req->klen) != (ssize_t)req->klen)
-                    LOG_ERROR("logstore: write key failed");
-                if (write(ls->fd, req->v, req->vlen) != (ssize_t)req->vlen)
-                    LOG_ERROR("logstore: write val failed");
-                uint8_t iv[12];
-                memcpy(iv, &off, 8);
-                memcpy(iv + 8, &vl, 4);
-                (void)db_put(ls->idx, req->k, req->klen, iv, sizeof iv);
-                pthread_rwlock_wrlock(&ls->idx_lock);
-                (void)po_index_put(ls->mem_idx, req->k, req->klen, (uint64_t)off, vl);
-                pthread_rwlock_unlock(&ls->idx_lock);
-                free(req); // single allocation
-                atomic_fetch_sub(&ls->outstanding_reqs, 1);
-            }
-            if (ls->fsync_policy == PO_LS_FSYNC_EACH_BATCH)
-                fsync(ls->fd);
-            goto post_batch;
+            if (_ls_req_is_sentinel(req))
+                free(req);
+            else
+                batch[live++] = req;
         }
+        if (live == 0)
+            continue; // spurious wake or sentinel only
 
-        uint64_t cur = (uint64_t)base;
-        size_t j = 0;
-        size_t rec_index = 0;
-        for (ssize_t i = 0; i < n; ++i) {
-            append_req_t *req = (append_req_t *)batch[i];
-            if (req == ls->sentinel)
-                continue;
-            uint32_t vl = (uint32_t)req->vlen;
-            kls_arr[rec_index] = (uint32_t)req->klen;
-            lens[rec_index] = vl;
-            offs[rec_index] = cur;
-            iov[j++] = (struct iovec){.iov_base = &kls_arr[rec_index], .iov_len = sizeof(uint32_t)};
-            cur += sizeof(uint32_t);
-            iov[j++] = (struct iovec){.iov_base = &lens[rec_index], .iov_len = sizeof(uint32_t)};
-            cur += sizeof(uint32_t);
-            iov[j++] = (struct iovec){.iov_base = req->k, .iov_len = req->klen};
-            cur += (uint64_t)req->klen;
-            iov[j++] = (struct iovec){.iov_base = req->v, .iov_len = req->vlen};
-            cur += (uint64_t)req->vlen;
-            rec_index++;
-        }
-        ssize_t w = -1;
-#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__GLIBC__)
-        errno = 0;
-        w = pwritev(ls->fd, iov, (int)iov_cnt, base);
-        if (w < 0 && (errno == ENOSYS || errno == EINVAL)) {
-            if (lseek(ls->fd, base, SEEK_SET) >= 0) {
-                w = writev(ls->fd, iov, (int)iov_cnt);
-            }
-        }
-#else
-        if (lseek(ls->fd, base, SEEK_SET) >= 0)
-            w = writev(ls->fd, iov, (int)iov_cnt);
-#endif
-        if (w < 0) {
-            LOG_ERROR("logstore: pwritev/writev failed");
-        } else {
-            rec_index = 0;
-            for (ssize_t i = 0; i < n; ++i) {
-                append_req_t *req = (append_req_t *)batch[i];
-                if (req == ls->sentinel)
-                    continue;
-                uint8_t iv[12];
-                memcpy(iv, &offs[rec_index], 8);
-                memcpy(iv + 8, &lens[rec_index], 4);
-                (void)db_put(ls->idx, req->k, req->klen, iv, sizeof iv);
-                pthread_rwlock_wrlock(&ls->idx_lock);
-                (void)po_index_put(ls->mem_idx, req->k, req->klen, offs[rec_index],
-                                   lens[rec_index]);
-                pthread_rwlock_unlock(&ls->idx_lock);
-                rec_index++;
-            }
-            if (ls->fsync_policy == PO_LS_FSYNC_EACH_BATCH)
-                fsync(ls->fd);
-            else if (ls->fsync_policy == PO_LS_FSYNC_EVERY_N) {
-                ls->batches_since_fsync++;
-                if (ls->batches_since_fsync >= (ls->fsync_every_n ? ls->fsync_every_n : 1)) {
-                    (void)fsync(ls->fd);
-                    ls->batches_since_fsync = 0;
-                }
-            } else if (ls->fsync_policy == PO_LS_FSYNC_INTERVAL) {
-                uint64_t now = _ls_now_ns();
-                if (now - ls->last_fsync_ns >= ls->fsync_interval_ns) {
-                    (void)fsync(ls->fd);
-                    ls->last_fsync_ns = now;
-                }
-            }
-        }
-        for (ssize_t i = 0; i < n; ++i) {
-            append_req_t *req = (append_req_t *)batch[i];
-            if (req == ls->sentinel)
-                continue;
-            free(req);
+        PO_METRIC_COUNTER_INC("logstore.flush.batch_count");
+        PO_METRIC_COUNTER_ADD("logstore.flush.batch_records", live);
+        PO_METRIC_TIMER_START("logstore.flush.ns");
+        PO_METRIC_TICK(_flush_start);
+        _ls_flush_batch(ls, ring, (append_req_t **)batch, live);
+        for (size_t i = 0; i < live; ++i) {
+            free(batch[i]); // single allocation
             atomic_fetch_sub(&ls->outstanding_reqs, 1);
         }
         atomic_fetch_add(&ls->metric_records_flushed, (uint64_t)live);
         atomic_fetch_add(&ls->metric_batches_flushed, 1);
         PO_METRIC_COUNTER_ADD("logstore.flush.records", live);
-        PO_METRIC_COUNTER_INC("logstore.flush.batch_count");
         PO_METRIC_TIMER_STOP("logstore.flush.ns");
         uint64_t elapsed = PO_METRIC_ELAPSED_NS(_flush_start);
         PO_METRIC_HISTO_RECORD("logstore.flush.latency", elapsed);
-        if (sentinel_seen && ls->sentinel) {
-            free(ls->sentinel);
-            ls->sentinel = NULL;
-        }
-        free(iov);
-        free(offs);
-        free(lens);
-        free(kls_arr);
-    post_batch:
-        if (!atomic_load(&ls->running) && perf_ringbuf_count(ls->q) == 0 && ls->sentinel == NULL) {
-            // Final defensive drain (paranoia)
-            void *left = NULL;
-            while (perf_ringbuf_dequeue(ls->q, &left) == 0) {
-                append_req_t *req = (append_req_t *)left;
-                if (!req)
-                    continue;
-                if (req == ls->sentinel) {
-                    free(req);
-                    ls->sentinel = NULL;
-                    continue;
-                }
-                free(req);
-                atomic_fetch_sub(&ls->outstanding_reqs, 1);
-            }
-            break;
-        }
+        // Nothing queued to overlap with: finish in-flight syncs now rather
+        // than at the next write, so their waiters are not left hanging.
+        if (ring && perf_ringbuf_count(ls->q) == 0)
+            _ls_uring_settle(ring);
     }
+    // close() wakes one worker; each one leaving wakes the next, which may be
+    // parked with the queue already drained.
+    if (atomic_fetch_sub(&ls->workers_live, 1) > 1) {
+        append_req_t *sent = calloc(1, sizeof(*sent));
+        if (sent && perf_batcher_enqueue(ls->b, sent) != 0)
+            free(sent);
+    }
+    _ls_uring_close(ring);
     free(batch);
     return NULL;
 }
@@ -307,11 +399,14 @@ void *_ls_fsync_thread_main(void *arg) {
     while (atomic_load(&ls->fsync_thread_run)) {
         struct timespec ts = {.tv_sec = 0, .tv_nsec = (long)interval};
         nanosleep(&ts, NULL);
-        if (!atomic_load(&ls->running)) {
-            (void)fsync(ls->fd);
+        // gc_settled, not gc_written: tickets marked ahead of a linked
+        // io_uring sync may still be unwritten.
+        pthread_mutex_lock(&ls->tail_lock);
+        uint64_t upto = ls->gc_settled;
+        pthread_mutex_unlock(&ls->tail_lock);
+        _ls_sync_publish(ls, upto);
+        if (!atomic_load(&ls->running))
             break;
-        }
-        (void)fsync(ls->fd);
     }
     return NULL;
 }
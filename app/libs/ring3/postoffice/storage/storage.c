@@ -21,6 +21,8 @@ int po_storage_init(const po_storage_config_t *cfg) {
         .ring_capacity = cfg->ring_capacity ? cfg->ring_capacity : 1024,
         .batch_size = cfg->batch_size ? cfg->batch_size : 32,
         .fsync_policy = cfg->fsync_policy,
+        .segment_bytes = cfg->segment_bytes,
+        .background_compact = cfg->background_compact,
     };
     g_ls = po_logstore_open_cfg(&lc);
     if (!g_ls)
@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include <sched.h>
+#include <string.h>
 
 #include "metrics/metrics.h"
 #include "net/framing.h"
@@ -75,6 +76,12 @@ int net_init_zerocopy(size_t tx_buffers, size_t rx_buffers, size_t buf_size) {
         }
     }
 
+    // Per-message counters are bumped by every thread of every process
+    PO_METRIC_COUNTER_CREATE_SHARDED("framing.write.msg");
+    PO_METRIC_COUNTER_CREATE_SHARDED("framing.write.msg.bytes");
+    PO_METRIC_COUNTER_CREATE_SHARDED("framing.read_into.msg");
+    PO_METRIC_COUNTER_CREATE_SHARDED("framing.read_into.msg.bytes");
+
     g_zcpool_refcount++;
     pthread_mutex_unlock(&g_zcpool_create_lock);
 
@@ -214,6 +221,24 @@ int net_send_message(int fd, uint8_t msg_type, uint8_t flags, const uint8_t *pay
     return rc;
 }
 
+size_t net_encode_message(void *buf, size_t cap, uint8_t msg_type, uint8_t flags,
+                          const uint8_t *payload, uint32_t payload_len) {
+    size_t total = sizeof(uint32_t) + sizeof(po_header_t) + payload_len;
+    if (!buf || total > cap || (payload_len && !payload))
+        return 0;
+
+    uint32_t len_be = htonl((uint32_t)(sizeof(po_header_t) + payload_len));
+    po_header_t hdr;
+    protocol_init_header(&hdr, msg_type, flags, payload_len);
+
+    uint8_t *p = buf;
+    memcpy(p, &len_be, sizeof(len_be));
+    memcpy(p + sizeof(len_be), &hdr, sizeof(hdr));
+    if (payload_len)
+        memcpy(p + sizeof(len_be) + sizeof(hdr), payload, payload_len);
+    return total;
+}
+
 int net_send_message_zcp(int fd, uint8_t msg_type, uint8_t flags, void *payload_buf,
                          uint32_t payload_len) {
     PO_METRIC_COUNTER_INC("net.send.zcp");
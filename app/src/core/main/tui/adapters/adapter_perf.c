@@ -0,0 +1,36 @@
+#include "adapter_perf.h"
+
+#include <postoffice/metrics/metrics.h>
+
+#define PERF_SNAPSHOT_MAX 256
+#define PERF_SNAPSHOT_INTERVAL_NS 500000000ull
+
+static po_perf_counter_sample_t g_counters[PERF_SNAPSHOT_MAX];
+static size_t g_counterCount = 0;
+static uint64_t g_lastSnapshotNs = 0;
+
+static po_perf_histogram_summary_t g_histograms[PERF_SNAPSHOT_MAX];
+static size_t g_histogramCount = 0;
+static uint64_t g_lastHistogramNs = 0;
+
+size_t tui_PerfCounters(const po_perf_counter_sample_t **out) {
+    uint64_t now = po_metric_now_ns();
+    if (g_lastSnapshotNs == 0 || now - g_lastSnapshotNs >= PERF_SNAPSHOT_INTERVAL_NS) {
+        // Summing per-CPU slots walks a few KB per sharded counter: throttle it
+        g_counterCount = po_perf_counter_snapshot(g_counters, PERF_SNAPSHOT_MAX);
+        g_lastSnapshotNs = now;
+    }
+    *out = g_counters;
+    return g_counterCount;
+}
+
+size_t tui_PerfHistograms(const po_perf_histogram_summary_t **out) {
+    uint64_t now = po_metric_now_ns();
+    if (g_lastHistogramNs == 0 || now - g_lastHistogramNs >= PERF_SNAPSHOT_INTERVAL_NS) {
+        // Each percentile walks up to ~2k buckets per log-linear histogram
+        g_histogramCount = po_perf_histogram_snapshot(g_histograms, PERF_SNAPSHOT_MAX);
+        g_lastHistogramNs = now;
+    }
+    *out = g_histograms;
+    return g_histogramCount;
+}
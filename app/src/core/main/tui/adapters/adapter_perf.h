@@ -31,4 +31,28 @@
 #ifndef ADAPTER_PERF_H
 #define ADAPTER_PERF_H
 
+#include <postoffice/perf/perf.h>
+#include <stddef.h>
+
+/**
+ * @brief Current counter totals (sharded counters already summed).
+ *
+ * The snapshot is refreshed at most every 500 ms; in between the previous
+ * copy is returned, so calling this every frame is cheap.
+ *
+ * @param[out] out Set to the snapshot array (valid until the next call).
+ * @return Number of counters in the snapshot.
+ */
+size_t tui_PerfCounters(const po_perf_counter_sample_t **out);
+
+/**
+ * @brief Current histogram summaries (count, min/max, p50..p99.9).
+ *
+ * Throttled like tui_PerfCounters().
+ *
+ * @param[out] out Set to the snapshot array (valid until the next call).
+ * @return Number of histograms in the snapshot.
+ */
+size_t tui_PerfHistograms(const po_perf_histogram_summary_t **out);
+
 #endif // ADAPTER_PERF_H
@@ -1,5 +1,6 @@
 #include "screen_performance.h"
 #include "../tui_state.h"
+#include "../adapters/adapter_perf.h"
 #include <clay/clay.h>
 #include <renderer/clay_ncurses_renderer.h>
 
@@ -48,6 +49,71 @@ static void RenderTabs(const char *titles[], uint32_t count, uint32_t activeInde
     }
 }
 
+/**
+ * @brief Renders the perf counters (Libraries tab), one per line.
+ *
+ * Sharded counters are marked with '*': their value is the sum of the
+ * per-CPU slots at snapshot time.
+ */
+static void RenderCounters(void) {
+    const po_perf_counter_sample_t *counters = NULL;
+    size_t count = tui_PerfCounters(&counters);
+
+    CLAY_AUTO_ID({.layout = {.sizing = {.width = CLAY_SIZING_GROW(), .height = CLAY_SIZING_GROW()},
+                             .layoutDirection = CLAY_TOP_TO_BOTTOM}}) {
+        if (count == 0) {
+            CLAY_TEXT(CLAY_STRING("No counters registered"), CLAY_TEXT_CONFIG({.textColor = COLOR_TEXT_DIM}));
+        }
+        for (size_t i = 0; i < count; i++) {
+            CLAY_TEXT(CLAY_STRING_DYN(tui_ScratchFmt("%-48s %14llu%s", counters[i].name,
+                                                     (unsigned long long)counters[i].value,
+                                                     counters[i].sharded ? " *" : "")),
+                      CLAY_TEXT_CONFIG({.textColor = {255, 255, 255, 255}}));
+        }
+    }
+}
+
+/**
+ * @brief Renders the perf histograms (Stats tab) as percentile rows.
+ *
+ * Threshold-bin histograms only know bin edges, so their percentiles are
+ * bin thresholds and min/max are shown as '-'.
+ */
+static void RenderHistograms(void) {
+    const po_perf_histogram_summary_t *hists = NULL;
+    size_t count = tui_PerfHistograms(&hists);
+
+    CLAY_AUTO_ID({.layout = {.sizing = {.width = CLAY_SIZING_GROW(), .height = CLAY_SIZING_GROW()},
+                             .layoutDirection = CLAY_TOP_TO_BOTTOM}}) {
+        if (count == 0) {
+            CLAY_TEXT(CLAY_STRING("No histograms registered"), CLAY_TEXT_CONFIG({.textColor = COLOR_TEXT_DIM}));
+        } else {
+            CLAY_TEXT(CLAY_STRING_DYN(tui_ScratchFmt("%-32s %10s %10s %10s %10s %10s %10s %10s",
+                                                     "histogram", "count", "min", "p50", "p90",
+                                                     "p99", "p99.9", "max")),
+                      CLAY_TEXT_CONFIG({.textColor = COLOR_TEXT_DIM}));
+        }
+        for (size_t i = 0; i < count; i++) {
+            const po_perf_histogram_summary_t *h = &hists[i];
+            if (h->hdr) {
+                CLAY_TEXT(CLAY_STRING_DYN(tui_ScratchFmt(
+                              "%-32s %10llu %10llu %10llu %10llu %10llu %10llu %10llu", h->name,
+                              (unsigned long long)h->count, (unsigned long long)h->min,
+                              (unsigned long long)h->p50, (unsigned long long)h->p90,
+                              (unsigned long long)h->p99, (unsigned long long)h->p999,
+                              (unsigned long long)h->max)),
+                          CLAY_TEXT_CONFIG({.textColor = {255, 255, 255, 255}}));
+            } else {
+                CLAY_TEXT(CLAY_STRING_DYN(tui_ScratchFmt(
+                              "%-32s %10llu %10s %10llu %10llu %10llu %10llu %10s", h->name,
+                              (unsigned long long)h->count, "-", (unsigned long long)h->p50,
+                              (unsigned long long)h->p90, (unsigned long long)h->p99,
+                              (unsigned long long)h->p999, "-")),
+                          CLAY_TEXT_CONFIG({.textColor = {255, 255, 255, 255}}));
+            }
+        }
+    }
+}
 
 /**
  * @brief Renders the Performance Monitor content.
@@ -66,6 +132,12 @@ void tui_RenderPerformanceScreen(void) {
          .border = {.width = {1 * TUI_CW, 1 * TUI_CW, 1 * TUI_CH, 1 * TUI_CH, 0}, 
                     .color = {255, 255, 255, 255}}}) {
 
-        CLAY_TEXT(CLAY_STRING("Performance Metrics - Placeholder"), CLAY_TEXT_CONFIG({.textColor = {255, 255, 255, 255}}));
+        if (g_tuiState.activePerfTab == 1) {
+            RenderCounters();
+        } else if (g_tuiState.activePerfTab == 2) {
+            RenderHistograms();
+        } else {
+            CLAY_TEXT(CLAY_STRING("Performance Metrics - Placeholder"), CLAY_TEXT_CONFIG({.textColor = {255, 255, 255, 255}}));
+        }
     }
 }
@@ -16,7 +16,10 @@ void initialize_configuration_defaults(director_config_t *cfg) {
     cfg->log_level = "INFO";
     cfg->is_headless = false;
     cfg->issuer_pool_size = 64;
+    cfg->issuer_park_timeout_ms = 200;
     cfg->manager_pool_size = 1000;
+    cfg->manager_event_engine = false;
+    cfg->manager_capacity = 0;
     cfg->initial_users = 5;
     cfg->batch_users = 5;
 
@@ -80,6 +83,15 @@ void resolve_complete_configuration(director_config_t *cfg, po_sysinfo_t *sysinf
             if (po_config_get_int(file_cfg, "users_manager", "POOL_SIZE", &um_pool) == 0)
                 cfg->manager_pool_size = um_pool;
 
+            int um_engine;
+            if (po_config_get_int(file_cfg, "users_manager", "EVENT_ENGINE", &um_engine) == 0)
+                cfg->manager_event_engine = (um_engine != 0);
+
+            int um_capacity;
+            if (po_config_get_int(file_cfg, "users_manager", "CAPACITY", &um_capacity) == 0 &&
+                um_capacity > 0)
+                cfg->manager_capacity = um_capacity;
+
             int init_users;
             if (po_config_get_int(file_cfg, "users", "NOF_USERS", &init_users) == 0)
                 cfg->initial_users = init_users;
@@ -95,6 +107,11 @@ void resolve_complete_configuration(director_config_t *cfg, po_sysinfo_t *sysinf
             if (po_config_get_int(file_cfg, "ticket_issuer", "POOL_SIZE", &ti_pool) == 0)
                 cfg->issuer_pool_size = ti_pool;
 
+            int ti_park;
+            if (po_config_get_int(file_cfg, "ticket_issuer", "PARK_TIMEOUT_MS", &ti_park) == 0 &&
+                ti_park >= 0)
+                cfg->issuer_park_timeout_ms = ti_park;
+
             // Load Balancing config
             int lb_enabled;
             if (po_config_get_int(file_cfg, "load_balance", "ENABLED", &lb_enabled) == 0)
@@ -15,7 +15,10 @@ typedef struct {
 
     // Process Configs
     int issuer_pool_size;
+    int issuer_park_timeout_ms; // Long-poll GET_WORK bound (0 disables)
     int manager_pool_size;
+    bool manager_event_engine; // Multiplex users over engine shards instead of threads
+    int manager_capacity;      // Engine user capacity (0 = default)
     int initial_users;
     int batch_users;
 
@@ -32,10 +32,17 @@ static void launch_process(const char *bin, char *const argv[]) {
 
 void spawn_simulation_subsystems(const director_config_t *cfg) {
     // A. Work Broker
-    char pool_str[16];
+    char pool_str[16], park_str[16];
     snprintf(pool_str, sizeof(pool_str), "%d", cfg->issuer_pool_size);
-    char *args_wb[] = {
-        "bin/post_office_work_broker", "-l", (char *)cfg->log_level, "--pool-size", pool_str, NULL};
+    snprintf(park_str, sizeof(park_str), "%d", cfg->issuer_park_timeout_ms);
+    char *args_wb[] = {"bin/post_office_work_broker",
+                       "-l",
+                       (char *)cfg->log_level,
+                       "--pool-size",
+                       pool_str,
+                       "--park-timeout-ms",
+                       park_str,
+                       NULL};
     launch_process("bin/post_office_work_broker", args_wb);
 
     // B. Workers
@@ -46,10 +53,11 @@ void spawn_simulation_subsystems(const director_config_t *cfg) {
     launch_process("bin/post_office_worker", args_w);
 
     // C. Users Manager
-    char init_str[16], batch_str[16], um_pool_str[16];
+    char init_str[16], batch_str[16], um_pool_str[16], um_cap_str[16];
     snprintf(init_str, sizeof(init_str), "%d", cfg->initial_users);
     snprintf(batch_str, sizeof(batch_str), "%d", cfg->batch_users);
     snprintf(um_pool_str, sizeof(um_pool_str), "%d", cfg->manager_pool_size);
+    snprintf(um_cap_str, sizeof(um_cap_str), "%d", cfg->manager_capacity);
     char *args_um[] = {"bin/post_office_users_manager",
                        "-l",
                        (char *)cfg->log_level,
@@ -59,6 +67,10 @@ void spawn_simulation_subsystems(const director_config_t *cfg) {
                        batch_str,
                        "--pool-size",
                        um_pool_str,
+                       "--engine",
+                       cfg->manager_event_engine ? "event" : "thread",
+                       "--capacity",
+                       um_cap_str,
                        NULL};
     launch_process("bin/post_office_users_manager", args_um);
 }
@@ -10,8 +10,22 @@
 
 #include "ctrl_bridge/bridge_mainloop.h"
 #include "director_orch.h"
+#include "ipc/simulation_protocol.h"
 #include "utils/signals.h"
 
+// The director writes every process's log: one file per category
+static const struct {
+    const char *path;
+    sim_log_category_t category;
+    bool append;
+} k_log_files[] = {
+    {"logs/director.log", SIM_LOG_DIRECTOR, false},
+    {"logs/work_broker.log", SIM_LOG_WORK_BROKER, true},
+    {"logs/workers.log", SIM_LOG_WORKERS, true},
+    {"logs/users_manager.log", SIM_LOG_USERS_MANAGER, false},
+    {"logs/users.log", SIM_LOG_USERS, false},
+};
+
 // Static pointers for signal handlers to access flags in main
 static volatile sig_atomic_t *g_ptr_running = NULL;
 static volatile sig_atomic_t *g_ptr_sigchld = NULL;
@@ -41,13 +55,21 @@ int director_setup_subsystems(const director_config_t *cfg, director_sig_ctx_t s
                                                ? LOG_INFO
                                                : po_logger_level_from_str(cfg->log_level),
                                   .ring_capacity = 4096,
-                                  .consumers = 1};
+                                  .consumers = 1,
+                                  .async_writer = true,
+                                  .rotate_bytes = 64u << 20,
+                                  .rotate_keep = 3,
+                                  .default_category = SIM_LOG_DIRECTOR,
+                                  .shm_name = SIM_LOG_SHM_NAME,
+                                  .shm_serve = true};
 
     if (po_logger_init(&log_cfg) != 0) {
         return -1;
     }
-    po_logger_add_sink_file("logs/director.log", false);
-    po_logger_add_sink_console(false);
+    for (size_t i = 0; i < sizeof(k_log_files) / sizeof(k_log_files[0]); i++)
+        po_logger_add_sink_file_categorized(k_log_files[i].path, k_log_files[i].append,
+                                            1u << k_log_files[i].category);
+    po_logger_add_sink_console_categorized(false, 1u << SIM_LOG_DIRECTOR);
 
     // 3. Signals
     g_ptr_running = sig_ctx.running_flag;
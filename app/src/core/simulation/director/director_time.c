@@ -128,17 +128,8 @@ void execute_simulation_clock_loop(sim_shm_t *shm, const director_config_t *cfg,
         // Check for Closing Time (17:00)
         if (hour == 17 && minute == 0) {
             LOG_INFO("Office Closing (17:00) - Interrupting all active work/queues.");
-            for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
-                // Determine how many waiting
-                unsigned int waiting = atomic_load(&shm->queues[i].waiting_count);
-                if (waiting > 0) {
-                    LOG_DEBUG("Flushing Queue %d (%u users waiting)", i, waiting);
-                    // Wake all users waiting on cond_served -> they will check time >= 17 and leave
-                    pthread_mutex_lock(&shm->queues[i].mutex);
-                    pthread_cond_broadcast(&shm->queues[i].cond_served);
-                    pthread_mutex_unlock(&shm->queues[i].mutex);
-                }
-            }
+            // Wake every user blocked on a ticket -> they will check time >= 17 and leave
+            po_completion_wake_all(&shm->completions);
         }
 
         /* Load Balance Check (during office hours) */
@@ -9,7 +9,9 @@
 
 #include <errno.h>
 #include <postoffice/log/logger.h>
+#include <postoffice/net/net.h>
 #include <postoffice/net/socket.h>
+#include <postoffice/sysinfo/sysinfo.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
@@ -23,14 +25,18 @@
 
 // --- Connection ---
 
-int sim_client_connect_issuer(volatile atomic_bool *should_continue, sim_shm_t *shm) {
+void sim_client_issuer_path(char *buf, size_t len) {
     const char *user_home = getenv("HOME");
-    char sock_path[512];
     if (user_home) {
-        snprintf(sock_path, sizeof(sock_path), "%s/.postoffice/issuer.sock", user_home);
+        snprintf(buf, len, "%s/.postoffice/issuer.sock", user_home);
     } else {
-        snprintf(sock_path, sizeof(sock_path), "/tmp/postoffice_%d_issuer.sock", getuid());
+        snprintf(buf, len, "/tmp/postoffice_%d_issuer.sock", getuid());
     }
+}
+
+int sim_client_connect_issuer(volatile atomic_bool *should_continue, sim_shm_t *shm) {
+    char sock_path[512];
+    sim_client_issuer_path(sock_path, sizeof(sock_path));
 
     LOG_DEBUG("Attempting to connect to Ticket Issuer socket: %s",
               sock_path); // Keep DEBUG or TRACE
@@ -67,6 +73,119 @@ int sim_client_connect_issuer(volatile atomic_bool *should_continue, sim_shm_t *
     return socket_fd;
 }
 
+// --- Broker Sessions ---
+
+// Per-request receive timeout; a broker that stays silent longer than this is
+// treated as gone and the session reconnects.
+#define SESSION_RECV_TIMEOUT_MS 500
+
+// Attempts per call. A retry resends the request with the same correlation ID
+// over a fresh session, which the broker uses to answer a repeated JOIN with
+// the ticket it already issued.
+#define SESSION_MAX_ATTEMPTS 3
+
+void sim_client_session_init(sim_client_session_t *session) {
+    if (!session)
+        return;
+    session->fd = -1;
+    session->next_request_id = 0;
+}
+
+void sim_client_session_close(sim_client_session_t *session) {
+    if (!session || session->fd < 0)
+        return;
+    po_socket_close(session->fd);
+    session->fd = -1;
+}
+
+static int session_ensure_connected(sim_client_session_t *session,
+                                    volatile atomic_bool *should_continue, sim_shm_t *shm) {
+    if (session->fd >= 0)
+        return 0;
+
+    int fd = sim_client_connect_issuer(should_continue, shm);
+    if (fd < 0)
+        return -1;
+
+    struct timeval tv = {.tv_sec = SESSION_RECV_TIMEOUT_MS / 1000,
+                         .tv_usec = (SESSION_RECV_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    session->fd = fd;
+    return 0;
+}
+
+/**
+ * @brief Send one request and wait for the reply carrying its correlation ID.
+ * @return 0 on success, -1 on failure (the session is closed).
+ */
+static int session_round_trip(sim_client_session_t *session, uint8_t req_type, const void *req,
+                              uint32_t req_len, uint32_t request_id, uint8_t resp_type,
+                              void *resp, uint32_t resp_len) {
+    if (net_send_message(session->fd, req_type, PO_FLAG_NONE, (const uint8_t *)req, req_len) !=
+        0) {
+        sim_client_session_close(session);
+        return -1;
+    }
+
+    for (;;) {
+        po_header_t h;
+        zcp_buffer_t *p = NULL;
+        if (net_recv_message_blocking(session->fd, &h, &p) != 0 || !p) {
+            if (p)
+                net_zcp_release_rx(p);
+            sim_client_session_close(session);
+            return -1;
+        }
+
+        if (h.msg_type != resp_type || h.payload_len < resp_len) {
+            LOG_WARN("Broker session: unexpected reply type 0x%02X (len=%u)", h.msg_type,
+                     h.payload_len);
+            net_zcp_release_rx(p);
+            sim_client_session_close(session);
+            return -1;
+        }
+
+        uint32_t reply_id;
+        memcpy(&reply_id, p, sizeof(reply_id));
+        if (reply_id != request_id) {
+            // Reply to an earlier request we already gave up on
+            LOG_DEBUG("Broker session: dropping stale reply %u (want %u)", reply_id, request_id);
+            net_zcp_release_rx(p);
+            continue;
+        }
+
+        memcpy(resp, p, resp_len);
+        net_zcp_release_rx(p);
+        return 0;
+    }
+}
+
+int sim_client_session_call(sim_client_session_t *session, volatile atomic_bool *should_continue,
+                            sim_shm_t *shm, uint8_t req_type, void *req, uint32_t req_len,
+                            uint8_t resp_type, void *resp, uint32_t resp_len) {
+    if (!session || !req || !resp || req_len < sizeof(uint32_t) || resp_len < sizeof(uint32_t))
+        return -1;
+
+    // 0 is reserved so a zeroed reply never matches by accident
+    uint32_t request_id = ++session->next_request_id;
+    if (request_id == 0)
+        request_id = ++session->next_request_id;
+    memcpy(req, &request_id, sizeof(request_id));
+
+    for (int attempt = 0; attempt < SESSION_MAX_ATTEMPTS; attempt++) {
+        if (attempt > 0 && should_continue && !atomic_load(should_continue))
+            break;
+        if (session_ensure_connected(session, should_continue, shm) != 0)
+            return -1;
+        if (session_round_trip(session, req_type, req, req_len, request_id, resp_type, resp,
+                               resp_len) == 0)
+            return 0;
+        LOG_DEBUG("Broker session: request %u failed (attempt %d), retrying", request_id,
+                  attempt + 1);
+    }
+    return -1;
+}
+
 // --- Time & Sync ---
 
 void sim_client_read_time(sim_shm_t *shm, int *day, int *hour, int *minute) {
@@ -126,6 +245,31 @@ void sim_client_wait_barrier(sim_shm_t *shm, int *last_synced_day,
     }
 }
 
+// --- Logging ---
+
+int sim_client_init_logger(const char *level, uint32_t category, const char *fallback_path) {
+    po_sysinfo_t si;
+    size_t cache =
+        (po_sysinfo_collect(&si) == 0 && si.dcache_lnsize > 0) ? (size_t)si.dcache_lnsize : 64;
+    int lvl = level ? po_logger_level_from_str(level) : -1;
+    po_logger_config_t cfg = {
+        .level = lvl == -1 ? LOG_INFO : (po_log_level_t)lvl,
+        .ring_capacity = 1024,
+        .consumers = 1,
+        .cacheline_bytes = cache,
+        .deferred_format = true,
+        .rotate_bytes = 64u << 20,
+        .rotate_keep = 3,
+        .default_category = category,
+        .shm_name = SIM_LOG_SHM_NAME,
+    };
+    if (po_logger_init(&cfg) != 0)
+        return -1;
+    // Opens nothing while attached to the director's ring
+    (void)po_logger_add_sink_file_categorized(fallback_path, true, 1u << category);
+    return 0;
+}
+
 // --- Signals ---
 
 void sim_client_setup_signals(void (*handler)(int, siginfo_t *, void *)) {
@@ -4,11 +4,17 @@
 #include <signal.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "simulation_ipc.h"
 
 // --- Connection ---
+/**
+ * @brief Resolve the Work Broker (Ticket Issuer) UNIX socket path.
+ */
+void sim_client_issuer_path(char *buf, size_t len);
+
 /**
  * @brief Retry loop to connect to the Ticket Issuer via UNIX socket.
  *
@@ -18,6 +24,56 @@
  */
 int sim_client_connect_issuer(volatile atomic_bool *should_continue, sim_shm_t *shm);
 
+// --- Broker Sessions ---
+/**
+ * @brief Long-lived, pipelined connection to the Work Broker.
+ *
+ * One session is owned by exactly one thread (worker or user). The socket is
+ * opened lazily on the first request and reused for every following one; it is
+ * only dropped (and transparently re-established) after an I/O error or a
+ * timeout. Each request is tagged with a fresh correlation ID so a late reply to
+ * an abandoned request is recognised and discarded; a request retried over a new
+ * socket keeps its ID.
+ */
+typedef struct sim_client_session_s {
+    int fd;                   // Connected socket, -1 while disconnected
+    uint32_t next_request_id; // Monotonic correlation ID generator
+} sim_client_session_t;
+
+/**
+ * @brief Initialize a disconnected session.
+ */
+void sim_client_session_init(sim_client_session_t *session);
+
+/**
+ * @brief Perform one request/response round trip over the session.
+ *
+ * Stamps a new correlation ID into the first 4 bytes of @p req (see
+ * simulation_protocol.h), sends it, and reads replies until the one carrying the
+ * same ID arrives. Stale replies are dropped. After an I/O error or a timeout the
+ * request is resent, with the same ID, over a reconnected session (up to 3
+ * attempts in all).
+ *
+ * @param session Session owned by the calling thread.
+ * @param should_continue Interruption flag forwarded to the connect retry loop.
+ * @param shm Pointer to SHM for logging time context (optional).
+ * @param req_type Request message type.
+ * @param req Request payload (first member must be the request_id).
+ * @param req_len Request payload size.
+ * @param resp_type Expected response message type.
+ * @param resp Output buffer for the response payload (first member request_id).
+ * @param resp_len Expected response payload size.
+ * @return 0 on success, -1 on failure (session is disconnected on I/O errors).
+ */
+int sim_client_session_call(sim_client_session_t *session, volatile atomic_bool *should_continue,
+                            sim_shm_t *shm, uint8_t req_type, void *req, uint32_t req_len,
+                            uint8_t resp_type, void *resp, uint32_t resp_len);
+
+/**
+ * @brief Close the session socket (safe on a disconnected session).
+ */
+void sim_client_session_close(sim_client_session_t *session);
+
 // --- Synchronization ---
 /**
  * @brief Reads current simulation time from SHM.
@@ -34,6 +90,23 @@ void sim_client_read_time(sim_shm_t *shm, int *day, int *hour, int *minute);
 void sim_client_wait_barrier(sim_shm_t *shm, int *last_synced_day,
                              volatile sig_atomic_t *g_running);
 
+// --- Logging ---
+/**
+ * @brief Start the logger of a simulation client process.
+ *
+ * Joins the director's shared log ring with @p category as the default
+ * category, so the director writes the records. Only when no director serves
+ * the ring does the process keep a private ring and append the records of
+ * @p category to @p fallback_path itself. The deferred formatting and
+ * rotation configured here apply only then (see po_logger_init()).
+ *
+ * @param level Level name (NULL or unknown: INFO).
+ * @param category The process's SIM_LOG_* category.
+ * @param fallback_path Log file used without the director's ring.
+ * @return 0 on success, -1 if the logger could not start.
+ */
+int sim_client_init_logger(const char *level, uint32_t category, const char *fallback_path);
+
 // --- Signal Handling ---
 /**
  * @brief Sets up standard termination signals (SIGINT, SIGTERM).
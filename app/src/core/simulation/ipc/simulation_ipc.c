@@ -144,10 +144,11 @@ sim_shm_t *sim_ipc_shm_create(size_t n_workers) {
         // Initialize Queue Condition Variables
         for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
             pthread_cond_init(&shm->queues[i].cond_added, &cattr);
-            pthread_cond_init(&shm->queues[i].cond_served, &cattr);
         }
         pthread_condattr_destroy(&cattr);
 
+        po_completion_init(&shm->completions);
+
         close(shm_fd);
         LOG_DEBUG("sim_ipc_shm_create() - SHM Created at %p (size: %zu)", ptr, total_size);
         return shm;
@@ -1,10 +1,12 @@
 #ifndef PO_SIMULATION_PROTOCOL_H
 #define PO_SIMULATION_PROTOCOL_H
 
+#include <postoffice/concurrency/completion.h>
 #include <postoffice/perf/cache.h> // For PO_CACHE_LINE_MAX
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -17,6 +19,7 @@
 /* --- Constants --- */
 
 #define SIM_SHM_NAME "/postoffice_shm"
+#define SIM_LOG_SHM_NAME "/postoffice_log_shm" // log ring served by the director
 // Socket path will be determined at runtime (e.g. $HOME/.postoffice/launcher.sock)
 // Semaphore key will be derived via ftok
 
@@ -40,6 +43,18 @@ typedef enum {
     SERVICE_TYPE_COUNT = 4
 } service_type_t;
 
+/**
+ * @brief Log categories. Every process logs into the director's shared log
+ * ring, and the director writes each category to its own file.
+ */
+typedef enum {
+    SIM_LOG_DIRECTOR = 0,  // logs/director.log
+    SIM_LOG_WORK_BROKER,   // logs/work_broker.log
+    SIM_LOG_WORKERS,       // logs/workers.log
+    SIM_LOG_USERS_MANAGER, // logs/users_manager.log
+    SIM_LOG_USERS,         // logs/users.log
+} sim_log_category_t;
+
 /**
  * @brief Status of a single worker.
  */
@@ -71,12 +86,11 @@ _Static_assert(sizeof(worker_status_t) % PO_CACHE_LINE_MAX == 0, "worker_status_
 typedef struct __attribute__((aligned(PO_CACHE_LINE_MAX))) queue_status_s {
     atomic_uint waiting_count;        // Users currently in queue
     atomic_uint total_served;         // Cumulative users served
-    atomic_uint last_finished_ticket; // Most recently completed ticket
+    atomic_uint last_finished_ticket; // Most recently completed ticket (display only)
 
     // Synchronization for this queue
     pthread_mutex_t mutex;
-    pthread_cond_t cond_added;  // For workers to wait for tickets
-    pthread_cond_t cond_served; // For users to wait for completion
+    pthread_cond_t cond_added; // For workers to wait for tickets
 
     // Ticket Queue for User->Worker handoff
     atomic_uint head;
@@ -176,7 +190,10 @@ typedef struct simulation_shm_s {
     // 6. Live Data - Queues
     queue_status_t queues[SIM_MAX_SERVICE_TYPES];
 
-    // 7. Live Data - Workers (Flexible Array Member)
+    // 7. Per-ticket completion notification (users wait on their own ticket)
+    po_completion_table_t completions;
+
+    // 8. Live Data - Workers (Flexible Array Member)
     // Must be at the end.
     worker_status_t workers[];
 } sim_shm_t;
@@ -215,37 +232,65 @@ typedef struct msg_ticket_resp_s {
     service_type_t assigned_service;
 } msg_ticket_resp_t;
 
+/*
+ * Broker messages travel over long-lived, pipelined sessions (see sim_client.h),
+ * so every request carries a correlation ID that the broker echoes back in the
+ * matching response. It must stay the first member of each struct: the session
+ * layer reads/writes it without knowing the concrete message type.
+ */
+
 /**
  * @brief Request: User joining the queue (Broker Model)
+ *
+ * A retry keeps the request ID, so the broker recognises it by (pid, tid,
+ * request_id) and acknowledges the ticket it already issued.
  */
 typedef struct msg_join_queue_s {
+    uint32_t request_id; // Correlation ID (echoed in msg_join_ack_t)
     pid_t requester_pid;
+    pid_t requester_tid; // Thread owning the session (request IDs are per thread)
     service_type_t service_type;
     int is_vip; // 1 = VIP, 0 = Normal
 } msg_join_queue_t;
 
 /**
  * @brief Response: User joined queue, here is your ticket
+ *
+ * Ticket 0 means the JOIN was refused (queue full); the user may retry.
  */
 typedef struct msg_join_ack_s {
+    uint32_t request_id; // Correlation ID of the originating msg_join_queue_t
     uint32_t ticket_number;
     uint32_t estimated_wait_ms; // Optional hint
 } msg_join_ack_t;
 
 /**
  * @brief Request: Worker asking for a task
+ *
+ * With @c max_wait_ms > 0 the request is a long poll: if the queue is empty
+ * the broker parks the worker and answers as soon as a ticket for the service
+ * arrives, or with ticket 0 once the (broker-clamped) wait expires or a day
+ * barrier starts.
  */
 typedef struct msg_get_work_s {
+    uint32_t request_id; // Correlation ID (echoed in msg_work_item_t)
     pid_t worker_pid;
     service_type_t service_type;
+    uint32_t max_wait_ms; // 0 = answer immediately
 } msg_get_work_t;
 
 /**
  * @brief Response: Work item (Ticket) for worker
  */
 typedef struct msg_work_item_s {
+    uint32_t request_id; // Correlation ID of the originating msg_get_work_t
     uint32_t ticket_number;
     int is_vip; // For worker stats
 } msg_work_item_t;
 
+_Static_assert(offsetof(msg_join_queue_t, request_id) == 0, "request_id must lead the payload");
+_Static_assert(offsetof(msg_join_ack_t, request_id) == 0, "request_id must lead the payload");
+_Static_assert(offsetof(msg_get_work_t, request_id) == 0, "request_id must lead the payload");
+_Static_assert(offsetof(msg_work_item_t, request_id) == 0, "request_id must lead the payload");
+
 #endif // PO_SIMULATION_PROTOCOL_H
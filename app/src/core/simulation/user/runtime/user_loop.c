@@ -12,7 +12,6 @@
 #include <postoffice/net/net.h>
 #include <postoffice/net/socket.h>
 #include <postoffice/random/random.h>
-#include <postoffice/sysinfo/sysinfo.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,20 +37,10 @@ static void on_sig(int s, siginfo_t *i, void *c) {
 }
 
 int initialize_user_runtime(sim_shm_t **out_shm) {
-    po_sysinfo_t si;
-    size_t cache =
-        (po_sysinfo_collect(&si) == 0 && si.dcache_lnsize > 0) ? (size_t)si.dcache_lnsize : 64;
-
     po_metrics_init(0, 0, 0);
+    PO_METRIC_HISTO_CREATE_HDR("user.ticket.wait_ns");
 
-    char *lvl = getenv("PO_LOG_LEVEL");
-    po_logger_init(&(po_logger_config_t){.level = (lvl && po_logger_level_from_str(lvl) != -1)
-                                                      ? po_logger_level_from_str(lvl)
-                                                      : LOG_INFO,
-                                         .ring_capacity = 256,
-                                         .consumers = 1,
-                                         .cacheline_bytes = cache});
-    po_logger_add_sink_file("logs/users.log", true);
+    sim_client_init_logger(getenv("PO_LOG_LEVEL"), SIM_LOG_USERS, "logs/users.log");
     po_logger_add_sink_console(true);
 
     *out_shm = sim_ipc_shm_attach();
@@ -80,42 +69,21 @@ void teardown_user_runtime(sim_shm_t *shm) {
     po_logger_shutdown();
 }
 
-static bool join_queue_broker(sim_shm_t *shm, int service_type, int is_vip,
-                              volatile atomic_bool *should_continue, uint32_t *ticket_out) {
-    int fd = sim_client_connect_issuer(should_continue, shm);
-    if (fd < 0)
-        return false;
-
-    // Timeout
-    struct timeval tv = {.tv_usec = 500000};
-    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    msg_join_queue_t req = {
-        .requester_pid = getpid(), .service_type = (service_type_t)service_type, .is_vip = is_vip};
-
-    if (net_send_message(fd, MSG_TYPE_JOIN_QUEUE, PO_FLAG_NONE, (uint8_t *)&req, sizeof(req)) !=
-        0) {
-        po_socket_close(fd);
-        return false;
-    }
-
-    po_header_t h;
-    zcp_buffer_t *p = NULL;
-    int ret = net_recv_message_blocking(fd, &h, &p);
-    po_socket_close(fd);
+static bool join_queue_broker(sim_client_session_t *session, sim_shm_t *shm, int service_type,
+                              int is_vip, volatile atomic_bool *should_continue,
+                              uint32_t *ticket_out) {
+    msg_join_queue_t req = {.requester_pid = getpid(),
+                            .requester_tid = (pid_t)syscall(SYS_gettid),
+                            .service_type = (service_type_t)service_type,
+                            .is_vip = is_vip};
+    msg_join_ack_t resp;
 
-    if (ret != 0 || !p || h.msg_type != MSG_TYPE_JOIN_ACK) {
-        if (p)
-            net_zcp_release_rx(p);
+    if (sim_client_session_call(session, should_continue, shm, MSG_TYPE_JOIN_QUEUE, &req,
+                                sizeof(req), MSG_TYPE_JOIN_ACK, &resp, sizeof(resp)) != 0)
         return false;
-    }
-
-    msg_join_ack_t resp;
-    memcpy(&resp, p, sizeof(resp));
-    net_zcp_release_rx(p);
 
     *ticket_out = resp.ticket_number;
-    return true;
+    return resp.ticket_number != 0; // 0: queue full, not joined
 }
 
 static void wait_for_office(int user_id, sim_shm_t *shm, volatile atomic_bool *should_continue) {
@@ -153,7 +121,6 @@ static bool wait_service(int user_id, uint32_t ticket, int service, unsigned int
     bool done = false;
     int d, h, m;
 
-    pthread_mutex_lock(&q->mutex);
     while (should_continue && atomic_load(should_continue) && !g_proc_shutdown) {
         if (!atomic_load(&shm->time_control.sim_active))
             break;
@@ -175,23 +142,13 @@ static bool wait_service(int user_id, uint32_t ticket, int service, unsigned int
                       user_id);
         }
 
-        if (atomic_load(&q->last_finished_ticket) >= ticket) {
+        // Sleeps on our own ticket's slot only; times out to re-check the flags above
+        if (po_completion_wait(&shm->completions, ticket, 100) == 0) {
             LOG_DEBUG("[Day %d %02d:%02d] User %d Finished.", d, h, m, user_id);
             done = true;
             break;
         }
-
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        ts.tv_nsec += 100000000;
-        if (ts.tv_nsec >= 1000000000) {
-            ts.tv_sec++;
-            ts.tv_nsec -= 1000000000;
-        }
-
-        pthread_cond_timedwait(&q->cond_served, &q->mutex, &ts);
     }
-    pthread_mutex_unlock(&q->mutex);
     return done;
 }
 
@@ -207,6 +164,10 @@ int run_user_simulation_loop(int user_id, int service_type, sim_shm_t *shm,
     sim_client_read_time(shm, &d, &h, &m);
     LOG_INFO("User %d Active (Requests: %d)", user_id, count);
 
+    // Reused across all requests of this user
+    sim_client_session_t session;
+    sim_client_session_init(&session);
+
     for (int i = 0; i < count; i++) {
         LOG_DEBUG("User %d starting request iteration %d", user_id, i);
 
@@ -236,7 +197,7 @@ int run_user_simulation_loop(int user_id, int service_type, sim_shm_t *shm,
 
         LOG_DEBUG("User %d joining queue (VIP=%d)", user_id, is_vip);
 
-        if (!join_queue_broker(shm, service_type, is_vip, should_continue_flag, &t)) {
+        if (!join_queue_broker(&session, shm, service_type, is_vip, should_continue_flag, &t)) {
             LOG_WARN("User %d failed to join queue, retrying", user_id);
             usleep(100000);
             continue;
@@ -244,12 +205,15 @@ int run_user_simulation_loop(int user_id, int service_type, sim_shm_t *shm,
 
         LOG_INFO("User %d Joined Queue %d [Ticket #%u] (VIP=%d)", user_id, service_type, t, is_vip);
 
+        PO_METRIC_TICK(wait_start);
         if (wait_service(user_id, t, service_type, 0, shm, should_continue_flag)) {
+            PO_METRIC_HISTO_RECORD("user.ticket.wait_ns", PO_METRIC_ELAPSED_NS(wait_start));
             LOG_INFO("User %d Service Complete [Ticket #%u]", user_id, t);
         } else {
             LOG_ERROR("User %d Service Interrupted/Failed [Ticket #%u]", user_id, t);
         }
     }
+    sim_client_session_close(&session);
     LOG_INFO("User %d simulation loop complete", user_id);
     return 0;
 }
@@ -0,0 +1,661 @@
+#define _POSIX_C_SOURCE 200809L
+#include "user_engine.h"
+
+#include <errno.h>
+#include <postoffice/concurrency/completion.h>
+#include <postoffice/log/logger.h>
+#include <postoffice/metrics/metrics.h>
+#include <postoffice/net/net.h>
+#include <postoffice/net/poller.h>
+#include <postoffice/net/socket.h>
+#include <postoffice/random/random.h>
+#include <postoffice/sysinfo/sysinfo.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "ipc/sim_client.h"
+#include "ipc/simulation_protocol.h"
+
+// Shard tick: how often office hours, served tickets and think timers are checked
+#define ENGINE_TICK_MS 5
+
+// Pause between two requests of the same user (mirrors the threaded runtime)
+#define ENGINE_THINK_NS (200ull * 1000000ull)
+
+// Max JOIN_QUEUE requests in flight per shard session. Keeps the broker's
+// replies well within the socket buffer so blocking sends cannot deadlock.
+#define ENGINE_MAX_INFLIGHT 1024
+
+// Minimum delay between two broker (re)connect attempts
+#define ENGINE_RECONNECT_NS (100ull * 1000000ull)
+
+#define USER_NIL UINT32_MAX
+
+typedef enum {
+    USER_FREE = 0,
+    USER_WAIT_OFFICE,  // Office closed, waiting for 08:00
+    USER_JOIN,         // Ready to send JOIN_QUEUE
+    USER_JOIN_PENDING, // JOIN_QUEUE sent, waiting for the ticket
+    USER_WAIT_SERVICE, // Holding a ticket, waiting for a worker to finish it
+    USER_NEXT_REQUEST  // Think time before the next request
+} user_state_t;
+
+/**
+ * @brief One simulated user. Kept small: the table is preallocated per shard.
+ */
+typedef struct {
+    uint64_t due_ns; // USER_NEXT_REQUEST deadline
+    union {
+        uint32_t ticket;     // USER_WAIT_SERVICE ticket
+        uint32_t request_id; // USER_JOIN / USER_JOIN_PENDING correlation ID (0: not sent yet)
+    };
+    uint32_t next;          // Intrusive FIFO / bucket link (slot index)
+    int32_t user_id;
+    uint16_t requests_left;
+    uint8_t service;
+    uint8_t state; // user_state_t
+} engine_user_t;
+
+typedef struct {
+    uint32_t head;
+    uint32_t tail;
+} user_fifo_t;
+
+typedef struct {
+    pthread_t thread;
+    size_t index;
+    poller_t *poller;
+    int timer_fd;
+    int conn_fd;
+    uint64_t last_connect_ns;
+    pid_t tid;           // Shard thread, part of the broker's JOIN key
+    uint32_t join_round; // Upper part of the next JOIN correlation ID
+
+    engine_user_t *users;
+    uint32_t capacity;
+    uint32_t free_head; // Free slots, linked through next
+    uint32_t inflight;
+
+    user_fifo_t office;
+    user_fifo_t join;
+    user_fifo_t think;
+
+    // USER_WAIT_SERVICE users hashed by ticket, fed by the SHM completion log
+    uint32_t *waiting;
+    uint32_t waiting_mask;
+    uint32_t log_cursor;
+
+    // Posted by the manager thread, consumed by the shard
+    atomic_uint pending_spawns;
+    atomic_uint pending_stops;
+    atomic_uint reserved; // Slots promised (live + pending spawns)
+    atomic_bool stop;
+} engine_shard_t;
+
+static struct {
+    sim_shm_t *shm;
+    engine_shard_t *shards;
+    size_t nshards;
+    atomic_size_t next_shard;
+    atomic_int live;
+    int requests_per_user;
+} g_engine;
+
+// --- FIFOs ---
+
+static void fifo_init(user_fifo_t *f) {
+    f->head = f->tail = USER_NIL;
+}
+
+static void fifo_push(engine_shard_t *s, user_fifo_t *f, uint32_t idx) {
+    s->users[idx].next = USER_NIL;
+    if (f->tail == USER_NIL)
+        f->head = idx;
+    else
+        s->users[f->tail].next = idx;
+    f->tail = idx;
+}
+
+static uint32_t fifo_pop(engine_shard_t *s, user_fifo_t *f) {
+    uint32_t idx = f->head;
+    if (idx == USER_NIL)
+        return USER_NIL;
+    f->head = s->users[idx].next;
+    if (f->head == USER_NIL)
+        f->tail = USER_NIL;
+    return idx;
+}
+
+static void fifo_splice(engine_shard_t *s, user_fifo_t *dst, user_fifo_t *src) {
+    if (src->head == USER_NIL)
+        return;
+    if (dst->tail == USER_NIL)
+        dst->head = src->head;
+    else
+        s->users[dst->tail].next = src->head;
+    dst->tail = src->tail;
+    fifo_init(src);
+}
+
+// --- User transitions ---
+
+static void user_retire(engine_shard_t *s, uint32_t idx) {
+    engine_user_t *u = &s->users[idx];
+    LOG_DEBUG("User %d simulation loop complete", u->user_id);
+
+    u->state = USER_FREE;
+    u->next = s->free_head;
+    s->free_head = idx;
+
+    atomic_fetch_sub(&g_engine.live, 1);
+    atomic_fetch_sub(&s->reserved, 1);
+    atomic_fetch_sub(&g_engine.shm->stats.connected_users, 1);
+}
+
+static bool claim_stop(engine_shard_t *s) {
+    unsigned int n = atomic_load(&s->pending_stops);
+    while (n > 0) {
+        if (atomic_compare_exchange_weak(&s->pending_stops, &n, n - 1))
+            return true;
+    }
+    return false;
+}
+
+static void user_begin_request(engine_shard_t *s, uint32_t idx) {
+    if (claim_stop(s)) {
+        user_retire(s, idx);
+        return;
+    }
+    s->users[idx].state = USER_WAIT_OFFICE;
+    s->users[idx].request_id = 0;
+    fifo_push(s, &s->office, idx);
+}
+
+static void user_finish_request(engine_shard_t *s, uint32_t idx, bool served, uint64_t now) {
+    engine_user_t *u = &s->users[idx];
+    if (served)
+        LOG_DEBUG("User %d Service Complete [Ticket #%u]", u->user_id, u->ticket);
+    else
+        LOG_DEBUG("User %d Service Interrupted [Ticket #%u]", u->user_id, u->ticket);
+
+    if (u->requests_left > 0)
+        u->requests_left--;
+    if (u->requests_left == 0) {
+        user_retire(s, idx);
+        return;
+    }
+
+    if (g_engine.shm->params.tick_nanos > 0) {
+        u->state = USER_NEXT_REQUEST;
+        u->due_ns = now + ENGINE_THINK_NS;
+        fifo_push(s, &s->think, idx);
+    } else {
+        user_begin_request(s, idx);
+    }
+}
+
+static void admit_users(engine_shard_t *s) {
+    unsigned int n = atomic_exchange(&s->pending_spawns, 0);
+    for (unsigned int i = 0; i < n; i++) {
+        uint32_t idx = s->free_head;
+        if (idx == USER_NIL) // Cannot happen: spawns are reserved against capacity
+            break;
+        s->free_head = s->users[idx].next;
+
+        engine_user_t *u = &s->users[idx];
+        memset(u, 0, sizeof(*u));
+        u->user_id = (int32_t)(po_rand_u32() & 0x7fffffff);
+        u->service = (uint8_t)(po_rand_u32() % SIM_MAX_SERVICE_TYPES);
+        u->requests_left = (uint16_t)g_engine.requests_per_user;
+
+        atomic_fetch_add(&g_engine.shm->stats.connected_users, 1);
+        LOG_DEBUG("User %d Active (Requests: %d, Shard %zu)", u->user_id,
+                  g_engine.requests_per_user, s->index);
+        user_begin_request(s, idx);
+    }
+}
+
+static void retire_stopped(engine_shard_t *s) {
+    // Honour stop requests on users that are idle right now; busy users pick
+    // theirs up when they start the next request.
+    while (atomic_load(&s->pending_stops) > 0) {
+        user_fifo_t *src = s->office.head != USER_NIL ? &s->office : &s->think;
+        if (src->head == USER_NIL || !claim_stop(s))
+            return;
+        user_retire(s, fifo_pop(s, src));
+    }
+}
+
+// --- Ticket waits ---
+
+static void waiting_insert(engine_shard_t *s, uint32_t idx) {
+    uint32_t *bucket = &s->waiting[s->users[idx].ticket & s->waiting_mask];
+    s->users[idx].next = *bucket;
+    *bucket = idx;
+}
+
+static uint32_t waiting_take(engine_shard_t *s, uint32_t ticket) {
+    for (uint32_t *link = &s->waiting[ticket & s->waiting_mask]; *link != USER_NIL;
+         link = &s->users[*link].next) {
+        uint32_t idx = *link;
+        if (s->users[idx].ticket == ticket) {
+            *link = s->users[idx].next;
+            return idx;
+        }
+    }
+    return USER_NIL; // Someone else's ticket
+}
+
+/**
+ * @brief Unlink waiting users matching @p all or whose ticket completed.
+ *
+ * Used when the completion log cannot be trusted (reader lapped) or the
+ * simulation stopped; O(capacity), so only on those rare paths.
+ */
+static void waiting_sweep(engine_shard_t *s, bool all, uint64_t now) {
+    user_fifo_t done;
+    fifo_init(&done);
+
+    for (uint32_t b = 0; b <= s->waiting_mask; b++) {
+        uint32_t *link = &s->waiting[b];
+        while (*link != USER_NIL) {
+            uint32_t idx = *link;
+            if (all || po_completion_is_done(&g_engine.shm->completions, s->users[idx].ticket)) {
+                *link = s->users[idx].next;
+                fifo_push(s, &done, idx);
+            } else {
+                link = &s->users[idx].next;
+            }
+        }
+    }
+
+    uint32_t idx;
+    while ((idx = fifo_pop(s, &done)) != USER_NIL)
+        user_finish_request(s, idx, !all, now);
+}
+
+static void consume_completions(engine_shard_t *s, uint64_t now) {
+    uint32_t batch[256];
+    for (;;) {
+        int n = po_completion_log_read(&g_engine.shm->completions, &s->log_cursor, batch, 256);
+        if (n < 0) {
+            waiting_sweep(s, false, now);
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            uint32_t idx = waiting_take(s, batch[i]);
+            if (idx != USER_NIL)
+                user_finish_request(s, idx, true, now);
+        }
+        if (n < (int)(sizeof(batch) / sizeof(batch[0])))
+            return;
+    }
+}
+
+// --- Broker session ---
+
+static void drop_connection(engine_shard_t *s) {
+    if (s->conn_fd < 0)
+        return;
+
+    LOG_WARN("User engine shard %zu: broker session lost, requeueing %u joins", s->index,
+             s->inflight);
+    poller_remove(s->poller, s->conn_fd);
+    po_socket_close(s->conn_fd);
+    s->conn_fd = -1;
+    s->inflight = 0;
+
+    for (uint32_t i = 0; i < s->capacity; i++) {
+        if (s->users[i].state == USER_JOIN_PENDING) {
+            s->users[i].state = USER_JOIN;
+            fifo_push(s, &s->join, i);
+        }
+    }
+}
+
+static bool ensure_connection(engine_shard_t *s, uint64_t now) {
+    if (s->conn_fd >= 0)
+        return true;
+    if (now - s->last_connect_ns < ENGINE_RECONNECT_NS)
+        return false;
+    s->last_connect_ns = now;
+
+    char path[512];
+    sim_client_issuer_path(path, sizeof(path));
+    int fd = po_socket_connect_unix(path);
+    if (fd < 0)
+        return false;
+
+    // Sends stay blocking (bounded by ENGINE_MAX_INFLIGHT); receives go through
+    // the poller and the non-blocking net_recv_message().
+    po_socket_set_blocking(fd);
+    if (poller_add(s->poller, fd, EPOLLIN | EPOLLRDHUP) != 0) {
+        po_socket_close(fd);
+        return false;
+    }
+    s->conn_fd = fd;
+    return true;
+}
+
+/**
+ * @brief Correlation ID for a user's next JOIN: round * capacity + slot + 1.
+ *
+ * The slot is recoverable from the ID, and the round makes a user's
+ * consecutive JOINs distinct, so the broker can tell a resent JOIN (same ID)
+ * from the next one.
+ */
+static uint32_t next_join_id(engine_shard_t *s, uint32_t idx) {
+    uint32_t rounds = (UINT32_MAX - 1) / s->capacity;
+    s->join_round = (s->join_round + 1) % rounds;
+    return s->join_round * s->capacity + idx + 1;
+}
+
+static void flush_joins(engine_shard_t *s, uint64_t now) {
+    if (s->join.head == USER_NIL || !ensure_connection(s, now))
+        return;
+
+    while (s->join.head != USER_NIL && s->inflight < ENGINE_MAX_INFLIGHT) {
+        uint32_t idx = fifo_pop(s, &s->join);
+        engine_user_t *u = &s->users[idx];
+
+        // A JOIN resent after a lost session keeps its ID (see next_join_id)
+        if (u->request_id == 0)
+            u->request_id = next_join_id(s, idx);
+        msg_join_queue_t req = {.request_id = u->request_id,
+                                .requester_pid = getpid(),
+                                .requester_tid = s->tid,
+                                .service_type = (service_type_t)u->service,
+                                .is_vip = (po_rand_u32() % 100) < 10};
+        if (net_send_message(s->conn_fd, MSG_TYPE_JOIN_QUEUE, PO_FLAG_NONE, (uint8_t *)&req,
+                             sizeof(req)) != 0) {
+            fifo_push(s, &s->join, idx);
+            drop_connection(s);
+            return;
+        }
+        u->state = USER_JOIN_PENDING;
+        s->inflight++;
+    }
+}
+
+static void read_replies(engine_shard_t *s) {
+    for (;;) {
+        po_header_t header;
+        zcp_buffer_t *payload = NULL;
+        int ret = net_recv_message(s->conn_fd, &header, &payload);
+        if (ret != 0) {
+            if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            drop_connection(s);
+            return;
+        }
+        if (!payload)
+            continue;
+
+        msg_join_ack_t ack;
+        bool valid = header.msg_type == MSG_TYPE_JOIN_ACK && header.payload_len >= sizeof(ack);
+        if (valid)
+            memcpy(&ack, payload, sizeof(ack));
+        net_zcp_release_rx(payload);
+
+        uint32_t idx = valid && ack.request_id > 0 ? (ack.request_id - 1) % s->capacity : USER_NIL;
+        if (idx >= s->capacity || s->users[idx].state != USER_JOIN_PENDING ||
+            s->users[idx].request_id != ack.request_id) {
+            LOG_DEBUG("User engine shard %zu: dropping unexpected reply 0x%02X", s->index,
+                      header.msg_type);
+            continue;
+        }
+
+        engine_user_t *u = &s->users[idx];
+        s->inflight--;
+        if (ack.ticket_number == 0) {
+            // Queue full: try again after the think time without using up a request
+            LOG_DEBUG("User %d turned away from full Queue %d", u->user_id, u->service);
+            u->state = USER_NEXT_REQUEST;
+            u->due_ns = po_metric_now_ns() + ENGINE_THINK_NS;
+            fifo_push(s, &s->think, idx);
+            continue;
+        }
+        u->ticket = ack.ticket_number;
+        u->state = USER_WAIT_SERVICE;
+        waiting_insert(s, idx);
+        LOG_DEBUG("User %d Joined Queue %d [Ticket #%u]", u->user_id, u->service, u->ticket);
+    }
+}
+
+// --- Tick ---
+
+static void shard_tick(engine_shard_t *s, uint64_t now) {
+    sim_shm_t *shm = g_engine.shm;
+
+    // NEXT_REQUEST -> WAIT_OFFICE (deadlines are pushed in order)
+    while (s->think.head != USER_NIL && s->users[s->think.head].due_ns <= now)
+        user_begin_request(s, fifo_pop(s, &s->think));
+
+    // WAIT_OFFICE -> JOIN
+    int d, h, m;
+    sim_client_read_time(shm, &d, &h, &m);
+    if (h >= 8 && h < 17 && s->office.head != USER_NIL) {
+        for (uint32_t i = s->office.head; i != USER_NIL; i = s->users[i].next)
+            s->users[i].state = USER_JOIN;
+        fifo_splice(s, &s->join, &s->office);
+    }
+
+    // WAIT_SERVICE -> NEXT_REQUEST: only the tickets completed since last tick
+    if (atomic_load(&shm->time_control.sim_active))
+        consume_completions(s, now);
+    else
+        waiting_sweep(s, true, now);
+
+    retire_stopped(s);
+}
+
+static void *shard_main(void *arg) {
+    engine_shard_t *s = (engine_shard_t *)arg;
+    po_logger_set_thread_category(SIM_LOG_USERS);
+    po_rand_seed_auto();
+    s->tid = (pid_t)syscall(SYS_gettid);
+    s->log_cursor = po_completion_log_head(&g_engine.shm->completions);
+
+    struct epoll_event ev[16];
+    while (!atomic_load(&s->stop)) {
+        int n = poller_wait(s->poller, ev, 16, -1);
+        if (n < 0)
+            break;
+
+        atomic_fetch_add(&g_engine.shm->stats.active_threads, 1);
+        bool tick = false;
+        for (int i = 0; i < n; i++) {
+            if (ev[i].data.fd == s->timer_fd) {
+                uint64_t expirations;
+                if (read(s->timer_fd, &expirations, sizeof(expirations)) > 0)
+                    tick = true;
+            } else if (ev[i].data.fd == s->conn_fd) {
+                read_replies(s);
+            }
+        }
+
+        uint64_t now = po_metric_now_ns();
+        admit_users(s);
+        if (tick)
+            shard_tick(s, now);
+        flush_joins(s, now);
+        atomic_fetch_sub(&g_engine.shm->stats.active_threads, 1);
+    }
+    return NULL;
+}
+
+// --- Public API ---
+
+static void shard_destroy(engine_shard_t *s) {
+    if (s->conn_fd >= 0)
+        po_socket_close(s->conn_fd);
+    if (s->timer_fd >= 0)
+        close(s->timer_fd);
+    if (s->poller)
+        poller_destroy(s->poller);
+    free(s->users);
+    free(s->waiting);
+}
+
+static int shard_init(engine_shard_t *s, size_t index, uint32_t capacity) {
+    memset(s, 0, sizeof(*s));
+    s->index = index;
+    s->conn_fd = -1;
+    s->timer_fd = -1;
+    s->capacity = capacity;
+
+    fifo_init(&s->office);
+    fifo_init(&s->join);
+    fifo_init(&s->think);
+
+    s->users = calloc(capacity, sizeof(*s->users));
+    if (!s->users)
+        return -1;
+    for (uint32_t i = 0; i < capacity; i++)
+        s->users[i].next = i + 1 < capacity ? i + 1 : USER_NIL;
+    s->free_head = 0;
+
+    uint32_t buckets = 1;
+    while (buckets < capacity)
+        buckets <<= 1;
+    s->waiting = malloc(buckets * sizeof(*s->waiting));
+    if (!s->waiting)
+        return -1;
+    for (uint32_t i = 0; i < buckets; i++)
+        s->waiting[i] = USER_NIL;
+    s->waiting_mask = buckets - 1;
+
+    s->poller = poller_create();
+    if (!s->poller)
+        return -1;
+
+    s->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (s->timer_fd < 0)
+        return -1;
+    struct itimerspec its = {.it_interval = {0, ENGINE_TICK_MS * 1000000L},
+                             .it_value = {0, ENGINE_TICK_MS * 1000000L}};
+    if (timerfd_settime(s->timer_fd, 0, &its, NULL) != 0)
+        return -1;
+    return poller_add(s->poller, s->timer_fd, EPOLLIN);
+}
+
+static void stop_shards(void) {
+    for (size_t i = 0; i < g_engine.nshards; i++) {
+        atomic_store(&g_engine.shards[i].stop, true);
+        poller_wake(g_engine.shards[i].poller);
+    }
+
+    for (size_t i = 0; i < g_engine.nshards; i++) {
+        engine_shard_t *s = &g_engine.shards[i];
+        pthread_join(s->thread, NULL);
+
+        // Users still admitted at shutdown leave without finishing
+        uint32_t still = atomic_load(&s->reserved) - atomic_load(&s->pending_spawns);
+        atomic_fetch_sub(&g_engine.shm->stats.connected_users, still);
+        shard_destroy(s);
+    }
+
+    free(g_engine.shards);
+    g_engine.shards = NULL;
+    g_engine.nshards = 0;
+    atomic_store(&g_engine.live, 0);
+}
+
+int user_engine_init(sim_shm_t *shm, size_t shards, size_t capacity) {
+    if (!shm)
+        return -1;
+
+    if (shards == 0) {
+        po_sysinfo_t info;
+        shards = (po_sysinfo_collect(&info) == 0 && info.physical_cores > 0)
+                     ? (size_t)info.physical_cores
+                     : (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (capacity == 0)
+        capacity = USER_ENGINE_DEFAULT_CAPACITY;
+    if (capacity < shards)
+        capacity = shards;
+
+    char *reqs = getenv("PO_USER_REQUESTS");
+    g_engine.requests_per_user = (reqs && atoi(reqs) > 0) ? atoi(reqs) : 1;
+    if (g_engine.requests_per_user > UINT16_MAX)
+        g_engine.requests_per_user = UINT16_MAX;
+
+    g_engine.shm = shm;
+    g_engine.nshards = shards;
+    atomic_init(&g_engine.next_shard, 0);
+    atomic_init(&g_engine.live, 0);
+    g_engine.shards = calloc(shards, sizeof(*g_engine.shards));
+    if (!g_engine.shards)
+        return -1;
+
+    uint32_t per_shard = (uint32_t)(capacity / shards);
+    for (size_t i = 0; i < shards; i++) {
+        engine_shard_t *s = &g_engine.shards[i];
+        if (shard_init(s, i, per_shard) != 0 || pthread_create(&s->thread, NULL, shard_main, s)) {
+            LOG_ERROR("User engine: failed to start shard %zu", i);
+            shard_destroy(s);
+            g_engine.nshards = i;
+            stop_shards();
+            return -1;
+        }
+    }
+
+    // Track: 1 (UM Main) + shard threads
+    atomic_fetch_add(&shm->stats.connected_threads, (uint32_t)shards + 1);
+    atomic_fetch_add(&shm->stats.active_threads, 1);
+
+    LOG_INFO("User engine started (Shards: %zu, Capacity: %zu, %zu bytes/user)", shards,
+             (size_t)per_shard * shards, sizeof(engine_user_t));
+    return 0;
+}
+
+int user_engine_spawn(void) {
+    for (size_t tries = 0; tries < g_engine.nshards; tries++) {
+        size_t i = atomic_fetch_add(&g_engine.next_shard, 1) % g_engine.nshards;
+        engine_shard_t *s = &g_engine.shards[i];
+
+        if (atomic_fetch_add(&s->reserved, 1) >= s->capacity) {
+            atomic_fetch_sub(&s->reserved, 1);
+            continue;
+        }
+        atomic_fetch_add(&g_engine.live, 1);
+        atomic_fetch_add(&s->pending_spawns, 1);
+        poller_wake(s->poller);
+        return 0;
+    }
+
+    LOG_WARN("Cannot spawn user: engine capacity reached.");
+    return -1;
+}
+
+void user_engine_stop_one(void) {
+    size_t start = atomic_fetch_add(&g_engine.next_shard, 1);
+    for (size_t k = 0; k < g_engine.nshards; k++) {
+        engine_shard_t *s = &g_engine.shards[(start + k) % g_engine.nshards];
+        unsigned int live = atomic_load(&s->reserved) - atomic_load(&s->pending_spawns);
+        if (live > atomic_load(&s->pending_stops)) {
+            atomic_fetch_add(&s->pending_stops, 1);
+            return;
+        }
+    }
+}
+
+int user_engine_count(void) {
+    return atomic_load(&g_engine.live);
+}
+
+void user_engine_shutdown(void) {
+    if (!g_engine.shards)
+        return;
+
+    atomic_fetch_sub(&g_engine.shm->stats.active_threads, 1);
+    atomic_fetch_sub(&g_engine.shm->stats.connected_threads, (uint32_t)g_engine.nshards + 1);
+    stop_shards();
+}
@@ -0,0 +1,53 @@
+#ifndef USER_ENGINE_H
+#define USER_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ipc/simulation_ipc.h"
+
+/**
+ * @file user_engine.h
+ * @brief Event-driven user runtime: many simulated users per thread.
+ *
+ * Instead of parking one pool thread per user, every user is a small state
+ * machine (WAIT_OFFICE -> JOIN -> WAIT_SERVICE -> NEXT_REQUEST) owned by a
+ * shard. Each shard is one thread driving an epoll loop over a timerfd tick
+ * and a single pipelined broker session, so a users_manager process can host
+ * 100k+ users with a handful of threads and a fixed-size user table.
+ */
+
+// Default total user capacity when the engine is enabled
+#define USER_ENGINE_DEFAULT_CAPACITY 131072
+
+/**
+ * @brief Start the engine shards.
+ * @param shm Simulation shared memory.
+ * @param shards Number of shard threads (0 = one per physical core).
+ * @param capacity Total user slots, split evenly across shards.
+ * @return 0 on success, -1 on failure.
+ */
+int user_engine_init(sim_shm_t *shm, size_t shards, size_t capacity);
+
+/**
+ * @brief Admit a new user on the next shard (round-robin).
+ * @return 0 on success, -1 if every shard is full.
+ */
+int user_engine_spawn(void);
+
+/**
+ * @brief Ask one live user to leave after its current step.
+ */
+void user_engine_stop_one(void);
+
+/**
+ * @brief Number of admitted users that have not finished yet.
+ */
+int user_engine_count(void);
+
+/**
+ * @brief Stop every shard, join the threads and release the user tables.
+ */
+void user_engine_shutdown(void);
+
+#endif
@@ -1,6 +1,7 @@
 #define _POSIX_C_SOURCE 200809L
 #include "users_spawn.h"
 #include "../../user/runtime/user_loop.h"
+#include "../engine/user_engine.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -18,6 +19,7 @@ static sim_shm_t *g_shm = NULL; // Save for thread tracking
 static uint32_t g_last_threads_count = 0;
 static waitgroup_t *g_user_wg = NULL;
 static threadpool_t *g_user_thread_pool = NULL;
+static bool g_event_driven = false;
 
 typedef struct {
     int user_id;
@@ -26,8 +28,15 @@ typedef struct {
     sim_shm_t *shm;
 } user_task_ctx_t;
 
-void users_spawn_init(sim_shm_t *shm, size_t pool_size) {
+int users_spawn_init(sim_shm_t *shm, size_t pool_size, bool event_driven, size_t capacity) {
     g_shm = shm;
+    g_event_driven = event_driven;
+    if (event_driven) {
+        LOG_INFO("Initializing Event-Driven User Engine (Capacity: %zu)",
+                 capacity ? capacity : (size_t)USER_ENGINE_DEFAULT_CAPACITY);
+        return user_engine_init(shm, 0, capacity);
+    }
+
     LOG_INFO("Initializing User Thread Pool (PoolSize: %zu, MaxCapacity: %d)", pool_size, MAX_USER_CAPACITY);
     for (int i = 0; i < MAX_USER_CAPACITY; i++) {
         atomic_init(&g_user_slots[i].is_occupied, false);
@@ -55,6 +64,7 @@ void users_spawn_init(sim_shm_t *shm, size_t pool_size) {
         atomic_fetch_add(&g_shm->stats.active_threads, 1); // UM Main is active
         tp_set_active_counter(g_user_thread_pool, &g_shm->stats.active_threads);
     }
+    return g_user_thread_pool ? 0 : -1;
 }
 
 static void execute_user_simulation(void *arg) {
@@ -62,7 +72,7 @@ static void execute_user_simulation(void *arg) {
     int slot_idx = ctx->slot; 
 
     // Categorize this thread's logs
-    po_logger_set_thread_category(1); // User category
+    po_logger_set_thread_category(SIM_LOG_USERS);
 
     atomic_fetch_add(&ctx->shm->stats.connected_users, 1);
 
@@ -81,6 +91,9 @@ static void execute_user_simulation(void *arg) {
 }
 
 int users_spawn_new(sim_shm_t *shm) {
+    if (g_event_driven)
+        return user_engine_spawn();
+
     if (wg_active_count(g_user_wg) >= MAX_USER_CAPACITY) {
         LOG_WARN("Cannot spawn user: Max capacity (%d) reached.", MAX_USER_CAPACITY);
         return -1;
@@ -131,10 +144,17 @@ int users_spawn_new(sim_shm_t *shm) {
 }
 
 int users_spawn_count(void) {
+    if (g_event_driven)
+        return user_engine_count();
     return wg_active_count(g_user_wg);
 }
 
 void users_spawn_stop_random(void) {
+    if (g_event_driven) {
+        user_engine_stop_one();
+        return;
+    }
+
     // Linear scan to find occupier - simple approach
     for (int i = MAX_USER_CAPACITY - 1; i >= 0; i--) {
         if (atomic_load(&g_user_slots[i].is_occupied)) {
@@ -147,6 +167,11 @@ void users_spawn_stop_random(void) {
 }
 
 void users_spawn_shutdown_all(void) {
+    if (g_event_driven) {
+        user_engine_shutdown();
+        return;
+    }
+
     if (g_shm && g_last_threads_count > 0) {
         atomic_fetch_sub(&g_shm->stats.active_threads, 1);
         atomic_fetch_sub(&g_shm->stats.connected_threads, g_last_threads_count + 1);
@@ -14,7 +14,20 @@ typedef struct {
     int worker_idx;
 } user_slot_t;
 
-void users_spawn_init(sim_shm_t *shm, size_t pool_size);
+/**
+ * @brief Prepare the user runtime.
+ *
+ * The threaded runtime runs each user as a threadpool task (at most
+ * MAX_USER_CAPACITY). With @p event_driven set, users are state machines
+ * multiplexed over a few engine shards instead (see user_engine.h).
+ *
+ * @param shm Pointer to simulation shared memory.
+ * @param pool_size Extra pool threads (threaded runtime only).
+ * @param event_driven Use the event-driven engine.
+ * @param capacity Engine user capacity (0 = default, event-driven only).
+ * @return 0 on success, -1 on failure.
+ */
+int users_spawn_init(sim_shm_t *shm, size_t pool_size, bool event_driven, size_t capacity);
 
 /**
  * @brief Spawns a new user thread.
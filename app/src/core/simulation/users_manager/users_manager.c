@@ -12,6 +12,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <signal.h>
@@ -43,6 +44,8 @@ static void on_scale_down(int s, siginfo_t* i, void* c) {
 int main(int argc, char *argv[]) {
     // 1. Args
     int initial=5, batch=5, pool_size=64;
+    bool event_engine = false;
+    size_t engine_capacity = 0;
     char *loglevel = "INFO";
     int opt;
     struct option long_opts[] = {
@@ -50,6 +53,8 @@ int main(int argc, char *argv[]) {
         {"batch", required_argument, 0, 'b'},
         {"pool-size", required_argument, 0, 'p'},
         {"l", required_argument, 0, 'l'},
+        {"engine", required_argument, 0, 'e'},
+        {"capacity", required_argument, 0, 'c'},
         {0, 0, 0, 0}
     };
 
@@ -58,21 +63,19 @@ int main(int argc, char *argv[]) {
         if (opt == 'b') batch = atoi(optarg);
         if (opt == 'p') pool_size = atoi(optarg);
         if (opt == 'l') loglevel = optarg;
+        if (opt == 'e') event_engine = strcmp(optarg, "event") == 0;
+        if (opt == 'c') engine_capacity = (size_t)atol(optarg);
     }
     po_sort_init();
 
     g_target_population = initial;
 
     // 2. Logging
-    po_logger_init(&(po_logger_config_t){
-        .level = (po_logger_level_from_str(loglevel) == -1 ? LOG_INFO : po_logger_level_from_str(loglevel)),
-        .ring_capacity = 8192,
-        .consumers = 1
-    });
-    po_logger_add_sink_file_categorized("logs/users_manager.log", false, 1u << 0);
-    po_logger_add_sink_file_categorized("logs/users.log", false, 1u << 1);
+    sim_client_init_logger(loglevel, SIM_LOG_USERS_MANAGER, "logs/users_manager.log");
+    // Engine threads log as users (also a no-op with the director's ring)
+    po_logger_add_sink_file_categorized("logs/users.log", true, 1u << SIM_LOG_USERS);
     // po_logger_add_sink_console(false);
-    po_logger_set_thread_category(0); // Manager category
+    po_logger_set_thread_category(SIM_LOG_USERS_MANAGER);
 
     // 3. SHM
     sim_shm_t *shm = sim_ipc_shm_attach();
@@ -88,13 +91,16 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    users_spawn_init(shm, (size_t)pool_size);
-
     if (net_init_zerocopy(128, 128, 4096) != 0) {
         LOG_FATAL("Users Manager: Failed to initialize net zerocopy");
         return 1;
     }
 
+    if (users_spawn_init(shm, (size_t)pool_size, event_engine, engine_capacity) != 0) {
+        LOG_FATAL("Users Manager: Failed to initialize user runtime");
+        return 1;
+    }
+
     LOG_INFO("Users Manager Started (Target=%d, Batch=%d)", initial, batch);
 
     int last_day = 0;
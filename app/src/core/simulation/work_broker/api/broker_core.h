@@ -4,13 +4,14 @@
 #include <postoffice/concurrency/threadpool.h>
 #include <postoffice/log/logger.h>
 #include <postoffice/net/poller.h>
-#include <postoffice/priority_queue/priority_queue.h>
+#include <postoffice/priority_queue/class_queue.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "../state/broker_state.h"
 #include "ipc/simulation_ipc.h"
 
 // --- Structures ---
@@ -23,9 +24,10 @@ typedef struct {
 } broker_item_t;
 
 typedef struct {
-    // Queues
-    po_priority_queue_t *queues[SIM_MAX_SERVICE_TYPES];
-    pthread_mutex_t queue_mutexes[SIM_MAX_SERVICE_TYPES];
+    // Queues (lock-free; VIP tickets in the high class)
+    po_class_queue_t *queues[SIM_MAX_SERVICE_TYPES];
+    pthread_mutex_t park_mutexes[SIM_MAX_SERVICE_TYPES];
+    broker_park_list_t parked[SIM_MAX_SERVICE_TYPES]; // Guarded by park_mutexes
 
     // Runtime
     sim_shm_t *shm;
@@ -33,18 +35,30 @@ typedef struct {
     volatile sig_atomic_t shutdown_requested;
     threadpool_t *tp;
     poller_t *poller;
+    broker_conn_table_t conns; // Persistent client sessions, indexed by fd
+    broker_join_cache_t joins; // Tickets issued per JOIN, for retried requests
 
     // Config
     size_t pool_size;
+    uint32_t park_timeout_ms; // Upper bound for long-poll GET_WORK (0 disables parking)
 } broker_ctx_t;
 
+// Default upper bound for a parked GET_WORK; must stay below the client
+// session receive timeout.
+#define BROKER_DEFAULT_PARK_TIMEOUT_MS 200
+
+// Tickets per class and service queue. Every user holds at most one ticket,
+// so this matches the largest user population the engine admits.
+#define BROKER_QUEUE_CAPACITY 131072
+
 // --- Core Functions ---
 
 /**
  * @brief Initialize the broker context (queues, shm, socket).
  * @return 0 on success, <0 on failure.
  */
-int broker_init(broker_ctx_t *ctx, const char *loglevel, size_t pool_size);
+int broker_init(broker_ctx_t *ctx, const char *loglevel, size_t pool_size,
+                uint32_t park_timeout_ms);
 
 /**
  * @brief Run the broker main loop.
@@ -56,4 +70,20 @@ void broker_run(broker_ctx_t *ctx);
  */
 void broker_cleanup(broker_ctx_t *ctx);
 
+/**
+ * @brief Hand a session back to the poller once its owner is done with it.
+ *
+ * Also waits for EPOLLOUT while replies are left in its outbox. Closes the
+ * session instead if @p healthy is false or re-arming fails.
+ */
+void broker_conn_release(broker_ctx_t *ctx, broker_conn_t *conn, bool healthy);
+
+/**
+ * @brief Flush the session's outbox, then drain the pipelined requests
+ *        currently buffered on it.
+ * @return BROKER_REQ_DONE if the session must be re-armed, BROKER_REQ_PARKED if
+ *         a long-poll took ownership of it, BROKER_REQ_CLOSE on EOF / error.
+ */
+int broker_conn_serve(broker_conn_t *conn, broker_ctx_t *ctx);
+
 #endif
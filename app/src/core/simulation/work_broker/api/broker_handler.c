@@ -2,9 +2,10 @@
 #include "broker_handler.h"
 
 #include <postoffice/log/logger.h>
+#include <postoffice/metrics/metrics.h>
 #include <postoffice/net/net.h>
 #include <postoffice/net/socket.h>
-#include <postoffice/priority_queue/priority_queue.h>
+#include <postoffice/priority_queue/class_queue.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdlib.h>
@@ -16,96 +17,235 @@
 
 /* broker_item_t is defined in broker_core.h */
 
-void broker_handler_process_request(int client_fd, broker_ctx_t *ctx) {
-    LOG_DEBUG("Broker: Handler invoked for client_fd=%d", client_fd);
+static int send_work_item(broker_conn_t *conn, uint32_t request_id, const broker_item_t *item) {
+    msg_work_item_t resp = {.request_id = request_id};
+    if (item) {
+        resp.ticket_number = item->ticket_number;
+        resp.is_vip = item->is_vip;
+    }
+    return broker_conn_send(conn, MSG_TYPE_WORK_ITEM, &resp, sizeof(resp));
+}
 
-    po_socket_set_blocking(client_fd);
+/**
+ * @brief Answer the pending GET_WORK of a parked session we just unlinked.
+ * @return true if the item was delivered; false if the session was dead
+ *         (it is closed and the caller still owns @p item).
+ */
+static bool deliver_to_parked(broker_ctx_t *ctx, broker_conn_t *waiter, broker_item_t *item) {
+    if (send_work_item(waiter, waiter->parked_request_id, item) == 0) {
+        LOG_DEBUG("Broker: Handed Ticket %u (VIP=%d) to parked worker fd=%d",
+                  item->ticket_number, item->is_vip, waiter->fd);
+        broker_conn_release(ctx, waiter, true);
+        free(item);
+        return true;
+    }
+    broker_conn_release(ctx, waiter, false);
+    return false;
+}
 
-    po_header_t header;
-    zcp_buffer_t *payload = NULL;
+/**
+ * @brief Queue a ticket and, if a worker of its service is parked, hand the
+ *        head of the queue to the longest-parked one.
+ *
+ * The queue push is lock-free; the park mutex is only taken when the parked
+ * count says somebody is waiting. A parked session that turns out to be dead
+ * is closed and the ticket is re-queued, so it is never lost.
+ *
+ * @return 0 once the ticket is queued or delivered, -1 if the queue is full
+ *         (@p item is freed).
+ */
+static int enqueue_or_dispatch(broker_ctx_t *ctx, int service, broker_item_t *item) {
+    for (;;) {
+        po_class_queue_class_t cls = item->is_vip ? PO_CLASS_QUEUE_HIGH : PO_CLASS_QUEUE_NORMAL;
+        if (po_class_queue_push(ctx->queues[service], item, cls) != 0) {
+            LOG_ERROR("Broker: Queue %d full, dropping Ticket %u", service, item->ticket_number);
+            free(item);
+            return -1;
+        }
+        LOG_DEBUG("Broker: Enqueued Ticket %u (VIP=%d) for Service %d", item->ticket_number,
+                  item->is_vip, service);
+
+        // Pairs with the fence in the GET_WORK park path: either that worker
+        // sees our ticket on its re-check, or we see it parked here.
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load(&ctx->parked[service].count) == 0)
+            return 0;
+
+        broker_conn_t *waiter = NULL;
+        pthread_mutex_lock(&ctx->park_mutexes[service]);
+        item = ctx->parked[service].head ? po_class_queue_pop(ctx->queues[service], NULL) : NULL;
+        if (item)
+            waiter = broker_park_pop(&ctx->parked[service]);
+        pthread_mutex_unlock(&ctx->park_mutexes[service]);
+
+        if (!waiter || deliver_to_parked(ctx, waiter, item))
+            return 0;
+    }
+}
 
-    int ret = net_recv_message_blocking(client_fd, &header, &payload);
+/**
+ * @brief Re-queue a ticket that was already acknowledged to its user.
+ *
+ * Only reached once every session that could take it has failed; a full
+ * queue then loses it, which is counted as well as logged.
+ */
+static void requeue_acked(broker_ctx_t *ctx, int service, broker_item_t *item) {
+    if (enqueue_or_dispatch(ctx, service, item) != 0)
+        PO_METRIC_COUNTER_INC("broker.ticket.lost");
+}
 
-    if (ret != 0 || !payload) {
-        LOG_WARN("Broker: Failed to recv message (ret=%d)", ret);
-        po_socket_close(client_fd);
-        if (payload)
-            net_zcp_release_rx(payload);
-        return;
-    }
+int broker_handler_process_request(broker_conn_t *conn, const po_header_t *header,
+                                   zcp_buffer_t *payload, broker_ctx_t *ctx) {
+    conn->requests_served++;
 
-    if (header.msg_type == MSG_TYPE_JOIN_QUEUE) {
+    if (header->msg_type == MSG_TYPE_JOIN_QUEUE) {
         msg_join_queue_t req;
+        if (header->payload_len < sizeof(req)) {
+            LOG_WARN("Broker: Short JOIN_QUEUE payload (%u bytes) on fd=%d", header->payload_len,
+                     conn->fd);
+            net_zcp_release_rx(payload);
+            return BROKER_REQ_CLOSE;
+        }
         memcpy(&req, payload, sizeof(req));
         net_zcp_release_rx(payload);
 
         if (req.service_type >= SIM_MAX_SERVICE_TYPES) {
             LOG_ERROR("Broker: Invalid service type %d", req.service_type);
-            po_socket_close(client_fd);
-            return;
+            return BROKER_REQ_CLOSE;
         }
 
-        // 1. Issue Ticket
-        uint32_t ticket = atomic_fetch_add(&ctx->shm->ticket_seq, 1);
-
-        // 2. Add to Priority Queue
-        broker_item_t *item = malloc(sizeof(broker_item_t));
-        if (item) {
-            item->ticket_number = ticket;
-            item->is_vip = req.is_vip;
-            item->requester_pid = req.requester_pid;
-            clock_gettime(CLOCK_MONOTONIC, &item->arrival_time);
-
-            pthread_mutex_lock(&ctx->queue_mutexes[req.service_type]);
-            if (po_priority_queue_push(ctx->queues[req.service_type], item) != 0) {
-                LOG_ERROR("Broker: Failed to push to queue %d", req.service_type);
-                free(item);
-            } else {
-                LOG_DEBUG("Broker: Enqueued Ticket %u (VIP=%d) for Service %d", ticket, req.is_vip,
-                          req.service_type);
+        // 1. Issue Ticket, unless this is a retry of a JOIN we already took
+        uint32_t ticket;
+        bool fresh = broker_join_cache_claim(&ctx->joins, req.requester_pid, req.requester_tid,
+                                             req.request_id, &ctx->shm->ticket_seq, &ticket);
+
+        // 2. Hand straight to a parked worker, or queue it
+        if (fresh) {
+            broker_item_t *item = malloc(sizeof(broker_item_t));
+            int queued = -1;
+            if (item) {
+                item->ticket_number = ticket;
+                item->is_vip = req.is_vip;
+                item->requester_pid = req.requester_pid;
+                clock_gettime(CLOCK_MONOTONIC, &item->arrival_time);
+                queued = enqueue_or_dispatch(ctx, req.service_type, item);
+            }
+            if (queued != 0) {
+                // Refuse with ticket 0; a retry of this JOIN is treated as new
+                broker_join_cache_forget(&ctx->joins, req.requester_pid, req.requester_tid,
+                                         req.request_id, ticket);
+                ticket = 0;
             }
-            pthread_mutex_unlock(&ctx->queue_mutexes[req.service_type]);
+        } else {
+            LOG_DEBUG("Broker: Repeated JOIN %u from PID %d, re-acking Ticket %u", req.request_id,
+                      req.requester_pid, ticket);
         }
 
-        // 3. Send Ack
-        msg_join_ack_t resp = {.ticket_number = ticket, .estimated_wait_ms = 0};
-        net_send_message(client_fd, MSG_TYPE_JOIN_ACK, PO_FLAG_NONE, (uint8_t *)&resp,
-                         sizeof(resp));
+        // 3. Send Ack (ticket 0: not queued)
+        msg_join_ack_t resp = {
+            .request_id = req.request_id, .ticket_number = ticket, .estimated_wait_ms = 0};
+        return broker_conn_send(conn, MSG_TYPE_JOIN_ACK, &resp, sizeof(resp)) == 0
+                   ? BROKER_REQ_DONE
+                   : BROKER_REQ_CLOSE;
+    }
 
-    } else if (header.msg_type == MSG_TYPE_GET_WORK) {
+    if (header->msg_type == MSG_TYPE_GET_WORK) {
         msg_get_work_t req;
+        if (header->payload_len < sizeof(req)) {
+            LOG_WARN("Broker: Short GET_WORK payload (%u bytes) on fd=%d", header->payload_len,
+                     conn->fd);
+            net_zcp_release_rx(payload);
+            return BROKER_REQ_CLOSE;
+        }
         memcpy(&req, payload, sizeof(req));
         net_zcp_release_rx(payload);
 
-        if (req.service_type >= SIM_MAX_SERVICE_TYPES) {
-            po_socket_close(client_fd);
-            return;
+        if (req.service_type >= SIM_MAX_SERVICE_TYPES)
+            return BROKER_REQ_CLOSE;
+
+        uint32_t wait_ms = req.max_wait_ms < ctx->park_timeout_ms ? req.max_wait_ms
+                                                                  : ctx->park_timeout_ms;
+        // A session with replies still queued is not parked: nobody would flush them
+        bool may_park = wait_ms > 0 && conn->out_len == 0 &&
+                        !atomic_load(&ctx->shm->sync.barrier_active) && !ctx->shutdown_requested;
+
+        // 1. Pop from the class queue, or park until JOIN_QUEUE hands us one
+        po_class_queue_t *queue = ctx->queues[req.service_type];
+        broker_item_t *item = po_class_queue_pop(queue, NULL);
+        if (!item && may_park) {
+            broker_park_list_t *parked = &ctx->parked[req.service_type];
+            conn->parked_request_id = req.request_id;
+            conn->park_deadline_ns = po_metric_now_ns() + (uint64_t)wait_ms * 1000000ull;
+
+            pthread_mutex_lock(&ctx->park_mutexes[req.service_type]);
+            broker_park_push(parked, conn);
+            // Re-check after publishing the park (see enqueue_or_dispatch):
+            // a ticket pushed meanwhile goes to the longest-parked worker.
+            atomic_thread_fence(memory_order_seq_cst);
+            broker_conn_t *waiter = NULL;
+            item = po_class_queue_pop(queue, NULL);
+            if (item)
+                waiter = broker_park_pop(parked);
+            pthread_mutex_unlock(&ctx->park_mutexes[req.service_type]);
+
+            if (!item)
+                return BROKER_REQ_PARKED;
+            if (waiter != conn) {
+                // An older parked worker takes it; we stay parked.
+                if (deliver_to_parked(ctx, waiter, item))
+                    return BROKER_REQ_PARKED;
+                // It was dead. The ticket is acked and the queue may have
+                // filled up since our pop, so we take it back ourselves
+                // rather than re-queue it, unless someone unparked us already.
+                pthread_mutex_lock(&ctx->park_mutexes[req.service_type]);
+                bool unparked = broker_park_remove(parked, conn);
+                pthread_mutex_unlock(&ctx->park_mutexes[req.service_type]);
+                if (!unparked) {
+                    requeue_acked(ctx, req.service_type, item);
+                    return BROKER_REQ_PARKED;
+                }
+            }
+            // We were the longest-parked worker (or took it back): serve it below.
         }
 
-        // 1. Pop from Priority Queue
-        pthread_mutex_lock(&ctx->queue_mutexes[req.service_type]);
-        broker_item_t *item = po_priority_queue_pop(ctx->queues[req.service_type]);
-        pthread_mutex_unlock(&ctx->queue_mutexes[req.service_type]);
-
-        msg_work_item_t resp = {0};
-        if (item) {
-            resp.ticket_number = item->ticket_number;
-            resp.is_vip = item->is_vip;
-            free(item); // Processed
-            LOG_DEBUG("Broker: Assigned Ticket %u to Worker (PID %d)", resp.ticket_number,
+        if (item)
+            LOG_DEBUG("Broker: Assigned Ticket %u to Worker (PID %d)", item->ticket_number,
                       req.worker_pid);
-        } else {
-            resp.ticket_number = 0; // No work available
+
+        // 2. Send Work Item (ticket 0: no work available)
+        if (send_work_item(conn, req.request_id, item) != 0) {
+            if (item)
+                requeue_acked(ctx, req.service_type, item);
+            return BROKER_REQ_CLOSE;
         }
+        free(item); // Processed
+        return BROKER_REQ_DONE;
+    }
 
-        // 2. Send Work Item
-        net_send_message(client_fd, MSG_TYPE_WORK_ITEM, PO_FLAG_NONE, (uint8_t *)&resp,
-                         sizeof(resp));
+    LOG_WARN("Broker: Unexpected message type 0x%02X", header->msg_type);
+    net_zcp_release_rx(payload);
+    return BROKER_REQ_CLOSE;
+}
 
-    } else {
-        LOG_WARN("Broker: Unexpected message type 0x%02X", header.msg_type);
-        net_zcp_release_rx(payload);
+int broker_handler_expire_parked(broker_ctx_t *ctx, bool flush_all) {
+    uint64_t now = flush_all ? UINT64_MAX : po_metric_now_ns();
+    uint64_t next = UINT64_MAX;
+
+    for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
+        pthread_mutex_lock(&ctx->park_mutexes[i]);
+        broker_conn_t *expired = broker_park_expire(&ctx->parked[i], now, &next);
+        pthread_mutex_unlock(&ctx->park_mutexes[i]);
+
+        while (expired) {
+            broker_conn_t *conn = expired;
+            expired = conn->park_next;
+            bool ok = send_work_item(conn, conn->parked_request_id, NULL) == 0;
+            broker_conn_release(ctx, conn, ok);
+        }
     }
 
-    po_socket_close(client_fd);
+    if (next == UINT64_MAX)
+        return BROKER_NO_DEADLINE;
+    now = po_metric_now_ns();
+    return next <= now ? 0 : (int)((next - now + 999999ull) / 1000000ull);
 }
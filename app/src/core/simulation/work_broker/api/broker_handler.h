@@ -1,8 +1,40 @@
 #ifndef BROKER_HANDLER_H
 #define BROKER_HANDLER_H
 
+#include <postoffice/net/net.h>
+
 #include "broker_core.h"
 
-void broker_handler_process_request(int client_fd, broker_ctx_t *ctx);
+#define BROKER_REQ_DONE 0
+#define BROKER_REQ_PARKED 1
+#define BROKER_REQ_CLOSE -1
+
+// broker_handler_expire_parked(): no session left parked
+#define BROKER_NO_DEADLINE -1
+
+/**
+ * @brief Handle one framed request received on a persistent session.
+ *
+ * The reply (if any) is written back on @p conn and echoes the request's
+ * correlation ID. Ownership of @p payload passes to the handler.
+ *
+ * @return BROKER_REQ_DONE to keep serving the session, BROKER_REQ_PARKED if the
+ *         session was parked on an empty queue (ownership moved to the park
+ *         list: the caller must neither read from nor re-arm it), or
+ *         BROKER_REQ_CLOSE if it must be closed.
+ */
+int broker_handler_process_request(broker_conn_t *conn, const po_header_t *header,
+                                   zcp_buffer_t *payload, broker_ctx_t *ctx);
+
+/**
+ * @brief Answer parked GET_WORK requests with "no work" (ticket 0).
+ *
+ * Expires sessions whose park deadline has passed, or every parked session
+ * when @p flush_all is set (day barrier, shutdown).
+ *
+ * @return Milliseconds until the next deadline still pending, or
+ *         BROKER_NO_DEADLINE if no session remains parked.
+ */
+int broker_handler_expire_parked(broker_ctx_t *ctx, bool flush_all);
 
 #endif
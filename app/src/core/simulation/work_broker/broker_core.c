@@ -3,12 +3,14 @@
 #include "api/broker_core.h"
 
 #include <errno.h>
+#include <postoffice/metrics/metrics.h>
 #include <postoffice/net/net.h>
 #include <postoffice/net/socket.h>
 #include <postoffice/sysinfo/sysinfo.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -17,61 +19,170 @@
 
 // --- Helpers ---
 
-static unsigned long item_hash(const void *ptr) {
-    return (unsigned long)(uintptr_t)ptr;
-}
+// Session sockets are armed one-shot so a single pool thread owns a connection
+// between a readiness event and the re-arm at the end of its task.
+#define BROKER_CONN_EVENTS (EPOLLIN | EPOLLRDHUP | EPOLLONESHOT)
 
-static int item_compare(const void *a, const void *b) {
-    const broker_item_t *ia = (const broker_item_t *)a;
-    const broker_item_t *ib = (const broker_item_t *)b;
-    if (ia->is_vip != ib->is_vip)
-        return ib->is_vip - ia->is_vip;
-    if (ia->arrival_time.tv_sec != ib->arrival_time.tv_sec)
-        return (int)(ia->arrival_time.tv_sec - ib->arrival_time.tv_sec);
-    return (int)(ia->arrival_time.tv_nsec - ib->arrival_time.tv_nsec);
-}
+// Upper bound of pipelined requests drained per task before yielding the
+// thread back to the pool (keeps one chatty session from starving the rest).
+#define BROKER_CONN_BUDGET 64
+
+// Hard cap for the fd-indexed connection table.
+#define BROKER_MAX_CONN_FDS 65536
 
 typedef struct {
-    int client_fd;
+    broker_conn_t *conn;
     broker_ctx_t *ctx;
 } task_data_t;
 
+int broker_conn_serve(broker_conn_t *conn, broker_ctx_t *ctx) {
+    if (conn->out_len > 0 && broker_conn_flush(conn) != 0)
+        return BROKER_REQ_CLOSE;
+
+    for (int i = 0; i < BROKER_CONN_BUDGET; i++) {
+        po_header_t header;
+        zcp_buffer_t *payload = NULL;
+
+        int ret = net_recv_message(conn->fd, &header, &payload);
+        if (ret == 0) {
+            if (!payload) // Empty frame: nothing we speak
+                return BROKER_REQ_CLOSE;
+            PO_METRIC_TIMER_BEGIN(req_timer, "broker.request.ns");
+            int verdict = broker_handler_process_request(conn, &header, payload, ctx);
+            PO_METRIC_TIMER_END(req_timer);
+            if (verdict != BROKER_REQ_DONE)
+                return verdict;
+            continue;
+        }
+
+        if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return BROKER_REQ_DONE; // Drained (or partial frame still in flight)
+
+        if (ret != -2)
+            LOG_WARN("Broker: Failed to recv on fd=%d (errno=%d)", conn->fd, errno);
+        return BROKER_REQ_CLOSE; // EOF or hard error
+    }
+    return BROKER_REQ_DONE;
+}
+
+void broker_conn_release(broker_ctx_t *ctx, broker_conn_t *conn, bool healthy) {
+    uint32_t events = (uint32_t)(BROKER_CONN_EVENTS | (conn->out_len > 0 ? EPOLLOUT : 0));
+    if (healthy && poller_mod(ctx->poller, conn->fd, events) == 0)
+        return;
+
+    LOG_DEBUG("Broker: Closing session fd=%d after %lu requests", conn->fd,
+              (unsigned long)conn->requests_served);
+    poller_remove(ctx->poller, conn->fd);
+    broker_conns_close(&ctx->conns, conn);
+}
+
+static void serve_and_rearm(broker_conn_t *conn, broker_ctx_t *ctx) {
+    int verdict = broker_conn_serve(conn, ctx);
+    if (verdict != BROKER_REQ_PARKED)
+        broker_conn_release(ctx, conn, verdict == BROKER_REQ_DONE);
+}
+
 static void worker_task(void *arg) {
     task_data_t *data = (task_data_t *)arg;
-    broker_handler_process_request(data->client_fd, data->ctx);
+    serve_and_rearm(data->conn, data->ctx);
     free(data);
 }
 
+static size_t conn_table_capacity(void) {
+    // Every user/worker thread holds a session, so lift the soft fd limit.
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+        return 1024;
+
+    if (rl.rlim_cur < rl.rlim_max) {
+        struct rlimit raised = {.rlim_cur = rl.rlim_max, .rlim_max = rl.rlim_max};
+        if (raised.rlim_cur > BROKER_MAX_CONN_FDS)
+            raised.rlim_cur = BROKER_MAX_CONN_FDS;
+        if (raised.rlim_cur > rl.rlim_cur && setrlimit(RLIMIT_NOFILE, &raised) == 0)
+            rl.rlim_cur = raised.rlim_cur;
+    }
+
+    if (rl.rlim_cur == RLIM_INFINITY || rl.rlim_cur > BROKER_MAX_CONN_FDS)
+        return BROKER_MAX_CONN_FDS;
+    return (size_t)rl.rlim_cur;
+}
+
+static void accept_connections(broker_ctx_t *ctx) {
+    while (!ctx->shutdown_requested) {
+        int client = po_socket_accept(ctx->socket_fd, NULL, 0);
+        if (client < 0)
+            break;
+
+        broker_conn_t *conn = broker_conns_open(&ctx->conns, client);
+        if (!conn) {
+            LOG_WARN("Broker: Rejecting session fd=%d (table capacity %zu)", client,
+                     ctx->conns.capacity);
+            po_socket_close(client);
+            continue;
+        }
+
+        if (poller_add(ctx->poller, client, BROKER_CONN_EVENTS) != 0) {
+            LOG_WARN("Broker: Failed to register session fd=%d", client);
+            broker_conns_close(&ctx->conns, conn);
+        }
+    }
+}
+
+static void dispatch_connection(broker_ctx_t *ctx, int fd) {
+    broker_conn_t *conn = broker_conns_get(&ctx->conns, fd);
+    if (!conn)
+        return;
+
+    task_data_t *data = malloc(sizeof(task_data_t));
+    if (data) {
+        data->conn = conn;
+        data->ctx = ctx;
+        if (tp_submit(ctx->tp, worker_task, data) == 0)
+            return;
+        free(data);
+    }
+
+    // Pool saturated: serve inline rather than dropping the event (one-shot
+    // means nobody else would ever re-arm this session).
+    serve_and_rearm(conn, ctx);
+}
+
 // --- Implementation ---
 
-int broker_init(broker_ctx_t *ctx, const char *loglevel, size_t pool_size) {
+int broker_init(broker_ctx_t *ctx, const char *loglevel, size_t pool_size,
+                uint32_t park_timeout_ms) {
     if (!ctx)
         return -1;
     memset(ctx, 0, sizeof(*ctx));
     ctx->pool_size = pool_size;
+    ctx->park_timeout_ms = park_timeout_ms;
     ctx->shutdown_requested = 0;
 
     // Logger
-    po_logger_config_t log_cfg = {.level = po_logger_level_from_str(loglevel) == -1
-                                               ? LOG_INFO
-                                               : po_logger_level_from_str(loglevel),
-                                  .ring_capacity = 4096,
-                                  .consumers = 1};
-    if (po_logger_init(&log_cfg) != 0)
+    if (sim_client_init_logger(loglevel, SIM_LOG_WORK_BROKER, "logs/work_broker.log") != 0)
         return -1;
-    po_logger_add_sink_file("logs/work_broker.log", true);
 
     // Queues
     for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
-        ctx->queues[i] = po_priority_queue_create(item_compare, item_hash);
-        pthread_mutex_init(&ctx->queue_mutexes[i], NULL);
+        ctx->queues[i] = po_class_queue_create(BROKER_QUEUE_CAPACITY);
+        if (!ctx->queues[i])
+            return -1;
+        pthread_mutex_init(&ctx->park_mutexes[i], NULL);
     }
 
+    if (broker_join_cache_init(&ctx->joins) != 0)
+        return -1;
+
     // SHM
     ctx->shm = sim_ipc_shm_attach();
     if (!ctx->shm)
         return -1;
 
+    // Metrics (attaches to the director's perf SHM; before net so its counters register)
+    po_metrics_init(0, 0, 0);
+    PO_METRIC_TIMER_CREATE("broker.request.ns");
+    PO_METRIC_COUNTER_CREATE("broker.ticket.lost");
+
     // Net
     if (net_init_zerocopy(128, 128, 4096) != 0)
         return -1;
@@ -98,6 +209,10 @@ int broker_init(broker_ctx_t *ctx, const char *loglevel, size_t pool_size) {
     atomic_fetch_add(&ctx->shm->stats.active_threads, 1);
     tp_set_active_counter(ctx->tp, &ctx->shm->stats.active_threads);
 
+    // Sessions
+    if (broker_conns_init(&ctx->conns, conn_table_capacity()) != 0)
+        return -1;
+
     // Poller
     ctx->poller = poller_create();
     poller_add(ctx->poller, ctx->socket_fd, EPOLLIN);
@@ -109,28 +224,27 @@ void broker_run(broker_ctx_t *ctx) {
     struct epoll_event ev[32];
     int last_day = 0;
 
+    int timeout_ms = 100;
+
     while (!ctx->shutdown_requested) {
-        int n = poller_wait(ctx->poller, ev, 32, 100);
+        int n = poller_wait(ctx->poller, ev, 32, timeout_ms);
         if (n < 0 && errno != EINTR)
             break;
 
         for (int i = 0; i < n; i++) {
-            if (ev[i].data.fd == ctx->socket_fd) {
-                while (!ctx->shutdown_requested) {
-                    int client = po_socket_accept(ctx->socket_fd, NULL, 0);
-                    if (client < 0)
-                        break;
-
-                    task_data_t *data = malloc(sizeof(task_data_t));
-                    data->client_fd = client;
-                    data->ctx = ctx; // Pass context
-
-                    tp_submit(ctx->tp, worker_task, data);
-                }
-            }
+            if (ev[i].data.fd == ctx->socket_fd)
+                accept_connections(ctx);
+            else
+                dispatch_connection(ctx, ev[i].data.fd);
         }
 
-        if (atomic_load(&ctx->shm->sync.barrier_active)) {
+        // Answer expired long polls; release every parked worker before a
+        // day barrier so they can reach it.
+        bool barrier = atomic_load(&ctx->shm->sync.barrier_active);
+        int next_ms = broker_handler_expire_parked(ctx, barrier);
+        timeout_ms = (next_ms != BROKER_NO_DEADLINE && next_ms < 100) ? next_ms : 100;
+
+        if (barrier) {
             // Cast generic shutdown flag locally if needed or update sim_client_wait_barrier sig
             // checking sim_client definition for wait_barrier signature: (shm, last_day,
             // shutdown_ptr) shutdown_ptr is volatile sig_atomic_t* in original code. We cast our
@@ -152,6 +266,9 @@ void broker_shutdown(broker_ctx_t *ctx) {
 
     if (ctx->tp)
         tp_destroy(ctx->tp, true);
+    if (ctx->poller)
+        broker_handler_expire_parked(ctx, true);
+    broker_conns_destroy(&ctx->conns);
     if (ctx->poller)
         poller_destroy(ctx->poller);
 
@@ -160,10 +277,15 @@ void broker_shutdown(broker_ctx_t *ctx) {
         sim_ipc_shm_detach(ctx->shm);
 
     for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
-        if (ctx->queues[i])
-            po_priority_queue_destroy(ctx->queues[i]);
-        pthread_mutex_destroy(&ctx->queue_mutexes[i]);
+        if (ctx->queues[i]) {
+            broker_item_t *item;
+            while ((item = po_class_queue_pop(ctx->queues[i], NULL)) != NULL)
+                free(item); // Tickets nobody served before closing time
+            po_class_queue_destroy(ctx->queues[i]);
+        }
+        pthread_mutex_destroy(&ctx->park_mutexes[i]);
     }
+    broker_join_cache_destroy(&ctx->joins);
 
     po_logger_shutdown();
 }
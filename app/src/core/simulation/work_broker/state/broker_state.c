@@ -1,2 +1,235 @@
 #include "broker_state.h"
-// This module could manage in-memory state snapshots for the broker.
+
+#include <errno.h>
+#include <postoffice/net/net.h>
+#include <postoffice/net/socket.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+int broker_conns_init(broker_conn_table_t *table, size_t capacity) {
+    if (!table || capacity == 0)
+        return -1;
+
+    table->slots = calloc(capacity, sizeof(*table->slots));
+    if (!table->slots)
+        return -1;
+
+    table->capacity = capacity;
+    atomic_init(&table->live, 0);
+    return 0;
+}
+
+broker_conn_t *broker_conns_open(broker_conn_table_t *table, int fd) {
+    if (!table->slots || fd < 0 || (size_t)fd >= table->capacity)
+        return NULL;
+
+    broker_conn_t *conn = calloc(1, sizeof(*conn));
+    if (!conn)
+        return NULL;
+
+    conn->fd = fd;
+    atomic_store(&table->slots[fd], conn);
+    atomic_fetch_add(&table->live, 1);
+    return conn;
+}
+
+broker_conn_t *broker_conns_get(broker_conn_table_t *table, int fd) {
+    if (!table->slots || fd < 0 || (size_t)fd >= table->capacity)
+        return NULL;
+    return atomic_load(&table->slots[fd]);
+}
+
+void broker_conns_close(broker_conn_table_t *table, broker_conn_t *conn) {
+    if (!conn)
+        return;
+
+    // Clear the slot before closing: once the fd is closed the kernel may hand
+    // the same number to the next accept().
+    atomic_store(&table->slots[conn->fd], NULL);
+    atomic_fetch_sub(&table->live, 1);
+    po_socket_close(conn->fd);
+    free(conn->out_buf);
+    free(conn);
+}
+
+void broker_conns_destroy(broker_conn_table_t *table) {
+    if (!table || !table->slots)
+        return;
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        broker_conn_t *conn = atomic_load(&table->slots[i]);
+        if (conn)
+            broker_conns_close(table, conn);
+    }
+
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+}
+
+int broker_conn_flush(broker_conn_t *conn) {
+    size_t sent = 0;
+    while (sent < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out_buf + sent, conn->out_len - sent,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        return -1;
+    }
+
+    conn->out_len -= sent;
+    if (sent > 0 && conn->out_len > 0)
+        memmove(conn->out_buf, conn->out_buf + sent, conn->out_len);
+    return 0;
+}
+
+int broker_conn_send(broker_conn_t *conn, uint8_t msg_type, const void *payload, uint32_t len) {
+    size_t need = conn->out_len + sizeof(uint32_t) + sizeof(po_header_t) + len;
+    if (need > BROKER_CONN_OUTBOX_MAX)
+        return -1;
+
+    if (need > conn->out_cap) {
+        size_t cap = conn->out_cap ? conn->out_cap : 256;
+        while (cap < need)
+            cap *= 2;
+        uint8_t *buf = realloc(conn->out_buf, cap);
+        if (!buf)
+            return -1;
+        conn->out_buf = buf;
+        conn->out_cap = cap;
+    }
+
+    // Frames are appended behind anything still queued so replies keep their order
+    conn->out_len += net_encode_message(conn->out_buf + conn->out_len,
+                                        conn->out_cap - conn->out_len, msg_type, PO_FLAG_NONE,
+                                        payload, len);
+    return broker_conn_flush(conn);
+}
+
+int broker_join_cache_init(broker_join_cache_t *cache) {
+    cache->slots = calloc(BROKER_JOIN_CACHE_SLOTS, sizeof(*cache->slots));
+    if (!cache->slots)
+        return -1;
+    for (int i = 0; i < BROKER_JOIN_CACHE_LOCKS; i++)
+        pthread_mutex_init(&cache->locks[i], NULL);
+    return 0;
+}
+
+void broker_join_cache_destroy(broker_join_cache_t *cache) {
+    if (!cache->slots)
+        return;
+    for (int i = 0; i < BROKER_JOIN_CACHE_LOCKS; i++)
+        pthread_mutex_destroy(&cache->locks[i]);
+    free(cache->slots);
+    cache->slots = NULL;
+}
+
+static size_t join_slot(pid_t pid, pid_t tid, uint32_t request_id) {
+    uint64_t h = ((uint64_t)(uint32_t)pid << 32 | (uint32_t)tid) * 0x9E3779B97F4A7C15ull;
+    h ^= request_id * 0xC2B2AE3D27D4EB4Full;
+    return (size_t)(h >> 32) & (BROKER_JOIN_CACHE_SLOTS - 1);
+}
+
+bool broker_join_cache_claim(broker_join_cache_t *cache, pid_t pid, pid_t tid,
+                             uint32_t request_id, atomic_uint *ticket_seq, uint32_t *ticket) {
+    size_t slot = join_slot(pid, tid, request_id);
+    broker_join_entry_t *e = &cache->slots[slot];
+    pthread_mutex_t *lock = &cache->locks[slot % BROKER_JOIN_CACHE_LOCKS];
+
+    pthread_mutex_lock(lock);
+    bool fresh = e->ticket == 0 || e->pid != pid || e->tid != tid || e->request_id != request_id;
+    if (fresh) {
+        uint32_t t;
+        do // 0 is reserved for "no ticket"
+            t = atomic_fetch_add(ticket_seq, 1) + 1;
+        while (t == 0);
+        *e = (broker_join_entry_t){
+            .pid = pid, .tid = tid, .request_id = request_id, .ticket = t};
+    }
+    *ticket = e->ticket;
+    pthread_mutex_unlock(lock);
+    return fresh;
+}
+
+void broker_join_cache_forget(broker_join_cache_t *cache, pid_t pid, pid_t tid,
+                              uint32_t request_id, uint32_t ticket) {
+    size_t slot = join_slot(pid, tid, request_id);
+    broker_join_entry_t *e = &cache->slots[slot];
+    pthread_mutex_t *lock = &cache->locks[slot % BROKER_JOIN_CACHE_LOCKS];
+
+    pthread_mutex_lock(lock);
+    if (e->ticket == ticket && e->pid == pid && e->tid == tid && e->request_id == request_id)
+        e->ticket = 0;
+    pthread_mutex_unlock(lock);
+}
+
+void broker_park_push(broker_park_list_t *list, broker_conn_t *conn) {
+    conn->park_next = NULL;
+    if (list->tail)
+        list->tail->park_next = conn;
+    else
+        list->head = conn;
+    list->tail = conn;
+    list->count++;
+}
+
+broker_conn_t *broker_park_pop(broker_park_list_t *list) {
+    broker_conn_t *conn = list->head;
+    if (!conn)
+        return NULL;
+
+    list->head = conn->park_next;
+    if (!list->head)
+        list->tail = NULL;
+    list->count--;
+    conn->park_next = NULL;
+    return conn;
+}
+
+bool broker_park_remove(broker_park_list_t *list, broker_conn_t *conn) {
+    broker_conn_t *prev = NULL;
+    for (broker_conn_t **link = &list->head; *link; link = &(*link)->park_next) {
+        if (*link == conn) {
+            *link = conn->park_next;
+            if (list->tail == conn)
+                list->tail = prev;
+            list->count--;
+            conn->park_next = NULL;
+            return true;
+        }
+        prev = *link;
+    }
+    return false;
+}
+
+broker_conn_t *broker_park_expire(broker_park_list_t *list, uint64_t now_ns,
+                                  uint64_t *next_deadline_ns) {
+    broker_conn_t *expired = NULL;
+    broker_conn_t **link = &list->head;
+    broker_conn_t *prev = NULL;
+
+    while (*link) {
+        broker_conn_t *conn = *link;
+        if (conn->park_deadline_ns <= now_ns) {
+            *link = conn->park_next;
+            list->count--;
+            conn->park_next = expired;
+            expired = conn;
+            continue;
+        }
+        if (conn->park_deadline_ns < *next_deadline_ns)
+            *next_deadline_ns = conn->park_deadline_ns;
+        prev = conn;
+        link = &conn->park_next;
+    }
+
+    list->tail = prev;
+    return expired;
+}
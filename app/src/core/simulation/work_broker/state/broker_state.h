@@ -1,6 +1,194 @@
 #ifndef BROKER_STATE_H
 #define BROKER_STATE_H
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 // State management for the work broker
 
+/**
+ * @brief Per-connection state for a long-lived client session.
+ *
+ * Connections are registered with the broker poller in EPOLLONESHOT mode, so
+ * at most one pool thread owns a connection at any time; the fields below are
+ * only touched by that owner.
+ */
+typedef struct broker_conn_s {
+    int fd;
+    uint64_t requests_served; // Messages handled over this session
+
+    // Replies the socket buffer has not taken yet, flushed on EPOLLOUT
+    uint8_t *out_buf;
+    size_t out_len;
+    size_t out_cap;
+
+    // Long-poll state, valid while the session sits on a broker_park_list_t
+    uint32_t parked_request_id;
+    uint64_t park_deadline_ns;
+    struct broker_conn_s *park_next;
+} broker_conn_t;
+
+/**
+ * @brief FIFO of sessions parked on an empty service queue.
+ *
+ * Not synchronised: callers hold the park mutex of the service it belongs
+ * to. A session on the list is not armed in the poller, so whoever unlinks
+ * it becomes its owner and must answer and re-arm (or close) it. @c count is
+ * atomic so producers can check for parked sessions without the mutex.
+ */
+typedef struct broker_park_list_s {
+    broker_conn_t *head;
+    broker_conn_t *tail;
+    atomic_size_t count;
+} broker_park_list_t;
+
+// Largest outbox a session may build up before the broker gives up on it
+#define BROKER_CONN_OUTBOX_MAX (1u << 20)
+
+/**
+ * @brief One issued ticket, remembered by who asked for it.
+ */
+typedef struct broker_join_entry_s {
+    pid_t pid;
+    pid_t tid;
+    uint32_t request_id;
+    uint32_t ticket; // 0: empty slot
+} broker_join_entry_t;
+
+#define BROKER_JOIN_CACHE_SLOTS 65536
+#define BROKER_JOIN_CACHE_LOCKS 64
+
+/**
+ * @brief Direct-mapped cache of recently issued JOIN_QUEUE tickets.
+ *
+ * Keyed by the requester's (pid, tid) and request ID, so a JOIN retried after
+ * a lost reply, even over a new session, gets back the ticket issued the first
+ * time instead of a second one. A later join hashing to the same slot
+ * overwrites it; retries arrive well within that window.
+ */
+typedef struct broker_join_cache_s {
+    broker_join_entry_t *slots;
+    pthread_mutex_t locks[BROKER_JOIN_CACHE_LOCKS];
+} broker_join_cache_t;
+
+/**
+ * @brief fd-indexed table of live connections.
+ *
+ * Slots are atomics so the accept thread can publish a connection while pool
+ * threads look up others without a lock.
+ */
+typedef struct broker_conn_table_s {
+    _Atomic(broker_conn_t *) *slots;
+    size_t capacity;
+    atomic_uint live;
+} broker_conn_table_t;
+
+/**
+ * @brief Allocate a table able to index file descriptors in [0, capacity).
+ * @return 0 on success, -1 on allocation failure.
+ */
+int broker_conns_init(broker_conn_table_t *table, size_t capacity);
+
+/**
+ * @brief Register a freshly accepted socket.
+ * @return The new connection, or NULL if @p fd is out of range / OOM.
+ */
+broker_conn_t *broker_conns_open(broker_conn_table_t *table, int fd);
+
+/**
+ * @brief Look up the connection bound to @p fd (NULL if none).
+ */
+broker_conn_t *broker_conns_get(broker_conn_table_t *table, int fd);
+
+/**
+ * @brief Unregister, close and free a connection.
+ */
+void broker_conns_close(broker_conn_table_t *table, broker_conn_t *conn);
+
+/**
+ * @brief Close every remaining connection and release the table.
+ */
+void broker_conns_destroy(broker_conn_table_t *table);
+
+/**
+ * @brief Queue one framed message on a session and write what the socket takes.
+ *
+ * Never blocks: bytes the socket buffer cannot take yet stay in the session's
+ * outbox until broker_conn_flush() runs on the next EPOLLOUT. Only the current
+ * owner of the session may call it.
+ *
+ * @return 0 if the message was sent or queued, -1 if the session is dead or
+ *         its outbox would exceed BROKER_CONN_OUTBOX_MAX.
+ */
+int broker_conn_send(broker_conn_t *conn, uint8_t msg_type, const void *payload, uint32_t len);
+
+/**
+ * @brief Write as much of the outbox as the socket takes.
+ * @return 0 (out_len tells what is left), or -1 on a hard socket error.
+ */
+int broker_conn_flush(broker_conn_t *conn);
+
+/**
+ * @brief Allocate an empty JOIN cache.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int broker_join_cache_init(broker_join_cache_t *cache);
+
+/**
+ * @brief Release the cache (safe on a zeroed or destroyed cache).
+ */
+void broker_join_cache_destroy(broker_join_cache_t *cache);
+
+/**
+ * @brief Return the ticket already issued for a JOIN, or issue a new one.
+ *
+ * Lookup and issue happen under the slot's lock, so two copies of the same
+ * JOIN racing on different sessions agree on one ticket.
+ *
+ * @param ticket_seq Ticket sequence (the new ticket is its next value, never 0).
+ * @param[out] ticket The ticket to acknowledge.
+ * @return true if @p ticket was issued by this call, false for a repeated JOIN.
+ */
+bool broker_join_cache_claim(broker_join_cache_t *cache, pid_t pid, pid_t tid,
+                             uint32_t request_id, atomic_uint *ticket_seq, uint32_t *ticket);
+
+/**
+ * @brief Drop the entry for a JOIN whose ticket was never queued.
+ *
+ * A retry of that JOIN then claims a fresh ticket instead of being
+ * acknowledged with the dropped one. No-op if the slot was reused meanwhile.
+ */
+void broker_join_cache_forget(broker_join_cache_t *cache, pid_t pid, pid_t tid,
+                              uint32_t request_id, uint32_t ticket);
+
+/**
+ * @brief Append a session to the tail of a park list.
+ */
+void broker_park_push(broker_park_list_t *list, broker_conn_t *conn);
+
+/**
+ * @brief Unlink the longest-waiting session (NULL if the list is empty).
+ */
+broker_conn_t *broker_park_pop(broker_park_list_t *list);
+
+/**
+ * @brief Unlink @p conn if it is still parked on @p list.
+ * @return true if it was unlinked (the caller now owns it).
+ */
+bool broker_park_remove(broker_park_list_t *list, broker_conn_t *conn);
+
+/**
+ * @brief Unlink every session whose deadline is <= @p now_ns.
+ *
+ * @param now_ns Monotonic timestamp; UINT64_MAX expires the whole list.
+ * @param next_deadline_ns In/out: lowered to the earliest deadline still parked.
+ * @return Chain of expired sessions linked through park_next (NULL if none).
+ */
+broker_conn_t *broker_park_expire(broker_park_list_t *list, uint64_t now_ns,
+                                  uint64_t *next_deadline_ns);
+
 #endif
@@ -33,16 +33,20 @@ int main(int argc, char *argv[]) {
 
     char *loglevel = "INFO";
     size_t pool_size = 0;
+    uint32_t park_timeout_ms = BROKER_DEFAULT_PARK_TIMEOUT_MS;
 
     struct option long_opts[] = {{"pool-size", required_argument, 0, 'p'},
                                  {"loglevel", required_argument, 0, 'l'},
+                                 {"park-timeout-ms", required_argument, 0, 't'},
                                  {0, 0, 0, 0}};
     int opt;
-    while ((opt = getopt_long(argc, argv, "l:p:", long_opts, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "l:p:t:", long_opts, NULL)) != -1) {
         if (opt == 'p')
             pool_size = (size_t)atol(optarg);
         if (opt == 'l')
             loglevel = optarg;
+        if (opt == 't')
+            park_timeout_ms = (uint32_t)atol(optarg);
     }
 
     if (pool_size == 0) {
@@ -54,7 +58,7 @@ int main(int argc, char *argv[]) {
     // Setup signals
     sim_client_setup_signals(on_sig);
 
-    if (broker_init(&g_ctx, loglevel, pool_size) != 0) {
+    if (broker_init(&g_ctx, loglevel, pool_size, park_timeout_ms) != 0) {
         return 1;
     }
 
@@ -50,11 +50,7 @@ void worker_job_simulate(int worker_id, int service_type, uint32_t ticket, sim_s
     atomic_store(&shm->workers[worker_id].state, WORKER_STATUS_FREE);
     atomic_fetch_add(&shm->stats.total_services_completed, 1);
 
-    // Notify queue (that we are free or ticket is done)
-    queue_status_t *q = &shm->queues[service_type];
-    pthread_mutex_lock(&q->mutex);
-    atomic_store(&q->last_finished_ticket, ticket); // Persistent record of completion
-    pthread_cond_broadcast(&q->cond_served);
-    pthread_mutex_unlock(&q->mutex);
-    // Also cond_added is used for workers to sleep, but here we wake users waiting on cond_served.
+    // Wake exactly the owner of this ticket
+    atomic_store(&shm->queues[service_type].last_finished_ticket, ticket);
+    po_completion_publish(&shm->completions, ticket);
 }
@@ -12,7 +12,6 @@
 #include <postoffice/net/net.h>
 #include <postoffice/net/socket.h>
 #include <postoffice/random/random.h>
-#include <postoffice/sysinfo/sysinfo.h>
 #include <pthread.h>
 #include <sched.h>
 #include <stdatomic.h>
@@ -37,18 +36,7 @@ static void on_sig(int s, siginfo_t *i, void *c) {
 sim_shm_t *initialize_worker_runtime(void) {
     po_metrics_init(0, 0, 0);
 
-    po_sysinfo_t si;
-    size_t cache =
-        (po_sysinfo_collect(&si) == 0 && si.dcache_lnsize > 0) ? (size_t)si.dcache_lnsize : 64;
-
-    char *lvl = getenv("PO_LOG_LEVEL");
-    po_logger_init(&(po_logger_config_t){.level = (lvl && po_logger_level_from_str(lvl) != -1)
-                                                      ? po_logger_level_from_str(lvl)
-                                                      : LOG_INFO,
-                                         .ring_capacity = 256,
-                                         .consumers = 1,
-                                         .cacheline_bytes = cache});
-    po_logger_add_sink_file("logs/workers.log", true);
+    sim_client_init_logger(getenv("PO_LOG_LEVEL"), SIM_LOG_WORKERS, "logs/workers.log");
     // po_logger_add_sink_console(false);
 
     sim_shm_t *shm = sim_ipc_shm_attach();
@@ -57,6 +45,13 @@ sim_shm_t *initialize_worker_runtime(void) {
         return NULL; // Should not reach here due to abort
     }
 
+    // RX buffers for broker replies (one in flight per worker thread)
+    if (net_init_zerocopy(32, 32, 4096) != 0) {
+        LOG_FATAL("Worker failed to initialize network zerocopy");
+        sim_ipc_shm_detach(shm);
+        return NULL;
+    }
+
     sim_client_setup_signals(on_sig);
     po_rand_seed_auto();
     return shm;
@@ -65,50 +60,36 @@ sim_shm_t *initialize_worker_runtime(void) {
 void teardown_worker_runtime(sim_shm_t *shm) {
     if (shm)
         sim_ipc_shm_detach(shm);
+    net_shutdown_zerocopy();
     po_logger_shutdown();
 }
 
-static uint32_t retrieve_next_ticket_broker(int service, sim_shm_t *shm) {
+// Long-poll bound requested from the broker (which clamps it to its own
+// park timeout). Kept below the session receive timeout.
+#define WORKER_GET_WORK_WAIT_MS 250
+
+/**
+ * @brief Long-poll the broker for the next ticket of @p service.
+ * @return 0 with *ticket_out set (0 = none before the wait expired), -1 if
+ *         the broker could not be reached.
+ */
+static int retrieve_next_ticket_broker(sim_client_session_t *session, int service,
+                                       sim_shm_t *shm, uint32_t *ticket_out) {
+    *ticket_out = 0;
     if (!atomic_load(&shm->time_control.sim_active))
         return 0;
 
-    // Connect to Broker
-    // Note: In optimal design, we might keep connection open.
-    // Here we reconnect for simplicity as per current Net API usage in User.
-    // Broker handles short-lived connections fine.
     volatile atomic_bool dummy_cont = 1;
-    int fd = sim_client_connect_issuer(&dummy_cont, shm);
-    if (fd < 0)
-        return 0;
-
-    struct timeval tv = {.tv_usec = 500000};
-    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    msg_get_work_t req = {.worker_pid = getpid(), .service_type = (service_type_t)service};
-
-    if (net_send_message(fd, MSG_TYPE_GET_WORK, PO_FLAG_NONE, (uint8_t *)&req, sizeof(req)) != 0) {
-        po_socket_close(fd);
-        return 0;
-    }
-
-    po_header_t h;
-    zcp_buffer_t *p = NULL;
-    int ret = net_recv_message_blocking(fd, &h, &p);
-    po_socket_close(fd);
-
-    if (ret != 0 || !p || h.msg_type != MSG_TYPE_WORK_ITEM) {
-        if (p)
-            net_zcp_release_rx(p);
-        return 0;
-    }
-
+    msg_get_work_t req = {.worker_pid = getpid(),
+                          .service_type = (service_type_t)service,
+                          .max_wait_ms = WORKER_GET_WORK_WAIT_MS};
     msg_work_item_t resp;
-    memcpy(&resp, p, sizeof(resp));
-    net_zcp_release_rx(p);
 
-    if (resp.ticket_number > 0) {
-        return resp.ticket_number;
-    }
+    if (sim_client_session_call(session, &dummy_cont, shm, MSG_TYPE_GET_WORK, &req, sizeof(req),
+                                MSG_TYPE_WORK_ITEM, &resp, sizeof(resp)) != 0)
+        return -1;
+
+    *ticket_out = resp.ticket_number;
     return 0;
 }
 
@@ -119,6 +100,11 @@ int run_worker_service_loop(int worker_id, int service_type, sim_shm_t *shm,
 
     int last_day = 0;
     int d, h, m;
+
+    // One persistent broker connection per worker thread
+    sim_client_session_t session;
+    sim_client_session_init(&session);
+
     while (!g_shutdown) {
         // 1. Enter Process-Local Barrier
         int rc = pthread_barrier_wait(&sync_ctx->barrier);
@@ -163,18 +149,23 @@ int run_worker_service_loop(int worker_id, int service_type, sim_shm_t *shm,
                 }
             }
 
-            uint32_t ticket = retrieve_next_ticket_broker(service_type, shm);
+            uint32_t ticket;
+            if (retrieve_next_ticket_broker(&session, service_type, shm, &ticket) != 0) {
+                // Broker unreachable: back off before reconnecting
+                usleep(10000);
+                continue;
+            }
+
             if (ticket > 0) {
                 LOG_DEBUG("Worker %d acquiring ticket...", worker_id);
                 worker_job_simulate(worker_id, service_type, ticket, shm);
+            } else if (!atomic_load(&shm->time_control.sim_active)) {
+                // Not running yet: the broker was not asked, so do not spin
+                usleep(1000);
             } else {
-                if (atomic_load(&shm->sync.barrier_active))
-                    break;
-                // No tickets and no barrier - yield
-                if (shm->params.tick_nanos > 0)
-                    usleep(10000);
-                else
-                    sched_yield();
+                // The broker already parked us for the long-poll window; only
+                // yield in case parking is disabled broker-side.
+                sched_yield();
             }
         }
 
@@ -186,5 +177,7 @@ int run_worker_service_loop(int worker_id, int service_type, sim_shm_t *shm,
         else
             sched_yield();
     }
+
+    sim_client_session_close(&session);
     return 0;
 }
@@ -0,0 +1,123 @@
+#include "unity/unity_fixture.h"
+#include "postoffice/concurrency/completion.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+TEST_GROUP(COMPLETION);
+
+static po_completion_table_t *table;
+
+typedef struct {
+    uint32_t ticket;
+    int rc;
+    atomic_bool returned;
+} waiter_t;
+
+static void *waiter_thread(void *arg) {
+    waiter_t *w = (waiter_t *)arg;
+    w->rc = po_completion_wait(table, w->ticket, 2000);
+    atomic_store(&w->returned, true);
+    return NULL;
+}
+
+static void wait_until_blocked(uint32_t ticket, unsigned int count) {
+    for (int i = 0; i < 2000; i++) {
+        if (atomic_load(&table->slots[ticket & (PO_COMPLETION_SLOTS - 1)].waiters) >= count)
+            return;
+        usleep(1000);
+    }
+}
+
+TEST_SETUP(COMPLETION) {
+    table = malloc(sizeof(*table));
+    TEST_ASSERT_NOT_NULL(table);
+    po_completion_init(table);
+}
+
+TEST_TEAR_DOWN(COMPLETION) {
+    free(table);
+    table = NULL;
+}
+
+TEST(COMPLETION, PublishBeforeWait) {
+    TEST_ASSERT_FALSE(po_completion_is_done(table, 7));
+    po_completion_publish(table, 7);
+    TEST_ASSERT_TRUE(po_completion_is_done(table, 7));
+    TEST_ASSERT_EQUAL_INT(0, po_completion_wait(table, 7, 0));
+    // Nobody was waiting: no futex wake issued
+    TEST_ASSERT_EQUAL_UINT64(0, atomic_load(&table->wakes));
+}
+
+TEST(COMPLETION, WaitTimesOut) {
+    errno = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_completion_wait(table, 42, 20));
+    TEST_ASSERT_EQUAL_INT(ETIMEDOUT, errno);
+    TEST_ASSERT_EQUAL_INT(-1, po_completion_wait(table, 0, 0));
+}
+
+TEST(COMPLETION, WakesOnlyOwner) {
+    waiter_t a = {.ticket = 10}, b = {.ticket = 11};
+    pthread_t ta, tb;
+    pthread_create(&ta, NULL, waiter_thread, &a);
+    pthread_create(&tb, NULL, waiter_thread, &b);
+    wait_until_blocked(10, 1);
+    wait_until_blocked(11, 1);
+
+    po_completion_publish(table, 10);
+    pthread_join(ta, NULL);
+    TEST_ASSERT_EQUAL_INT(0, a.rc);
+
+    usleep(20000);
+    TEST_ASSERT_FALSE(atomic_load(&b.returned));
+    TEST_ASSERT_EQUAL_UINT64(1, atomic_load(&table->wakes));
+
+    po_completion_publish(table, 11);
+    pthread_join(tb, NULL);
+    TEST_ASSERT_EQUAL_INT(0, b.rc);
+}
+
+TEST(COMPLETION, WakeAllInterrupts) {
+    waiter_t a = {.ticket = 5};
+    pthread_t ta;
+    pthread_create(&ta, NULL, waiter_thread, &a);
+    wait_until_blocked(5, 1);
+
+    po_completion_wake_all(table);
+    pthread_join(ta, NULL);
+    TEST_ASSERT_EQUAL_INT(-1, a.rc);
+    TEST_ASSERT_FALSE(po_completion_is_done(table, 5));
+}
+
+TEST(COMPLETION, LogReadInOrder) {
+    uint32_t cursor = po_completion_log_head(table);
+    for (uint32_t t = 1; t <= 5; t++)
+        po_completion_publish(table, t * 3);
+
+    uint32_t out[8];
+    TEST_ASSERT_EQUAL_INT(5, po_completion_log_read(table, &cursor, out, 8));
+    for (uint32_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_UINT32((i + 1) * 3, out[i]);
+    TEST_ASSERT_EQUAL_INT(0, po_completion_log_read(table, &cursor, out, 8));
+}
+
+TEST(COMPLETION, LogOverrunReported) {
+    uint32_t cursor = po_completion_log_head(table);
+    for (uint32_t t = 1; t <= PO_COMPLETION_LOG_SIZE + 1; t++)
+        po_completion_publish(table, t);
+
+    uint32_t out[4];
+    TEST_ASSERT_EQUAL_INT(-1, po_completion_log_read(table, &cursor, out, 4));
+    TEST_ASSERT_EQUAL_UINT32(po_completion_log_head(table), cursor);
+}
+
+TEST_GROUP_RUNNER(COMPLETION) {
+    RUN_TEST_CASE(COMPLETION, PublishBeforeWait);
+    RUN_TEST_CASE(COMPLETION, WaitTimesOut);
+    RUN_TEST_CASE(COMPLETION, WakesOnlyOwner);
+    RUN_TEST_CASE(COMPLETION, WakeAllInterrupts);
+    RUN_TEST_CASE(COMPLETION, LogReadInOrder);
+    RUN_TEST_CASE(COMPLETION, LogOverrunReported);
+}
@@ -1,10 +1,19 @@
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include "log/logfmt.h"
 #include "log/logger.h"
+#include "log/logring.h"
+#include "log/logshm.h"
 #include "unity/unity_fixture.h"
 
 TEST_GROUP(LOGGER);
@@ -128,10 +137,561 @@ TEST(LOGGER, OVERFLOW_EMITS_ERROR) {
     unlink(path);
 }
 
+// Capture + render of @p fmt must print exactly what vsnprintf prints.
+static void __attribute__((format(printf, 1, 2))) check_deferred(const char *fmt, ...) {
+    char want[LOGGER_MSG_MAX], got[LOGGER_MSG_MAX];
+    uint8_t blob[LOGGER_MSG_MAX];
+    va_list ap, ap2;
+    va_start(ap, fmt);
+    va_copy(ap2, ap);
+    vsnprintf(want, sizeof(want), fmt, ap);
+    ssize_t n = po_logfmt_capture(fmt, ap2, blob, sizeof(blob));
+    va_end(ap2);
+    va_end(ap);
+    TEST_ASSERT_TRUE_MESSAGE(n >= 0, fmt);
+    po_logfmt_render(fmt, blob, (size_t)n, got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(want, got, fmt);
+}
+
+static ssize_t __attribute__((format(printf, 2, 3))) try_capture(size_t cap, const char *fmt,
+                                                                  ...) {
+    uint8_t blob[LOGGER_MSG_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    ssize_t n = po_logfmt_capture(fmt, ap, blob, cap);
+    va_end(ap);
+    return n;
+}
+
+TEST(LOGGER, DEFERRED_RENDER_MATCHES_VSNPRINTF) {
+    check_deferred("no args, 100%% literal");
+    check_deferred("ticket %d from user %u queue=%s", -42, 7u, "postal");
+    check_deferred("%hhd %hhu %hd %hu %ld %lu %lld %llu", 300, 300, 70000, 70000, -1L, ~0UL,
+                   -9000000000LL, 18000000000ULL);
+    check_deferred("%zu %zd %jd %td", (size_t)12, (ssize_t)-12, (intmax_t)-1, (ptrdiff_t)3);
+    check_deferred("[%5d|%-5d|%05d|%+d|% d] %x %#X %o", 42, 42, 42, 42, 42, 0xbeefu, 0xbeefu, 8u);
+    check_deferred("[%8s|%-8s|%.3s|%.*s|%*d|%-*.*s]", "ab", "ab", "abcdef", 2, "xyz", -6, 9, 7, 2,
+                   "hello");
+    check_deferred("%.2f %e %g %10.4f %Lf %c%c %%", 3.14159, 1e-9, 0.5, -2.0, (long double)1.25,
+                   'o', 'k');
+    check_deferred("%p %s", (void *)0x1234, (const char *)NULL);
+
+    // Not deferrable: the caller falls back to formatting inline
+    TEST_ASSERT_EQUAL_INT(-1, try_capture(64, "errno text: %m"));
+    // Strings are cut to fit; fixed-size arguments that do not fit fail
+    TEST_ASSERT_EQUAL_INT(16, try_capture(16, "%s", "a long string argument"));
+    TEST_ASSERT_EQUAL_INT(-1, try_capture(16, "%s %d %d", "abc", 1, 2));
+}
+
+static void read_all(const char *path, char *buf, size_t cap) {
+    FILE *fp = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    size_t n = fread(buf, 1, cap - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+}
+
+TEST(LOGGER, BINARY_SINK_DECODES_LIKE_TEXT) {
+    char bin[] = "/tmp/po_logger_binXXXXXX";
+    char txt[] = "/tmp/po_logger_txtXXXXXX";
+    int fd = mkstemp(bin);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+    fd = mkstemp(txt);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+
+    // Two sessions in one file: deferred, then inline formatting
+    for (int session = 0; session < 2; session++) {
+        po_logger_shutdown();
+        po_logger_config_t cfg = {
+            .level = LOG_TRACE,
+            .ring_capacity = 1024,
+            .consumers = 1,
+            .policy = LOGGER_DROP_NEW,
+            .deferred_format = session == 0,
+        };
+        TEST_ASSERT_EQUAL_INT(0, po_logger_init(&cfg));
+        TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_binary(bin, session > 0));
+        TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_file(txt, session > 0));
+        for (int i = 0; i < 100; i++)
+            LOG_INFO("session %d ticket %d user=%s wait=%.1fms", session, i, "alice", i * 0.5);
+        errno = EAGAIN;
+        LOG_WARN("inline fallback: %m");
+    }
+    po_logger_shutdown();
+
+    size_t cap = 1 << 16;
+    char *text = malloc(cap);
+    TEST_ASSERT_NOT_NULL(text);
+    read_all(txt, text, cap);
+
+    po_polog_reader_t *r = po_polog_open(bin);
+    TEST_ASSERT_NOT_NULL(r);
+    po_polog_entry e;
+    const char *line = text;
+    int records = 0;
+    while (po_polog_next(r, &e) == 1) {
+        // Same message, source and level as the text sink's line
+        const char *nl = strchr(line, '\n');
+        TEST_ASSERT_NOT_NULL(nl);
+        char want[LOGGER_MSG_MAX + 64];
+        snprintf(want, sizeof(want), "%s:%u %s", e.file, e.line, e.msg);
+        TEST_ASSERT_EQUAL_STRING_LEN(want, nl - strlen(want), strlen(want));
+        TEST_ASSERT_EQUAL_UINT8(records % 101 == 100 ? LOG_WARN : LOG_INFO, e.level);
+        TEST_ASSERT_EQUAL_STRING_LEN("TEST_LOGGER_BINARY", e.func, 18);
+        line = nl + 1;
+        records++;
+    }
+    TEST_ASSERT_EQUAL_INT(2 * 101, records);
+    TEST_ASSERT_EQUAL_CHAR('\0', *line);
+    po_polog_close(&r);
+    TEST_ASSERT_NULL(r);
+
+    free(text);
+    unlink(bin);
+    unlink(txt);
+}
+
+TEST(LOGGER, RING_PADS_AT_WRAP_AND_WAITS_FOR_COMMIT) {
+    size_t cap = PO_LOGRING_MIN;
+    void *mem = aligned_alloc(64, po_logring_footprint(cap));
+    TEST_ASSERT_NOT_NULL(mem);
+    TEST_ASSERT_NULL(po_logring_init(mem, cap + 8));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    po_logring_t *r = po_logring_init(mem, cap);
+    TEST_ASSERT_NOT_NULL(r);
+
+    errno = 0;
+    uint64_t tag;
+    TEST_ASSERT_NULL(po_logring_reserve(r, cap / 4 + 1, &tag));
+    TEST_ASSERT_EQUAL_INT(EMSGSIZE, errno);
+
+    // Fill with 1000-byte records (1008 in the ring) until full
+    unsigned n = 0;
+    char *p;
+    while ((p = po_logring_reserve(r, 1000, &tag)) != NULL) {
+        memset(p, 'a' + (int)n, 1000);
+        po_logring_commit(r, p, tag);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+    TEST_ASSERT_EQUAL_UINT(cap / 1008, n);
+
+    // Consume one; the next record does not fit before the end, so it pads
+    uint64_t cursor = po_logring_cursor(r);
+    size_t len = 0;
+    const char *q = po_logring_peek(r, &cursor, &len);
+    TEST_ASSERT_EQUAL_size_t(1000, len);
+    TEST_ASSERT_EQUAL_CHAR('a', q[999]);
+    po_logring_release(r, cursor);
+    uint64_t first_tag;
+    char *first = po_logring_reserve(r, 1000, &first_tag);
+    TEST_ASSERT_EQUAL_PTR(r->data, first - PO_LOGRING_HDR);
+
+    // Reserved but not committed: invisible, and it holds back later records
+    q = po_logring_peek(r, &cursor, NULL);
+    TEST_ASSERT_EQUAL_CHAR('b', q[0]);
+    po_logring_release(r, cursor);
+    char *second = po_logring_reserve(r, 8, &tag);
+    TEST_ASSERT_NOT_NULL(second);
+    memcpy(second, "second!", 8);
+    po_logring_commit(r, second, tag);
+    for (unsigned i = 2; i < n; i++) {
+        q = po_logring_peek(r, &cursor, NULL);
+        TEST_ASSERT_NOT_NULL(q);
+        TEST_ASSERT_EQUAL_CHAR('a' + (int)i, q[0]);
+    }
+    po_logring_release(r, cursor);
+    TEST_ASSERT_NULL(po_logring_peek(r, &cursor, NULL)); // padding skipped, then `first`
+    TEST_ASSERT_TRUE(po_logring_empty(r));
+
+    memcpy(first, "first", 6);
+    po_logring_commit(r, first, first_tag);
+    cursor = po_logring_cursor(r);
+    TEST_ASSERT_EQUAL_STRING("first", po_logring_peek(r, &cursor, NULL));
+    TEST_ASSERT_EQUAL_STRING("second!", po_logring_peek(r, &cursor, &len));
+    TEST_ASSERT_EQUAL_size_t(8, len);
+    TEST_ASSERT_NULL(po_logring_peek(r, &cursor, NULL));
+    free(mem);
+}
+
+typedef struct {
+    unsigned seen;
+    unsigned bad;
+} order_check_t;
+
+static void check_order(const char *line, void *ud) {
+    order_check_t *c = ud;
+    const char *m = strstr(line, "rec=");
+    if (!m)
+        return;
+    unsigned id = (unsigned)strtoul(m + 4, NULL, 10);
+    // Long messages arrive truncated to LOGGER_MSG_MAX - 1 (+ newline), not cut short
+    if (id != c->seen || (id % 3 == 0 && strlen(m) != LOGGER_MSG_MAX))
+        c->bad++;
+    c->seen++;
+}
+
+TEST(LOGGER, MIXED_LENGTH_RECORDS_KEEP_ORDER) {
+    order_check_t c = {0};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_custom(check_order, &c));
+    char pad[LOGGER_MSG_MAX];
+    memset(pad, 'x', sizeof(pad) - 1);
+    pad[sizeof(pad) - 1] = '\0';
+
+    // Long (truncated) and short records interleaved, across many wraps
+    const unsigned total = 3000;
+    for (unsigned i = 0; i < total; i++) {
+        if (i % 3 == 0)
+            LOG_INFO("rec=%u %s", i, pad);
+        else
+            LOG_INFO("rec=%u", i);
+        if (i % 64 == 63)
+            usleep(2000);
+    }
+    po_logger_shutdown(); // drains everything still queued
+    TEST_ASSERT_EQUAL_UINT(total, c.seen);
+    TEST_ASSERT_EQUAL_UINT(0, c.bad);
+
+    po_logger_config_t cfg = {.level = LOG_TRACE, .ring_capacity = 1024, .consumers = 1};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_init(&cfg)); // for TEAR_DOWN
+}
+
+#define PT_THREADS 8
+#define PT_RECORDS 2000
+
+typedef struct {
+    unsigned next[PT_THREADS]; // expected sequence number per thread
+    unsigned seen;
+    unsigned bad;
+} merge_check_t;
+
+static void check_per_thread_order(const char *line, void *ud) {
+    merge_check_t *c = ud;
+    unsigned t, seq;
+    const char *m = strstr(line, "pt=");
+    if (!m || sscanf(m, "pt=%u seq=%u", &t, &seq) != 2)
+        return;
+    if (t >= PT_THREADS || seq != c->next[t])
+        c->bad++;
+    else
+        c->next[t]++;
+    c->seen++;
+}
+
+static void *per_thread_producer(void *arg) {
+    unsigned t = (unsigned)(uintptr_t)arg;
+    for (unsigned i = 0; i < PT_RECORDS; i++) {
+        LOG_INFO("pt=%u seq=%u", t, i);
+        if (i % 32 == 31)
+            usleep(1000);
+    }
+    return NULL;
+}
+
+TEST(LOGGER, PER_THREAD_RINGS_MERGE_ALL_RECORDS) {
+    po_logger_shutdown();
+    po_logger_config_t cfg = {
+        .level = LOG_TRACE,
+        .ring_capacity = 64,
+        .consumers = 1,
+        .policy = LOGGER_DROP_NEW,
+        .per_thread_rings = true,
+        .thread_ring_capacity = 256,
+    };
+    TEST_ASSERT_EQUAL_INT(0, po_logger_init(&cfg));
+    merge_check_t c = {0};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_custom(check_per_thread_order, &c));
+
+    // Two waves: rings of the first wave's exited threads are freed while the second logs
+    for (int wave = 0; wave < 2; wave++) {
+        pthread_t th[PT_THREADS / 2];
+        for (unsigned i = 0; i < PT_THREADS / 2; i++) {
+            uintptr_t t = (uintptr_t)(wave * (PT_THREADS / 2)) + i;
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&th[i], NULL, per_thread_producer, (void *)t));
+        }
+        for (unsigned i = 0; i < PT_THREADS / 2; i++)
+            pthread_join(th[i], NULL);
+    }
+    LOG_INFO("main thread uses its own ring too");
+    po_logger_shutdown(); // drains, then frees every thread ring (LSan checks)
+
+    TEST_ASSERT_EQUAL_UINT(0, c.bad);
+    TEST_ASSERT_EQUAL_UINT(PT_THREADS * PT_RECORDS, c.seen);
+
+    po_logger_config_t plain = {.level = LOG_TRACE, .ring_capacity = 1024, .consumers = 1};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_init(&plain)); // for TEAR_DOWN
+    LOG_INFO("back on the shared ring");
+}
+
+#define ROT_RECORDS 1500u
+
+// Checks that path.2, path.1, path hold consecutive rot= numbers ending at the last record
+static void check_rotated_files(const char *path) {
+    char name[64];
+    unsigned next = 0, files = 0;
+    bool first = true;
+    for (int k = 2; k >= 0; k--) {
+        if (k > 0)
+            snprintf(name, sizeof(name), "%s.%d", path, k);
+        else
+            snprintf(name, sizeof(name), "%s", path);
+        FILE *fp = fopen(name, "r");
+        TEST_ASSERT_NOT_NULL_MESSAGE(fp, name);
+        files++;
+        char line[512];
+        while (fgets(line, sizeof(line), fp)) {
+            unsigned seq;
+            const char *m = strstr(line, "rot=");
+            if (!m || sscanf(m, "rot=%u", &seq) != 1)
+                continue;
+            if (!first)
+                TEST_ASSERT_EQUAL_UINT(next, seq);
+            first = false;
+            next = seq + 1;
+        }
+        fclose(fp);
+        unlink(name);
+    }
+    TEST_ASSERT_EQUAL_UINT(3, files);
+    TEST_ASSERT_EQUAL_UINT(ROT_RECORDS, next);
+    snprintf(name, sizeof(name), "%s.3", path);
+    TEST_ASSERT_EQUAL_INT(-1, access(name, F_OK)); // rotate_keep = 2
+}
+
+TEST(LOGGER, FILE_SINK_ROTATES_BY_SIZE) {
+    const char *path = "/tmp/po_logger_rotate_test.log";
+    for (int async = 0; async < 2; async++) {
+        po_logger_shutdown();
+        po_logger_config_t cfg = {
+            .level = LOG_TRACE,
+            .ring_capacity = 1024,
+            .consumers = 1,
+            .async_writer = async != 0,
+            .rotate_bytes = 8192,
+            .rotate_keep = 2,
+        };
+        TEST_ASSERT_EQUAL_INT(0, po_logger_init(&cfg));
+        TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_file(path, false));
+        for (unsigned i = 0; i < ROT_RECORDS; i++) {
+            LOG_INFO("rot=%u", i);
+            if (i % 50 == 49)
+                usleep(2000); // several batches, so several rotations
+        }
+        po_logger_shutdown();
+        check_rotated_files(path);
+
+        TEST_ASSERT_EQUAL_INT(0, po_logger_init(&cfg)); // for the next pass / TEAR_DOWN
+    }
+}
+
+#define SHM_TEST_NAME "/po_logger_test_shm"
+#define SHM_CHILD_RECORDS 500u
+#define SHM_PARENT_RECORDS 200u
+#define SHM_CHILD_CATEGORY 3u
+
+typedef struct {
+    unsigned child;  // next expected child sequence number
+    unsigned parent; // next expected parent sequence number
+    unsigned bad;
+} shm_check_t;
+
+static void check_shm_line(const char *line, void *ud) {
+    shm_check_t *c = ud;
+    unsigned seq;
+    const char *m;
+    if ((m = strstr(line, "child=")) && sscanf(m, "child=%u", &seq) == 1) {
+        // File name travels inline in a shared-ring record
+        if (seq != c->child || !strstr(line, "test_logger.c:"))
+            c->bad++;
+        c->child = seq + 1;
+    } else if ((m = strstr(line, "parent=")) && sscanf(m, "parent=%u", &seq) == 1) {
+        if (seq != c->parent)
+            c->bad++;
+        c->parent = seq + 1;
+    }
+}
+
+TEST(LOGGER, SHM_RING_CARRIES_OTHER_PROCESS_RECORDS) {
+    po_logger_shutdown();
+    po_logger_config_t serve = {
+        .level = LOG_TRACE,
+        .ring_capacity = 1024,
+        .consumers = 1,
+        .shm_name = SHM_TEST_NAME,
+        .shm_serve = true,
+    };
+    TEST_ASSERT_EQUAL_INT(0, po_logger_init(&serve));
+    shm_check_t c = {0};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_custom(check_shm_line, &c));
+    char path[] = "/tmp/po_logger_shmXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+    uint32_t child_mask = 1u << SHM_CHILD_CATEGORY;
+    TEST_ASSERT_EQUAL_INT(0, po_logger_add_sink_file_categorized(path, false, child_mask));
+
+    pid_t pid = fork();
+    TEST_ASSERT_NOT_EQUAL(-1, pid);
+    if (pid == 0) {
+        po_logger_config_t client = {
+            .level = LOG_TRACE,
+            .ring_capacity = 1024,
+            .default_category = SHM_CHILD_CATEGORY,
+            .shm_name = SHM_TEST_NAME,
+        };
+        if (po_logger_init(&client) != 0)
+            _exit(2);
+        if (po_logger_add_sink_file("/nonexistent/x.log", true) != 0)
+            _exit(3); // a client opens no sinks, so the bad path is never tried
+        for (unsigned i = 0; i < SHM_CHILD_RECORDS; i++) {
+            LOG_INFO("child=%u", i);
+            if (i % 64 == 63)
+                usleep(1000);
+        }
+        po_logger_shutdown();
+        _exit(0);
+    }
+    for (unsigned i = 0; i < SHM_PARENT_RECORDS; i++)
+        LOG_INFO("parent=%u", i);
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+    po_logger_shutdown(); // drains both rings, then unlinks the shared one
+
+    TEST_ASSERT_EQUAL_UINT(0, c.bad);
+    TEST_ASSERT_EQUAL_UINT(SHM_CHILD_RECORDS, c.child);
+    TEST_ASSERT_EQUAL_UINT(SHM_PARENT_RECORDS, c.parent);
+
+    // The categorized file got exactly the child's records
+    FILE *fp = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    char line[512];
+    unsigned child_lines = 0, other_lines = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strstr(line, "child="))
+            child_lines++;
+        else
+            other_lines++;
+    }
+    fclose(fp);
+    unlink(path);
+    TEST_ASSERT_EQUAL_UINT(SHM_CHILD_RECORDS, child_lines);
+    TEST_ASSERT_EQUAL_UINT(0, other_lines);
+
+    po_logger_config_t plain = {.level = LOG_TRACE, .ring_capacity = 1024, .consumers = 1};
+    TEST_ASSERT_EQUAL_INT(0, po_logger_init(&plain)); // for TEAR_DOWN
+}
+
+TEST(LOGGER, SHM_RING_SKIPS_RESERVATION_OF_KILLED_PRODUCER) {
+    po_logshm_t shm;
+    TEST_ASSERT_EQUAL_INT(0, po_logshm_create(&shm, SHM_TEST_NAME, PO_LOGRING_MIN));
+    po_logring_t *r = shm.ring;
+
+    // The child dies holding a reservation it never commits
+    int ready[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(ready));
+    pid_t pid = fork();
+    TEST_ASSERT_NOT_EQUAL(-1, pid);
+    if (pid == 0) {
+        po_logshm_t client;
+        if (po_logshm_attach(&client, SHM_TEST_NAME) != 0)
+            _exit(2);
+        uint64_t tag;
+        char *p = po_logring_reserve(client.ring, 100, &tag);
+        if (p)
+            memset(p, 'x', 100);
+        (void)!write(ready[1], "r", 1);
+        pause();
+        _exit(0);
+    }
+    char c;
+    TEST_ASSERT_EQUAL_INT(1, read(ready[0], &c, 1));
+    kill(pid, SIGKILL);
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    close(ready[0]);
+    close(ready[1]);
+
+    uint64_t tag;
+    char *after = po_logring_reserve(r, 8, &tag);
+    TEST_ASSERT_NOT_NULL(after);
+    memcpy(after, "after!!", 8);
+    po_logring_commit(r, after, tag);
+
+    // Held back until the consumer gives the dead owner's reservation up
+    uint64_t cursor = po_logring_cursor(r);
+    TEST_ASSERT_NULL(po_logring_peek(r, &cursor, NULL));
+    TEST_ASSERT_FALSE(po_logring_reclaim(r, cursor, 60000)); // first sighting
+    TEST_ASSERT_TRUE(po_logring_reclaim(r, cursor, 60000));
+    size_t len = 0;
+    TEST_ASSERT_EQUAL_STRING("after!!", po_logring_peek(r, &cursor, &len));
+    TEST_ASSERT_EQUAL_size_t(8, len);
+    po_logring_release(r, cursor);
+
+    // A live owner's reservation is only given up after the timeout
+    uint64_t stalled_tag;
+    char *stalled = po_logring_reserve(r, 8, &stalled_tag);
+    char *later = po_logring_reserve(r, 8, &tag);
+    memcpy(later, "later!!", 8);
+    po_logring_commit(r, later, tag);
+    TEST_ASSERT_NULL(po_logring_peek(r, &cursor, NULL));
+    TEST_ASSERT_FALSE(po_logring_reclaim(r, cursor, 60000));
+    TEST_ASSERT_FALSE(po_logring_reclaim(r, cursor, -1)); // alive: never
+    TEST_ASSERT_TRUE(po_logring_reclaim(r, cursor, 0));
+    TEST_ASSERT_EQUAL_STRING("later!!", po_logring_peek(r, &cursor, NULL));
+    po_logring_release(r, cursor);
+
+    // Go once around the ring, so a new reservation reuses the stalled bytes
+    // with the same size and owner: the stalled producer's late commit must
+    // not publish it
+    while ((uint64_t)(stalled - (char *)r->data) != ((cursor + PO_LOGRING_HDR) & (r->cap - 1))) {
+        char *p = po_logring_reserve(r, 8, &tag);
+        TEST_ASSERT_NOT_NULL(p);
+        po_logring_commit(r, p, tag);
+        TEST_ASSERT_EQUAL_PTR(p, po_logring_peek(r, &cursor, NULL));
+        po_logring_release(r, cursor);
+    }
+    char *reused = po_logring_reserve(r, 8, &tag);
+    TEST_ASSERT_EQUAL_PTR(stalled, reused);
+    TEST_ASSERT_NOT_EQUAL(stalled_tag, tag);
+    memcpy(stalled, "stale!!", 8); // unfenced: lands in the new record
+    TEST_ASSERT_FALSE(po_logring_commit(r, stalled, stalled_tag));
+    TEST_ASSERT_NULL(po_logring_peek(r, &cursor, NULL));
+    memcpy(reused, "reused", 7);
+    TEST_ASSERT_TRUE(po_logring_commit(r, reused, tag));
+    TEST_ASSERT_EQUAL_STRING("reused", po_logring_peek(r, &cursor, NULL));
+    po_logring_release(r, cursor);
+    TEST_ASSERT_TRUE(po_logring_empty(r));
+    po_logshm_close(&shm, SHM_TEST_NAME);
+
+    // A ring whose creator crashed (left linked) is refused
+    pid = fork();
+    TEST_ASSERT_NOT_EQUAL(-1, pid);
+    if (pid == 0)
+        _exit(po_logshm_create(&shm, SHM_TEST_NAME, PO_LOGRING_MIN) == 0 ? 0 : 2);
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+    errno = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_logshm_attach(&shm, SHM_TEST_NAME));
+    TEST_ASSERT_EQUAL_INT(EOWNERDEAD, errno);
+    shm_unlink(SHM_TEST_NAME);
+}
+
 // Group runner with all tests
 TEST_GROUP_RUNNER(LOGGER) {
     RUN_TEST_CASE(LOGGER, INIT_AND_LEVEL);
     RUN_TEST_CASE(LOGGER, CONSOLE_SINK_AND_WRITE);
     RUN_TEST_CASE(LOGGER, FILE_SINK_WRITES);
     RUN_TEST_CASE(LOGGER, OVERFLOW_EMITS_ERROR);
+    RUN_TEST_CASE(LOGGER, DEFERRED_RENDER_MATCHES_VSNPRINTF);
+    RUN_TEST_CASE(LOGGER, BINARY_SINK_DECODES_LIKE_TEXT);
+    RUN_TEST_CASE(LOGGER, RING_PADS_AT_WRAP_AND_WAITS_FOR_COMMIT);
+    RUN_TEST_CASE(LOGGER, MIXED_LENGTH_RECORDS_KEEP_ORDER);
+    RUN_TEST_CASE(LOGGER, PER_THREAD_RINGS_MERGE_ALL_RECORDS);
+    RUN_TEST_CASE(LOGGER, FILE_SINK_ROTATES_BY_SIZE);
+    RUN_TEST_CASE(LOGGER, SHM_RING_CARRIES_OTHER_PROCESS_RECORDS);
+    RUN_TEST_CASE(LOGGER, SHM_RING_SKIPS_RESERVATION_OF_KILLED_PRODUCER);
 }
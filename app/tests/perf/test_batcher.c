@@ -1,6 +1,10 @@
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "perf/batcher.h"
@@ -101,10 +105,119 @@ TEST(BATCHER, BLOCKING_NEXT) {
     TEST_ASSERT_EQUAL_INT(0, pthread_join(tid, NULL));
 }
 
+#define STREAM_ITEMS 50000
+
+static size_t stream_out_of_order;
+
+// Expects the tokens 1..STREAM_ITEMS in order
+static void *stream_drain_thread(void *arg) {
+    po_perf_batcher_t *b = arg;
+    void *out[64];
+    uintptr_t want = 1;
+    while (want <= STREAM_ITEMS) {
+        ssize_t n = perf_batcher_next(b, out);
+        for (ssize_t i = 0; i < n; i++, want++) {
+            if ((uintptr_t)out[i] != want)
+                stream_out_of_order++;
+        }
+    }
+    return NULL;
+}
+
+// One producer racing one consumer: nothing lost, duplicated or reordered
+// (throughput and syscalls per item: tools/batcher_bench.c)
+TEST(BATCHER, STREAM_DELIVERS_EVERY_ITEM_IN_ORDER) {
+    po_perf_ringbuf_t *rb = perf_ringbuf_create(1024, PERF_RINGBUF_NOFLAGS);
+    po_perf_batcher_t *b = perf_batcher_create(rb, 64, PERF_BATCHER_NOFLAGS);
+    TEST_ASSERT_NOT_NULL(b);
+    stream_out_of_order = 0;
+
+    pthread_t tid;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&tid, NULL, stream_drain_thread, b));
+    for (uintptr_t i = 1; i <= STREAM_ITEMS; i++) {
+        while (perf_batcher_enqueue(b, (void *)i) != 0)
+            sched_yield(); // Full: let the consumer run
+    }
+    TEST_ASSERT_EQUAL_INT(0, pthread_join(tid, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, stream_out_of_order);
+
+    perf_batcher_destroy(&b);
+    perf_ringbuf_destroy(&rb);
+}
+
+#define MPMC_PRODUCERS 3
+#define MPMC_CONSUMERS 3
+#define MPMC_PER_PRODUCER 20000
+
+static po_perf_batcher_t *mpmc_batcher;
+static atomic_size_t mpmc_consumed;
+static int mpmc_sentinel;
+
+static void *mpmc_producer(void *arg) {
+    (void)arg;
+    static int item;
+    for (int i = 0; i < MPMC_PER_PRODUCER; i++) {
+        while (perf_batcher_enqueue(mpmc_batcher, &item) != 0)
+            sched_yield();
+        if (i % 1000 == 0)
+            usleep(200); // Let consumers go idle and park
+    }
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+    (void)arg;
+    void *out[64];
+    for (;;) {
+        ssize_t n = perf_batcher_next(mpmc_batcher, out);
+        for (ssize_t i = 0; i < n; i++) {
+            if (out[i] == &mpmc_sentinel)
+                return NULL;
+            atomic_fetch_add(&mpmc_consumed, 1);
+        }
+    }
+}
+
+// Every item reaches a consumer and parked consumers are always woken
+TEST(BATCHER, MULTI_CONSUMER_NO_LOST_WAKEUPS) {
+    po_perf_ringbuf_t *rb = perf_ringbuf_create(256, PERF_RINGBUF_NOFLAGS);
+    mpmc_batcher = perf_batcher_create(rb, 64, PERF_BATCHER_NOFLAGS);
+    TEST_ASSERT_NOT_NULL(mpmc_batcher);
+    atomic_store(&mpmc_consumed, 0);
+
+    pthread_t prod[MPMC_PRODUCERS], cons[MPMC_CONSUMERS];
+    for (int i = 0; i < MPMC_CONSUMERS; i++)
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&cons[i], NULL, mpmc_consumer, NULL));
+    for (int i = 0; i < MPMC_PRODUCERS; i++)
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&prod[i], NULL, mpmc_producer, NULL));
+    for (int i = 0; i < MPMC_PRODUCERS; i++)
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(prod[i], NULL));
+
+    while (atomic_load(&mpmc_consumed) < MPMC_PRODUCERS * MPMC_PER_PRODUCER)
+        usleep(1000);
+
+    // All consumers are idle now; one sentinel each must wake every one of them
+    for (int i = 0; i < MPMC_CONSUMERS; i++) {
+        while (perf_batcher_enqueue(mpmc_batcher, &mpmc_sentinel) != 0)
+            sched_yield();
+    }
+    for (int i = 0; i < MPMC_CONSUMERS; i++)
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(cons[i], NULL));
+
+    perf_batcher_stats_t st;
+    perf_batcher_get_stats(mpmc_batcher, &st);
+    TEST_ASSERT_TRUE(st.signals < MPMC_PRODUCERS * MPMC_PER_PRODUCER); // Wakeups were suppressed
+
+    perf_batcher_destroy(&mpmc_batcher);
+    perf_ringbuf_destroy(&rb);
+}
+
 TEST_GROUP_RUNNER(BATCHER) {
     RUN_TEST_CASE(BATCHER, INVALID_CREATE);
     RUN_TEST_CASE(BATCHER, SINGLE_BATCH);
     RUN_TEST_CASE(BATCHER, PARTIAL_BATCH);
     RUN_TEST_CASE(BATCHER, FULL_BATCH);
     RUN_TEST_CASE(BATCHER, BLOCKING_NEXT);
+    RUN_TEST_CASE(BATCHER, STREAM_DELIVERS_EVERY_ITEM_IN_ORDER);
+    RUN_TEST_CASE(BATCHER, MULTI_CONSUMER_NO_LOST_WAKEUPS);
 }
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -94,6 +95,35 @@ TEST(PERF, TIMER_CREATE_AND_MEASURE) {
     TEST_ASSERT_NOT_NULL(strstr(buf, "tm:"));
 }
 
+TEST(PERF, TIMER_SCOPES_NEST) {
+    po_perf_init(1, 1, 1);
+    int idx = po_perf_timer_lookup("nest");
+    TEST_ASSERT_TRUE(idx >= 0);
+
+    po_perf_timer_scope_t outer = po_perf_timer_begin_by_idx(idx);
+    po_perf_timer_scope_t inner = po_perf_timer_begin_by_idx(idx);
+    struct timespec ts = {0, 1000 * 1000};
+    nanosleep(&ts, NULL);
+    po_perf_timer_end(&inner);
+    nanosleep(&ts, NULL);
+    po_perf_timer_end(&outer);
+
+    uint64_t total = 0, count = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_timer_value("nest", &total, &count));
+    TEST_ASSERT_EQUAL_UINT64(2, count);
+    TEST_ASSERT_TRUE(total >= 3 * 1000 * 1000); // inner (1ms) + outer (2ms)
+
+    // Unmatched stop records nothing
+    TEST_ASSERT_EQUAL_INT(0, po_perf_timer_stop("nest"));
+    TEST_ASSERT_EQUAL_INT(0, po_perf_timer_value("nest", &total, &count));
+    TEST_ASSERT_EQUAL_UINT64(2, count);
+
+    // Each interval also lands in the timer's latency histogram
+    po_perf_histogram_summary_t h;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_summary("nest", &h));
+    TEST_ASSERT_EQUAL_UINT64(2, h.count);
+}
+
 TEST(PERF, HISTOGRAM_BEFORE_INIT) {
     po_perf_shutdown(stdout);
     uint64_t bins[] = {10, 20};
@@ -136,6 +166,97 @@ TEST(PERF, HISTOGRAM_OVERFLOW_BIN) {
     TEST_ASSERT_NOT_NULL(strstr(buf, "<= 2: 1"));
 }
 
+TEST(PERF, HDR_HISTOGRAM_PERCENTILES) {
+    po_perf_init(1, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_create_hdr("lat"));
+    TEST_ASSERT_EQUAL_INT(-1, po_perf_histogram_create_hdr("lat"));
+    TEST_ASSERT_EQUAL_INT(EEXIST, errno);
+
+    // Uniform 1..100000: pN is N% of the range
+    for (uint64_t v = 1; v <= 100000; v++)
+        TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_record("lat", v));
+
+    static const struct {
+        double p;
+        uint64_t want;
+    } cases[] = {{50.0, 50000}, {90.0, 90000}, {99.0, 99000}, {99.9, 99900}};
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint64_t got = 0;
+        TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_percentile("lat", cases[i].p, &got));
+        TEST_ASSERT_UINT64_WITHIN(cases[i].want / 32, cases[i].want, got); // <= 1/32 error
+    }
+
+    uint64_t v = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_percentile("lat", 0.0, &v));
+    TEST_ASSERT_EQUAL_UINT64(1, v);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_percentile("lat", 100.0, &v));
+    TEST_ASSERT_EQUAL_UINT64(100000, v);
+
+    TEST_ASSERT_EQUAL_INT(-1, po_perf_histogram_percentile("missing", 50.0, &v));
+    TEST_ASSERT_EQUAL_INT(ENOENT, errno);
+}
+
+TEST(PERF, HDR_HISTOGRAM_EXACT_SMALL_AND_EXTREMES) {
+    po_perf_init(1, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_create_hdr("ext"));
+
+    uint64_t v = 42;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_percentile("ext", 50.0, &v));
+    TEST_ASSERT_EQUAL_UINT64(0, v); // Empty
+
+    po_perf_histogram_record("ext", 0);
+    po_perf_histogram_record("ext", 7);
+    po_perf_histogram_record("ext", UINT64_MAX);
+
+    po_perf_histogram_summary_t s;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_summary("ext", &s));
+    TEST_ASSERT_TRUE(s.hdr);
+    TEST_ASSERT_EQUAL_UINT64(3, s.count);
+    TEST_ASSERT_EQUAL_UINT64(0, s.min);
+    TEST_ASSERT_EQUAL_UINT64(7, s.p50); // Values below 32 have exact buckets
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, s.max);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, s.p999);
+}
+
+TEST(PERF, HDR_HISTOGRAM_MERGES_ACROSS_PROCESSES) {
+    po_perf_init(1, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_create_hdr("xproc"));
+
+    enum { CHILDREN = 3, PER_CHILD = 1000 };
+    for (int c = 0; c < CHILDREN; c++) {
+        pid_t pid = fork();
+        TEST_ASSERT_TRUE(pid >= 0);
+        if (pid == 0) {
+            for (uint64_t i = 0; i < PER_CHILD; i++)
+                po_perf_histogram_record("xproc", 1000 * (uint64_t)(c + 1));
+            _exit(0);
+        }
+    }
+    for (int c = 0; c < CHILDREN; c++) {
+        int status = 0;
+        wait(&status);
+        TEST_ASSERT_TRUE(WIFEXITED(status));
+    }
+
+    po_perf_histogram_summary_t s;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_summary("xproc", &s));
+    TEST_ASSERT_EQUAL_UINT64(CHILDREN * PER_CHILD, s.count);
+    TEST_ASSERT_EQUAL_UINT64(1000, s.min);
+    TEST_ASSERT_EQUAL_UINT64(3000, s.max);
+    TEST_ASSERT_UINT64_WITHIN(2000 / 32, 2000, s.p50);
+}
+
+TEST(PERF, HDR_HISTOGRAM_IN_REPORT) {
+    po_perf_init(1, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_create_hdr("rep"));
+    for (uint64_t v = 0; v < 10; v++)
+        po_perf_histogram_record("rep", 5);
+
+    char buf[2048];
+    CAPTURE_REPORT(buf, sizeof(buf), po_perf_report);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "rep: count=10 min=5 p50=5 p90=5 p99=5 p99.9=5 max=5"));
+}
+
 TEST_GROUP_RUNNER(PERF) {
     RUN_TEST_CASE(PERF, INIT_AND_SHUTDOWN);
     RUN_TEST_CASE(PERF, IDEMPOTENT_INIT);
@@ -143,7 +264,12 @@ TEST_GROUP_RUNNER(PERF) {
     RUN_TEST_CASE(PERF, COUNTER_CREATE_AND_INCREMENT);
     RUN_TEST_CASE(PERF, TIMER_BEFORE_INIT);
     RUN_TEST_CASE(PERF, TIMER_CREATE_AND_MEASURE);
+    RUN_TEST_CASE(PERF, TIMER_SCOPES_NEST);
     RUN_TEST_CASE(PERF, HISTOGRAM_BEFORE_INIT);
     RUN_TEST_CASE(PERF, HISTOGRAM_CREATE_AND_RECORD_BINS);
     RUN_TEST_CASE(PERF, HISTOGRAM_OVERFLOW_BIN);
+    RUN_TEST_CASE(PERF, HDR_HISTOGRAM_PERCENTILES);
+    RUN_TEST_CASE(PERF, HDR_HISTOGRAM_EXACT_SMALL_AND_EXTREMES);
+    RUN_TEST_CASE(PERF, HDR_HISTOGRAM_MERGES_ACROSS_PROCESSES);
+    RUN_TEST_CASE(PERF, HDR_HISTOGRAM_IN_REPORT);
 }
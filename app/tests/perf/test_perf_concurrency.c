@@ -4,6 +4,7 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -135,6 +136,36 @@ static void *add_thread_global(void *arg) {
     return NULL;
 }
 
+// Fast-path incrementer used by the sharded tests
+// (same path as the PO_METRIC_COUNTER_* macros: cached index, no lookup).
+typedef struct {
+    int idx;
+    int increments;
+} idx_inc_args_t;
+
+static void *idx_inc_thread(void *arg) {
+    idx_inc_args_t *args = (idx_inc_args_t *)arg;
+    pthread_barrier_wait(&g_barrier);
+    for (int i = 0; i < args->increments; i++) {
+        po_perf_counter_inc_by_idx(args->idx);
+    }
+    return NULL;
+}
+
+static void run_increments(int idx, int nthreads, int increments) {
+    pthread_t threads[16];
+    idx_inc_args_t args = {.idx = idx, .increments = increments};
+    pthread_barrier_init(&g_barrier, NULL, (unsigned)nthreads + 1);
+    for (int i = 0; i < nthreads; i++) {
+        pthread_create(&threads[i], NULL, idx_inc_thread, &args);
+    }
+
+    pthread_barrier_wait(&g_barrier);
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&g_barrier);
+}
 
 TEST_GROUP(PERF_CONCURRENCY);
 
@@ -358,6 +389,35 @@ TEST(PERF_CONCURRENCY, TIMER_CONCURRENCY) {
     TEST_ASSERT_GREATER_THAN_UINT64(0, timer_value);
 }
 
+// Per-thread start stamps: every interval is counted and none is inflated by
+// another thread's start.
+TEST(PERF_CONCURRENCY, TIMER_CONCURRENT_TOTALS_CONSISTENT) {
+    TEST_ASSERT_EQUAL_INT(0, po_perf_timer_create("concurrent_timer"));
+
+    pthread_barrier_init(&g_barrier, NULL, NUM_THREADS);
+    uint64_t t0 = po_perf_now_ns();
+    pthread_t threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, timer_thread_global, NULL);
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t wall = po_perf_now_ns() - t0;
+    pthread_barrier_destroy(&g_barrier);
+
+    uint64_t total = 0, count = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_timer_value("concurrent_timer", &total, &count));
+    TEST_ASSERT_EQUAL_UINT64(NUM_THREADS * 100, count);
+    TEST_ASSERT_TRUE(total >= count * 10000);         // Each scope slept >= 10us
+    TEST_ASSERT_TRUE(total <= wall * NUM_THREADS);    // No scope outlived the run
+
+    po_perf_histogram_summary_t h;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_histogram_summary("concurrent_timer", &h));
+    TEST_ASSERT_EQUAL_UINT64(count, h.count);
+    TEST_ASSERT_TRUE(h.min >= 10000);
+}
+
 // Test 6: Histogram concurrency
 TEST(PERF_CONCURRENCY, HISTOGRAM_CONCURRENCY) {
     uint64_t bins[] = {10, 100, 1000, 10000};
@@ -424,12 +484,96 @@ TEST(PERF_CONCURRENCY, COUNTER_ADD_CONCURRENCY) {
     TEST_ASSERT_EQUAL_UINT64(expected, actual);
 }
 
+// Test 8: Sharded counter, threads and processes, exact total
+TEST(PERF_CONCURRENCY, SHARDED_COUNTER_EXACT_TOTAL) {
+    const char *counter_name = "sharded_counter";
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_create_sharded(counter_name));
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_create_sharded(counter_name)); // Idempotent
+    int idx = po_perf_counter_lookup(counter_name);
+    TEST_ASSERT_TRUE(idx >= 0);
+
+    pid_t children[NUM_PROCESSES];
+    for (int i = 0; i < NUM_PROCESSES; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (int j = 0; j < INCREMENTS_PER_PROCESS; j++) {
+                po_perf_counter_inc(counter_name);
+            }
+            exit(0);
+        }
+        TEST_ASSERT_TRUE(pid > 0);
+        children[i] = pid;
+    }
+
+    run_increments(idx, NUM_THREADS, INCREMENTS_PER_THREAD);
+
+    for (int i = 0; i < NUM_PROCESSES; i++) {
+        int status;
+        waitpid(children[i], &status, 0);
+        TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+    }
+
+    uint64_t expected = NUM_PROCESSES * INCREMENTS_PER_PROCESS + NUM_THREADS * INCREMENTS_PER_THREAD;
+    uint64_t value = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_value(counter_name, &value));
+    TEST_ASSERT_EQUAL_UINT64(expected, value);
+    TEST_ASSERT_EQUAL_UINT64(expected, get_counter_value_from_report(counter_name));
+}
+
+// Test 9: Converting a live counter keeps the increments recorded before
+TEST(PERF_CONCURRENCY, SHARDED_CONVERSION_PRESERVES_VALUE) {
+    const char *counter_name = "converted_counter";
+    po_perf_counter_add(counter_name, 40);
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_create_sharded(counter_name));
+    po_perf_counter_add(counter_name, 2);
+
+    po_perf_counter_sample_t samples[64];
+    size_t n = po_perf_counter_snapshot(samples, 64);
+    bool found = false;
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(samples[i].name, counter_name) == 0) {
+            TEST_ASSERT_EQUAL_UINT64(42, samples[i].value);
+            TEST_ASSERT_TRUE(samples[i].sharded);
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    uint64_t value = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_perf_counter_value("no_such_counter", &value));
+    TEST_ASSERT_EQUAL_INT(ENOENT, errno);
+}
+
+// Test 10: Sharded totals stay exact at every thread count
+// (timings: tools/perf_counter_scaling_bench.c)
+TEST(PERF_CONCURRENCY, SHARDED_TOTAL_ACROSS_THREAD_COUNTS) {
+    static const int thread_counts[] = {1, 2, 4, 8, 16};
+    const int increments = 10000;
+
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_create_sharded("scaling_sharded"));
+    int sharded = po_perf_counter_lookup("scaling_sharded");
+
+    uint64_t expected = 0;
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        run_increments(sharded, thread_counts[i], increments);
+        expected += (uint64_t)thread_counts[i] * (uint64_t)increments;
+    }
+
+    uint64_t value = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_perf_counter_value("scaling_sharded", &value));
+    TEST_ASSERT_EQUAL_UINT64(expected, value);
+}
+
 TEST_GROUP_RUNNER(PERF_CONCURRENCY) {
     RUN_TEST_CASE(PERF_CONCURRENCY, MULTI_THREADED_COUNTER_INCREMENT);
     RUN_TEST_CASE(PERF_CONCURRENCY, MULTI_PROCESS_COUNTER_INCREMENT);
     RUN_TEST_CASE(PERF_CONCURRENCY, MIXED_PROCESS_AND_THREAD);
     RUN_TEST_CASE(PERF_CONCURRENCY, STRESS_TEST_HIGH_CONTENTION);
     RUN_TEST_CASE(PERF_CONCURRENCY, TIMER_CONCURRENCY);
+    RUN_TEST_CASE(PERF_CONCURRENCY, TIMER_CONCURRENT_TOTALS_CONSISTENT);
     RUN_TEST_CASE(PERF_CONCURRENCY, HISTOGRAM_CONCURRENCY);
     RUN_TEST_CASE(PERF_CONCURRENCY, COUNTER_ADD_CONCURRENCY);
+    RUN_TEST_CASE(PERF_CONCURRENCY, SHARDED_COUNTER_EXACT_TOTAL);
+    RUN_TEST_CASE(PERF_CONCURRENCY, SHARDED_CONVERSION_PRESERVES_VALUE);
+    RUN_TEST_CASE(PERF_CONCURRENCY, SHARDED_TOTAL_ACROSS_THREAD_COUNTS);
 }
\ No newline at end of file
@@ -268,6 +268,28 @@ TEST(RINGBUF, MIXED_OPERATIONS) {
     TEST_ASSERT_EQUAL_UINT64(0, perf_ringbuf_count(rb));
 }
 
+TEST(RINGBUF, DEQUEUE_BATCH) {
+    int data[3] = {1, 2, 3};
+    void *out[4];
+
+    TEST_ASSERT_EQUAL_size_t(0, perf_ringbuf_dequeue_batch(rb, out, 4));
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT(0, perf_ringbuf_enqueue(rb, &data[i]));
+
+    // Capped at max, FIFO order preserved across calls
+    TEST_ASSERT_EQUAL_size_t(2, perf_ringbuf_dequeue_batch(rb, out, 2));
+    TEST_ASSERT_EQUAL_PTR(&data[0], out[0]);
+    TEST_ASSERT_EQUAL_PTR(&data[1], out[1]);
+    TEST_ASSERT_EQUAL_size_t(1, perf_ringbuf_dequeue_batch(rb, out, 4));
+    TEST_ASSERT_EQUAL_PTR(&data[2], out[0]);
+
+    // Released slots are reusable after a wrap
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT(0, perf_ringbuf_enqueue(rb, &data[i]));
+    TEST_ASSERT_EQUAL_size_t(3, perf_ringbuf_dequeue_batch(rb, out, 4));
+    TEST_ASSERT_EQUAL_UINT64(0, perf_ringbuf_count(rb));
+}
+
 TEST_GROUP_RUNNER(RINGBUF) {
     RUN_TEST_CASE(RINGBUF, INVALID_CAPACITY);
     RUN_TEST_CASE(RINGBUF, VALID_CREATE_DESTROY);
@@ -281,4 +303,5 @@ TEST_GROUP_RUNNER(RINGBUF) {
     RUN_TEST_CASE(RINGBUF, PEEK_AT);
     RUN_TEST_CASE(RINGBUF, ADVANCE);
     RUN_TEST_CASE(RINGBUF, MIXED_OPERATIONS);
+    RUN_TEST_CASE(RINGBUF, DEQUEUE_BATCH);
 }
@@ -0,0 +1,142 @@
+#include "unity/unity_fixture.h"
+#include "postoffice/priority_queue/class_queue.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+TEST_GROUP(CLASS_QUEUE);
+
+static po_class_queue_t *q;
+
+TEST_SETUP(CLASS_QUEUE) {
+    q = po_class_queue_create(8);
+    TEST_ASSERT_NOT_NULL(q);
+}
+
+TEST_TEAR_DOWN(CLASS_QUEUE) {
+    po_class_queue_destroy(q);
+    q = NULL;
+}
+
+TEST(CLASS_QUEUE, InvalidArguments) {
+    int x = 0;
+    TEST_ASSERT_NULL(po_class_queue_create(0));
+    TEST_ASSERT_EQUAL_INT(-1, po_class_queue_push(q, NULL, PO_CLASS_QUEUE_HIGH));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    TEST_ASSERT_EQUAL_INT(-1, po_class_queue_push(q, &x, PO_CLASS_QUEUE_CLASSES));
+    TEST_ASSERT_NULL(po_class_queue_pop(NULL, NULL));
+    TEST_ASSERT_TRUE(po_class_queue_is_empty(q));
+}
+
+TEST(CLASS_QUEUE, HighClassFirstThenFifo) {
+    int v[6] = {0, 1, 2, 3, 4, 5};
+    po_class_queue_push(q, &v[0], PO_CLASS_QUEUE_NORMAL);
+    po_class_queue_push(q, &v[1], PO_CLASS_QUEUE_HIGH);
+    po_class_queue_push(q, &v[2], PO_CLASS_QUEUE_NORMAL);
+    po_class_queue_push(q, &v[3], PO_CLASS_QUEUE_HIGH);
+    TEST_ASSERT_EQUAL_size_t(4, po_class_queue_size(q));
+
+    po_class_queue_class_t cls;
+    TEST_ASSERT_EQUAL_PTR(&v[1], po_class_queue_pop(q, &cls));
+    TEST_ASSERT_EQUAL_INT(PO_CLASS_QUEUE_HIGH, cls);
+    TEST_ASSERT_EQUAL_PTR(&v[3], po_class_queue_pop(q, NULL));
+
+    // A late high-class arrival still overtakes queued normal ones
+    po_class_queue_push(q, &v[4], PO_CLASS_QUEUE_HIGH);
+    TEST_ASSERT_EQUAL_PTR(&v[4], po_class_queue_pop(q, NULL));
+    TEST_ASSERT_EQUAL_PTR(&v[0], po_class_queue_pop(q, &cls));
+    TEST_ASSERT_EQUAL_INT(PO_CLASS_QUEUE_NORMAL, cls);
+    TEST_ASSERT_EQUAL_PTR(&v[2], po_class_queue_pop(q, NULL));
+    TEST_ASSERT_NULL(po_class_queue_pop(q, NULL));
+    TEST_ASSERT_TRUE(po_class_queue_is_empty(q));
+}
+
+TEST(CLASS_QUEUE, FullClassReportsEagain) {
+    po_class_queue_t *small = po_class_queue_create(3); // Rounded up to 4
+    TEST_ASSERT_NOT_NULL(small);
+
+    int v[5];
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL_INT(0, po_class_queue_push(small, &v[i], PO_CLASS_QUEUE_NORMAL));
+    TEST_ASSERT_EQUAL_INT(-1, po_class_queue_push(small, &v[4], PO_CLASS_QUEUE_NORMAL));
+    TEST_ASSERT_EQUAL_INT(EAGAIN, errno);
+
+    // Classes have independent capacity
+    TEST_ASSERT_EQUAL_INT(0, po_class_queue_push(small, &v[4], PO_CLASS_QUEUE_HIGH));
+    po_class_queue_destroy(small);
+}
+
+// --- Concurrency ---
+
+#define CQ_THREADS 4
+#define CQ_PER_THREAD 20000
+
+typedef struct {
+    po_class_queue_t *queue;
+    int base;
+    int *items;
+    atomic_int *seen;
+    atomic_int *popped;
+} cq_worker_t;
+
+static void *cq_producer(void *arg) {
+    cq_worker_t *w = (cq_worker_t *)arg;
+    for (int i = 0; i < CQ_PER_THREAD; i++) {
+        int *item = &w->items[w->base + i];
+        po_class_queue_class_t cls = (i % 8 == 0) ? PO_CLASS_QUEUE_HIGH : PO_CLASS_QUEUE_NORMAL;
+        while (po_class_queue_push(w->queue, item, cls) != 0)
+            ;
+    }
+    return NULL;
+}
+
+static void *cq_consumer(void *arg) {
+    cq_worker_t *w = (cq_worker_t *)arg;
+    while (atomic_load(w->popped) < CQ_THREADS * CQ_PER_THREAD) {
+        int *item = po_class_queue_pop(w->queue, NULL);
+        if (!item)
+            continue;
+        atomic_fetch_add(&w->seen[*item], 1);
+        atomic_fetch_add(w->popped, 1);
+    }
+    return NULL;
+}
+
+TEST(CLASS_QUEUE, ConcurrentExactlyOnce) {
+    const int total = CQ_THREADS * CQ_PER_THREAD;
+    po_class_queue_t *mq = po_class_queue_create(1024);
+    int *items = malloc((size_t)total * sizeof(int));
+    atomic_int *seen = calloc((size_t)total, sizeof(atomic_int));
+    TEST_ASSERT_NOT_NULL(mq);
+    TEST_ASSERT_NOT_NULL(items);
+    TEST_ASSERT_NOT_NULL(seen);
+    for (int i = 0; i < total; i++)
+        items[i] = i;
+
+    atomic_int popped = 0;
+    pthread_t threads[2 * CQ_THREADS];
+    cq_worker_t workers[CQ_THREADS];
+    for (int i = 0; i < CQ_THREADS; i++) {
+        workers[i] = (cq_worker_t){mq, i * CQ_PER_THREAD, items, seen, &popped};
+        pthread_create(&threads[i], NULL, cq_producer, &workers[i]);
+        pthread_create(&threads[CQ_THREADS + i], NULL, cq_consumer, &workers[i]);
+    }
+    for (int i = 0; i < 2 * CQ_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < total; i++)
+        TEST_ASSERT_EQUAL_INT(1, atomic_load(&seen[i]));
+    TEST_ASSERT_TRUE(po_class_queue_is_empty(mq));
+
+    free(seen);
+    free(items);
+    po_class_queue_destroy(mq);
+}
+
+TEST_GROUP_RUNNER(CLASS_QUEUE) {
+    RUN_TEST_CASE(CLASS_QUEUE, InvalidArguments);
+    RUN_TEST_CASE(CLASS_QUEUE, HighClassFirstThenFifo);
+    RUN_TEST_CASE(CLASS_QUEUE, FullClassReportsEagain);
+    RUN_TEST_CASE(CLASS_QUEUE, ConcurrentExactlyOnce);
+}
@@ -0,0 +1,130 @@
+#include "unity/unity_fixture.h"
+#include "postoffice/priority_queue/indexed_heap.h"
+#include <errno.h>
+#include <stdlib.h>
+
+TEST_GROUP(INDEXED_HEAP);
+
+typedef struct {
+    int key;
+    po_heap_node_t node;
+} elem_t;
+
+static int cmp_elem(const po_heap_node_t *a, const po_heap_node_t *b) {
+    int ka = PO_HEAP_ENTRY(a, elem_t, node)->key;
+    int kb = PO_HEAP_ENTRY(b, elem_t, node)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+static int pop_key(po_indexed_heap_t *heap) {
+    po_heap_node_t *n = po_indexed_heap_pop(heap);
+    TEST_ASSERT_NOT_NULL(n);
+    TEST_ASSERT_EQUAL_size_t(PO_HEAP_NOT_QUEUED, n->index);
+    return PO_HEAP_ENTRY(n, elem_t, node)->key;
+}
+
+static po_indexed_heap_t *heap;
+
+TEST_SETUP(INDEXED_HEAP) {
+    heap = po_indexed_heap_create(cmp_elem, 2); // Tiny: exercises growth
+    TEST_ASSERT_NOT_NULL(heap);
+}
+
+TEST_TEAR_DOWN(INDEXED_HEAP) {
+    po_indexed_heap_destroy(heap);
+    heap = NULL;
+}
+
+TEST(INDEXED_HEAP, PushPopOrdered) {
+    elem_t e[64];
+    for (int i = 0; i < 64; i++) {
+        e[i] = (elem_t){.key = (i * 37) % 64, .node = PO_HEAP_NODE_INIT};
+        TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_push(heap, &e[i].node));
+    }
+    TEST_ASSERT_EQUAL_size_t(64, po_indexed_heap_size(heap));
+    TEST_ASSERT_EQUAL_INT(0, PO_HEAP_ENTRY(po_indexed_heap_peek(heap), elem_t, node)->key);
+
+    for (int i = 0; i < 64; i++)
+        TEST_ASSERT_EQUAL_INT(i, pop_key(heap));
+    TEST_ASSERT_NULL(po_indexed_heap_pop(heap));
+    TEST_ASSERT_TRUE(po_indexed_heap_is_empty(heap));
+}
+
+TEST(INDEXED_HEAP, DoublePushRejected) {
+    elem_t e = {.key = 1, .node = PO_HEAP_NODE_INIT};
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_push(heap, &e.node));
+    TEST_ASSERT_EQUAL_INT(-1, po_indexed_heap_push(heap, &e.node));
+    TEST_ASSERT_EQUAL_INT(EEXIST, errno);
+    TEST_ASSERT_EQUAL_size_t(1, po_indexed_heap_size(heap));
+}
+
+TEST(INDEXED_HEAP, RemoveArbitrary) {
+    elem_t e[10];
+    for (int i = 0; i < 10; i++) {
+        e[i] = (elem_t){.key = i, .node = PO_HEAP_NODE_INIT};
+        po_indexed_heap_push(heap, &e[i].node);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_remove(heap, &e[0].node)); // Root
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_remove(heap, &e[5].node)); // Middle
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_remove(heap, &e[9].node)); // Leaf
+    TEST_ASSERT_EQUAL_INT(-1, po_indexed_heap_remove(heap, &e[5].node));
+
+    static const int expected[] = {1, 2, 3, 4, 6, 7, 8};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+        TEST_ASSERT_EQUAL_INT(expected[i], pop_key(heap));
+    TEST_ASSERT_TRUE(po_indexed_heap_is_empty(heap));
+
+    // Detached nodes can be reused
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_push(heap, &e[5].node));
+}
+
+TEST(INDEXED_HEAP, UpdateKey) {
+    elem_t e[8];
+    for (int i = 0; i < 8; i++) {
+        e[i] = (elem_t){.key = i * 10, .node = PO_HEAP_NODE_INIT};
+        po_indexed_heap_push(heap, &e[i].node);
+    }
+
+    e[7].key = -1; // Decrease: moves to the root
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_update(heap, &e[7].node));
+    e[0].key = 100; // Increase: sinks to the bottom
+    TEST_ASSERT_EQUAL_INT(0, po_indexed_heap_update(heap, &e[0].node));
+
+    static const int expected[] = {-1, 10, 20, 30, 40, 50, 60, 100};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+        TEST_ASSERT_EQUAL_INT(expected[i], pop_key(heap));
+}
+
+TEST(INDEXED_HEAP, RandomizedAgainstSortedOrder) {
+    enum { N = 5000 };
+    elem_t *e = malloc(N * sizeof(*e));
+    TEST_ASSERT_NOT_NULL(e);
+
+    srand(7);
+    for (int i = 0; i < N; i++) {
+        e[i] = (elem_t){.key = rand() % 1000, .node = PO_HEAP_NODE_INIT};
+        po_indexed_heap_push(heap, &e[i].node);
+    }
+    for (int i = 0; i < N; i += 3)
+        po_indexed_heap_remove(heap, &e[i].node);
+
+    int prev = -1;
+    size_t popped = 0;
+    while (!po_indexed_heap_is_empty(heap)) {
+        int k = pop_key(heap);
+        TEST_ASSERT_TRUE(k >= prev);
+        prev = k;
+        popped++;
+    }
+    TEST_ASSERT_EQUAL_size_t(N - (N + 2) / 3, popped);
+    free(e);
+}
+
+TEST_GROUP_RUNNER(INDEXED_HEAP) {
+    RUN_TEST_CASE(INDEXED_HEAP, PushPopOrdered);
+    RUN_TEST_CASE(INDEXED_HEAP, DoublePushRejected);
+    RUN_TEST_CASE(INDEXED_HEAP, RemoveArbitrary);
+    RUN_TEST_CASE(INDEXED_HEAP, UpdateKey);
+    RUN_TEST_CASE(INDEXED_HEAP, RandomizedAgainstSortedOrder);
+}
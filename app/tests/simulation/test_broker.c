@@ -0,0 +1,349 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "ipc/simulation_protocol.h"
+#include "net/net.h"
+#include "net/poller.h"
+#include "net/socket.h"
+#include "unity/unity_fixture.h"
+#include "work_broker/api/broker_core.h"
+#include "work_broker/api/broker_handler.h"
+
+static broker_ctx_t ctx;
+static int sv[2]; // sv[0]: broker side, sv[1]: client side
+static broker_conn_t *conn;
+
+/**
+ * @brief Register one end of a fresh socketpair as a broker session.
+ * @param[out] client The other end (blocking, 2 s receive timeout).
+ */
+static broker_conn_t *open_session(int *client) {
+    int pair[2];
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+    TEST_ASSERT_EQUAL_INT(0, po_socket_set_nonblocking(pair[0]));
+    struct timeval tv = {.tv_sec = 2};
+    setsockopt(pair[1], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    broker_conn_t *c = broker_conns_open(&ctx.conns, pair[0]);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(0, poller_add(ctx.poller, pair[0], EPOLLIN | EPOLLONESHOT));
+    *client = pair[1];
+    return c;
+}
+
+static void send_join(int fd, uint32_t request_id, pid_t tid, int service) {
+    msg_join_queue_t req = {.request_id = request_id,
+                            .requester_pid = 4242,
+                            .requester_tid = tid,
+                            .service_type = (service_type_t)service};
+    TEST_ASSERT_EQUAL_INT(
+        0, net_send_message(fd, MSG_TYPE_JOIN_QUEUE, PO_FLAG_NONE, (uint8_t *)&req, sizeof(req)));
+}
+
+static msg_join_ack_t recv_ack(int fd) {
+    po_header_t h;
+    zcp_buffer_t *p = NULL;
+    TEST_ASSERT_EQUAL_INT(0, net_recv_message_blocking(fd, &h, &p));
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_JOIN_ACK, h.msg_type);
+    msg_join_ack_t ack;
+    memcpy(&ack, p, sizeof(ack));
+    net_zcp_release_rx(p);
+    return ack;
+}
+
+static void send_get_work(int fd, uint32_t request_id, int service, uint32_t max_wait_ms) {
+    msg_get_work_t req = {.request_id = request_id,
+                          .worker_pid = 4343,
+                          .service_type = (service_type_t)service,
+                          .max_wait_ms = max_wait_ms};
+    TEST_ASSERT_EQUAL_INT(
+        0, net_send_message(fd, MSG_TYPE_GET_WORK, PO_FLAG_NONE, (uint8_t *)&req, sizeof(req)));
+}
+
+static msg_work_item_t recv_work(int fd) {
+    po_header_t h;
+    zcp_buffer_t *p = NULL;
+    TEST_ASSERT_EQUAL_INT(0, net_recv_message_blocking(fd, &h, &p));
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_WORK_ITEM, h.msg_type);
+    msg_work_item_t item;
+    memcpy(&item, p, sizeof(item));
+    net_zcp_release_rx(p);
+    return item;
+}
+
+static bool nothing_to_read(int fd) {
+    char c;
+    return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) < 0 && errno == EAGAIN;
+}
+
+static int queued(int service) {
+    int n = 0;
+    broker_item_t *item;
+    while ((item = po_class_queue_pop(ctx.queues[service], NULL)) != NULL) {
+        free(item);
+        n++;
+    }
+    return n;
+}
+
+TEST_GROUP(BROKER);
+
+TEST_SETUP(BROKER) {
+    memset(&ctx, 0, sizeof(ctx));
+    net_init_zerocopy(16, 16, 4096);
+    ctx.shm = calloc(1, sizeof(sim_shm_t));
+    ctx.park_timeout_ms = BROKER_DEFAULT_PARK_TIMEOUT_MS;
+    for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
+        ctx.queues[i] = po_class_queue_create(64);
+        pthread_mutex_init(&ctx.park_mutexes[i], NULL);
+    }
+    TEST_ASSERT_EQUAL_INT(0, broker_join_cache_init(&ctx.joins));
+    TEST_ASSERT_EQUAL_INT(0, broker_conns_init(&ctx.conns, 1024));
+    ctx.poller = poller_create();
+    TEST_ASSERT_NOT_NULL(ctx.poller);
+
+    conn = open_session(&sv[1]);
+    sv[0] = conn->fd;
+}
+
+TEST_TEAR_DOWN(BROKER) {
+    broker_handler_expire_parked(&ctx, true);
+    broker_conns_destroy(&ctx.conns);
+    po_socket_close(sv[1]);
+    poller_destroy(ctx.poller);
+    for (int i = 0; i < SIM_MAX_SERVICE_TYPES; i++) {
+        queued(i);
+        po_class_queue_destroy(ctx.queues[i]);
+        pthread_mutex_destroy(&ctx.park_mutexes[i]);
+    }
+    broker_join_cache_destroy(&ctx.joins);
+    free(ctx.shm);
+    net_shutdown_zerocopy();
+}
+
+TEST(BROKER, PIPELINED_JOINS_DRAIN_IN_ONE_SERVE) {
+    for (uint32_t id = 1; id <= 5; id++)
+        send_join(sv[1], id, 1, 0);
+
+    // One readiness event answers every frame already buffered on the session
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+
+    for (uint32_t id = 1; id <= 5; id++) {
+        msg_join_ack_t ack = recv_ack(sv[1]);
+        TEST_ASSERT_EQUAL_UINT32(id, ack.request_id);
+        TEST_ASSERT_EQUAL_UINT32(id, ack.ticket_number);
+    }
+    TEST_ASSERT_EQUAL_INT(5, queued(0));
+    TEST_ASSERT_EQUAL_UINT64(5, conn->requests_served);
+}
+
+TEST(BROKER, REPEATED_JOIN_GETS_SAME_TICKET) {
+    send_join(sv[1], 7, 1, 0);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+    msg_join_ack_t first = recv_ack(sv[1]);
+
+    // The client lost the reply and retries the same request over a new session
+    int client2;
+    broker_conn_t *conn2 = open_session(&client2);
+    send_join(client2, 7, 1, 0);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn2, &ctx));
+    msg_join_ack_t retry = recv_ack(client2);
+    TEST_ASSERT_EQUAL_UINT32(7, retry.request_id);
+    TEST_ASSERT_EQUAL_UINT32(first.ticket_number, retry.ticket_number);
+
+    // Same request ID from another thread is a different JOIN
+    send_join(client2, 7, 2, 0);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn2, &ctx));
+    TEST_ASSERT_NOT_EQUAL(first.ticket_number, recv_ack(client2).ticket_number);
+
+    TEST_ASSERT_EQUAL_INT(2, queued(0));
+    po_socket_close(client2);
+}
+
+TEST(BROKER, FULL_QUEUE_REFUSES_JOIN_WITH_TICKET_ZERO) {
+    for (uint32_t id = 1; id <= 64; id++) {
+        send_join(sv[1], id, 1, 0);
+        TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+        TEST_ASSERT_NOT_EQUAL(0, recv_ack(sv[1]).ticket_number);
+    }
+
+    // Capacity 64: the next JOIN is refused, not acked with a dropped ticket
+    send_join(sv[1], 65, 1, 0);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+    msg_join_ack_t refused = recv_ack(sv[1]);
+    TEST_ASSERT_EQUAL_UINT32(65, refused.request_id);
+    TEST_ASSERT_EQUAL_UINT32(0, refused.ticket_number);
+
+    // Once a worker drains one, the retried JOIN gets a real ticket
+    free(po_class_queue_pop(ctx.queues[0], NULL));
+    send_join(sv[1], 65, 1, 0);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+    msg_join_ack_t retry = recv_ack(sv[1]);
+    TEST_ASSERT_EQUAL_UINT32(65, retry.request_id);
+    TEST_ASSERT_NOT_EQUAL(0, retry.ticket_number);
+
+    TEST_ASSERT_EQUAL_INT(64, queued(0));
+}
+
+TEST(BROKER, FULL_SOCKET_BUFFER_QUEUES_REPLIES) {
+    // Nobody reads the client side: fill the socket until replies back up
+    uint32_t sent = 0;
+    while (conn->out_len == 0) {
+        msg_join_ack_t ack = {.request_id = ++sent, .ticket_number = sent};
+        TEST_ASSERT_EQUAL_INT(0, broker_conn_send(conn, MSG_TYPE_JOIN_ACK, &ack, sizeof(ack)));
+    }
+    for (int i = 0; i < 8; i++) {
+        msg_join_ack_t ack = {.request_id = ++sent, .ticket_number = sent};
+        TEST_ASSERT_EQUAL_INT(0, broker_conn_send(conn, MSG_TYPE_JOIN_ACK, &ack, sizeof(ack)));
+    }
+    TEST_ASSERT_TRUE(conn->out_len > 0);
+
+    // The client catches up; every reply arrives whole and in order
+    for (uint32_t id = 1; id <= sent; id++) {
+        TEST_ASSERT_EQUAL_UINT32(id, recv_ack(sv[1]).request_id);
+        TEST_ASSERT_EQUAL_INT(0, broker_conn_flush(conn));
+    }
+    TEST_ASSERT_EQUAL_size_t(0, conn->out_len);
+}
+
+TEST(BROKER, PARKED_WORKER_GETS_NEXT_JOIN) {
+    send_get_work(sv[1], 11, 1, 1000);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_PARKED, broker_conn_serve(conn, &ctx));
+    TEST_ASSERT_EQUAL_size_t(1, atomic_load(&ctx.parked[1].count));
+    TEST_ASSERT_TRUE(nothing_to_read(sv[1]));
+
+    int user;
+    broker_conn_t *user_conn = open_session(&user);
+    send_join(user, 1, 1, 1);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(user_conn, &ctx));
+    msg_join_ack_t ack = recv_ack(user);
+
+    // The JOIN hands its ticket straight to the parked worker
+    msg_work_item_t work = recv_work(sv[1]);
+    TEST_ASSERT_EQUAL_UINT32(11, work.request_id);
+    TEST_ASSERT_EQUAL_UINT32(ack.ticket_number, work.ticket_number);
+    TEST_ASSERT_EQUAL_size_t(0, atomic_load(&ctx.parked[1].count));
+    TEST_ASSERT_EQUAL_INT(0, queued(1));
+    po_socket_close(user);
+}
+
+typedef struct {
+    broker_conn_t *conn;
+    pthread_barrier_t *start;
+} serve_arg_t;
+
+static void *serve_after_barrier(void *arg) {
+    serve_arg_t *a = arg;
+    pthread_barrier_wait(a->start);
+    broker_conn_serve(a->conn, &ctx);
+    return NULL;
+}
+
+TEST(BROKER, PARK_RACING_JOIN_NEVER_STRANDS_TICKET) {
+    int user;
+    broker_conn_t *user_conn = open_session(&user);
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, 2);
+
+    // Either the JOIN sees the worker parked, or the worker's re-check after
+    // parking sees the ticket: it must never sit queued while a worker waits.
+    for (uint32_t i = 1; i <= 200; i++) {
+        send_get_work(sv[1], i, 0, 1000);
+        send_join(user, i, 1, 0);
+
+        pthread_t tw, tu;
+        serve_arg_t wa = {.conn = conn, .start = &start};
+        serve_arg_t ua = {.conn = user_conn, .start = &start};
+        pthread_create(&tw, NULL, serve_after_barrier, &wa);
+        pthread_create(&tu, NULL, serve_after_barrier, &ua);
+        pthread_join(tw, NULL);
+        pthread_join(tu, NULL);
+
+        msg_join_ack_t ack = recv_ack(user);
+        msg_work_item_t work = recv_work(sv[1]);
+        TEST_ASSERT_EQUAL_UINT32(i, work.request_id);
+        TEST_ASSERT_EQUAL_UINT32(ack.ticket_number, work.ticket_number);
+        TEST_ASSERT_EQUAL_size_t(0, atomic_load(&ctx.parked[0].count));
+    }
+    TEST_ASSERT_EQUAL_INT(0, queued(0));
+
+    pthread_barrier_destroy(&start);
+    po_socket_close(user);
+}
+
+TEST(BROKER, PARKED_WORKER_EXPIRES_AT_DEADLINE) {
+    send_get_work(sv[1], 21, 2, 50);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_PARKED, broker_conn_serve(conn, &ctx));
+
+    int next_ms = broker_handler_expire_parked(&ctx, false);
+    TEST_ASSERT_TRUE(next_ms > 0 && next_ms <= 50);
+    TEST_ASSERT_TRUE(nothing_to_read(sv[1]));
+
+    usleep(60 * 1000);
+    TEST_ASSERT_EQUAL_INT(BROKER_NO_DEADLINE, broker_handler_expire_parked(&ctx, false));
+    msg_work_item_t work = recv_work(sv[1]);
+    TEST_ASSERT_EQUAL_UINT32(21, work.request_id);
+    TEST_ASSERT_EQUAL_UINT32(0, work.ticket_number);
+    TEST_ASSERT_EQUAL_size_t(0, atomic_load(&ctx.parked[2].count));
+}
+
+TEST(BROKER, FLUSH_ALL_RELEASES_PARKED_WORKERS) {
+    int other;
+    broker_conn_t *other_conn = open_session(&other);
+    send_get_work(sv[1], 31, 0, 1000);
+    send_get_work(other, 32, 1, 1000);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_PARKED, broker_conn_serve(conn, &ctx));
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_PARKED, broker_conn_serve(other_conn, &ctx));
+
+    // Day barrier: nobody may stay parked, whatever their deadline
+    TEST_ASSERT_EQUAL_INT(BROKER_NO_DEADLINE, broker_handler_expire_parked(&ctx, true));
+    TEST_ASSERT_EQUAL_UINT32(0, recv_work(sv[1]).ticket_number);
+    TEST_ASSERT_EQUAL_UINT32(32, recv_work(other).request_id);
+    TEST_ASSERT_EQUAL_size_t(0, atomic_load(&ctx.parked[0].count));
+    TEST_ASSERT_EQUAL_size_t(0, atomic_load(&ctx.parked[1].count));
+
+    // While the barrier is up a GET_WORK is answered at once instead of parking
+    atomic_store(&ctx.shm->sync.barrier_active, 1);
+    send_get_work(sv[1], 33, 0, 1000);
+    TEST_ASSERT_EQUAL_INT(BROKER_REQ_DONE, broker_conn_serve(conn, &ctx));
+    TEST_ASSERT_EQUAL_UINT32(0, recv_work(sv[1]).ticket_number);
+    po_socket_close(other);
+}
+
+TEST(BROKER, PARK_REMOVE_TAKES_BACK_ONLY_A_PARKED_SESSION) {
+    broker_park_list_t list = {0};
+    broker_conn_t a = {.fd = 1}, b = {.fd = 2}, c = {.fd = 3};
+    broker_park_push(&list, &a);
+    broker_park_push(&list, &b);
+    broker_park_push(&list, &c);
+
+    // From the tail: the list keeps appending after the new tail
+    TEST_ASSERT_TRUE(broker_park_remove(&list, &c));
+    TEST_ASSERT_FALSE(broker_park_remove(&list, &c)); // already unparked
+    TEST_ASSERT_EQUAL_size_t(2, atomic_load(&list.count));
+    broker_park_push(&list, &c);
+    TEST_ASSERT_TRUE(broker_park_remove(&list, &b));
+    TEST_ASSERT_EQUAL_PTR(&a, broker_park_pop(&list));
+    TEST_ASSERT_EQUAL_PTR(&c, broker_park_pop(&list));
+    TEST_ASSERT_NULL(broker_park_pop(&list));
+    TEST_ASSERT_NULL(list.tail);
+}
+
+TEST_GROUP_RUNNER(BROKER) {
+    RUN_TEST_CASE(BROKER, PIPELINED_JOINS_DRAIN_IN_ONE_SERVE);
+    RUN_TEST_CASE(BROKER, REPEATED_JOIN_GETS_SAME_TICKET);
+    RUN_TEST_CASE(BROKER, FULL_QUEUE_REFUSES_JOIN_WITH_TICKET_ZERO);
+    RUN_TEST_CASE(BROKER, FULL_SOCKET_BUFFER_QUEUES_REPLIES);
+    RUN_TEST_CASE(BROKER, PARKED_WORKER_GETS_NEXT_JOIN);
+    RUN_TEST_CASE(BROKER, PARK_RACING_JOIN_NEVER_STRANDS_TICKET);
+    RUN_TEST_CASE(BROKER, PARKED_WORKER_EXPIRES_AT_DEADLINE);
+    RUN_TEST_CASE(BROKER, FLUSH_ALL_RELEASES_PARKED_WORKERS);
+    RUN_TEST_CASE(BROKER, PARK_REMOVE_TAKES_BACK_ONLY_A_PARKED_SESSION);
+}
@@ -0,0 +1,144 @@
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "ipc/sim_client.h"
+#include "ipc/simulation_protocol.h"
+#include "net/framing.h"
+#include "net/net.h"
+#include "net/socket.h"
+#include "unity/unity_fixture.h"
+
+static int sv[2]; // sv[0]: session side, sv[1]: broker side
+
+static void send_ack(int fd, uint32_t request_id, uint32_t ticket) {
+    msg_join_ack_t ack = {.request_id = request_id, .ticket_number = ticket};
+    TEST_ASSERT_EQUAL_INT(
+        0, net_send_message(fd, MSG_TYPE_JOIN_ACK, PO_FLAG_NONE, (uint8_t *)&ack, sizeof(ack)));
+}
+
+static uint32_t read_request_id(int fd) {
+    po_header_t h;
+    msg_join_queue_t req;
+    uint32_t len = 0;
+    if (framing_read_msg_blocking(fd, &h, &req, sizeof(req), &len) != 0 || len < sizeof(req))
+        return 0;
+    return req.request_id;
+}
+
+typedef struct {
+    int listen_fd;
+    uint32_t request_id; // Seen by the fake broker
+} fake_broker_t;
+
+// Accepts one session, answers its JOIN with ticket 9
+static void *fake_broker_main(void *arg) {
+    fake_broker_t *fb = arg;
+    struct pollfd pfd = {.fd = fb->listen_fd, .events = POLLIN};
+    if (poll(&pfd, 1, 5000) != 1)
+        return NULL;
+    int fd = po_socket_accept(fb->listen_fd, NULL, 0);
+    if (fd < 0)
+        return NULL;
+    po_socket_set_blocking(fd);
+    fb->request_id = read_request_id(fd);
+    msg_join_ack_t ack = {.request_id = fb->request_id, .ticket_number = 9};
+    net_send_message(fd, MSG_TYPE_JOIN_ACK, PO_FLAG_NONE, (uint8_t *)&ack, sizeof(ack));
+    read_request_id(fd); // Wait for the client to hang up
+    po_socket_close(fd);
+    return NULL;
+}
+
+TEST_GROUP(SIM_CLIENT);
+
+TEST_SETUP(SIM_CLIENT) {
+    net_init_zerocopy(16, 16, 4096);
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+}
+
+TEST_TEAR_DOWN(SIM_CLIENT) {
+    po_socket_close(sv[1]);
+    net_shutdown_zerocopy();
+}
+
+TEST(SIM_CLIENT, STALE_REPLY_IS_DROPPED) {
+    sim_client_session_t session;
+    sim_client_session_init(&session);
+    session.fd = sv[0];
+    session.next_request_id = 41;
+
+    // A late reply to an abandoned request sits ahead of the real one
+    send_ack(sv[1], 40, 99);
+    send_ack(sv[1], 42, 5);
+
+    msg_join_queue_t req = {.requester_pid = getpid()};
+    msg_join_ack_t resp;
+    TEST_ASSERT_EQUAL_INT(0, sim_client_session_call(&session, NULL, NULL, MSG_TYPE_JOIN_QUEUE,
+                                                     &req, sizeof(req), MSG_TYPE_JOIN_ACK, &resp,
+                                                     sizeof(resp)));
+    TEST_ASSERT_EQUAL_UINT32(42, resp.request_id);
+    TEST_ASSERT_EQUAL_UINT32(5, resp.ticket_number);
+    TEST_ASSERT_EQUAL_UINT32(42, read_request_id(sv[1]));
+    TEST_ASSERT_EQUAL_INT(sv[0], session.fd); // Still connected
+
+    sim_client_session_close(&session);
+}
+
+TEST(SIM_CLIENT, RETRY_KEEPS_REQUEST_ID) {
+    // Point the issuer path at a private listener
+    char home[] = "/tmp/po_sim_client_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(home));
+    char dir[64], path[96];
+    snprintf(dir, sizeof(dir), "%s/.postoffice", home);
+    snprintf(path, sizeof(path), "%s/issuer.sock", dir);
+    TEST_ASSERT_EQUAL_INT(0, mkdir(dir, 0700));
+    char *saved_home = getenv("HOME") ? strdup(getenv("HOME")) : NULL;
+    setenv("HOME", home, 1);
+
+    fake_broker_t fb = {.listen_fd = po_socket_listen_unix(path, 4)};
+    TEST_ASSERT_TRUE(fb.listen_fd >= 0);
+    pthread_t th;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&th, NULL, fake_broker_main, &fb));
+
+    // The first broker takes the request and never answers
+    sim_client_session_t session;
+    sim_client_session_init(&session);
+    session.fd = sv[0];
+    struct timeval tv = {.tv_usec = 100000};
+    setsockopt(sv[0], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    msg_join_queue_t req = {.requester_pid = getpid()};
+    msg_join_ack_t resp;
+    int rc = sim_client_session_call(&session, NULL, NULL, MSG_TYPE_JOIN_QUEUE, &req, sizeof(req),
+                                     MSG_TYPE_JOIN_ACK, &resp, sizeof(resp));
+    sim_client_session_close(&session);
+    pthread_join(th, NULL);
+
+    TEST_ASSERT_EQUAL_INT(0, rc);
+    TEST_ASSERT_EQUAL_UINT32(9, resp.ticket_number);
+    uint32_t first_id = read_request_id(sv[1]);
+    TEST_ASSERT_NOT_EQUAL(0, first_id);
+    TEST_ASSERT_EQUAL_UINT32(first_id, fb.request_id);
+    TEST_ASSERT_EQUAL_UINT32(first_id, resp.request_id);
+
+    po_socket_close(fb.listen_fd);
+    unlink(path);
+    rmdir(dir);
+    rmdir(home);
+    if (saved_home)
+        setenv("HOME", saved_home, 1);
+    else
+        unsetenv("HOME");
+    free(saved_home);
+}
+
+TEST_GROUP_RUNNER(SIM_CLIENT) {
+    RUN_TEST_CASE(SIM_CLIENT, STALE_REPLY_IS_DROPPED);
+    RUN_TEST_CASE(SIM_CLIENT, RETRY_KEEPS_REQUEST_ID);
+}
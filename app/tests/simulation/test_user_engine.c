@@ -0,0 +1,250 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "ipc/simulation_protocol.h"
+#include "metrics/metrics.h"
+#include "net/framing.h"
+#include "net/net.h"
+#include "net/socket.h"
+#include "unity/unity_fixture.h"
+#include "users_manager/engine/user_engine.h"
+
+static sim_shm_t *shm;
+static int listen_fd = -1; // Stands in for the broker's issuer socket
+static char home[] = "/tmp/po_user_engine_XXXXXX";
+static char sock_dir[64], sock_path[96];
+static char *saved_home;
+
+static void set_hour(int hour) {
+    atomic_store(&shm->time_control.packed_time, (uint64_t)hour << 8);
+}
+
+static void start_engine(const char *requests) {
+    setenv("PO_USER_REQUESTS", requests, 1);
+    TEST_ASSERT_EQUAL_INT(0, user_engine_init(shm, 1, 8));
+}
+
+// The shard's broker session, once it connects (blocking, 2 s receive timeout)
+static int accept_session(void) {
+    struct pollfd pfd = {.fd = listen_fd, .events = POLLIN};
+    TEST_ASSERT_EQUAL_INT(1, poll(&pfd, 1, 2000));
+    int fd = po_socket_accept(listen_fd, NULL, 0);
+    TEST_ASSERT_TRUE(fd >= 0);
+    po_socket_set_blocking(fd);
+    struct timeval tv = {.tv_sec = 2};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static msg_join_queue_t read_join(int fd) {
+    po_header_t h;
+    msg_join_queue_t req;
+    uint32_t len = 0;
+    TEST_ASSERT_EQUAL_INT(0, framing_read_msg_blocking(fd, &h, &req, sizeof(req), &len));
+    TEST_ASSERT_EQUAL_HEX8(MSG_TYPE_JOIN_QUEUE, h.msg_type);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(req), len);
+    return req;
+}
+
+static void send_ack(int fd, uint32_t request_id, uint32_t ticket) {
+    msg_join_ack_t ack = {.request_id = request_id, .ticket_number = ticket};
+    TEST_ASSERT_EQUAL_INT(
+        0, net_send_message(fd, MSG_TYPE_JOIN_ACK, PO_FLAG_NONE, (uint8_t *)&ack, sizeof(ack)));
+}
+
+static bool readable(int fd, int timeout_ms) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    return poll(&pfd, 1, timeout_ms) == 1;
+}
+
+// Polls until @p expected users are left; false after ~2 s
+static bool wait_count(int expected) {
+    for (int i = 0; i < 400; i++) {
+        if (user_engine_count() == expected)
+            return true;
+        usleep(5000);
+    }
+    return false;
+}
+
+TEST_GROUP(USER_ENGINE);
+
+TEST_SETUP(USER_ENGINE) {
+    net_init_zerocopy(16, 16, 4096);
+    shm = calloc(1, sizeof(sim_shm_t));
+    TEST_ASSERT_NOT_NULL(shm);
+    po_completion_init(&shm->completions);
+    shm->params.tick_nanos = 1000000; // Non-zero: users think between requests
+    atomic_store(&shm->time_control.sim_active, true);
+    set_hour(9);
+
+    // Point the issuer path at a private listener
+    strcpy(home, "/tmp/po_user_engine_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(home));
+    snprintf(sock_dir, sizeof(sock_dir), "%s/.postoffice", home);
+    snprintf(sock_path, sizeof(sock_path), "%s/issuer.sock", sock_dir);
+    TEST_ASSERT_EQUAL_INT(0, mkdir(sock_dir, 0700));
+    saved_home = getenv("HOME") ? strdup(getenv("HOME")) : NULL;
+    setenv("HOME", home, 1);
+    listen_fd = po_socket_listen_unix(sock_path, 4);
+    TEST_ASSERT_TRUE(listen_fd >= 0);
+}
+
+TEST_TEAR_DOWN(USER_ENGINE) {
+    user_engine_shutdown();
+    unsetenv("PO_USER_REQUESTS");
+
+    po_socket_close(listen_fd);
+    unlink(sock_path);
+    rmdir(sock_dir);
+    rmdir(home);
+    if (saved_home)
+        setenv("HOME", saved_home, 1);
+    else
+        unsetenv("HOME");
+    free(saved_home);
+
+    free(shm);
+    net_shutdown_zerocopy();
+}
+
+TEST(USER_ENGINE, USER_WALKS_THROUGH_REQUEST_STATES) {
+    set_hour(7);
+    start_engine("2");
+    TEST_ASSERT_EQUAL_INT(0, user_engine_spawn());
+    TEST_ASSERT_EQUAL_INT(1, user_engine_count());
+
+    // WAIT_OFFICE: admitted, but nothing is sent before opening time
+    for (int i = 0; i < 400 && atomic_load(&shm->stats.connected_users) == 0; i++)
+        usleep(5000);
+    TEST_ASSERT_EQUAL_UINT32(1, atomic_load(&shm->stats.connected_users));
+    TEST_ASSERT_FALSE(readable(listen_fd, 50));
+
+    // JOIN once the office opens
+    set_hour(9);
+    int fd = accept_session();
+    msg_join_queue_t first = read_join(fd);
+    TEST_ASSERT_NOT_EQUAL(0, first.request_id);
+    TEST_ASSERT_EQUAL_INT(getpid(), first.requester_pid);
+    TEST_ASSERT_NOT_EQUAL(0, first.requester_tid);
+
+    // WAIT_SERVICE: the ticket is held until it completes
+    send_ack(fd, first.request_id, 100);
+    TEST_ASSERT_FALSE(readable(fd, 50));
+
+    // NEXT_REQUEST: the next JOIN follows after the think time
+    uint64_t served_ns = po_metric_now_ns();
+    po_completion_publish(&shm->completions, 100);
+    msg_join_queue_t second = read_join(fd);
+    TEST_ASSERT_TRUE(po_metric_now_ns() - served_ns >= 150ull * 1000000ull);
+    TEST_ASSERT_NOT_EQUAL(first.request_id, second.request_id);
+    TEST_ASSERT_EQUAL_INT(first.service_type, second.service_type);
+
+    // Last request served: the user leaves
+    send_ack(fd, second.request_id, 101);
+    TEST_ASSERT_FALSE(readable(fd, 50));
+    TEST_ASSERT_EQUAL_INT(1, user_engine_count());
+    po_completion_publish(&shm->completions, 101);
+    TEST_ASSERT_TRUE(wait_count(0));
+    TEST_ASSERT_EQUAL_UINT32(0, atomic_load(&shm->stats.connected_users));
+
+    po_socket_close(fd);
+}
+
+TEST(USER_ENGINE, COMPLETION_WAKES_ONLY_ITS_TICKET_OWNER) {
+    start_engine("1");
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT(0, user_engine_spawn());
+
+    int fd = accept_session();
+    for (uint32_t i = 0; i < 3; i++)
+        send_ack(fd, read_join(fd).request_id, 200 + i);
+    usleep(50000); // Let the shard file the tickets
+
+    // Someone else's ticket wakes nobody
+    po_completion_publish(&shm->completions, 999);
+    usleep(50000);
+    TEST_ASSERT_EQUAL_INT(3, user_engine_count());
+
+    po_completion_publish(&shm->completions, 201);
+    TEST_ASSERT_TRUE(wait_count(2));
+    usleep(50000);
+    TEST_ASSERT_EQUAL_INT(2, user_engine_count());
+
+    po_completion_publish(&shm->completions, 200);
+    po_completion_publish(&shm->completions, 202);
+    TEST_ASSERT_TRUE(wait_count(0));
+
+    po_socket_close(fd);
+}
+
+TEST(USER_ENGINE, LOST_SESSION_RESENDS_SAME_REQUEST_ID) {
+    start_engine("1");
+    TEST_ASSERT_EQUAL_INT(0, user_engine_spawn());
+
+    // The broker goes away before answering
+    int fd = accept_session();
+    msg_join_queue_t first = read_join(fd);
+    po_socket_close(fd);
+
+    fd = accept_session();
+    msg_join_queue_t resent = read_join(fd);
+    TEST_ASSERT_EQUAL_UINT32(first.request_id, resent.request_id);
+
+    send_ack(fd, resent.request_id, 300);
+    usleep(50000);
+    po_completion_publish(&shm->completions, 300);
+    TEST_ASSERT_TRUE(wait_count(0));
+
+    po_socket_close(fd);
+}
+
+TEST(USER_ENGINE, REFUSED_JOIN_IS_RETRIED) {
+    start_engine("1");
+    TEST_ASSERT_EQUAL_INT(0, user_engine_spawn());
+
+    // Ticket 0: the queue was full; the user tries again without using up its request
+    int fd = accept_session();
+    msg_join_queue_t first = read_join(fd);
+    send_ack(fd, first.request_id, 0);
+    msg_join_queue_t retry = read_join(fd);
+    TEST_ASSERT_NOT_EQUAL(first.request_id, retry.request_id);
+    TEST_ASSERT_EQUAL_INT(1, user_engine_count());
+
+    send_ack(fd, retry.request_id, 500);
+    usleep(50000);
+    po_completion_publish(&shm->completions, 500);
+    TEST_ASSERT_TRUE(wait_count(0));
+
+    po_socket_close(fd);
+}
+
+TEST(USER_ENGINE, SIMULATION_STOP_INTERRUPTS_WAITING_USERS) {
+    start_engine("1");
+    TEST_ASSERT_EQUAL_INT(0, user_engine_spawn());
+
+    int fd = accept_session();
+    send_ack(fd, read_join(fd).request_id, 400);
+    usleep(50000);
+    TEST_ASSERT_EQUAL_INT(1, user_engine_count());
+
+    // The ticket never completes; stopping the simulation still releases the user
+    atomic_store(&shm->time_control.sim_active, false);
+    TEST_ASSERT_TRUE(wait_count(0));
+
+    po_socket_close(fd);
+}
+
+TEST_GROUP_RUNNER(USER_ENGINE) {
+    RUN_TEST_CASE(USER_ENGINE, USER_WALKS_THROUGH_REQUEST_STATES);
+    RUN_TEST_CASE(USER_ENGINE, COMPLETION_WAKES_ONLY_ITS_TICKET_OWNER);
+    RUN_TEST_CASE(USER_ENGINE, LOST_SESSION_RESENDS_SAME_REQUEST_ID);
+    RUN_TEST_CASE(USER_ENGINE, REFUSED_JOIN_IS_RETRIED);
+    RUN_TEST_CASE(USER_ENGINE, SIMULATION_STOP_INTERRUPTS_WAITING_USERS);
+}
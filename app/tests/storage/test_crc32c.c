@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "storage/crc32c.h"
+#include "unity/unity_fixture.h"
+
+TEST_GROUP(CRC32C);
+
+TEST_SETUP(CRC32C) {}
+
+TEST_TEAR_DOWN(CRC32C) {}
+
+TEST(CRC32C, KNOWN_VECTORS) {
+    // RFC 3720 (iSCSI) check value and test patterns
+    TEST_ASSERT_EQUAL_HEX32(0xE3069283u, po_crc32c(0, "123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0xE3069283u, po_crc32c_sw(0, "123456789", 9));
+    uint8_t zeros[32] = {0};
+    uint8_t ones[32];
+    memset(ones, 0xFF, sizeof(ones));
+    TEST_ASSERT_EQUAL_HEX32(0x8A9136AAu, po_crc32c(0, zeros, sizeof(zeros)));
+    TEST_ASSERT_EQUAL_HEX32(0x62A8AB43u, po_crc32c(0, ones, sizeof(ones)));
+    TEST_ASSERT_EQUAL_HEX32(0u, po_crc32c(0, NULL, 0));
+}
+
+TEST(CRC32C, CHAINING_MATCHES_ONE_SHOT) {
+    const char *msg = "The quick brown fox jumps over the lazy dog";
+    size_t n = strlen(msg);
+    uint32_t whole = po_crc32c(0, msg, n);
+    for (size_t cut = 0; cut <= n; cut++)
+        TEST_ASSERT_EQUAL_HEX32(whole, po_crc32c(po_crc32c(0, msg, cut), msg + cut, n - cut));
+}
+
+TEST(CRC32C, HARDWARE_MATCHES_SOFTWARE) {
+    enum { N = 4096 };
+    uint8_t *buf = malloc(N + 8);
+    TEST_ASSERT_NOT_NULL(buf);
+    uint32_t x = 12345;
+    for (size_t i = 0; i < N + 8; i++) {
+        x = x * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(x >> 16);
+    }
+    // Every misalignment and a spread of lengths around the 8-byte stride
+    for (size_t off = 0; off < 8; off++) {
+        for (size_t len = 0; len < 80; len++)
+            TEST_ASSERT_EQUAL_HEX32(po_crc32c_sw(0, buf + off, len), po_crc32c(0, buf + off, len));
+        TEST_ASSERT_EQUAL_HEX32(po_crc32c_sw(0, buf + off, N), po_crc32c(0, buf + off, N));
+    }
+    free(buf);
+}
+
+TEST_GROUP_RUNNER(CRC32C) {
+    RUN_TEST_CASE(CRC32C, KNOWN_VECTORS);
+    RUN_TEST_CASE(CRC32C, CHAINING_MATCHES_ONE_SHOT);
+    RUN_TEST_CASE(CRC32C, HARDWARE_MATCHES_SOFTWARE);
+}
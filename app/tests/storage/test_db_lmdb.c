@@ -195,6 +195,33 @@ TEST(DB_LMDB, ITERATE_ALL) {
     TEST_ASSERT_EQUAL_STRING("cherry", data.keys[2]);
 }
 
+TEST(DB_LMDB, ITERATE_FROM_LOWER_BOUND) {
+    open_env_and_bucket("b7");
+    const char *keys[] = {"apple", "banana", "cherry"};
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT(0, db_put(bucket, keys[i], strlen(keys[i]) + 1, "v", 2));
+
+    /* a bound between keys starts at the next one */
+    iter_data_t data = {.count = 0};
+    TEST_ASSERT_EQUAL_INT(0, db_iterate_from(bucket, "b", 1, iter_collect, &data));
+    TEST_ASSERT_EQUAL_INT(2, data.count);
+    TEST_ASSERT_EQUAL_STRING("banana", data.keys[0]);
+    TEST_ASSERT_EQUAL_STRING("cherry", data.keys[1]);
+
+    /* an existing key is included */
+    data.count = 0;
+    TEST_ASSERT_EQUAL_INT(0, db_iterate_from(bucket, "cherry", 7, iter_collect, &data));
+    TEST_ASSERT_EQUAL_INT(1, data.count);
+    TEST_ASSERT_EQUAL_STRING("cherry", data.keys[0]);
+
+    /* past the last key, and no bound at all */
+    data.count = 0;
+    TEST_ASSERT_EQUAL_INT(0, db_iterate_from(bucket, "d", 1, iter_collect, &data));
+    TEST_ASSERT_EQUAL_INT(0, data.count);
+    TEST_ASSERT_EQUAL_INT(0, db_iterate_from(bucket, NULL, 0, iter_collect, &data));
+    TEST_ASSERT_EQUAL_INT(3, data.count);
+}
+
 TEST(DB_LMDB, ITERATE_EARLY_STOP) {
     open_env_and_bucket("b6");
     TEST_ASSERT_EQUAL_INT(0, db_put(bucket, "x", 1 + 1, "1", 1 + 1));
@@ -226,6 +253,84 @@ TEST(DB_LMDB, MULTIPLE_BUCKETS_ISOLATION) {
     db_bucket_close(&b2);
 }
 
+TEST(DB_LMDB, PUT_MANY_AND_TXN) {
+    open_env_and_bucket("b7");
+    const db_kv_t items[] = {
+        {"k1", 3, "v1", 3},
+        {"k2", 3, "v2", 3},
+        {"k3", 3, "v3", 3},
+    };
+    TEST_ASSERT_EQUAL_INT(0, db_put_many(bucket, items, 3));
+    TEST_ASSERT_EQUAL_INT(0, db_put_many(bucket, items, 0));
+
+    void *out;
+    size_t len;
+    TEST_ASSERT_EQUAL_INT(0, db_get(bucket, "k3", 3, &out, &len));
+    TEST_ASSERT_EQUAL_STRING("v3", (char *)out);
+    free(out);
+
+    // Explicit transaction: nothing is visible until commit
+    db_txn_t *txn = NULL;
+    TEST_ASSERT_EQUAL_INT(0, db_txn_begin(bucket, &txn));
+    TEST_ASSERT_EQUAL_INT(0, db_txn_put(txn, bucket, "k4", 3, "v4", 3));
+    db_txn_abort(&txn);
+    TEST_ASSERT_NULL(txn);
+    TEST_ASSERT_EQUAL_INT(-1, db_get(bucket, "k4", 3, &out, &len));
+
+    TEST_ASSERT_EQUAL_INT(0, db_txn_begin(bucket, &txn));
+    TEST_ASSERT_EQUAL_INT(0, db_txn_put(txn, bucket, "k4", 3, "v4", 3));
+    TEST_ASSERT_EQUAL_INT(0, db_txn_commit(&txn));
+    TEST_ASSERT_NULL(txn);
+    TEST_ASSERT_EQUAL_INT(0, db_get(bucket, "k4", 3, &out, &len));
+    free(out);
+}
+
+TEST(DB_LMDB, PUT_MANY_ALL_OR_NOTHING) {
+    open_env_and_bucket("b8");
+    const db_kv_t items[] = {
+        {"good", 5, "1", 2},
+        {"bad", 0, "2", 2}, // empty key: rejected
+    };
+    TEST_ASSERT_EQUAL_INT(-1, db_put_many(bucket, items, 2));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+
+    void *out;
+    size_t len;
+    TEST_ASSERT_EQUAL_INT(-1, db_get(bucket, "good", 5, &out, &len));
+    TEST_ASSERT_EQUAL_INT(DB_ENOTFOUND, errno);
+}
+
+// Batches of 1, 32 and 1024 all land (puts/s per batch size:
+// tools/db_put_many_bench.c)
+TEST(DB_LMDB, PUT_MANY_BATCH_SIZES_ROUND_TRIP) {
+    enum { RECORDS = 4096 };
+    TEST_ASSERT_EQUAL_INT(0, db_env_open(env_path, 4, 64u << 20, &env));
+    static const size_t batch_sizes[] = {1, 32, 1024};
+    static char keys[RECORDS][16];
+    static db_kv_t kvs[RECORDS];
+    uint8_t iv[12] = {0};
+
+    for (size_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++) {
+        char name[16];
+        snprintf(name, sizeof name, "batch%zu", b);
+        TEST_ASSERT_EQUAL_INT(0, db_bucket_open(env, name, &bucket));
+        for (int i = 0; i < RECORDS; i++) {
+            snprintf(keys[i], sizeof keys[i], "k%014d", i);
+            kvs[i] = (db_kv_t){keys[i], sizeof keys[i], iv, sizeof iv};
+        }
+
+        for (size_t i = 0; i < RECORDS; i += batch_sizes[b])
+            TEST_ASSERT_EQUAL_INT(0, db_put_many(bucket, &kvs[i], batch_sizes[b]));
+
+        void *out;
+        size_t len;
+        TEST_ASSERT_EQUAL_INT(0, db_get(bucket, keys[RECORDS - 1], sizeof keys[0], &out, &len));
+        TEST_ASSERT_EQUAL_size_t(sizeof iv, len);
+        free(out);
+        db_bucket_close(&bucket);
+    }
+}
+
 TEST_GROUP_RUNNER(DB_LMDB) {
     RUN_TEST_CASE(DB_LMDB, ENV_OPEN_INVALID_PATH);
     RUN_TEST_CASE(DB_LMDB, ENV_OPEN_CLOSE);
@@ -235,6 +340,10 @@ TEST_GROUP_RUNNER(DB_LMDB) {
     RUN_TEST_CASE(DB_LMDB, DELETE_MISSING);
     RUN_TEST_CASE(DB_LMDB, GET_MISSING);
     RUN_TEST_CASE(DB_LMDB, ITERATE_ALL);
+    RUN_TEST_CASE(DB_LMDB, ITERATE_FROM_LOWER_BOUND);
     RUN_TEST_CASE(DB_LMDB, ITERATE_EARLY_STOP);
     RUN_TEST_CASE(DB_LMDB, MULTIPLE_BUCKETS_ISOLATION);
+    RUN_TEST_CASE(DB_LMDB, PUT_MANY_AND_TXN);
+    RUN_TEST_CASE(DB_LMDB, PUT_MANY_ALL_OR_NOTHING);
+    RUN_TEST_CASE(DB_LMDB, PUT_MANY_BATCH_SIZES_ROUND_TRIP);
 }
@@ -0,0 +1,129 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "storage/index.h"
+#include "unity/unity_fixture.h"
+
+static po_index_t *idx;
+
+TEST_GROUP(INDEX);
+
+TEST_SETUP(INDEX) {
+    idx = po_index_create(16);
+    TEST_ASSERT_NOT_NULL(idx);
+}
+
+TEST_TEAR_DOWN(INDEX) {
+    po_index_destroy(&idx);
+    TEST_ASSERT_NULL(idx);
+}
+
+// Short keys stay inline in the slot, long ones go to the key arena
+static size_t make_key(char *buf, size_t cap, size_t i) {
+    if (i % 3 == 0)
+        return (size_t)snprintf(buf, cap, "tenant-%04zu/mailbox/message-%012zu", i % 97, i);
+    return (size_t)snprintf(buf, cap, "k%zu", i);
+}
+
+TEST(INDEX, PUT_GET_OVERWRITE) {
+    uint64_t off = 0;
+    uint32_t len = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_index_get(idx, "a", 1, &off, &len));
+    TEST_ASSERT_EQUAL_INT(ENOENT, errno);
+
+    TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, "a", 1, 10, 3));
+    TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, "ab", 2, 20, 4));
+    TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, "a", 1, &off, &len));
+    TEST_ASSERT_EQUAL_UINT64(10, off);
+    TEST_ASSERT_EQUAL_UINT32(3, len);
+
+    // Latest put wins; a prefix of a key is a different key
+    TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, "a", 1, 30, 5));
+    TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, "a", 1, &off, &len));
+    TEST_ASSERT_EQUAL_UINT64(30, off);
+    TEST_ASSERT_EQUAL_UINT32(5, len);
+    TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, "ab", 2, &off, NULL));
+    TEST_ASSERT_EQUAL_UINT64(20, off);
+    TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, "ab", 2, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(-1, po_index_put(idx, "", 0, 1, 1));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    TEST_ASSERT_EQUAL_INT(-1, po_index_get(NULL, "a", 1, NULL, NULL));
+}
+
+TEST(INDEX, GROWTH_KEEPS_SHORT_AND_LONG_KEYS) {
+    enum { N = 50000 };
+    char k[64];
+    for (size_t i = 0; i < N; i++) {
+        size_t kl = make_key(k, sizeof(k), i);
+        TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, k, kl, (uint64_t)i << 20, (uint32_t)i));
+    }
+    for (size_t i = 0; i < N; i++) {
+        size_t kl = make_key(k, sizeof(k), i);
+        uint64_t off = 0;
+        uint32_t len = 0;
+        TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, k, kl, &off, &len));
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)i << 20, off);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)i, len);
+    }
+    for (size_t i = N; i < N + 1000; i++) {
+        size_t kl = make_key(k, sizeof(k), i);
+        TEST_ASSERT_EQUAL_INT(-1, po_index_get(idx, k, kl, NULL, NULL));
+    }
+}
+
+TEST(INDEX, REMOVE_AND_CHURN_MATCH_REFERENCE) {
+    // Random put/remove churn over a small key space, checked against a flat
+    // array: exercises tombstones, slot reuse and in-place rehashes that
+    // repack the long-key arena.
+    enum { KEYS = 4096, OPS = 200000 };
+    int64_t *ref = malloc(sizeof(int64_t) * KEYS);
+    TEST_ASSERT_NOT_NULL(ref);
+    for (size_t i = 0; i < KEYS; i++)
+        ref[i] = -1;
+    char k[64];
+    uint32_t x = 2463534242u;
+    for (uint32_t op = 0; op < OPS; op++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        size_t i = x % KEYS;
+        size_t kl = make_key(k, sizeof(k), i);
+        if ((x >> 16) % 3 == 0) {
+            int rc = po_index_remove(idx, k, kl);
+            TEST_ASSERT_EQUAL_INT(ref[i] >= 0 ? 0 : -1, rc);
+            ref[i] = -1;
+        } else {
+            TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, k, kl, op, (uint32_t)i));
+            ref[i] = op;
+        }
+    }
+    for (size_t i = 0; i < KEYS; i++) {
+        size_t kl = make_key(k, sizeof(k), i);
+        uint64_t off = 0;
+        int rc = po_index_get(idx, k, kl, &off, NULL);
+        if (ref[i] < 0) {
+            TEST_ASSERT_EQUAL_INT(-1, rc);
+        } else {
+            TEST_ASSERT_EQUAL_INT(0, rc);
+            TEST_ASSERT_EQUAL_UINT64((uint64_t)ref[i], off);
+        }
+    }
+    // Removing everything leaves an empty, still usable index
+    for (size_t i = 0; i < KEYS; i++) {
+        size_t kl = make_key(k, sizeof(k), i);
+        TEST_ASSERT_EQUAL_INT(ref[i] >= 0 ? 0 : -1, po_index_remove(idx, k, kl));
+    }
+    TEST_ASSERT_EQUAL_INT(0, po_index_put(idx, "again", 5, 7, 7));
+    TEST_ASSERT_EQUAL_INT(0, po_index_get(idx, "again", 5, NULL, NULL));
+    free(ref);
+}
+
+TEST_GROUP_RUNNER(INDEX) {
+    RUN_TEST_CASE(INDEX, PUT_GET_OVERWRITE);
+    RUN_TEST_CASE(INDEX, GROWTH_KEEPS_SHORT_AND_LONG_KEYS);
+    RUN_TEST_CASE(INDEX, REMOVE_AND_CHURN_MATCH_REFERENCE);
+}
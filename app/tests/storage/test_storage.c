@@ -19,6 +19,7 @@
 
 #include "log/logger.h"
 #include "storage/logstore.h"
+#include "storage/logstore_internal.h"
 #include "sysinfo/sysinfo.h"
 #include "unity/unity_fixture.h"
 
@@ -43,6 +44,10 @@ static void rm_rf_dir(void) {
     char path[512];
     snprintf(path, sizeof(path), "%s/aof.log", g_dir);
     unlink(path); // ignore errors
+    for (int i = 0; i < 64; i++) {
+        snprintf(path, sizeof(path), "%s/aof.%06d.log", g_dir, i);
+        unlink(path);
+    }
     rmdir(g_dir);
     g_dir = NULL;
 }
@@ -61,6 +66,115 @@ static int wait_get(po_logstore_t *ls, const void *key, size_t klen, void **out,
     return -1;
 }
 
+// Wait until a key reads back exactly @p val.
+static int wait_value(po_logstore_t *ls, const char *key, const char *val, int timeout_ms) {
+    for (int waited_us = 0; waited_us < timeout_ms * 1000; waited_us += 2000) {
+        void *out = NULL;
+        size_t outlen = 0;
+        if (po_logstore_get(ls, key, strlen(key), &out, &outlen) == 0) {
+            int match = outlen == strlen(val) && memcmp(out, val, outlen) == 0;
+            free(out);
+            if (match)
+                return 0;
+        }
+        usleep(2000);
+    }
+    return -1;
+}
+
+static int file_exists(const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    return access(path, F_OK) == 0;
+}
+
+// Close the store and reopen g_dir with @p over; base fields left zero
+// (bucket, map size, ring, batch) get the suite defaults.
+static void reopen(const po_logstore_cfg *over) {
+    if (g_ls)
+        po_logstore_close(&g_ls);
+    po_logstore_cfg cfg = *over;
+    cfg.dir = g_dir;
+    if (!cfg.bucket)
+        cfg.bucket = "idx";
+    if (!cfg.map_size)
+        cfg.map_size = 4 << 20;
+    if (!cfg.ring_capacity)
+        cfg.ring_capacity = 256;
+    if (!cfg.batch_size)
+        cfg.batch_size = 16;
+    g_ls = po_logstore_open_cfg(&cfg);
+    TEST_ASSERT_NOT_NULL(g_ls);
+}
+
+// Recovery on open, truncating the log at the first bad record
+static const po_logstore_cfg REBUILD_FROM_CHECKPOINT = {
+    .rebuild_on_open = 1,
+    .truncate_on_rebuild = 1,
+};
+static const po_logstore_cfg REBUILD_FULL = {
+    .rebuild_on_open = 1,
+    .truncate_on_rebuild = 1,
+    .rebuild_full = 1,
+};
+
+static off_t data_size(void) {
+    char path[512];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/aof.log", g_dir);
+    TEST_ASSERT_EQUAL_INT(0, stat(path, &st));
+    return st.st_size;
+}
+
+// Write @p n bytes into aof.log at @p off (-1 appends).
+static void poke_data(off_t off, const void *bytes, size_t n) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/aof.log", g_dir);
+    int fd = open(path, O_CREAT | O_WRONLY, 0664);
+    TEST_ASSERT_TRUE(fd >= 0);
+    if (off < 0)
+        off = lseek(fd, 0, SEEK_END);
+    TEST_ASSERT_EQUAL_INT((int)n, (int)pwrite(fd, bytes, n, off));
+    close(fd);
+}
+
+static void append_v2_record(uint64_t seq, const char *k, const char *v, int corrupt) {
+    uint32_t kl = (uint32_t)strlen(k), vl = (uint32_t)strlen(v);
+    ls_rec_hdr_t h;
+    _ls_rec_encode(&h, seq, 0, k, kl, v, vl);
+    h.crc ^= (uint32_t)corrupt;
+    uint8_t rec[256];
+    memcpy(rec, &h, sizeof(h));
+    memcpy(rec + sizeof(h), k, kl);
+    memcpy(rec + sizeof(h) + kl, v, vl);
+    poke_data(-1, rec, (size_t)LS_REC_SIZE(kl, vl));
+}
+
+// 40 keys with ~100-byte values, rewritten @p rounds times (last round wins).
+#define SEG_KEYS 40
+static void write_rounds(int rounds) {
+    char k[16], v[128];
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < SEG_KEYS; i++) {
+            snprintf(k, sizeof(k), "key%02d", i);
+            int vlen = snprintf(v, sizeof(v), "round%03d-key%02d-%080d", r, i, 0);
+            TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, (size_t)vlen));
+        }
+    }
+    snprintf(k, sizeof(k), "key%02d", SEG_KEYS - 1);
+    snprintf(v, sizeof(v), "round%03d-key%02d-%080d", rounds - 1, SEG_KEYS - 1, 0);
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, k, v, 2000));
+}
+
+static void assert_round(int round) {
+    char k[16], v[128];
+    for (int i = 0; i < SEG_KEYS; i++) {
+        snprintf(k, sizeof(k), "key%02d", i);
+        snprintf(v, sizeof(v), "round%03d-key%02d-%080d", round, i, 0);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, wait_value(g_ls, k, v, 500), k);
+    }
+}
+
 // ---------------------------------------------------------------------
 // Test Group
 // ---------------------------------------------------------------------
@@ -648,7 +762,7 @@ static int fi_enable = 0;
 /* Recursion guard & lazy real malloc resolution to avoid infinite self calls
  * in clean link orders where weak aliasing captures early allocations. */
 static void *fi_malloc(size_t sz) {
-    static int depth = 0;
+    static _Thread_local int depth = 0; // per thread: concurrent callers are not nested
     if (depth > 0) {
         // We are inside our own hook from a nested allocation, bypass logic.
         return __builtin_malloc(sz);
@@ -742,10 +856,696 @@ TEST(LOGSTORE, FAULT_INJECTION_FALLBACK_PATH) {
     TEST_ASSERT_NOT_NULL(g_ls);
 }
 
+TEST(LOGSTORE, SEGMENTS_ROLL_AND_READ) {
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048});
+    write_rounds(2);
+    assert_round(1);
+
+    po_logstore_space_stats st;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &st));
+    TEST_ASSERT_TRUE(st.segments > 2);
+    TEST_ASSERT_TRUE(file_exists("aof.000000.log"));
+    TEST_ASSERT_TRUE(file_exists("aof.000001.log"));
+    TEST_ASSERT_FALSE(file_exists("aof.log"));
+    // Round 0 is fully shadowed by round 1
+    TEST_ASSERT_UINT64_WITHIN(st.total_bytes / 10, st.total_bytes / 2, st.dead_bytes);
+
+    // Index locations survive a reopen, with or without a rebuild scan
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048});
+    assert_round(1);
+}
+
+TEST(LOGSTORE, COMPACTION_RECLAIMS_DEAD_SEGMENTS) {
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048});
+    write_rounds(4);
+    po_logstore_space_stats before;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &before));
+
+    TEST_ASSERT_TRUE(po_logstore_compact(g_ls, 50) > 0);
+    assert_round(3);
+
+    po_logstore_space_stats after;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &after));
+    TEST_ASSERT_TRUE(after.compactions > 0);
+    TEST_ASSERT_TRUE(after.reclaimed_bytes > 0);
+    TEST_ASSERT_TRUE(after.total_bytes < before.total_bytes);
+    TEST_ASSERT_TRUE(after.segments < before.segments);
+    TEST_ASSERT_FALSE(file_exists("aof.000000.log"));
+
+    // Rebuilding from the remaining segments still yields the latest values
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048, .rebuild_on_open = 1});
+    assert_round(3);
+}
+
+TEST(LOGSTORE, BACKGROUND_COMPACTION_WITH_CONCURRENT_WRITES) {
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048,
+                              .background_compact = 1,
+                              .compact_min_dead_pct = 50,
+                              .compact_rate_bytes = 64u << 20,
+                              .compact_interval_ms = 5});
+    write_rounds(3);
+
+    po_logstore_space_stats st = {0};
+    for (int waited = 0; waited < 2000 && st.compactions == 0; waited += 5) {
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &st));
+        usleep(5000);
+    }
+    TEST_ASSERT_TRUE(st.compactions > 0);
+
+    // Keep overwriting while the compactor runs; reads must never miss
+    write_rounds(3);
+    assert_round(2);
+}
+
+TEST(LOGSTORE, LEGACY_AOF_ADOPTED_AS_SEGMENT_ZERO) {
+    write_rounds(1); // default config: single aof.log
+    TEST_ASSERT_TRUE(file_exists("aof.log"));
+
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048});
+    TEST_ASSERT_FALSE(file_exists("aof.log"));
+    TEST_ASSERT_TRUE(file_exists("aof.000000.log"));
+    assert_round(0);
+}
+
+TEST(LOGSTORE, RECORD_CHECKSUM_DETECTS_CORRUPTION) {
+    const char *k = "crck";
+    const char *v = "checksummed value";
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, strlen(v)));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, k, v, 400));
+    uint64_t off = 0;
+    uint32_t len = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_debug_lookup(g_ls, k, strlen(k), &off, &len));
+    po_logstore_close(&g_ls);
+
+    // Flip one value byte: lengths still parse, only the checksum catches it
+    poke_data((off_t)(off + LS_REC_HDR_SIZE + strlen(k) + 3), "X", 1);
+    reopen(&(po_logstore_cfg){.fsync_policy = PO_LS_FSYNC_NONE});
+    void *out = NULL;
+    size_t outlen = 0;
+    errno = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, k, strlen(k), &out, &outlen));
+    TEST_ASSERT_EQUAL_INT(EIO, errno);
+
+    po_logstore_integrity_stats st;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_integrity_scan(g_ls, 1, &st));
+    TEST_ASSERT_EQUAL_UINT(1, st.errors);
+    TEST_ASSERT_EQUAL_UINT(1, st.pruned);
+}
+
+TEST(LOGSTORE, RECOVERY_SCANS_ONLY_PAST_CHECKPOINT) {
+    char k[16], v[32];
+    for (int i = 0; i < 10; i++) {
+        snprintf(k, sizeof(k), "ck%02d", i);
+        snprintf(v, sizeof(v), "value-%02d", i);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, strlen(v)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "ck09", "value-09", 400));
+    uint64_t first = 0;
+    uint32_t len = 0;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_debug_lookup(g_ls, "ck00", 4, &first, &len));
+    po_logstore_close(&g_ls);
+
+    // Damage a checkpointed record: a scan from byte 0 would stop there.
+    poke_data((off_t)(first + LS_REC_HDR_SIZE + 4), "X", 1);
+    off_t indexed_end = data_size();
+    // Past the checkpoint: a record whose index commit was lost, then a torn one.
+    append_v2_record(UINT64_C(1) << 40, "late", "recovered", 0);
+    append_v2_record((UINT64_C(1) << 40) + 1, "torn", "bad checksum", 1);
+
+    reopen(&REBUILD_FROM_CHECKPOINT);
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "late", "recovered", 1));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "ck09", "value-09", 1));
+    void *out = NULL;
+    size_t outlen = 0;
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, "torn", 4, &out, &outlen));
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, "ck00", 4, &out, &outlen));
+    TEST_ASSERT_EQUAL_INT64(indexed_end + (off_t)LS_REC_SIZE(4, 9), data_size());
+
+    // New records continue the sequence after the recovered one
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, "next", 4, "after", 5));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "next", "after", 400));
+    reopen(&REBUILD_FROM_CHECKPOINT);
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "next", "after", 1));
+
+    // A full rebuild scans from byte 0 and cuts the log at the damaged record
+    reopen(&REBUILD_FULL);
+    TEST_ASSERT_EQUAL_INT64((off_t)first, data_size());
+}
+
+TEST(LOGSTORE, LEGACY_V1_RECORDS_STILL_READABLE) {
+    po_logstore_close(&g_ls);
+    // [u32 key_len][u32 val_len][key][value], as written before v2 headers
+    uint8_t file[64];
+    size_t at = 0;
+    const char *recs[][2] = {{"old1", "v1-a"}, {"old2", "v1-bb"}};
+    for (int i = 0; i < 2; i++) {
+        uint32_t kl = (uint32_t)strlen(recs[i][0]), vl = (uint32_t)strlen(recs[i][1]);
+        memcpy(file + at, &kl, 4);
+        memcpy(file + at + 4, &vl, 4);
+        memcpy(file + at + 8, recs[i][0], kl);
+        memcpy(file + at + 8 + kl, recs[i][1], vl);
+        at += 8 + kl + vl;
+    }
+    poke_data(0, file, at);
+
+    reopen(&REBUILD_FROM_CHECKPOINT); // no checkpoint yet: full scan
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "old1", "v1-a", 1));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "old2", "v1-bb", 1));
+
+    // v2 records follow the v1 ones in the same file
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, "new1", 4, "v2", 2));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "new1", "v2", 400));
+    reopen(&REBUILD_FULL);
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "old2", "v1-bb", 1));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "new1", "v2", 1));
+    TEST_ASSERT_EQUAL_INT64((off_t)at + (off_t)LS_REC_SIZE(4, 2), data_size());
+}
+
 // ---------------------------------------------------------------------
 // Group Runner
 // ---------------------------------------------------------------------
 
+TEST(LOGSTORE, VIEW_MATCHES_GET) {
+    reopen(&(po_logstore_cfg){.mmap_reads = 1});
+    // 64 B, 4 KiB and 1 MiB values; the last one outgrows the initial 1 MiB
+    // mapping of the active segment and forces a remap
+    const size_t sizes[] = {64, 4096, 1u << 20};
+    char k[16];
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char *val = malloc(sizes[i]);
+        TEST_ASSERT_NOT_NULL(val);
+        for (size_t j = 0; j < sizes[i]; j++)
+            val[j] = (char)('a' + (j + i) % 26);
+        snprintf(k, sizeof(k), "view%zu", i);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), val, sizes[i]));
+        void *out = NULL;
+        size_t outlen = 0;
+        TEST_ASSERT_EQUAL_INT(0, wait_get(g_ls, k, strlen(k), &out, &outlen, 2000));
+
+        po_logstore_view view;
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get_view(g_ls, k, strlen(k), &view));
+        TEST_ASSERT_EQUAL_UINT(sizes[i], view.len);
+        TEST_ASSERT_EQUAL_INT(0, view._copy);
+        TEST_ASSERT_EQUAL_MEMORY(val, view.data, sizes[i]);
+        TEST_ASSERT_EQUAL_MEMORY(out, view.data, outlen);
+        po_logstore_view_release(&view);
+        po_logstore_view_release(&view); // second release is a no-op
+        free(out);
+        free(val);
+    }
+    po_logstore_view view;
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get_view(g_ls, "missing", 7, &view));
+}
+
+TEST(LOGSTORE, VIEW_OUTLIVES_COMPACTION_AND_CLOSE) {
+    reopen(&(po_logstore_cfg){.segment_bytes = 2048, .mmap_reads = 1});
+    write_rounds(1);
+    po_logstore_view view;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_view(g_ls, "key00", 5, &view));
+    TEST_ASSERT_EQUAL_INT(0, view._copy);
+    char expect[128];
+    int n = snprintf(expect, sizeof(expect), "round%03d-key%02d-%080d", 0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT((size_t)n, view.len);
+
+    // Shadow everything, then compact: the viewed segment is unlinked
+    write_rounds(3);
+    TEST_ASSERT_TRUE(po_logstore_compact(g_ls, 50) > 0);
+    TEST_ASSERT_FALSE(file_exists("aof.000000.log"));
+    TEST_ASSERT_EQUAL_MEMORY(expect, view.data, view.len);
+
+    po_logstore_view fresh;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_view(g_ls, "key00", 5, &fresh));
+    snprintf(expect, sizeof(expect), "round%03d-key%02d-%080d", 2, 0, 0);
+    TEST_ASSERT_EQUAL_MEMORY(expect, fresh.data, fresh.len);
+
+    po_logstore_close(&g_ls);
+    TEST_ASSERT_EQUAL_MEMORY(expect, fresh.data, fresh.len);
+    po_logstore_view_release(&fresh);
+    po_logstore_view_release(&view);
+}
+
+TEST(LOGSTORE, VIEW_COPY_FALLBACK) {
+    const char *k = "copied", *v = "private bytes";
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, strlen(v)));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, k, v, 2000));
+    po_logstore_view view;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_view(g_ls, k, strlen(k), &view));
+    TEST_ASSERT_EQUAL_INT(1, view._copy);
+    TEST_ASSERT_EQUAL_UINT(strlen(v), view.len);
+    TEST_ASSERT_EQUAL_MEMORY(v, view.data, view.len);
+    po_logstore_view_release(&view);
+}
+
+TEST(LOGSTORE, IO_URING_BACKEND_FLUSHES_AND_SYNCS) {
+    const po_logstore_fsync_policy_t policies[] = {PO_LS_FSYNC_EACH_BATCH, PO_LS_FSYNC_EVERY_N,
+                                                   PO_LS_FSYNC_NONE};
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        reopen(&(po_logstore_cfg){.batch_size = 8,
+                                  .fsync_policy = policies[p],
+                                  .fsync_every_n = 2,
+                                  .segment_bytes = 4096,
+                                  .io_backend = PO_LS_IO_URING});
+        int with_uring = atomic_load(&g_ls->uring_workers) > 0;
+        write_rounds(3);
+        assert_round(2);
+
+        // Everything reached the files in order: a full rescan agrees
+        reopen(&REBUILD_FULL);
+        assert_round(2);
+        if (!with_uring)
+            TEST_IGNORE_MESSAGE("io_uring unavailable; verified the pwritev fallback only");
+    }
+}
+
+typedef struct {
+    po_logstore_t *ls;
+    int id;
+    int count;
+    int failures;
+} durable_ctx_t;
+
+static void *durable_writer(void *arg) {
+    durable_ctx_t *c = (durable_ctx_t *)arg;
+    char k[32], v[32];
+    for (int i = 0; i < c->count; i++) {
+        snprintf(k, sizeof(k), "d%d-%d", c->id, i);
+        int vl = snprintf(v, sizeof(v), "value-%d-%d", c->id, i);
+        po_logstore_token tok = 0;
+        if (po_logstore_append_async(c->ls, k, strlen(k), v, (size_t)vl, &tok) != 0 ||
+            po_logstore_wait_durable(c->ls, tok, 5000) != 0)
+            c->failures++;
+    }
+    return NULL;
+}
+
+TEST(LOGSTORE, GROUP_COMMIT_WAIT_DURABLE) {
+    const po_logstore_io_backend_t backends[] = {PO_LS_IO_PWRITEV, PO_LS_IO_URING};
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        // PO_LS_FSYNC_NONE: tokens force syncs on their own
+        reopen(&(po_logstore_cfg){.segment_bytes = 8192, .io_backend = backends[b]});
+
+        enum { THREADS = 4, PER_THREAD = 100 };
+        pthread_t th[THREADS];
+        durable_ctx_t ctx[THREADS];
+        for (int i = 0; i < THREADS; i++) {
+            ctx[i] = (durable_ctx_t){g_ls, i, PER_THREAD, 0};
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&th[i], NULL, durable_writer, &ctx[i]));
+        }
+        for (int i = 0; i < THREADS; i++)
+            pthread_join(th[i], NULL);
+        for (int i = 0; i < THREADS; i++)
+            TEST_ASSERT_EQUAL_INT(0, ctx[i].failures);
+        uint64_t issued = atomic_load(&g_ls->gc_next_ticket);
+        TEST_ASSERT_EQUAL_UINT64(THREADS * PER_THREAD, issued);
+        TEST_ASSERT_TRUE(atomic_load(&g_ls->gc_durable) >= issued);
+        // Durable records are indexed too
+        TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "d3-99", "value-3-99", 10));
+
+        // Earlier tokens stay durable; tokens never issued are rejected
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_wait_durable(g_ls, 1, 0));
+        TEST_ASSERT_EQUAL_INT(-1, po_logstore_wait_durable(g_ls, issued + 1, 0));
+        TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+        TEST_ASSERT_EQUAL_INT(-1, po_logstore_wait_durable(g_ls, 0, 0));
+    }
+}
+
+TEST(LOGSTORE, GROUP_COMMIT_WAITS_FOR_ROLLED_SEGMENT_ENTRY) {
+    const po_logstore_io_backend_t backends[] = {PO_LS_IO_PWRITEV, PO_LS_IO_URING};
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        reopen(&(po_logstore_cfg){.segment_bytes = 2048, .io_backend = backends[b]});
+        po_logstore_space_stats st;
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &st));
+        uint64_t segments = st.segments;
+
+        // From here on directory fsyncs fail (fsync on a pipe: EINVAL)
+        int pipefd[2];
+        TEST_ASSERT_EQUAL_INT(0, pipe(pipefd));
+        int dir_fd = g_ls->dir_fd;
+        g_ls->dir_fd = pipefd[0];
+
+        // Records stay durable until one lands in a freshly rolled segment
+        char k[16], v[128];
+        memset(v, 'r', sizeof(v));
+        int rc = 0, i;
+        for (i = 0; i < 64 && rc == 0; i++) {
+            snprintf(k, sizeof(k), "roll%02d", i);
+            po_logstore_token tok = 0;
+            TEST_ASSERT_EQUAL_INT(
+                0, po_logstore_append_async(g_ls, k, strlen(k), v, sizeof(v), &tok));
+            rc = po_logstore_wait_durable(g_ls, tok, 2000);
+        }
+        TEST_ASSERT_EQUAL_INT(-1, rc);
+        TEST_ASSERT_EQUAL_INT(EIO, errno);
+        TEST_ASSERT_TRUE(i > 1);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get_space_stats(g_ls, &st));
+        TEST_ASSERT_TRUE(st.segments > segments);
+
+        g_ls->dir_fd = dir_fd;
+        close(pipefd[0]);
+        close(pipefd[1]);
+    }
+}
+
+TEST(LOGSTORE, GROUP_COMMIT_FRONTIER_OUT_OF_ORDER) {
+    pthread_mutex_lock(&g_ls->tail_lock);
+    _ls_gc_mark(g_ls, 3, 1);
+    _ls_gc_mark(g_ls, 2, 1);
+    TEST_ASSERT_EQUAL_UINT64(0, g_ls->gc_written);
+    _ls_gc_mark(g_ls, 1, 1);
+    TEST_ASSERT_EQUAL_UINT64(3, g_ls->gc_written);
+
+    // A mark far past the window grows it without losing the ones inside
+    size_t len = g_ls->gc_bits_len;
+    _ls_gc_mark(g_ls, 5, 1);
+    _ls_gc_mark(g_ls, 3 + 3 * len, 1);
+    TEST_ASSERT_TRUE(g_ls->gc_bits_len > len);
+    _ls_gc_mark(g_ls, 4, 1);
+    TEST_ASSERT_EQUAL_UINT64(5, g_ls->gc_written);
+    for (uint64_t t = 6; t < 3 + 3 * len; t++)
+        _ls_gc_mark(g_ls, t, 1);
+    TEST_ASSERT_EQUAL_UINT64(3 + 3 * len, g_ls->gc_written);
+    pthread_mutex_unlock(&g_ls->tail_lock);
+
+    // A failed write fails its token and every later one, not earlier ones
+    atomic_store(&g_ls->gc_next_ticket, 20);
+    _ls_gc_durable(g_ls, 10);
+    pthread_mutex_lock(&g_ls->tail_lock);
+    _ls_gc_mark(g_ls, 15, 0);
+    pthread_mutex_unlock(&g_ls->tail_lock);
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_wait_durable(g_ls, 10, 0));
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_wait_durable(g_ls, 12, 0));
+    TEST_ASSERT_EQUAL_INT(ETIMEDOUT, errno);
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_wait_durable(g_ls, 16, -1));
+    TEST_ASSERT_EQUAL_INT(EIO, errno);
+}
+
+typedef struct {
+    po_logstore_t *ls;
+    int id;
+    int count;
+    int failures;
+} flush_ctx_t;
+
+static void *flush_writer(void *arg) {
+    flush_ctx_t *c = (flush_ctx_t *)arg;
+    char k[32], v[256];
+    po_logstore_token last = 0;
+    for (int i = 0; i < c->count; i++) {
+        snprintf(k, sizeof(k), "w%d-%d", c->id, i);
+        size_t vl = 16 + (size_t)(i * 37 % 200); // uneven record sizes
+        memset(v, 'a' + (i % 26), vl);
+        // Odd threads carry tokens so tickets ride in some batches only
+        int rc = c->id % 2 ? po_logstore_append_async(c->ls, k, strlen(k), v, vl, &last)
+                           : po_logstore_append(c->ls, k, strlen(k), v, vl);
+        if (rc != 0)
+            c->failures++;
+    }
+    if (last && po_logstore_wait_durable(c->ls, last, 5000) != 0)
+        c->failures++;
+    return NULL;
+}
+
+// Walk every segment record by record: ranges written by different workers
+// must tile each file exactly, with sequence numbers increasing in file order.
+static size_t walk_segments(void) {
+    size_t records = 0;
+    uint64_t last_seq = 0;
+    for (int id = 0; id < 64; id++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/aof.%06d.log", g_dir, id);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            continue;
+        struct stat st;
+        TEST_ASSERT_EQUAL_INT(0, fstat(fd, &st));
+        uint8_t *buf = malloc((size_t)st.st_size + 1);
+        TEST_ASSERT_NOT_NULL(buf);
+        TEST_ASSERT_EQUAL_INT64(st.st_size, pread(fd, buf, (size_t)st.st_size, 0));
+        close(fd);
+        size_t at = 0;
+        while (at < (size_t)st.st_size) {
+            ls_rec_t r;
+            TEST_ASSERT_EQUAL_INT(0, _ls_rec_decode(buf + at, (size_t)st.st_size - at, &r));
+            TEST_ASSERT_EQUAL_UINT(2, r.version);
+            TEST_ASSERT_TRUE(at + r.hdr_size + r.klen + r.vlen <= (size_t)st.st_size);
+            TEST_ASSERT_EQUAL_INT(0, _ls_rec_verify(&r, buf + at, buf + at + r.hdr_size));
+            TEST_ASSERT_TRUE(r.seq > last_seq);
+            last_seq = r.seq;
+            at += r.hdr_size + r.klen + r.vlen;
+            records++;
+        }
+        free(buf);
+    }
+    return records;
+}
+
+TEST(LOGSTORE, MULTI_WORKER_FLUSH_NO_OVERLAP) {
+    enum { THREADS = 4, PER_THREAD = 1500 };
+    const po_logstore_io_backend_t backends[] = {PO_LS_IO_PWRITEV, PO_LS_IO_URING};
+    size_t expected = 0;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        reopen(&(po_logstore_cfg){.map_size = 16 << 20,
+                                  .batch_size = 8,
+                                  .workers = 4,
+                                  .segment_bytes = 64 << 10,
+                                  .io_backend = backends[b]});
+        TEST_ASSERT_NOT_NULL(g_ls);
+
+        pthread_t th[THREADS];
+        flush_ctx_t ctx[THREADS];
+        for (int i = 0; i < THREADS; i++) {
+            ctx[i] = (flush_ctx_t){g_ls, i, PER_THREAD, 0};
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&th[i], NULL, flush_writer, &ctx[i]));
+        }
+        for (int i = 0; i < THREADS; i++)
+            pthread_join(th[i], NULL);
+        for (int i = 0; i < THREADS; i++)
+            TEST_ASSERT_EQUAL_INT(0, ctx[i].failures);
+        po_logstore_close(&g_ls); // drains every worker
+
+        expected += THREADS * PER_THREAD;
+        TEST_ASSERT_EQUAL_size_t(expected, walk_segments());
+    }
+
+    // Every key reads back its own value after reopening from the index
+    reopen(&(po_logstore_cfg){.segment_bytes = 64 << 10});
+    for (int t = 0; t < THREADS; t++) {
+        for (int i = 0; i < PER_THREAD; i += 97) {
+            char k[32], v[256];
+            snprintf(k, sizeof(k), "w%d-%d", t, i);
+            size_t vl = 16 + (size_t)(i * 37 % 200);
+            memset(v, 'a' + (i % 26), vl);
+            void *out = NULL;
+            size_t outlen = 0;
+            TEST_ASSERT_EQUAL_INT(0, po_logstore_get(g_ls, k, strlen(k), &out, &outlen));
+            TEST_ASSERT_EQUAL_size_t(vl, outlen);
+            TEST_ASSERT_EQUAL_MEMORY(v, out, vl);
+            free(out);
+        }
+    }
+}
+
+TEST(LOGSTORE, INDEX_COMMIT_RUNS_OUTSIDE_TAIL_LOCK) {
+    reopen(&(po_logstore_cfg){.batch_size = 1, .workers = 2});
+    const uint64_t rec = LS_REC_SIZE(3, 5);
+    ls_segment_t *act = g_ls->segs[g_ls->nsegs - 1];
+    uint64_t base = atomic_load(&act->size);
+
+    // A stalled index commit holds up neither writes nor publications
+    pthread_mutex_lock(&g_ls->idx_mu);
+    po_logstore_token tok[2];
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append_async(g_ls, "ka0", 3, "val-0", 5, &tok[0]));
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append_async(g_ls, "ka1", 3, "val-1", 5, &tok[1]));
+    for (int i = 0; i < 1000 && atomic_load(&act->size) < base + 2 * rec; i++)
+        usleep(2000);
+    TEST_ASSERT_EQUAL_UINT64(base + 2 * rec, atomic_load(&act->size));
+    TEST_ASSERT_EQUAL_INT(0, pthread_mutex_trylock(&g_ls->tail_lock));
+    pthread_mutex_unlock(&g_ls->tail_lock);
+    // Not indexed yet, so not reported durable either
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, "ka0", 3, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_wait_durable(g_ls, tok[0], 0));
+    pthread_mutex_unlock(&g_ls->idx_mu);
+
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_wait_durable(g_ls, tok[1], 2000));
+    for (int i = 0; i < 2; i++) {
+        char k[16], v[16];
+        snprintf(k, sizeof(k), "ka%d", i);
+        snprintf(v, sizeof(v), "val-%d", i);
+        void *out = NULL;
+        size_t outlen = 0;
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get(g_ls, k, 3, &out, &outlen));
+        TEST_ASSERT_EQUAL_size_t(5, outlen);
+        TEST_ASSERT_EQUAL_MEMORY(v, out, 5);
+        free(out);
+    }
+}
+
+// Drain a scan, checking key order and that each value is "<key>#<round>".
+static size_t drain_scan(po_logstore_scan_t *sc, const char *first, int day3_round) {
+    char prev[32] = "";
+    size_t n = 0;
+    po_logstore_scan_item it;
+    int rc;
+    while ((rc = po_logstore_scan_next(sc, &it)) == 1) {
+        char k[32], want[40];
+        TEST_ASSERT_TRUE(it.keylen < sizeof(k));
+        memcpy(k, it.key, it.keylen);
+        k[it.keylen] = '\0';
+        if (n == 0 && first)
+            TEST_ASSERT_EQUAL_STRING(first, k);
+        TEST_ASSERT_TRUE(strcmp(prev, k) < 0);
+        int odd_day3 = strncmp(k, "day3/", 5) == 0 && (k[strlen(k) - 1] - '0') % 2 == 1;
+        snprintf(want, sizeof(want), "%s#%d", k, odd_day3 ? day3_round : 0);
+        TEST_ASSERT_EQUAL_size_t(strlen(want), it.vallen);
+        TEST_ASSERT_EQUAL_MEMORY(want, it.val, it.vallen);
+        memcpy(prev, k, it.keylen + 1);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, rc);
+    return n;
+}
+
+TEST(LOGSTORE, SCAN_RANGE_AND_PREFIX_IN_KEY_ORDER) {
+    reopen(&(po_logstore_cfg){.segment_bytes = 16 << 10});
+    // 3 days x 300 keys, appended in a scattered order so log order differs
+    // from key order; odd day-3 keys are then rewritten
+    char k[32], v[40];
+    for (int i = 0; i < 900; i++) {
+        int j = (i * 7) % 900;
+        snprintf(k, sizeof(k), "day%d/t%04d", 1 + j / 300, j % 300);
+        snprintf(v, sizeof(v), "%s#0", k);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, strlen(v)));
+    }
+    for (int i = 1; i < 300; i += 2) {
+        snprintf(k, sizeof(k), "day3/t%04d", i);
+        snprintf(v, sizeof(v), "%s#1", k);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, k, strlen(k), v, strlen(v)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, "\xff\xff", 2, "x", 1));
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_append(g_ls, "\xff\xff\x01", 3, "y", 1));
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "\xff\xff\x01", "y", 2000));
+
+    po_logstore_scan_t *sc = po_logstore_scan_prefix(g_ls, "day2/", 5);
+    TEST_ASSERT_NOT_NULL(sc);
+    TEST_ASSERT_EQUAL_size_t(300, drain_scan(sc, "day2/t0000", 1));
+    po_logstore_scan_close(&sc);
+    TEST_ASSERT_NULL(sc);
+
+    // [lo, hi) spans batches and segments
+    sc = po_logstore_scan(g_ls, "day1/t0100", 10, "day3/t0050", 10);
+    TEST_ASSERT_NOT_NULL(sc);
+    TEST_ASSERT_EQUAL_size_t(200 + 300 + 50, drain_scan(sc, "day1/t0100", 1));
+    po_logstore_scan_close(&sc);
+
+    // An all-0xFF prefix is unbounded above; an inverted range is empty
+    sc = po_logstore_scan_prefix(g_ls, "\xff", 1);
+    TEST_ASSERT_NOT_NULL(sc);
+    po_logstore_scan_item it;
+    TEST_ASSERT_EQUAL_INT(1, po_logstore_scan_next(sc, &it));
+    TEST_ASSERT_EQUAL_size_t(2, it.keylen);
+    TEST_ASSERT_EQUAL_INT(1, po_logstore_scan_next(sc, &it));
+    TEST_ASSERT_EQUAL_size_t(3, it.keylen);
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_scan_next(sc, &it));
+    po_logstore_scan_close(&sc);
+    sc = po_logstore_scan(g_ls, "b", 1, "a", 1);
+    TEST_ASSERT_NOT_NULL(sc);
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_scan_next(sc, &it));
+    po_logstore_scan_close(&sc);
+
+    // Compacting the segments holding rewritten keys mid-scan: later batches
+    // follow the repointed index
+    sc = po_logstore_scan_prefix(g_ls, "day", 3);
+    TEST_ASSERT_NOT_NULL(sc);
+    TEST_ASSERT_EQUAL_INT(1, po_logstore_scan_next(sc, &it));
+    TEST_ASSERT_TRUE(po_logstore_compact(g_ls, 1) > 0);
+    TEST_ASSERT_EQUAL_size_t(899, drain_scan(sc, "day1/t0001", 1));
+    po_logstore_scan_close(&sc);
+}
+
+TEST(LOGSTORE, BLOOM_ANSWERS_MISSES_AND_GROWS) {
+    po_logstore_cfg cfg = {
+        .map_size = 16 << 20,
+        .ring_capacity = 1024,
+        .batch_size = 64,
+        .bloom_keys = 32, // a single 64-byte block: forces rebuilds below
+    };
+    reopen(&cfg);
+    po_logstore_bloom_stats st0, st;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_bloom_stats(g_ls, &st0));
+    TEST_ASSERT_EQUAL_size_t(64, st0.bytes);
+
+    enum { N = 3000 };
+    char k[32];
+    po_logstore_token tok = 0;
+    for (int i = 0; i < N; i++) {
+        int kl = snprintf(k, sizeof(k), "present/%05d", i);
+        while (po_logstore_append_async(g_ls, k, (size_t)kl, k, (size_t)kl, &tok) != 0)
+            usleep(100);
+    }
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_wait_durable(g_ls, tok, 5000));
+
+    // The filter was rebuilt from LMDB while appends ran and still holds all
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_bloom_stats(g_ls, &st));
+    TEST_ASSERT_TRUE(st.bytes >= N * 12 / 8);
+    for (int i = 0; i < N; i++) {
+        int kl = snprintf(k, sizeof(k), "present/%05d", i);
+        void *out = NULL;
+        size_t outlen = 0;
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_get(g_ls, k, (size_t)kl, &out, &outlen));
+        TEST_ASSERT_EQUAL_MEMORY(k, out, (size_t)kl);
+        free(out);
+    }
+    for (int i = 0; i < N; i++) {
+        int kl = snprintf(k, sizeof(k), "absent/%05d", i);
+        void *out = NULL;
+        size_t outlen = 0;
+        TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, k, (size_t)kl, &out, &outlen));
+        TEST_ASSERT_NULL(out);
+    }
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_bloom_stats(g_ls, &st));
+    TEST_ASSERT_EQUAL_UINT64(N, st.definite_misses + st.false_positives);
+    TEST_ASSERT_TRUE(st.fp_rate < 0.05);
+
+    // Reopen: the filter is sized from the stored keys and refilled by preload
+    cfg.bloom_keys = 0;
+    reopen(&cfg);
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_bloom_stats(g_ls, &st));
+    TEST_ASSERT_TRUE(st.keys >= N * 99 / 100);
+    TEST_ASSERT_EQUAL_INT(0, wait_value(g_ls, "present/00042", "present/00042", 1000));
+    TEST_ASSERT_EQUAL_INT(-1, po_logstore_get(g_ls, "absent/00042", 12, NULL, NULL));
+}
+
+TEST(LOGSTORE, BLOOM_REBUILD_RUNS_WITHOUT_INDEX_LOCK) {
+    reopen(&(po_logstore_cfg){.bloom_keys = 32});
+    char k[32];
+    for (int i = 0; i < 100; i++) {
+        int kl = snprintf(k, sizeof(k), "old/%03d", i);
+        TEST_ASSERT_EQUAL_INT(0, po_logstore_debug_put_index(g_ls, k, (size_t)kl, 0, 1));
+    }
+
+    // Full: a larger filter is installed under idx_mu, once
+    pthread_mutex_lock(&g_ls->idx_mu);
+    TEST_ASSERT_EQUAL_INT(1, _ls_bloom_grow_if_full(g_ls));
+    TEST_ASSERT_EQUAL_INT(0, _ls_bloom_grow_if_full(g_ls));
+    pthread_mutex_unlock(&g_ls->idx_mu);
+
+    // A key noted while it fills (its LMDB commit still to come) lands in both
+    pthread_rwlock_rdlock(&g_ls->idx_lock);
+    _ls_bloom_note_key(g_ls, "late", 4);
+    pthread_rwlock_unlock(&g_ls->idx_lock);
+    _ls_bloom_rebuild(g_ls);
+
+    TEST_ASSERT_NULL(g_ls->bloom_next);
+    po_logstore_bloom_stats st;
+    TEST_ASSERT_EQUAL_INT(0, po_logstore_get_bloom_stats(g_ls, &st));
+    TEST_ASSERT_EQUAL_size_t(128, st.bytes);
+    TEST_ASSERT_TRUE(_ls_bloom_may_contain(g_ls->bloom, "late", 4));
+    for (int i = 0; i < 100; i++) {
+        int kl = snprintf(k, sizeof(k), "old/%03d", i);
+        TEST_ASSERT_TRUE(_ls_bloom_may_contain(g_ls->bloom, k, (size_t)kl));
+    }
+}
+
 TEST_GROUP_RUNNER(LOGSTORE) {
     RUN_TEST_CASE(LOGSTORE, APPEND_AND_GET_SINGLE);
     RUN_TEST_CASE(LOGSTORE, APPEND_MULTIPLE_UNIQUE);
@@ -767,4 +1567,23 @@ TEST_GROUP_RUNNER(LOGSTORE) {
     RUN_TEST_CASE(LOGSTORE, APPEND_EXCEED_MAX_VALUE);
     RUN_TEST_CASE(LOGSTORE, DEBUG_LOOKUP_RETURNS_OFFSET);
     RUN_TEST_CASE(LOGSTORE, FAULT_INJECTION_FALLBACK_PATH);
+    RUN_TEST_CASE(LOGSTORE, SEGMENTS_ROLL_AND_READ);
+    RUN_TEST_CASE(LOGSTORE, COMPACTION_RECLAIMS_DEAD_SEGMENTS);
+    RUN_TEST_CASE(LOGSTORE, BACKGROUND_COMPACTION_WITH_CONCURRENT_WRITES);
+    RUN_TEST_CASE(LOGSTORE, LEGACY_AOF_ADOPTED_AS_SEGMENT_ZERO);
+    RUN_TEST_CASE(LOGSTORE, RECORD_CHECKSUM_DETECTS_CORRUPTION);
+    RUN_TEST_CASE(LOGSTORE, RECOVERY_SCANS_ONLY_PAST_CHECKPOINT);
+    RUN_TEST_CASE(LOGSTORE, LEGACY_V1_RECORDS_STILL_READABLE);
+    RUN_TEST_CASE(LOGSTORE, VIEW_MATCHES_GET);
+    RUN_TEST_CASE(LOGSTORE, VIEW_OUTLIVES_COMPACTION_AND_CLOSE);
+    RUN_TEST_CASE(LOGSTORE, VIEW_COPY_FALLBACK);
+    RUN_TEST_CASE(LOGSTORE, IO_URING_BACKEND_FLUSHES_AND_SYNCS);
+    RUN_TEST_CASE(LOGSTORE, GROUP_COMMIT_WAIT_DURABLE);
+    RUN_TEST_CASE(LOGSTORE, GROUP_COMMIT_WAITS_FOR_ROLLED_SEGMENT_ENTRY);
+    RUN_TEST_CASE(LOGSTORE, GROUP_COMMIT_FRONTIER_OUT_OF_ORDER);
+    RUN_TEST_CASE(LOGSTORE, MULTI_WORKER_FLUSH_NO_OVERLAP);
+    RUN_TEST_CASE(LOGSTORE, INDEX_COMMIT_RUNS_OUTSIDE_TAIL_LOCK);
+    RUN_TEST_CASE(LOGSTORE, SCAN_RANGE_AND_PREFIX_IN_KEY_ORDER);
+    RUN_TEST_CASE(LOGSTORE, BLOOM_ANSWERS_MISSES_AND_GROWS);
+    RUN_TEST_CASE(LOGSTORE, BLOOM_REBUILD_RUNS_WITHOUT_INDEX_LOCK);
 }
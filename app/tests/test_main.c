@@ -13,6 +13,8 @@ extern TEST_GROUP_RUNNER(PERF);
 extern TEST_GROUP_RUNNER(PERF_CONCURRENCY);
 extern TEST_GROUP_RUNNER(METRIC_CACHING);
 extern TEST_GROUP_RUNNER(DB_LMDB);
+extern TEST_GROUP_RUNNER(CRC32C);
+extern TEST_GROUP_RUNNER(INDEX);
 extern TEST_GROUP_RUNNER(FRAMING);
 extern TEST_GROUP_RUNNER(PROTOCOL);
 extern TEST_GROUP_RUNNER(SOCKET);
@@ -28,10 +30,16 @@ extern TEST_GROUP_RUNNER(VECTOR);
 extern TEST_GROUP_RUNNER(ERRORS);
 extern TEST_GROUP_RUNNER(SIGNALS);
 extern TEST_GROUP_RUNNER(THREADPOOL);
+extern TEST_GROUP_RUNNER(COMPLETION);
 extern TEST_GROUP_RUNNER(SAMPLER);
 extern TEST_GROUP_RUNNER(SORT);
 extern TEST_GROUP_RUNNER(PRIORITY_QUEUE);
+extern TEST_GROUP_RUNNER(CLASS_QUEUE);
+extern TEST_GROUP_RUNNER(INDEXED_HEAP);
 extern TEST_GROUP_RUNNER(LOAD_BALANCE);
+extern TEST_GROUP_RUNNER(BROKER);
+extern TEST_GROUP_RUNNER(SIM_CLIENT);
+extern TEST_GROUP_RUNNER(USER_ENGINE);
 
 static void RunAllTests(void) {
     RUN_TEST_GROUP(ARGV);
@@ -46,6 +54,8 @@ static void RunAllTests(void) {
     RUN_TEST_GROUP(PERF_CONCURRENCY);
     RUN_TEST_GROUP(METRIC_CACHING);
     RUN_TEST_GROUP(DB_LMDB);
+    RUN_TEST_GROUP(CRC32C);
+    RUN_TEST_GROUP(INDEX);
     RUN_TEST_GROUP(FRAMING);
     RUN_TEST_GROUP(PROTOCOL);
     RUN_TEST_GROUP(SOCKET);
@@ -61,10 +71,16 @@ static void RunAllTests(void) {
     RUN_TEST_GROUP(ERRORS);
     RUN_TEST_GROUP(SIGNALS);
     RUN_TEST_GROUP(THREADPOOL);
+    RUN_TEST_GROUP(COMPLETION);
     RUN_TEST_GROUP(SAMPLER);
     RUN_TEST_GROUP(SORT);
     RUN_TEST_GROUP(PRIORITY_QUEUE);
+    RUN_TEST_GROUP(CLASS_QUEUE);
+    RUN_TEST_GROUP(INDEXED_HEAP);
     RUN_TEST_GROUP(LOAD_BALANCE);
+    RUN_TEST_GROUP(BROKER);
+    RUN_TEST_GROUP(SIM_CLIENT);
+    RUN_TEST_GROUP(USER_ENGINE);
 }
 
 int main(int argc, const char *argv[]) {
@@ -0,0 +1,175 @@
+/**
+ * @file class_queue_bench.c
+ * @brief Benchmark: broker queue throughput under contention.
+ *
+ * Compares the two ways of holding a service's tickets:
+ *
+ * 1. mutex+heap: pthread mutex around po_priority_queue_t ordered by
+ *    (VIP, arrival), the broker's previous path.
+ * 2. class_queue: po_class_queue_t, one lock-free FIFO per class.
+ *
+ * Each thread owns one ticket and loops push(owned) / pop(any), so the queue
+ * depth stays at the prefill level and every operation hits the shared
+ * structure. 1 in 8 tickets is VIP.
+ *
+ * Usage: class_queue_bench [ops_per_thread] [prefill]   (defaults 50000, 1024)
+ */
+
+#include <postoffice/priority_queue/class_queue.h>
+#include <postoffice/priority_queue/priority_queue.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t arrival;
+    int is_vip;
+} bench_item_t;
+
+typedef struct {
+    bool lock_free;
+    size_t ops;
+    bench_item_t *owned;
+} bench_args_t;
+
+static po_class_queue_t *g_cq;
+static po_priority_queue_t *g_pq;
+static pthread_mutex_t g_pq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint_least64_t g_arrival;
+static atomic_uint g_ready;
+static atomic_bool g_go;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned long item_hash(const void *ptr) {
+    return (unsigned long)(uintptr_t)ptr;
+}
+
+static int item_compare(const void *a, const void *b) {
+    const bench_item_t *ia = (const bench_item_t *)a;
+    const bench_item_t *ib = (const bench_item_t *)b;
+    if (ia == ib)
+        return 0;
+    if (ia->is_vip != ib->is_vip)
+        return ib->is_vip - ia->is_vip;
+    return ia->arrival < ib->arrival ? -1 : 1;
+}
+
+static void push_item(bool lock_free, bench_item_t *item) {
+    item->arrival = atomic_fetch_add_explicit(&g_arrival, 1, memory_order_relaxed);
+    if (lock_free) {
+        po_class_queue_push(g_cq, item, item->is_vip ? PO_CLASS_QUEUE_HIGH : PO_CLASS_QUEUE_NORMAL);
+    } else {
+        pthread_mutex_lock(&g_pq_mutex);
+        po_priority_queue_push(g_pq, item);
+        pthread_mutex_unlock(&g_pq_mutex);
+    }
+}
+
+static bench_item_t *pop_item(bool lock_free) {
+    if (lock_free)
+        return po_class_queue_pop(g_cq, NULL);
+
+    pthread_mutex_lock(&g_pq_mutex);
+    bench_item_t *item = po_priority_queue_pop(g_pq);
+    pthread_mutex_unlock(&g_pq_mutex);
+    return item;
+}
+
+static void *thread_main(void *arg) {
+    bench_args_t *a = (bench_args_t *)arg;
+    atomic_fetch_add(&g_ready, 1);
+    while (!atomic_load(&g_go))
+        sched_yield();
+
+    bench_item_t *owned = a->owned;
+    for (size_t i = 0; i < a->ops; i++) {
+        push_item(a->lock_free, owned);
+        // Items are conserved, so a failed pop only means another thread is
+        // between its pop and its push.
+        while ((owned = pop_item(a->lock_free)) == NULL)
+            sched_yield();
+    }
+    a->owned = owned;
+    return NULL;
+}
+
+static double run(bool lock_free, unsigned int threads, size_t ops, size_t prefill) {
+    size_t n_items = prefill + threads;
+    bench_item_t *items = calloc(n_items, sizeof(*items));
+    pthread_t *tids = calloc(threads, sizeof(*tids));
+    bench_args_t *args = calloc(threads, sizeof(*args));
+    if (!items || !tids || !args) {
+        fprintf(stderr, "allocation failed\n");
+        exit(1);
+    }
+
+    if (lock_free)
+        g_cq = po_class_queue_create(n_items);
+    else
+        g_pq = po_priority_queue_create(item_compare, item_hash);
+    if ((lock_free && !g_cq) || (!lock_free && !g_pq)) {
+        fprintf(stderr, "queue creation failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < n_items; i++)
+        items[i].is_vip = (i % 8) == 0;
+    for (size_t i = 0; i < prefill; i++)
+        push_item(lock_free, &items[i]);
+
+    atomic_store(&g_ready, 0);
+    atomic_store(&g_go, false);
+    for (unsigned int t = 0; t < threads; t++) {
+        args[t] = (bench_args_t){.lock_free = lock_free, .ops = ops, .owned = &items[prefill + t]};
+        pthread_create(&tids[t], NULL, thread_main, &args[t]);
+    }
+    while (atomic_load(&g_ready) < threads)
+        sched_yield();
+
+    uint64_t t0 = now_ns();
+    atomic_store(&g_go, true);
+    for (unsigned int t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+    uint64_t elapsed = now_ns() - t0;
+
+    if (lock_free) {
+        po_class_queue_destroy(g_cq);
+        g_cq = NULL;
+    } else {
+        po_priority_queue_destroy(g_pq);
+        g_pq = NULL;
+    }
+    free(args);
+    free(tids);
+    free(items);
+
+    // push + pop per iteration
+    return (double)(2 * ops * threads) / ((double)elapsed / 1e9) / 1e6;
+}
+
+int main(int argc, char **argv) {
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 50000;
+    size_t prefill = argc > 2 ? strtoul(argv[2], NULL, 10) : 1024;
+    static const unsigned int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    printf("Broker queue contention benchmark (%zu push+pop per thread, depth %zu)\n", ops,
+           prefill);
+    printf("%-8s %16s %16s %8s\n", "threads", "mutex+heap Mop/s", "class_queue Mop/s", "speedup");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        unsigned int t = thread_counts[i];
+        double heap = run(false, t, ops, prefill);
+        double lf = run(true, t, ops, prefill);
+        printf("%-8u %16.2f %16.2f %7.2fx\n", t, heap, lf, lf / heap);
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file completion_wakeup_bench.c
+ * @brief Benchmark: waiter wakeups per completed ticket.
+ *
+ * N waiter threads each hold one ticket; a publisher completes the tickets one
+ * at a time in shuffled order (as VIP reordering does). Two strategies:
+ *
+ * 1. broadcast: one mutex + condvar per queue, every completion broadcasts and
+ *    every waiter re-checks its ticket (the old cond_served scheme).
+ * 2. completion: po_completion_table_t, a futex word per ticket slot, so a
+ *    completion wakes only the owner.
+ *
+ * Wakeups are measured as voluntary context switches of the waiter threads
+ * (getrusage RUSAGE_THREAD), i.e. how many times a waiter was put back on a
+ * CPU, divided by the number of completions.
+ *
+ * Usage: completion_wakeup_bench [waiters]   (default 256)
+ */
+
+#include <postoffice/concurrency/completion.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+// ============================================================================
+// Shared state
+// ============================================================================
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool *done;
+    atomic_uint blocked; // Waiters parked on the condvar right now
+} broadcast_queue_t;
+
+typedef struct {
+    uint32_t ticket;
+    bool use_completion;
+    broadcast_queue_t *queue;
+    po_completion_table_t *table;
+    long switches; // Voluntary context switches while waiting
+} waiter_args_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long thread_voluntary_switches(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_nvcsw;
+}
+
+// ============================================================================
+// Waiters
+// ============================================================================
+
+static void *waiter_main(void *arg) {
+    waiter_args_t *w = (waiter_args_t *)arg;
+    long before = thread_voluntary_switches();
+
+    if (w->use_completion) {
+        while (po_completion_wait(w->table, w->ticket, -1) != 0)
+            ;
+    } else {
+        broadcast_queue_t *q = w->queue;
+        pthread_mutex_lock(&q->mutex);
+        while (!q->done[w->ticket]) {
+            atomic_fetch_add(&q->blocked, 1);
+            pthread_cond_wait(&q->cond, &q->mutex);
+            atomic_fetch_sub(&q->blocked, 1);
+        }
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    w->switches = thread_voluntary_switches() - before;
+    return NULL;
+}
+
+static unsigned int completion_blocked(po_completion_table_t *t, uint32_t n) {
+    unsigned int sum = 0;
+    for (uint32_t i = 1; i <= n; i++)
+        sum += atomic_load(&t->slots[i & (PO_COMPLETION_SLOTS - 1)].waiters);
+    return sum;
+}
+
+// ============================================================================
+// Runner
+// ============================================================================
+
+static void run(const char *name, bool use_completion, uint32_t n) {
+    broadcast_queue_t q;
+    pthread_mutex_init(&q.mutex, NULL);
+    pthread_cond_init(&q.cond, NULL);
+    q.done = calloc(n + 1, sizeof(bool));
+    atomic_init(&q.blocked, 0);
+
+    po_completion_table_t *table = malloc(sizeof(*table));
+    po_completion_init(table);
+
+    waiter_args_t *args = calloc(n, sizeof(*args));
+    pthread_t *threads = calloc(n, sizeof(*threads));
+    uint32_t *order = malloc(n * sizeof(*order));
+    if (!q.done || !table || !args || !threads || !order) {
+        fprintf(stderr, "allocation failed\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        args[i] = (waiter_args_t){.ticket = i + 1,
+                                  .use_completion = use_completion,
+                                  .queue = &q,
+                                  .table = table};
+        pthread_create(&threads[i], NULL, waiter_main, &args[i]);
+        order[i] = i + 1;
+    }
+
+    // Shuffled completion order (fixed seed for reproducibility)
+    srand(42);
+    for (uint32_t i = n - 1; i > 0; i--) {
+        uint32_t j = (uint32_t)rand() % (i + 1);
+        uint32_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    // Wait until every waiter is asleep so each completion is measured alone
+    for (;;) {
+        unsigned int blocked =
+            use_completion ? completion_blocked(table, n) : atomic_load(&q.blocked);
+        if (blocked >= n)
+            break;
+        usleep(1000);
+    }
+
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        if (use_completion) {
+            po_completion_publish(table, order[i]);
+        } else {
+            pthread_mutex_lock(&q.mutex);
+            q.done[order[i]] = true;
+            pthread_cond_broadcast(&q.cond);
+            pthread_mutex_unlock(&q.mutex);
+        }
+        // Let the woken threads run before the next completion (busy wait so
+        // the publisher does not add context switches of its own).
+        uint64_t until = now_ns() + 200000;
+        while (now_ns() < until)
+            ;
+    }
+    for (uint32_t i = 0; i < n; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed_ms = (double)(now_ns() - t0) / 1e6;
+
+    long wakeups = 0;
+    for (uint32_t i = 0; i < n; i++)
+        wakeups += args[i].switches;
+
+    printf("%-12s waiters=%-6u completions=%-6u wakeups=%-9ld wakeups/completion=%8.2f "
+           "(%.1f ms)\n",
+           name, n, n, wakeups, (double)wakeups / n, elapsed_ms);
+
+    free(order);
+    free(threads);
+    free(args);
+    free(table);
+    free(q.done);
+    pthread_cond_destroy(&q.cond);
+    pthread_mutex_destroy(&q.mutex);
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 256;
+    if (n == 0 || n >= PO_COMPLETION_SLOTS) {
+        fprintf(stderr, "waiters must be in [1, %u)\n", PO_COMPLETION_SLOTS);
+        return 1;
+    }
+
+    printf("Completion wakeup benchmark (%u waiters, shuffled completion order)\n", n);
+    run("broadcast", false, n);
+    run("completion", true, n);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file db_put_many_bench.c
+ * @brief Benchmark: LMDB index-write throughput per db_put_many() batch size.
+ *
+ * Mirrors the logstore flush path: 12-byte values (offset + length) under
+ * 16-byte keys, committed in batches of 1, 32 and 1024 into a fresh bucket
+ * each. Every commit costs a page flush, so puts/s should grow with the batch.
+ *
+ * Usage: db_put_many_bench [records] [dir]   (defaults 4096, /tmp)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "storage/db_lmdb.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    const char *base = argc > 2 ? argv[2] : "/tmp";
+    static const size_t batch_sizes[] = {1, 32, 1024};
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/db_put_many_benchXXXXXX", base);
+    db_env_t *env = NULL;
+    if (!mkdtemp(path) || db_env_open(path, 4, 256u << 20, &env) != 0) {
+        fprintf(stderr, "failed to open LMDB environment under %s\n", base);
+        return 1;
+    }
+
+    char (*keys)[16] = calloc(records, sizeof(*keys));
+    db_kv_t *kvs = calloc(records, sizeof(*kvs));
+    uint8_t iv[12] = {0};
+    if (!keys || !kvs) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < records; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%014zu", i);
+        kvs[i] = (db_kv_t){keys[i], sizeof(keys[i]), iv, sizeof(iv)};
+    }
+
+    printf("LMDB put_many benchmark (%zu puts per batch size)\n", records);
+    printf("%-8s %12s\n", "batch", "puts/s");
+    int rc = 0;
+    for (size_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++) {
+        char name[16];
+        snprintf(name, sizeof(name), "bench%zu", b);
+        db_bucket_t *bucket = NULL;
+        if (db_bucket_open(env, name, &bucket) != 0) {
+            rc = 1;
+            break;
+        }
+
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < records && rc == 0; i += batch_sizes[b]) {
+            size_t n = records - i < batch_sizes[b] ? records - i : batch_sizes[b];
+            if (db_put_many(bucket, &kvs[i], n) != 0)
+                rc = 1;
+        }
+        double secs = (double)(now_ns() - t0) / 1e9;
+        db_bucket_close(&bucket);
+        if (rc != 0)
+            break;
+        printf("%-8zu %12.0f\n", batch_sizes[b], (double)records / secs);
+    }
+    if (rc != 0)
+        fprintf(stderr, "db_put_many failed\n");
+
+    db_env_close(&env);
+    char file[600];
+    snprintf(file, sizeof(file), "%s/data.mdb", path);
+    unlink(file);
+    snprintf(file, sizeof(file), "%s/lock.mdb", path);
+    unlink(file);
+    rmdir(path);
+    free(kvs);
+    free(keys);
+    return rc;
+}
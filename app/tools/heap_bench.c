@@ -0,0 +1,158 @@
+/**
+ * @file heap_bench.c
+ * @brief Benchmark: po_priority_queue_t vs po_indexed_heap_t, ns per operation.
+ *
+ * For each heap size N (1k, 100k, 10M) the heap is filled with N random keys
+ * (reported as ns/push), then run in the "hold" model used by timer and
+ * scheduling queues: pop the minimum, advance its key by a random increment
+ * and push it back (reported as ns per pop+push pair).
+ *
+ * po_priority_queue_t updates its element->index hashtable on every sift
+ * swap; po_indexed_heap_t stores the index in the element itself.
+ *
+ * Usage: heap_bench [hold_ops] [baseline_max_n]   (defaults 1000000, 10000000)
+ *   baseline_max_n skips the hashtable-backed queue above that size.
+ */
+
+#include <postoffice/priority_queue/indexed_heap.h>
+#include <postoffice/priority_queue/priority_queue.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t key;
+    po_heap_node_t node;
+} bench_elem_t;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_rand(void) {
+    // xorshift64: cheap enough not to dominate the measured loop
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Ties broken by address: the hashtable-backed queue uses the comparator for
+// key equality, so distinct elements must never compare equal.
+static int cmp_keys(const bench_elem_t *a, const bench_elem_t *b) {
+    if (a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    return (a > b) - (a < b);
+}
+
+static int cmp_elem(const void *a, const void *b) {
+    return cmp_keys((const bench_elem_t *)a, (const bench_elem_t *)b);
+}
+
+static unsigned long hash_elem(const void *ptr) {
+    return (unsigned long)(uintptr_t)ptr;
+}
+
+static int cmp_node(const po_heap_node_t *a, const po_heap_node_t *b) {
+    return cmp_keys(PO_HEAP_ENTRY(a, bench_elem_t, node), PO_HEAP_ENTRY(b, bench_elem_t, node));
+}
+
+typedef struct {
+    double push_ns;
+    double hold_ns;
+} bench_result_t;
+
+static void fill_keys(bench_elem_t *elems, size_t n) {
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; i++) {
+        elems[i].key = next_rand() % (n * 4);
+        elems[i].node = (po_heap_node_t)PO_HEAP_NODE_INIT;
+    }
+}
+
+static bench_result_t run_baseline(bench_elem_t *elems, size_t n, size_t ops) {
+    bench_result_t r = {0};
+    po_priority_queue_t *pq = po_priority_queue_create(cmp_elem, hash_elem);
+    if (!pq) {
+        fprintf(stderr, "po_priority_queue_create failed\n");
+        exit(1);
+    }
+
+    uint64_t t0 = now_ns();
+    for (size_t i = 0; i < n; i++)
+        po_priority_queue_push(pq, &elems[i]);
+    r.push_ns = (double)(now_ns() - t0) / (double)n;
+
+    t0 = now_ns();
+    for (size_t i = 0; i < ops; i++) {
+        bench_elem_t *e = po_priority_queue_pop(pq);
+        e->key += 1 + next_rand() % n;
+        po_priority_queue_push(pq, e);
+    }
+    r.hold_ns = (double)(now_ns() - t0) / (double)ops;
+
+    po_priority_queue_destroy(pq);
+    return r;
+}
+
+static bench_result_t run_indexed(bench_elem_t *elems, size_t n, size_t ops) {
+    bench_result_t r = {0};
+    po_indexed_heap_t *heap = po_indexed_heap_create(cmp_node, 0);
+    if (!heap) {
+        fprintf(stderr, "po_indexed_heap_create failed\n");
+        exit(1);
+    }
+
+    uint64_t t0 = now_ns();
+    for (size_t i = 0; i < n; i++)
+        po_indexed_heap_push(heap, &elems[i].node);
+    r.push_ns = (double)(now_ns() - t0) / (double)n;
+
+    t0 = now_ns();
+    for (size_t i = 0; i < ops; i++) {
+        po_heap_node_t *node = po_indexed_heap_pop(heap);
+        PO_HEAP_ENTRY(node, bench_elem_t, node)->key += 1 + next_rand() % n;
+        po_indexed_heap_push(heap, node);
+    }
+    r.hold_ns = (double)(now_ns() - t0) / (double)ops;
+
+    po_indexed_heap_destroy(heap);
+    return r;
+}
+
+int main(int argc, char **argv) {
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t baseline_max = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000000;
+    static const size_t sizes[] = {1000, 100000, 10000000};
+
+    printf("Heap benchmark (%zu hold ops per size)\n", ops);
+    printf("%-10s %-16s %12s %16s\n", "N", "impl", "ns/push", "ns/pop+push");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        bench_elem_t *elems = malloc(n * sizeof(*elems));
+        if (!elems) {
+            fprintf(stderr, "allocation of %zu elements failed\n", n);
+            return 1;
+        }
+
+        if (n <= baseline_max) {
+            fill_keys(elems, n);
+            bench_result_t b = run_baseline(elems, n, ops);
+            printf("%-10zu %-16s %12.1f %16.1f\n", n, "priority_queue", b.push_ns, b.hold_ns);
+        } else {
+            printf("%-10zu %-16s %12s %16s\n", n, "priority_queue", "skipped", "skipped");
+        }
+
+        fill_keys(elems, n);
+        bench_result_t h = run_indexed(elems, n, ops);
+        printf("%-10zu %-16s %12.1f %16.1f\n", n, "indexed_heap", h.push_ns, h.hold_ns);
+        fflush(stdout);
+        free(elems);
+    }
+    return 0;
+}
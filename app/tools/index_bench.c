@@ -0,0 +1,126 @@
+/**
+ * @file index_bench.c
+ * @brief Benchmark: po_index memory per key and put/get latency at scale.
+ *
+ * For each key count, inserts N distinct keys into a fresh index, then looks
+ * them up in a scattered order (hits) and looks up as many absent keys
+ * (misses). Memory per key is the resident-set growth across the inserts, so
+ * allocator overhead is charged too. Short keys (16 bytes) and long keys
+ * (40 bytes) are measured separately, each in a child process so memory
+ * freed by one run does not hide the next one's growth.
+ *
+ * Usage: index_bench [n ...]   (default 1000000 10000000)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "storage/index.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t rss_bytes(void) {
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    unsigned long pages = 0, resident = 0;
+    int ok = fscanf(f, "%lu %lu", &pages, &resident) == 2;
+    fclose(f);
+    return ok ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+static size_t make_key(char *buf, size_t i, int long_keys) {
+    if (long_keys)
+        return (size_t)snprintf(buf, 48, "tenant-0042/mailbox/%020zu", i);
+    return (size_t)snprintf(buf, 48, "k:%014zu", i);
+}
+
+static int run(size_t n, int long_keys) {
+    char k[48];
+    size_t rss0 = rss_bytes();
+    po_index_t *idx = po_index_create(1024);
+    if (!idx)
+        return -1;
+
+    uint64_t t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        size_t kl = make_key(k, i, long_keys);
+        if (po_index_put(idx, k, kl, (uint64_t)i * 64, (uint32_t)i) != 0) {
+            po_index_destroy(&idx);
+            return -1;
+        }
+    }
+    uint64_t t1 = now_ns();
+    size_t rss1 = rss_bytes();
+
+    // Scattered hits: stride through the keys with a step coprime to n
+    size_t step = 2654435761u % n;
+    while (step == 0 || n % step == 0)
+        step++;
+    uint64_t sum = 0;
+    size_t at = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t kl = make_key(k, at, long_keys);
+        uint64_t off = 0;
+        uint32_t len = 0;
+        if (po_index_get(idx, k, kl, &off, &len) != 0 || off != (uint64_t)at * 64) {
+            fprintf(stderr, "lookup of key %zu failed\n", at);
+            po_index_destroy(&idx);
+            return -1;
+        }
+        sum += len;
+        at = (at + step) % n;
+    }
+    uint64_t t2 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        size_t kl = make_key(k, n + i, long_keys);
+        if (po_index_get(idx, k, kl, NULL, NULL) == 0) {
+            fprintf(stderr, "absent key %zu found\n", n + i);
+            po_index_destroy(&idx);
+            return -1;
+        }
+    }
+    uint64_t t3 = now_ns();
+    po_index_destroy(&idx);
+
+    printf("%9zu keys %-5s  %6.1f B/key  put %6.1f ns  get %6.1f ns  miss %6.1f ns  (%llu)\n", n,
+           long_keys ? "40B" : "16B", rss1 > rss0 ? (double)(rss1 - rss0) / (double)n : 0.0,
+           (double)(t1 - t0) / (double)n, (double)(t2 - t1) / (double)n,
+           (double)(t3 - t2) / (double)n, (unsigned long long)(sum & 1u));
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t defaults[] = {1000000, 10000000};
+    size_t count = argc > 1 ? (size_t)(argc - 1) : sizeof(defaults) / sizeof(defaults[0]);
+    for (size_t i = 0; i < count; i++) {
+        size_t n = argc > 1 ? (size_t)strtoull(argv[i + 1], NULL, 10) : defaults[i];
+        if (n < 2)
+            n = 2;
+        for (int long_keys = 0; long_keys < 2; long_keys++) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0) {
+                int rc = run(n, long_keys);
+                fflush(stdout);
+                _exit(rc == 0 ? 0 : 1);
+            }
+            int status = 0;
+            if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+                WEXITSTATUS(status) != 0) {
+                fprintf(stderr, "benchmark failed\n");
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file logger_deferred_bench.c
+ * @brief Benchmark: producer-side cost of LOG_INFO with inline vs deferred formatting.
+ *
+ * Times only the calling thread: bursts of half the ring are logged, then the
+ * consumer is given time to drain before the next burst, so no call hits the
+ * overflow path. Modes:
+ *  - inline:           vsnprintf on the caller, text file sink
+ *  - deferred:         arguments captured, rendered by the consumer, text sink
+ *  - deferred+binary:  arguments captured, never rendered (.polog sink)
+ *
+ * Usage: logger_deferred_bench [calls]   (default 1000000)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+
+#define RING (1u << 14)
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double run(unsigned long calls, bool deferred, bool binary) {
+    po_logger_config_t cfg = {
+        .level = LOG_INFO,
+        .ring_capacity = RING,
+        .consumers = 1,
+        .policy = LOGGER_DROP_NEW,
+        .deferred_format = deferred,
+    };
+    if (po_logger_init(&cfg) != 0) {
+        fprintf(stderr, "logger init failed\n");
+        exit(1);
+    }
+    if (binary)
+        po_logger_add_sink_binary("/dev/null", true);
+    else
+        po_logger_add_sink_file("/dev/null", true);
+
+    static const char *const services[] = {"letters", "parcels", "registered"};
+    uint64_t spent = 0;
+    for (unsigned long done = 0; done < calls;) {
+        unsigned long burst = calls - done < RING / 2 ? calls - done : RING / 2;
+        uint64_t t0 = now_ns();
+        for (unsigned long i = done; i < done + burst; i++)
+            LOG_INFO("Ticket %lu dispatched to worker %d (service=%s, queue=%zu, wait=%.2f ms)", i,
+                     (int)(i % 64), services[i % 3], (size_t)(i & 255), (double)(i % 1000) / 7.0);
+        spent += now_ns() - t0;
+        done += burst;
+        usleep(20000); // let the consumer drain
+    }
+    po_logger_shutdown();
+    return (double)spent / (double)calls;
+}
+
+int main(int argc, char **argv) {
+    unsigned long calls = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    if (calls == 0)
+        calls = 1;
+    double inl = run(calls, false, false);
+    double def = run(calls, true, false);
+    double bin = run(calls, true, true);
+    printf("inline           %7.1f ns/call\n", inl);
+    printf("deferred         %7.1f ns/call  (%.2fx)\n", def, inl / def);
+    printf("deferred+binary  %7.1f ns/call  (%.2fx)\n", bin, inl / bin);
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file logger_footprint_bench.c
+ * @brief Benchmark: logger memory footprint and cache misses per record.
+ *
+ * Initializes the logger as users_manager does (ring_capacity 8192), then
+ * logs short messages ("Worker %d Online") in bursts of half the ring capacity,
+ * waiting for the consumer between bursts. Reports:
+ *  - resident memory added by po_logger_init() plus the traffic (every ring
+ *    byte has been touched by then);
+ *  - ns per LOG_INFO on the calling thread, and hardware cache misses and
+ *    cycles per call from perf_event_open (user space only; "n/a" where the
+ *    kernel does not allow it).
+ *
+ * Usage: logger_footprint_bench [records]   (default 200000)
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+
+#define RING 8192u
+
+static long rss_kib(void) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+        return -1;
+    char line[256];
+    long kib = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            kib = strtol(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return kib;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int counter_open(uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t counter_read(int fd) {
+    uint64_t v = 0;
+    if (fd < 0 || read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v))
+        return 0;
+    return v;
+}
+
+int main(int argc, char **argv) {
+    unsigned long records = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+    if (records == 0)
+        records = 1;
+
+    long rss0 = rss_kib();
+    po_logger_config_t cfg = {
+        .level = LOG_INFO,
+        .ring_capacity = RING,
+        .consumers = 1,
+        .policy = LOGGER_DROP_NEW,
+    };
+    if (po_logger_init(&cfg) != 0) {
+        fprintf(stderr, "logger init failed\n");
+        return 1;
+    }
+    po_logger_add_sink_file("/dev/null", true);
+    long rss_init = rss_kib();
+
+    int misses = counter_open(PERF_COUNT_HW_CACHE_MISSES);
+    int cycles = counter_open(PERF_COUNT_HW_CPU_CYCLES);
+    uint64_t spent = 0;
+    for (unsigned long done = 0; done < records;) {
+        unsigned long burst = records - done < RING / 2 ? records - done : RING / 2;
+        if (misses >= 0)
+            ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+        if (cycles >= 0)
+            ioctl(cycles, PERF_EVENT_IOC_ENABLE, 0);
+        uint64_t t0 = now_ns();
+        for (unsigned long i = done; i < done + burst; i++)
+            LOG_INFO("Worker %d Online", (int)(i % 64));
+        spent += now_ns() - t0;
+        if (misses >= 0)
+            ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+        if (cycles >= 0)
+            ioctl(cycles, PERF_EVENT_IOC_DISABLE, 0);
+        done += burst;
+        usleep(20000); // let the consumer drain
+    }
+    long rss_used = rss_kib();
+    po_logger_shutdown();
+
+    printf("resident after init   %6ld KiB\n", rss_init - rss0);
+    printf("resident after use    %6ld KiB\n", rss_used - rss0);
+    printf("ns/record             %6.0f\n", (double)spent / (double)records);
+    if (misses >= 0 && cycles >= 0) {
+        printf("cache misses/record   %6.2f\n", (double)counter_read(misses) / (double)records);
+        printf("cycles/record         %6.0f\n", (double)counter_read(cycles) / (double)records);
+    } else {
+        printf("cache misses/record      n/a (perf_event_open not permitted)\n");
+    }
+    return 0;
+}
@@ -3,8 +3,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+// read(2) + write(2) calls made by this process so far (all threads)
+static unsigned long long io_syscalls(void) {
+    FILE *f = fopen("/proc/self/io", "r");
+    if (!f)
+        return 0;
+    char key[32];
+    unsigned long long v, total = 0;
+    while (fscanf(f, "%31[^:]: %llu\n", key, &v) == 2) {
+        if (strcmp(key, "syscr") == 0 || strcmp(key, "syscw") == 0)
+            total += v;
+    }
+    fclose(f);
+    return total;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
 int main(void) {
     po_log_level_t level = LOG_DEBUG;
 
@@ -48,6 +70,24 @@ int main(void) {
         return 1;
     }
 
+    // SMOKE_RECORDS=N: throughput mode, N records into /dev/null, then report
+    // records/sec and read+write syscalls per record.
+    const char *records_env = getenv("SMOKE_RECORDS");
+    unsigned long records = records_env ? strtoul(records_env, NULL, 10) : 0;
+    if (records > 0) {
+        po_logger_add_sink_file("/dev/null", true);
+        unsigned long long sys0 = io_syscalls();
+        double t0 = now_s();
+        for (unsigned long i = 0; i < records; i++)
+            LOG_INFO("record %lu", i);
+        po_logger_shutdown(); // Drains the ring
+        double elapsed = now_s() - t0;
+        unsigned long long sys = io_syscalls() - sys0;
+        printf("records=%lu rate=%.0f rec/s syscalls/record=%.3f\n", records,
+               (double)records / elapsed, (double)sys / (double)records);
+        return 0;
+    }
+
     po_logger_add_sink_console(true);
 
     const char *use_syslog = getenv("SYSLOG");
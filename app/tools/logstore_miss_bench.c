@@ -0,0 +1,118 @@
+/**
+ * @file logstore_miss_bench.c
+ * @brief Benchmark: po_logstore_get() of absent keys with and without the Bloom filter.
+ *
+ * Stores N keys, then looks up N keys that were never written: once as the
+ * store runs (the filter answers) and once with the filter detached, so every
+ * miss opens an LMDB read transaction. Hits are timed for reference.
+ *
+ * Usage: logstore_miss_bench [keys] [dir]   (defaults 1000000, /tmp)
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "storage/logstore.h"
+#include "storage/logstore_internal.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Mean ns per po_logstore_get() over keys "<prefix><i>"; counts the hits.
+static double time_gets(po_logstore_t *ls, const char *prefix, size_t n, size_t *hits) {
+    char k[32];
+    *hits = 0;
+    uint64_t t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        int kl = snprintf(k, sizeof(k), "%s%010zu", prefix, i);
+        void *val = NULL;
+        size_t vl = 0;
+        if (po_logstore_get(ls, k, (size_t)kl, &val, &vl) == 0)
+            (*hits)++;
+        free(val);
+    }
+    return (double)(now_ns() - t0) / (double)n;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+    const char *parent = argc > 2 ? argv[2] : "/tmp";
+    if (n == 0)
+        n = 1;
+
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s/ls_miss_benchXXXXXX", parent);
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    po_logstore_cfg cfg = {
+        .dir = dir,
+        .bucket = "bench",
+        .map_size = 1u << 30,
+        .ring_capacity = 4096,
+        .batch_size = 256,
+        .fsync_policy = PO_LS_FSYNC_NONE,
+        .segment_bytes = 64u << 20,
+    };
+    po_logstore_t *ls = po_logstore_open_cfg(&cfg);
+    if (!ls) {
+        fprintf(stderr, "logstore open failed\n");
+        return 1;
+    }
+
+    char k[32], v[64];
+    memset(v, 'v', sizeof(v));
+    po_logstore_token tok = 0;
+    for (size_t i = 0; i < n; i++) {
+        int kl = snprintf(k, sizeof(k), "key/%010zu", i);
+        while (po_logstore_append_async(ls, k, (size_t)kl, v, sizeof(v), &tok) != 0)
+            usleep(100); // queue full
+    }
+    if (po_logstore_wait_durable(ls, tok, 120000) != 0) {
+        fprintf(stderr, "flush failed\n");
+        return 1;
+    }
+
+    size_t hits = 0;
+    double hit_ns = time_gets(ls, "key/", n, &hits);
+    printf("hits            %8zu keys  %7.0f ns/op\n", hits, hit_ns);
+    int ok = hits == n;
+
+    double bloom_ns = time_gets(ls, "nokey/", n, &hits);
+    ok &= hits == 0;
+    po_logstore_bloom_stats st;
+    po_logstore_get_bloom_stats(ls, &st);
+    printf("misses, filter  %8zu keys  %7.0f ns/op  (%zu KiB, fp rate %.4f)\n", n, bloom_ns,
+           st.bytes >> 10, st.fp_rate);
+
+    // No appends are in flight, so nothing adds to the filter while detached
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    ls_bloom_t *saved = ls->bloom;
+    ls->bloom = NULL;
+    pthread_rwlock_unlock(&ls->idx_lock);
+    double lmdb_ns = time_gets(ls, "nokey/", n, &hits);
+    ok &= hits == 0;
+    pthread_rwlock_wrlock(&ls->idx_lock);
+    ls->bloom = saved;
+    pthread_rwlock_unlock(&ls->idx_lock);
+    printf("misses, LMDB    %8zu keys  %7.0f ns/op  (%.1fx)\n", n, lmdb_ns, lmdb_ns / bloom_ns);
+
+    po_logstore_close(&ls);
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    if (system(cmd) != 0)
+        fprintf(stderr, "cleanup of %s failed\n", dir);
+    return ok ? 0 : 1;
+}
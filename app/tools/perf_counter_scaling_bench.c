@@ -0,0 +1,90 @@
+/**
+ * @file perf_counter_scaling_bench.c
+ * @brief Benchmark: plain vs sharded perf counters under thread contention.
+ *
+ * Every thread hammers the same counter through po_perf_counter_inc_by_idx()
+ * (the PO_METRIC_COUNTER_* fast path). A plain counter is one shared atomic;
+ * a sharded one spreads increments over per-CPU slots, so its cost per
+ * increment should stay flat as threads are added.
+ *
+ * Usage: perf_counter_scaling_bench [increments_per_thread]   (default 100000)
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "perf/perf.h"
+
+typedef struct {
+    int idx;
+    size_t increments;
+} inc_args_t;
+
+static pthread_barrier_t g_barrier;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *inc_thread(void *arg) {
+    inc_args_t *a = (inc_args_t *)arg;
+    pthread_barrier_wait(&g_barrier);
+    for (size_t i = 0; i < a->increments; i++)
+        po_perf_counter_inc_by_idx(a->idx);
+    return NULL;
+}
+
+// Returns ns per increment
+static double run(int idx, int threads, size_t increments) {
+    pthread_t tids[64];
+    inc_args_t args = {.idx = idx, .increments = increments};
+    pthread_barrier_init(&g_barrier, NULL, (unsigned)threads + 1);
+    for (int t = 0; t < threads; t++)
+        pthread_create(&tids[t], NULL, inc_thread, &args);
+
+    uint64_t t0 = now_ns();
+    pthread_barrier_wait(&g_barrier);
+    for (int t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+    uint64_t elapsed = now_ns() - t0;
+    pthread_barrier_destroy(&g_barrier);
+
+    return (double)elapsed / ((double)threads * (double)increments);
+}
+
+int main(int argc, char **argv) {
+    size_t increments = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    static const int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    if (po_perf_init(4, 0, 0) != 0 || po_perf_counter_create("bench_plain") != 0 ||
+        po_perf_counter_create_sharded("bench_sharded") != 0) {
+        fprintf(stderr, "perf init failed\n");
+        return 1;
+    }
+    int plain = po_perf_counter_lookup("bench_plain");
+    int sharded = po_perf_counter_lookup("bench_sharded");
+
+    uint64_t expected = 0;
+    printf("Perf counter scaling benchmark (%zu increments per thread)\n", increments);
+    printf("%-8s %14s %16s %8s\n", "threads", "plain ns/inc", "sharded ns/inc", "speedup");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        int t = thread_counts[i];
+        double p = run(plain, t, increments);
+        double sh = run(sharded, t, increments);
+        printf("%-8d %14.1f %16.1f %7.2fx\n", t, p, sh, p / sh);
+        expected += (uint64_t)t * increments;
+    }
+
+    uint64_t value = 0;
+    po_perf_counter_value("bench_sharded", &value);
+    if (value != expected)
+        fprintf(stderr, "sharded total %lu, expected %lu\n", (unsigned long)value,
+                (unsigned long)expected);
+    po_perf_shutdown(NULL);
+    return value == expected ? 0 : 1;
+}
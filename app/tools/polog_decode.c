@@ -0,0 +1,53 @@
+/**
+ * @file polog_decode.c
+ * @brief Decode binary `.polog` logs into the text sinks' line format.
+ *
+ * Usage: polog_decode file.polog [more.polog ...]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "log/logfmt.h"
+
+static const char *const level_names[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "FATAL"};
+
+static int decode(const char *path) {
+    po_polog_reader_t *r = po_polog_open(path);
+    if (!r) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    po_polog_entry e;
+    int rc;
+    while ((rc = po_polog_next(r, &e)) == 1) {
+        time_t sec = (time_t)(e.ts_ns / 1000000000ull);
+        struct tm tm_val;
+        char ts[32];
+        localtime_r(&sec, &tm_val);
+        strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &tm_val);
+        printf("%s.%06llu %llu %s %s:%u %s\n", ts,
+               (unsigned long long)(e.ts_ns % 1000000000ull / 1000ull),
+               (unsigned long long)e.tid, e.level < 6 ? level_names[e.level] : "UNK  ", e.file,
+               e.line, e.msg);
+    }
+    if (rc < 0)
+        fprintf(stderr, "%s: truncated or corrupt entry\n", path);
+    po_polog_close(&r);
+    return rc;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file.polog [more.polog ...]\n", argv[0]);
+        return 2;
+    }
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        if (decode(argv[i]) != 0)
+            status = 1;
+    }
+    return status;
+}